@@ -11,12 +11,13 @@
 #include "SkOSFile.h"
 
 BitmapRegionDecoderBench::BitmapRegionDecoderBench(const char* baseName, SkData* encoded,
-        SkColorType colorType, uint32_t sampleSize, const SkIRect& subset)
+        SkColorType colorType, uint32_t sampleSize, const SkIRect& subset, int tileSize)
     : fBRD(nullptr)
     , fData(SkRef(encoded))
     , fColorType(colorType)
     , fSampleSize(sampleSize)
     , fSubset(subset)
+    , fTileSize(tileSize)
 {
     // Choose a useful name for the color type
     const char* colorName = color_type_to_str(colorType);
@@ -43,7 +44,20 @@ void BitmapRegionDecoderBench::onDraw(int n, SkCanvas* canvas) {
     auto ct = fBRD->computeOutputColorType(fColorType);
     auto cs = fBRD->computeOutputColorSpace(ct, nullptr);
     for (int i = 0; i < n; i++) {
-        SkBitmap bm;
-        SkAssertResult(fBRD->decodeRegion(&bm, nullptr, fSubset, fSampleSize, ct, false, cs));
+        if (0 == fTileSize) {
+            SkBitmap bm;
+            SkAssertResult(fBRD->decodeRegion(&bm, nullptr, fSubset, fSampleSize, ct, false, cs));
+            continue;
+        }
+
+        for (int y = fSubset.top(); y < fSubset.bottom(); y += fTileSize) {
+            for (int x = fSubset.left(); x < fSubset.right(); x += fTileSize) {
+                SkIRect tile = SkIRect::MakeXYWH(x, y, fTileSize, fTileSize);
+                SkAssertResult(tile.intersect(fSubset));
+                SkBitmap bm;
+                SkAssertResult(fBRD->decodeRegion(&bm, nullptr, tile, fSampleSize, ct, false,
+                                                  cs));
+            }
+        }
     }
 }
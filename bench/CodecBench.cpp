@@ -10,10 +10,19 @@
 #include "SkBitmap.h"
 #include "SkCodec.h"
 #include "SkCommandLineFlags.h"
+#include "SkExecutor.h"
 #include "SkOSFile.h"
 
 // Actually zeroing the memory would throw off timing, so we just lie.
 DEFINE_bool(zero_init, false, "Pretend our destination is zero-intialized, simulating Android?");
+DEFINE_int32(codec_threads, 0, "If positive, let codecs decode in parallel on this many threads.");
+
+static SkExecutor* codec_executor() {
+    static SkExecutor* executor = FLAGS_codec_threads > 0
+            ? SkExecutor::MakeFIFOThreadPool(FLAGS_codec_threads).release()
+            : nullptr;
+    return executor;
+}
 
 CodecBench::CodecBench(SkString baseName, SkData* encoded, SkColorType colorType,
         SkAlphaType alphaType)
@@ -52,6 +61,7 @@ void CodecBench::onDraw(int n, SkCanvas* canvas) {
     if (FLAGS_zero_init) {
         options.fZeroInitialized = SkCodec::kYes_ZeroInitialized;
     }
+    options.fExecutor = codec_executor();
     for (int i = 0; i < n; i++) {
         codec = SkCodec::MakeFromData(fData);
 #ifdef SK_DEBUG
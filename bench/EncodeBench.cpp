@@ -8,6 +8,8 @@
 #include "Benchmark.h"
 #include "Resources.h"
 #include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkExecutor.h"
 #include "SkJpegEncoder.h"
 #include "SkPngEncoder.h"
 #include "SkWebpEncoder.h"
@@ -123,3 +125,62 @@ DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 3), "PNG_3n"));
 DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 1), "PNG_1n"));
 
 #undef PNG
+
+// Encodes a large png (one of the sources drawn 8x larger) either in one piece, or split into
+// bands that are filtered and compressed in parallel.
+class PngBandsBench : public Benchmark {
+public:
+    PngBandsBench(const char* filename, bool bands)
+        : fSourceFilename(filename)
+        , fBands(bands)
+        , fName(SkStringPrintf("Encode_%s_PNG_8x%s", filename, bands ? "_bands" : "")) {}
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        SkBitmap src;
+        SkAssertResult(GetResourceAsBitmap(fSourceFilename, &src));
+        fBitmap.allocPixels(src.info().makeWH(8 * src.width(), 8 * src.height()));
+        SkCanvas canvas(fBitmap);
+        canvas.scale(8, 8);
+        canvas.drawBitmap(src, 0, 0);
+
+        if (fBands) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool();
+
+            // Splitting the image costs a little in size; log how much.
+            SkNullWStream bands, whole;
+            SkAssertResult(this->encode(&bands, fExecutor.get()));
+            SkAssertResult(this->encode(&whole, nullptr));
+            SkDebugf("%s: %zu bytes in bands, %zu in one piece\n",
+                     fName.c_str(), bands.bytesWritten(), whole.bytesWritten());
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        while (loops-- > 0) {
+            SkNullWStream dst;
+            SkAssertResult(this->encode(&dst, fExecutor.get()));
+        }
+    }
+
+private:
+    bool encode(SkWStream* dst, SkExecutor* executor) {
+        SkPngEncoder::Options opts;
+        opts.fExecutor = executor;
+        return SkPngEncoder::Encode(dst, fBitmap.pixmap(), opts);
+    }
+
+    const char*                 fSourceFilename;
+    const bool                  fBands;
+    SkString                    fName;
+    SkBitmap                    fBitmap;
+    std::unique_ptr<SkExecutor> fExecutor;
+};
+
+DEF_BENCH(return new PngBandsBench(srcs[0], false));
+DEF_BENCH(return new PngBandsBench(srcs[0], true));
+DEF_BENCH(return new PngBandsBench(srcs[1], false));
+DEF_BENCH(return new PngBandsBench(srcs[1], true));
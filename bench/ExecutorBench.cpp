@@ -0,0 +1,64 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "SkExecutor.h"
+#include "SkString.h"
+#include "SkTaskGroup.h"
+
+#include <atomic>
+
+// Measures how quickly each kind of thread pool gets through many tiny tasks from
+// SkTaskGroup::batch(), where the executor's own overhead dominates the work itself.
+class ExecutorBench : public Benchmark {
+public:
+    using Factory = std::unique_ptr<SkExecutor>(*)(int);
+
+    ExecutorBench(const char* name, Factory factory, int tasks)
+        : fFactory(factory)
+        , fTasks(tasks) {
+        fName.printf("executor_%s_%d", name, tasks);
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        fExecutor = fFactory(0);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        std::atomic<int64_t> sum{0};
+        for (int i = 0; i < loops; i++) {
+            SkTaskGroup tg(*fExecutor);
+            tg.batch(fTasks, [&](int j) {
+                sum.fetch_add(j, std::memory_order_relaxed);
+            });
+            tg.wait();
+        }
+        SkASSERT(sum.load() == loops * ((int64_t)fTasks * (fTasks - 1) / 2));
+    }
+
+private:
+    SkString                    fName;
+    Factory                     fFactory;
+    int                         fTasks;
+    std::unique_ptr<SkExecutor> fExecutor;
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return new ExecutorBench("fifo",     SkExecutor::MakeFIFOThreadPool,           100); )
+DEF_BENCH( return new ExecutorBench("lifo",     SkExecutor::MakeLIFOThreadPool,           100); )
+DEF_BENCH( return new ExecutorBench("stealing", SkExecutor::MakeWorkStealingThreadPool,   100); )
+DEF_BENCH( return new ExecutorBench("fifo",     SkExecutor::MakeFIFOThreadPool,         10000); )
+DEF_BENCH( return new ExecutorBench("lifo",     SkExecutor::MakeLIFOThreadPool,         10000); )
+DEF_BENCH( return new ExecutorBench("stealing", SkExecutor::MakeWorkStealingThreadPool, 10000); )
@@ -6,7 +6,10 @@
  */
 
 #include "Benchmark.h"
+#include "SkExecutor.h"
 #include "SkResourceCache.h"
+#include "SkString.h"
+#include "SkTaskGroup.h"
 
 namespace {
 static void* gGlobalAddress;
@@ -72,6 +75,61 @@ private:
     typedef Benchmark INHERITED;
 };
 
+// Several threads hammering one SkShardedResourceCache with a mix of hits, misses and adds,
+// as our decode and draw workers do with the global cache.
+class ContendedImageCacheBench : public Benchmark {
+    enum {
+        CACHE_COUNT = 500,
+        THREADS     = 4,
+        OPS         = 1000,   // per thread per loop
+    };
+
+    const int                               fShards;
+    SkString                                fName;
+    std::unique_ptr<SkExecutor>             fExecutor;
+    std::unique_ptr<SkShardedResourceCache> fCache;
+
+public:
+    ContendedImageCacheBench(int shards) : fShards(shards) {
+        fName.printf("imagecache_contended_%dshards", shards);
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    void onDelayedSetup() override {
+        fExecutor = SkExecutor::MakeFIFOThreadPool(THREADS);
+        // Leave enough room that adds mostly replace entries rather than evict them.
+        fCache.reset(new SkShardedResourceCache(fShards, CACHE_COUNT * 100));
+        for (int i = 0; i < CACHE_COUNT; ++i) {
+            fCache->add(new TestRec(TestKey(i), i));
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkTaskGroup tg(*fExecutor);
+        for (int loop = 0; loop < loops; ++loop) {
+            tg.batch(THREADS, [&](int thread) {
+                for (int i = 0; i < OPS; ++i) {
+                    // Walk the keys in a different order on each thread.
+                    intptr_t k = (i * 7 + thread * 131) % (CACHE_COUNT + CACHE_COUNT / 4);
+                    if (!fCache->find(TestKey(k), TestRec::Visitor, nullptr) && k % 4 == 0) {
+                        fCache->add(new TestRec(TestKey(k), k));
+                    }
+                }
+            });
+            tg.wait();
+        }
+    }
+
+private:
+    typedef Benchmark INHERITED;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 DEF_BENCH( return new ImageCacheBench(); )
+DEF_BENCH( return new ContendedImageCacheBench(1); )
+DEF_BENCH( return new ContendedImageCacheBench(8); )
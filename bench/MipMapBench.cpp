@@ -7,21 +7,29 @@
 
 #include "Benchmark.h"
 #include "SkBitmap.h"
+#include "SkExecutor.h"
 #include "SkMipMap.h"
 
 class MipMapBench: public Benchmark {
     SkBitmap fBitmap;
     SkString fName;
     const int fW, fH;
-    bool fHalfFoat;
+    const SkColorType fColorType;
+    const bool fThreaded;
+    std::unique_ptr<SkExecutor> fExecutor;
 
 public:
-    MipMapBench(int w, int h, bool halfFloat = false)
-        : fW(w), fH(h), fHalfFoat(halfFloat)
+    MipMapBench(int w, int h, SkColorType ct = kN32_SkColorType, bool threaded = false)
+        : fW(w), fH(h), fColorType(ct), fThreaded(threaded)
     {
         fName.printf("mipmap_build_%dx%d", w, h);
-        if (halfFloat) {
+        if (kRGBA_F16_SkColorType == ct) {
             fName.append("_f16");
+        } else if (kAlpha_8_SkColorType == ct) {
+            fName.append("_a8");
+        }
+        if (threaded) {
+            fName.append("_threaded");
         }
     }
 
@@ -33,16 +41,18 @@ protected:
     const char* onGetName() override { return fName.c_str(); }
 
     void onDelayedSetup() override {
-        SkColorType ct = fHalfFoat ? kRGBA_F16_SkColorType : kN32_SkColorType;
-        SkImageInfo info = SkImageInfo::Make(fW, fH, ct, kPremul_SkAlphaType,
+        SkImageInfo info = SkImageInfo::Make(fW, fH, fColorType, kPremul_SkAlphaType,
                                              SkColorSpace::MakeSRGB());
         fBitmap.allocPixels(info);
         fBitmap.eraseColor(SK_ColorWHITE);  // so we don't read uninitialized memory
+        if (fThreaded) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool();
+        }
     }
 
     void onDraw(int loops, SkCanvas*) override {
         for (int i = 0; i < loops * 4; i++) {
-            SkMipMap::Build(fBitmap, nullptr)->unref();
+            SkMipMap::Build(fBitmap, nullptr, fExecutor.get())->unref();
         }
     }
 
@@ -58,10 +68,19 @@ DEF_BENCH( return new MipMapBench(512, 511); )
 DEF_BENCH( return new MipMapBench(511, 512); )
 DEF_BENCH( return new MipMapBench(512, 512); )
 
-DEF_BENCH( return new MipMapBench(512, 512, true); )
-DEF_BENCH( return new MipMapBench(511, 511, true); )
+DEF_BENCH( return new MipMapBench(512, 512, kRGBA_F16_SkColorType); )
+DEF_BENCH( return new MipMapBench(511, 511, kRGBA_F16_SkColorType); )
+
+DEF_BENCH( return new MipMapBench(512, 512, kAlpha_8_SkColorType); )
+DEF_BENCH( return new MipMapBench(511, 511, kAlpha_8_SkColorType); )
 
 DEF_BENCH( return new MipMapBench(2048, 2048); )
 DEF_BENCH( return new MipMapBench(2047, 2047); )
 DEF_BENCH( return new MipMapBench(2048, 2047); )
 DEF_BENCH( return new MipMapBench(2047, 2048); )
+
+// Large enough for the first few levels to be split into bands and built in parallel.
+DEF_BENCH( return new MipMapBench(4096, 4096, kN32_SkColorType); )
+DEF_BENCH( return new MipMapBench(4096, 4096, kN32_SkColorType, true); )
+DEF_BENCH( return new MipMapBench(4096, 4096, kRGBA_F16_SkColorType, true); )
+DEF_BENCH( return new MipMapBench(4095, 4095, kN32_SkColorType, true); )
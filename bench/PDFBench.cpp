@@ -12,6 +12,7 @@
 #include "SkData.h"
 #include "SkExecutor.h"
 #include "SkFloatToDecimal.h"
+#include "SkFont.h"
 #include "SkGradientShader.h"
 #include "SkImage.h"
 #include "SkPDFUnion.h"
@@ -157,11 +158,18 @@ private:
     alternate zlib settings, usage, and library versions. */
 class PDFCompressionBench : public Benchmark {
 public:
-    PDFCompressionBench() {}
+    PDFCompressionBench(SkPDF::Metadata::CompressionLevel level
+                                = SkPDF::Metadata::CompressionLevel::Default)
+        : fLevel(level) {
+        fName = "PDFCompression";
+        if (SkPDF::Metadata::CompressionLevel::Default != level) {
+            fName.appendf("_%d", (int)level);
+        }
+    }
     ~PDFCompressionBench() override {}
 
 protected:
-    const char* onGetName() override { return "PDFCompression"; }
+    const char* onGetName() override { return fName.c_str(); }
     bool isSuitableFor(Backend backend) override {
         return backend == kNonRendering_Backend;
     }
@@ -173,13 +181,17 @@ protected:
         if (!fAsset) { return; }
         while (loops-- > 0) {
             SkNullWStream wStream;
-            SkPDFDocument doc(&wStream, SkPDF::Metadata());
+            SkPDF::Metadata metadata;
+            metadata.fCompressionLevel = fLevel;
+            SkPDFDocument doc(&wStream, metadata);
             doc.beginPage(256, 256);
             (void)SkPDFStreamOut(nullptr, fAsset->duplicate(), &doc, true);
        }
     }
 
 private:
+    SkPDF::Metadata::CompressionLevel fLevel;
+    SkString fName;
     std::unique_ptr<SkStreamAsset> fAsset;
 };
 
@@ -247,6 +259,8 @@ struct WritePDFTextBenchmark : public Benchmark {
 DEF_BENCH(return new PDFImageBench;)
 DEF_BENCH(return new PDFJpegImageBench;)
 DEF_BENCH(return new PDFCompressionBench;)
+DEF_BENCH(return new PDFCompressionBench(SkPDF::Metadata::CompressionLevel::LowButFast);)
+DEF_BENCH(return new PDFCompressionBench(SkPDF::Metadata::CompressionLevel::HighButSlow);)
 DEF_BENCH(return new PDFColorComponentBench;)
 DEF_BENCH(return new PDFShaderBench;)
 DEF_BENCH(return new WritePDFTextBenchmark;)
@@ -352,9 +366,10 @@ SkBitmap make_background() {
 
 struct PDFBigDocBench : public Benchmark {
     bool fFast;
+    bool fStreaming;
     SkBitmap fBackground;
     std::unique_ptr<SkExecutor> fExecutor;
-    PDFBigDocBench(bool fast) : fFast(fast) {}
+    PDFBigDocBench(bool fast, bool streaming = false) : fFast(fast), fStreaming(streaming) {}
     void onDelayedSetup() override {
         fBackground = make_background();
         fExecutor = fFast ? SkExecutor::MakeFIFOThreadPool() : nullptr;
@@ -362,7 +377,8 @@ struct PDFBigDocBench : public Benchmark {
     const char* onGetName() override {
         static const char kNameFast[] = "PDFBigDocBench_fast";
         static const char kNameSlow[] = "PDFBigDocBench_slow";
-        return fFast ? kNameFast : kNameSlow;
+        static const char kNameStreaming[] = "PDFBigDocBench_streaming";
+        return fStreaming ? kNameStreaming : fFast ? kNameFast : kNameSlow;
     }
     bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
     void onDraw(int loops, SkCanvas*) override {
@@ -374,6 +390,7 @@ struct PDFBigDocBench : public Benchmark {
             #endif
             SkPDF::Metadata metadata;
             metadata.fExecutor = fExecutor.get();
+            metadata.fStreaming = fStreaming;
             auto doc = SkPDF::MakeDocument(&wStream, metadata);
             big_pdf_test(doc.get(), fBackground);
         }
@@ -382,6 +399,7 @@ struct PDFBigDocBench : public Benchmark {
 }  // namespace
 DEF_BENCH(return new PDFBigDocBench(false);)
 DEF_BENCH(return new PDFBigDocBench(true);)
+DEF_BENCH(return new PDFBigDocBench(true, true);)
 #endif
 
 #endif // SK_SUPPORT_PDF
@@ -7,7 +7,9 @@
 #include "Benchmark.h"
 #include "SkCanvas.h"
 #include "SkColor.h"
+#include "SkData.h"
 #include "SkPaint.h"
+#include "SkPath.h"
 #include "SkPicture.h"
 #include "SkPictureRecorder.h"
 #include "SkPoint.h"
@@ -22,7 +24,7 @@
 // Chrome draws into small tiles with impl-side painting.
 // This benchmark measures the relative performance of our bounding-box hierarchies,
 // both when querying tiles perfectly and when not.
-enum BBH  { kNone, kRTree };
+enum BBH  { kNone, kRTree, kPackedRTree };
 enum Mode { kTiled, kRandom };
 class TiledPlaybackBench : public Benchmark {
 public:
@@ -30,6 +32,7 @@ public:
         switch (fBBH) {
             case kNone:     fName.append("_none"    ); break;
             case kRTree:    fName.append("_rtree"   ); break;
+            case kPackedRTree: fName.append("_packedrtree"); break;
         }
         switch (fMode) {
             case kTiled:  fName.append("_tiled" ); break;
@@ -45,6 +48,7 @@ public:
         switch (fBBH) {
             case kNone:                                                 break;
             case kRTree:    factory.reset(new SkRTreeFactory);          break;
+            case kPackedRTree: factory.reset(new SkPackedRTreeFactory); break;
         }
 
         SkPictureRecorder recorder;
@@ -95,3 +99,138 @@ DEF_BENCH( return new TiledPlaybackBench(kNone,     kRandom); )
 DEF_BENCH( return new TiledPlaybackBench(kNone,     kTiled ); )
 DEF_BENCH( return new TiledPlaybackBench(kRTree,    kRandom); )
 DEF_BENCH( return new TiledPlaybackBench(kRTree,    kTiled ); )
+DEF_BENCH( return new TiledPlaybackBench(kPackedRTree, kRandom); )
+DEF_BENCH( return new TiledPlaybackBench(kPackedRTree, kTiled ); )
+
+// Measures loading a serialized picture, alone and with one draw, as SkPicture::MakeFromData()
+// does it and as SkPicture::MakeFromDataInPlace() does it.
+enum Load { kCopy, kInPlace };
+class PictureLoadBench : public Benchmark {
+public:
+    PictureLoadBench(Load load, bool draw) : fLoad(load), fDraw(draw), fName("picture_load") {
+        switch (fLoad) {
+            case kCopy:    fName.append("_copy"   ); break;
+            case kInPlace: fName.append("_inplace"); break;
+        }
+        if (fDraw) {
+            fName.append("_draw");
+        }
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return fDraw ? backend != kNonRendering_Backend : backend == kNonRendering_Backend;
+    }
+    const char* onGetName() override { return fName.c_str(); }
+    SkIPoint onGetSize() override { return SkIPoint::Make(1024,1024); }
+
+    void onDelayedSetup() override {
+        SkPictureRecorder recorder;
+        SkCanvas* canvas = recorder.beginRecording(1024, 1024);
+            SkRandom rand;
+            for (int i = 0; i < 10000; i++) {
+                SkScalar x = rand.nextRangeScalar(0, 1024),
+                         y = rand.nextRangeScalar(0, 1024),
+                         w = rand.nextRangeScalar(0, 128),
+                         h = rand.nextRangeScalar(0, 128);
+                SkPaint paint;
+                paint.setColor(rand.nextU());
+                paint.setAntiAlias(rand.nextBool());
+                if (i % 4) {
+                    canvas->drawRect(SkRect::MakeXYWH(x,y,w,h), paint);
+                } else {
+                    SkPath path;
+                    path.moveTo(x, y);
+                    path.quadTo(x + w, y, x + w, y + h);
+                    path.lineTo(x, y + h);
+                    path.close();
+                    canvas->drawPath(path, paint);
+                }
+            }
+        fData = recorder.finishRecordingAsPicture()->serialize();
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        for (int i = 0; i < loops; i++) {
+            sk_sp<SkPicture> pic;
+            switch (fLoad) {
+                case kCopy:    pic = SkPicture::MakeFromData(fData.get());   break;
+                case kInPlace: pic = SkPicture::MakeFromDataInPlace(fData); break;
+            }
+            if (fDraw) {
+                pic->playback(canvas);
+            }
+        }
+    }
+
+private:
+    Load                fLoad;
+    bool                fDraw;
+    SkString            fName;
+    sk_sp<SkData>       fData;
+};
+
+DEF_BENCH( return new PictureLoadBench(kCopy,    false); )
+DEF_BENCH( return new PictureLoadBench(kCopy,    true ); )
+DEF_BENCH( return new PictureLoadBench(kInPlace, false); )
+DEF_BENCH( return new PictureLoadBench(kInPlace, true ); )
+
+// Measures drawing one 256x256 tile of a large serialized picture, loading included.  An in-place
+// picture serialized with an op index (from recording with a BBH) reads only the tile's ops.
+class PictureTileBench : public Benchmark {
+public:
+    PictureTileBench(Load load, bool index) : fLoad(load), fIndex(index), fName("picture_tile") {
+        switch (fLoad) {
+            case kCopy:    fName.append("_copy"   ); break;
+            case kInPlace: fName.append("_inplace"); break;
+        }
+        if (fIndex) {
+            fName.append("_index");
+        }
+    }
+
+    const char* onGetName() override { return fName.c_str(); }
+    SkIPoint onGetSize() override { return SkIPoint::Make(256,256); }
+
+    void onDelayedSetup() override {
+        SkRTreeFactory factory;
+        SkPictureRecorder recorder;
+        SkCanvas* canvas = recorder.beginRecording(4096, 4096, fIndex ? &factory : nullptr);
+            SkRandom rand;
+            for (int i = 0; i < 50000; i++) {
+                SkScalar x = rand.nextRangeScalar(0, 4096),
+                         y = rand.nextRangeScalar(0, 4096),
+                         w = rand.nextRangeScalar(0, 64),
+                         h = rand.nextRangeScalar(0, 64);
+                SkPaint paint;
+                paint.setColor(rand.nextU());
+                canvas->drawRect(SkRect::MakeXYWH(x,y,w,h), paint);
+            }
+        fData = recorder.finishRecordingAsPicture()->serialize();
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        SkRandom rand;
+        for (int i = 0; i < loops; i++) {
+            sk_sp<SkPicture> pic;
+            switch (fLoad) {
+                case kCopy:    pic = SkPicture::MakeFromData(fData.get());   break;
+                case kInPlace: pic = SkPicture::MakeFromDataInPlace(fData); break;
+            }
+            SkAutoCanvasRestore ar(canvas, true/*save now*/);
+            canvas->clipRect(SkRect::MakeWH(256, 256));
+            canvas->translate(-SkScalar(256 * rand.nextULessThan(16)),
+                              -SkScalar(256 * rand.nextULessThan(16)));
+            pic->playback(canvas);
+        }
+    }
+
+private:
+    Load                fLoad;
+    bool                fIndex;
+    SkString            fName;
+    sk_sp<SkData>       fData;
+};
+
+DEF_BENCH( return new PictureTileBench(kCopy,    false); )
+DEF_BENCH( return new PictureTileBench(kInPlace, false); )
+DEF_BENCH( return new PictureTileBench(kInPlace, true ); )
@@ -7,6 +7,7 @@
 
 #include "Benchmark.h"
 #include "SkCanvas.h"
+#include "SkPackedRTree.h"
 #include "SkRTree.h"
 #include "SkRandom.h"
 #include "SkString.h"
@@ -19,11 +20,16 @@ static const int GRID_WIDTH = 100;
 
 typedef SkRect (*MakeRectProc)(SkRandom&, int, int);
 
+template <typename T> static const char* tree_name();
+template <> const char* tree_name<SkRTree>() { return "rtree"; }
+template <> const char* tree_name<SkPackedRTree>() { return "packedrtree"; }
+
 // Time how long it takes to build an R-Tree.
+template <typename Tree>
 class RTreeBuildBench : public Benchmark {
 public:
     RTreeBuildBench(const char* name, MakeRectProc proc) : fProc(proc) {
-        fName.printf("rtree_%s_build", name);
+        fName.printf("%s_%s_build", tree_name<Tree>(), name);
     }
 
     bool isSuitableFor(Backend backend) override {
@@ -42,7 +48,7 @@ protected:
         }
 
         for (int i = 0; i < loops; ++i) {
-            SkRTree tree;
+            Tree tree;
             tree.insert(rects.get(), NUM_BUILD_RECTS);
             SkASSERT(rects != nullptr);  // It'd break this bench if the tree took ownership of rects.
         }
@@ -54,10 +60,11 @@ private:
 };
 
 // Time how long it takes to perform queries on an R-Tree.
+template <typename Tree>
 class RTreeQueryBench : public Benchmark {
 public:
     RTreeQueryBench(const char* name, MakeRectProc proc) : fProc(proc) {
-        fName.printf("rtree_%s_query", name);
+        fName.printf("%s_%s_query", tree_name<Tree>(), name);
     }
 
     bool isSuitableFor(Backend backend) override {
@@ -89,7 +96,7 @@ protected:
         }
     }
 private:
-    SkRTree fTree;
+    Tree fTree;
     MakeRectProc fProc;
     SkString fName;
     typedef Benchmark INHERITED;
@@ -127,12 +134,22 @@ static inline SkRect make_concentric_rects(SkRandom&, int index, int numRects) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-DEF_BENCH(return new RTreeBuildBench("XY", &make_XYordered_rects));
-DEF_BENCH(return new RTreeBuildBench("YX", &make_YXordered_rects));
-DEF_BENCH(return new RTreeBuildBench("random", &make_random_rects));
-DEF_BENCH(return new RTreeBuildBench("concentric", &make_concentric_rects));
-
-DEF_BENCH(return new RTreeQueryBench("XY", &make_XYordered_rects));
-DEF_BENCH(return new RTreeQueryBench("YX", &make_YXordered_rects));
-DEF_BENCH(return new RTreeQueryBench("random", &make_random_rects));
-DEF_BENCH(return new RTreeQueryBench("concentric", &make_concentric_rects));
+DEF_BENCH(return new RTreeBuildBench<SkRTree>("XY", &make_XYordered_rects));
+DEF_BENCH(return new RTreeBuildBench<SkRTree>("YX", &make_YXordered_rects));
+DEF_BENCH(return new RTreeBuildBench<SkRTree>("random", &make_random_rects));
+DEF_BENCH(return new RTreeBuildBench<SkRTree>("concentric", &make_concentric_rects));
+
+DEF_BENCH(return new RTreeQueryBench<SkRTree>("XY", &make_XYordered_rects));
+DEF_BENCH(return new RTreeQueryBench<SkRTree>("YX", &make_YXordered_rects));
+DEF_BENCH(return new RTreeQueryBench<SkRTree>("random", &make_random_rects));
+DEF_BENCH(return new RTreeQueryBench<SkRTree>("concentric", &make_concentric_rects));
+
+DEF_BENCH(return new RTreeBuildBench<SkPackedRTree>("XY", &make_XYordered_rects));
+DEF_BENCH(return new RTreeBuildBench<SkPackedRTree>("YX", &make_YXordered_rects));
+DEF_BENCH(return new RTreeBuildBench<SkPackedRTree>("random", &make_random_rects));
+DEF_BENCH(return new RTreeBuildBench<SkPackedRTree>("concentric", &make_concentric_rects));
+
+DEF_BENCH(return new RTreeQueryBench<SkPackedRTree>("XY", &make_XYordered_rects));
+DEF_BENCH(return new RTreeQueryBench<SkPackedRTree>("YX", &make_YXordered_rects));
+DEF_BENCH(return new RTreeQueryBench<SkPackedRTree>("random", &make_random_rects));
+DEF_BENCH(return new RTreeQueryBench<SkPackedRTree>("concentric", &make_concentric_rects));
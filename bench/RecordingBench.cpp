@@ -10,6 +10,10 @@
 #include "SkLiteDL.h"
 #include "SkLiteRecorder.h"
 #include "SkPictureRecorder.h"
+#include "SkRecord.h"
+#include "SkRecordDraw.h"
+#include "SkRecordOpts.h"
+#include "SkRecorder.h"
 
 PictureCentricBench::PictureCentricBench(const char* name, const SkPicture* pic) : fName(name) {
     // Flatten the source picture in case it's trivially nested (useless for timing).
@@ -66,6 +70,59 @@ void RecordingBench::onDraw(int loops, SkCanvas*) {
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+FinishRecordingBench::FinishRecordingBench(const char* name, const SkPicture* pic,
+                                           SkExecutor* executor)
+    : INHERITED(name, pic)
+    , fExecutor(executor)
+{
+    fName.append("_finish");
+}
+
+FinishRecordingBench::~FinishRecordingBench() {}
+
+void FinishRecordingBench::onDelayedSetup() {
+    // Record and optimize once, as SkPictureRecorder would, leaving just the BBH to build.
+    fRecord.reset(new SkRecord);
+    SkRecorder recorder(fRecord.get(), fSrc->cullRect());
+    fSrc->playback(&recorder);
+    SkRecordOptimize(fRecord.get());
+}
+
+void FinishRecordingBench::onDraw(int loops, SkCanvas*) {
+    SkRTreeFactory factory;
+    factory.setExecutor(fExecutor);
+    SkAutoTMalloc<SkRect> bounds(fRecord->count());
+    while (loops --> 0) {
+        std::unique_ptr<SkBBoxHierarchy> bbh(factory(fSrc->cullRect()));
+        SkRecordFillBounds(fSrc->cullRect(), *fRecord, bounds, fExecutor);
+        bbh->insert(bounds, fRecord->count());
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+OptimizeRecordBench::OptimizeRecordBench(const char* name, const SkPicture* pic)
+    : INHERITED(name, pic)
+{
+    fName.append("_optimize");
+
+    SkRecord record;
+    SkRecorder recorder(&record, fSrc->cullRect());
+    fSrc->playback(&recorder);
+    SkRecordOptimize2(&record, fSrc->cullRect(), &fStats);
+}
+
+void OptimizeRecordBench::onDraw(int loops, SkCanvas*) {
+    while (loops --> 0) {
+        SkRecord record;
+        SkRecorder recorder(&record, fSrc->cullRect());
+        fSrc->playback(&recorder);
+        SkRecordOptimize2(&record, fSrc->cullRect());
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 #include "SkSerialProcs.h"
 
@@ -11,6 +11,7 @@
 #include "Benchmark.h"
 #include "SkPicture.h"
 #include "SkLiteDL.h"
+#include "SkRecordOpts.h"
 
 class PictureCentricBench : public Benchmark {
 public:
@@ -42,6 +43,45 @@ private:
     typedef PictureCentricBench INHERITED;
 };
 
+class SkExecutor;
+class SkRecord;
+
+// Times just the work of finishing a recording with a BBH: bounding each op and building the tree.
+class FinishRecordingBench : public PictureCentricBench {
+public:
+    // If executor is set, both steps may run in parallel on it.
+    FinishRecordingBench(const char* name, const SkPicture*, SkExecutor* executor);
+    ~FinishRecordingBench() override;
+
+protected:
+    void onDelayedSetup() override;
+    void onDraw(int loops, SkCanvas*) override;
+
+private:
+    sk_sp<SkRecord> fRecord;
+    SkExecutor*     fExecutor;
+
+    typedef PictureCentricBench INHERITED;
+};
+
+// Times recording a picture into an SkRecord and running SkRecordOptimize2() on it.  Compare with
+// the picture's RecordingBench to see what the optimization costs.
+class OptimizeRecordBench : public PictureCentricBench {
+public:
+    OptimizeRecordBench(const char* name, const SkPicture*);
+
+    // How many ops each pass removes from the picture.
+    const SkRecordOptimizeStats& stats() const { return fStats; }
+
+protected:
+    void onDraw(int loops, SkCanvas*) override;
+
+private:
+    SkRecordOptimizeStats fStats;
+
+    typedef PictureCentricBench INHERITED;
+};
+
 class DeserializePictureBench : public Benchmark {
 public:
     DeserializePictureBench(const char* name, sk_sp<SkData> encodedPicture);
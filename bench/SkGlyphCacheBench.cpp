@@ -38,6 +38,25 @@ static void do_font_stuff(SkFont* font) {
     }
 }
 
+static void do_shared_font_stuff(SkFont* font) {
+    SkPaint defaultPaint;
+    for (SkScalar i = 8; i < 64; i++) {
+        font->setSize(i);
+        auto strike = SkStrikeCache::FindOrCreateStrikeShared(
+                *font,  defaultPaint, SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                SkScalerContextFlags::kNone, SkMatrix::I());
+        uint16_t glyphs['z'];
+        for (int c = ' '; c < 'z'; c++) {
+            glyphs[c] = font->unicharToGlyph(c);
+        }
+        for (int lookups = 0; lookups < 10; lookups++) {
+            for (int c = ' '; c < 'z'; c++) {
+                strike.getGlyphIDMetrics(glyphs[c]);
+            }
+        }
+    }
+}
+
 class SkGlyphCacheBasic : public Benchmark {
 public:
     explicit SkGlyphCacheBasic(size_t cacheSize) : fCacheSize(cacheSize) { }
@@ -111,7 +130,54 @@ private:
     SkString fName;
 };
 
+// Every thread draws the same strikes, which exclusive strikes serialize (or duplicate), and
+// shared strikes let the threads look up at the same time.
+class SkGlyphCacheMultiThreaded : public Benchmark {
+public:
+    explicit SkGlyphCacheMultiThreaded(bool shared) : fShared(shared) { }
+
+protected:
+    const char* onGetName() override {
+        return fShared ? "SkGlyphCacheMultiThreaded_shared" : "SkGlyphCacheMultiThreaded_exclusive";
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        fTypeface = sk_tool_utils::create_portable_typeface("serif", SkFontStyle::Italic());
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        size_t oldCacheLimitSize = SkGraphics::GetFontCacheLimit();
+        SkGraphics::SetFontCacheLimit(32 * 1024 * 1024);
+
+        for (int work = 0; work < loops; work++) {
+            SkTaskGroup().batch(16, [&](int) {
+                SkFont font;
+                font.setEdging(SkFont::Edging::kAntiAlias);
+                font.setSubpixel(true);
+                font.setTypeface(fTypeface);
+                if (fShared) {
+                    do_shared_font_stuff(&font);
+                } else {
+                    do_font_stuff(&font);
+                }
+            });
+        }
+        SkGraphics::SetFontCacheLimit(oldCacheLimitSize);
+    }
+
+private:
+    typedef Benchmark INHERITED;
+    const bool fShared;
+    sk_sp<SkTypeface> fTypeface;
+};
+
 DEF_BENCH( return new SkGlyphCacheBasic(256 * 1024); )
 DEF_BENCH( return new SkGlyphCacheBasic(32 * 1024 * 1024); )
 DEF_BENCH( return new SkGlyphCacheStressTest(256 * 1024); )
 DEF_BENCH( return new SkGlyphCacheStressTest(32 * 1024 * 1024); )
+DEF_BENCH( return new SkGlyphCacheMultiThreaded(false); )
+DEF_BENCH( return new SkGlyphCacheMultiThreaded( true); )
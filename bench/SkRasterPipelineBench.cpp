@@ -0,0 +1,153 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "SkRasterPipeline.h"
+#include "SkString.h"
+
+// These benches run a few common raster pipelines over a 1000-pixel row (not a multiple of
+// any stride, so the tail is exercised too).  F16 destinations have no lowp implementation,
+// so they measure highp; 8888 destinations run in lowp.
+//
+// The _chained variants turn off stage fusion, to compare against the fused stages we'd
+// normally build for the same pipeline (see SK_RASTER_PIPELINE_FUSED_STAGES).
+
+static const int N = 1000;
+
+class SkRasterPipelineBench : public Benchmark {
+public:
+    SkRasterPipelineBench(const char* name, bool highp, bool fused)
+            : fHighp(highp)
+            , fFused(fused) {
+        fName.printf("SkRasterPipeline_%s_%s%s", name, highp ? "highp" : "lowp",
+                                                 fused ? "" : "_chained");
+    }
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        for (int i = 0; i < N; i++) {
+            fSrc8888[i] = 0x80000000 | (i * 0x00010203);
+            fDst8888[i] = 0xff804020;
+            fDstF16 [i] = 0x3c0038003c003800;   // (1.0, 0.5, 1.0, 0.5)
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkRasterPipeline_MemoryCtx dst8888 = { fDst8888, 0 },
+                                   dstF16  = { fDstF16,  0 };
+
+        SkRasterPipeline_<256> p;
+        p.set_fusion_enabled(fFused);
+        this->appendShader(&p);
+        if (fHighp) {
+            p.append(SkRasterPipeline::load_f16_dst, &dstF16);
+            p.append(SkRasterPipeline::srcover);
+            p.append(SkRasterPipeline::store_f16, &dstF16);
+        } else {
+            p.append(SkRasterPipeline::load_8888_dst, &dst8888);
+            p.append(SkRasterPipeline::srcover);
+            p.append(SkRasterPipeline::store_8888, &dst8888);
+        }
+
+        auto fn = p.compile();
+        while (loops --> 0) {
+            fn(0,0,N,1);
+        }
+    }
+
+protected:
+    virtual void appendShader(SkRasterPipeline*) = 0;
+
+    uint32_t fSrc8888[N];
+
+private:
+    SkString fName;
+    bool     fHighp;
+    bool     fFused;
+    uint32_t fDst8888[N];
+    uint64_t fDstF16 [N];
+};
+
+class SrcOverBench : public SkRasterPipelineBench {
+public:
+    SrcOverBench(bool highp, bool fused) : SkRasterPipelineBench("srcover", highp, fused) {}
+
+private:
+    void appendShader(SkRasterPipeline* p) override {
+        fSrc = { fSrc8888, 0 };
+        p->append(SkRasterPipeline::load_8888, &fSrc);
+    }
+
+    SkRasterPipeline_MemoryCtx fSrc;
+};
+DEF_BENCH( return new SrcOverBench(false, true); )
+DEF_BENCH( return new SrcOverBench( true, true); )
+DEF_BENCH( return new SrcOverBench(false, false); )
+
+class GradientBench : public SkRasterPipelineBench {
+public:
+    GradientBench(bool highp, bool fused) : SkRasterPipelineBench("gradient", highp, fused) {}
+
+private:
+    void appendShader(SkRasterPipeline* p) override {
+        // Map x in [0,N) onto t in [0,1], then look up one of three color stops.
+        fMatrix[0] = 1.0f / N; fMatrix[2] = 0; fMatrix[4] = 0;
+        fMatrix[1] = 0;        fMatrix[3] = 0; fMatrix[5] = 0;
+
+        // Like SkGradientShader, pad the stops out to 16 so wide backends can load them whole.
+        for (int c = 0; c < 4; c++) {
+            for (int i = 0; i < 16; i++) {
+                fF[c][i] = i < 4 ? 0.25f * (c + 1) : 0;
+                fB[c][i] = i < 4 ? 0.125f * i      : 0;
+            }
+            fCtx.fs[c] = fF[c];
+            fCtx.bs[c] = fB[c];
+        }
+        fTs[0] = 0; fTs[1] = 0.25f; fTs[2] = 0.5f; fTs[3] = 1.0f;
+        fCtx.stopCount = 4;
+        fCtx.ts = fTs;
+        fCtx.interpolatedInPremul = false;
+
+        p->append(SkRasterPipeline::seed_shader);
+        p->append(SkRasterPipeline::matrix_2x3, fMatrix);
+        p->append(SkRasterPipeline::gradient, &fCtx);
+    }
+
+    float                       fMatrix[6];
+    float                       fF[4][16],
+                                fB[4][16],
+                                fTs[4];
+    SkRasterPipeline_GradientCtx fCtx;
+};
+DEF_BENCH( return new GradientBench(false, true); )
+DEF_BENCH( return new GradientBench( true, true); )
+
+class BilerpBench : public SkRasterPipelineBench {
+public:
+    BilerpBench(bool highp, bool fused) : SkRasterPipelineBench("bilerp", highp, fused) {}
+
+private:
+    void appendShader(SkRasterPipeline* p) override {
+        // Stretch our 1000x1 source row by 1.3x, landing between pixels almost everywhere.
+        fMatrix[0] = 1/1.3f; fMatrix[2] = 0; fMatrix[4] = 0;
+        fMatrix[1] = 0;      fMatrix[3] = 1; fMatrix[5] = 0;
+        fCtx = { fSrc8888, N, N, 1 };
+
+        p->append(SkRasterPipeline::seed_shader);
+        p->append(SkRasterPipeline::matrix_2x3, fMatrix);
+        p->append(SkRasterPipeline::bilerp_clamp_8888, &fCtx);
+    }
+
+    float                      fMatrix[6];
+    SkRasterPipeline_GatherCtx fCtx;
+};
+DEF_BENCH( return new BilerpBench(false, true); )
+DEF_BENCH( return new BilerpBench( true, true); )
+DEF_BENCH( return new BilerpBench(false, false); )
+DEF_BENCH( return new BilerpBench( true, false); )
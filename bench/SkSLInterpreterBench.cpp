@@ -0,0 +1,137 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "SkRasterPipeline.h"
+#include "SkSLByteCode.h"
+#include "SkSLCompiler.h"
+#include "SkSLInterpreter.h"
+
+// Runs the same small SkSL function over 1000 sets of inputs, by walking its IR tree, by running
+// its bytecode one set at a time, and by running its bytecode over many sets at once.
+
+static const char* kSrc =
+    "void shade(inout float r, inout float g, inout float b) {"
+    "    float t = r;"
+    "    for (int i = 0; i < 8; i++) {"
+    "        t = t * 0.75 + g;"
+    "        if (t > 1.0) {"
+    "            t -= 1.0;"
+    "        }"
+    "    }"
+    "    r = t;"
+    "    g = g * b;"
+    "    b = 1.0 - b;"
+    "}";
+
+static const int N = 1000;
+
+class SkSLInterpreterBench : public Benchmark {
+public:
+    enum class Mode {
+        kTreeWalk,
+        kByteCode,
+        kByteCodeStriped,
+    };
+
+    SkSLInterpreterBench(Mode mode) : fMode(mode) {}
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+
+    const char* onGetName() override {
+        switch (fMode) {
+            case Mode::kTreeWalk:        return "SkSLInterpreter_treewalk";
+            case Mode::kByteCode:        return "SkSLInterpreter_bytecode";
+            case Mode::kByteCodeStriped: return "SkSLInterpreter_bytecode_striped";
+        }
+        return "";
+    }
+
+    void onDelayedSetup() override {
+        for (int i = 0; i < N; i++) {
+            fR[i] = SkSL::Interpreter::Value(i / (float) N);
+            fG[i] = SkSL::Interpreter::Value(0.5f);
+            fB[i] = SkSL::Interpreter::Value(0.25f);
+        }
+
+        SkSL::Program::Settings settings;
+        std::unique_ptr<SkSL::Program> program = fCompiler.convertProgram(
+                                                                 SkSL::Program::kPipelineStage_Kind,
+                                                                 SkSL::String(kSrc), settings);
+        if (!program) {
+            SkDebugf("%s\n", fCompiler.errorText().c_str());
+            return;
+        }
+        if (Mode::kTreeWalk == fMode) {
+            for (const auto& e : *program) {
+                if (SkSL::ProgramElement::kFunction_Kind == e.fKind) {
+                    fFunctionDefinition = (const SkSL::FunctionDefinition*) &e;
+                }
+            }
+            fInterpreter.reset(new SkSL::Interpreter(std::move(program), &fPipeline, &fStack));
+        } else {
+            fByteCode = fCompiler.toByteCode(*program);
+            if (!fByteCode) {
+                SkDebugf("%s\n", fCompiler.errorText().c_str());
+                return;
+            }
+            fFunction = fByteCode->getFunction("shade");
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        while (loops --> 0) {
+            switch (fMode) {
+                case Mode::kTreeWalk:
+                    for (int i = 0; i < N; i++) {
+                        // run() leaves the function's locals on the stack above its parameters.
+                        size_t base = fStack.size();
+                        fInterpreter->push(fR[i]);
+                        fInterpreter->push(fG[i]);
+                        fInterpreter->push(fB[i]);
+                        fInterpreter->run(*fFunctionDefinition);
+                        fR[i] = fStack[base + 0];
+                        fG[i] = fStack[base + 1];
+                        fB[i] = fStack[base + 2];
+                        fStack.resize(base);
+                    }
+                    break;
+                case Mode::kByteCode:
+                    for (int i = 0; i < N; i++) {
+                        SkSL::Interpreter::Value args[] = { fR[i], fG[i], fB[i] };
+                        SkSL::Interpreter::Run(fFunction, args, nullptr);
+                        fR[i] = args[0];
+                        fG[i] = args[1];
+                        fB[i] = args[2];
+                    }
+                    break;
+                case Mode::kByteCodeStriped: {
+                    SkSL::Interpreter::Value* args[] = { fR, fG, fB };
+                    SkSL::Interpreter::RunStriped(fFunction, N, args, nullptr);
+                    break;
+                }
+            }
+        }
+    }
+
+private:
+    Mode                                 fMode;
+    SkSL::Compiler                       fCompiler;
+    SkRasterPipeline_<256>               fPipeline;
+    std::vector<SkSL::Interpreter::Value> fStack;
+    std::unique_ptr<SkSL::Interpreter>   fInterpreter;
+    const SkSL::FunctionDefinition*      fFunctionDefinition = nullptr;
+    std::unique_ptr<SkSL::ByteCode>      fByteCode;
+    const SkSL::ByteCodeFunction*        fFunction = nullptr;
+    SkSL::Interpreter::Value             fR[N], fG[N], fB[N];
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return new SkSLInterpreterBench(SkSLInterpreterBench::Mode::kTreeWalk); )
+DEF_BENCH( return new SkSLInterpreterBench(SkSLInterpreterBench::Mode::kByteCode); )
+DEF_BENCH( return new SkSLInterpreterBench(SkSLInterpreterBench::Mode::kByteCodeStriped); )
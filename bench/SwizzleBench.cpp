@@ -6,28 +6,38 @@
  */
 
 #include "Benchmark.h"
+#include "SkCodec.h"
+#include "SkEncodedInfo.h"
 #include "SkOpts.h"
+#include "SkString.h"
+#include "SkSwizzler.h"
+
+static const int K = 1023; // Arbitrary, but nice to be a non-power-of-two to trip up SIMD.
 
 class SwizzleBench : public Benchmark {
 public:
+    typedef void (*Index_to_8888)(uint32_t*, const uint8_t*, int, const uint32_t[]);
 
     SwizzleBench(const char* name, SkOpts::Swizzle_8888_u32 fn) : fName(name), fFn_u32(fn) {}
     SwizzleBench(const char* name, SkOpts::Swizzle_8888_u8  fn) : fName(name), fFn_u8 (fn) {}
+    SwizzleBench(const char* name, Index_to_8888            fn) : fName(name), fFn_index(fn) {}
 
     bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
     const char* onGetName() override { return fName; }
     void onDraw(int loops, SkCanvas*) override {
-        static const int K = 1023; // Arbitrary, but nice to be a non-power-of-two to trip up SIMD.
-        uint32_t dst[K], src[K];
+        // 16-bit per channel sources need up to 8 bytes per pixel.
+        uint32_t dst[K], src[2*K], ctable[256] = {};
         while (loops --> 0) {
-            if (fFn_u32) { fFn_u32(dst,                 src, K); }
-            if (fFn_u8)  { fFn_u8 (dst, (const uint8_t*)src, K); }
+            if (fFn_u32)   { fFn_u32  (dst,                 src, K); }
+            if (fFn_u8)    { fFn_u8   (dst, (const uint8_t*)src, K); }
+            if (fFn_index) { fFn_index(dst, (const uint8_t*)src, K, ctable); }
         }
     }
 private:
     const char* fName;
-    SkOpts::Swizzle_8888_u32 fFn_u32 = nullptr;
-    SkOpts::Swizzle_8888_u8  fFn_u8  = nullptr;
+    SkOpts::Swizzle_8888_u32 fFn_u32   = nullptr;
+    SkOpts::Swizzle_8888_u8  fFn_u8    = nullptr;
+    Index_to_8888            fFn_index = nullptr;
 };
 
 
@@ -41,3 +51,75 @@ DEF_BENCH(return new SwizzleBench("SkOpts::grayA_to_RGBA", SkOpts::grayA_to_RGBA
 DEF_BENCH(return new SwizzleBench("SkOpts::grayA_to_rgbA", SkOpts::grayA_to_rgbA));
 DEF_BENCH(return new SwizzleBench("SkOpts::inverted_CMYK_to_RGB1", SkOpts::inverted_CMYK_to_RGB1));
 DEF_BENCH(return new SwizzleBench("SkOpts::inverted_CMYK_to_BGR1", SkOpts::inverted_CMYK_to_BGR1));
+DEF_BENCH(return new SwizzleBench("SkOpts::RGB16_to_RGB1",  SkOpts::RGB16_to_RGB1));
+DEF_BENCH(return new SwizzleBench("SkOpts::RGB16_to_BGR1",  SkOpts::RGB16_to_BGR1));
+DEF_BENCH(return new SwizzleBench("SkOpts::RGBA16_to_RGBA", SkOpts::RGBA16_to_RGBA));
+DEF_BENCH(return new SwizzleBench("SkOpts::RGBA16_to_BGRA", SkOpts::RGBA16_to_BGRA));
+DEF_BENCH(return new SwizzleBench("SkOpts::index_to_8888",  SkOpts::index_to_8888));
+
+// Swizzles a row the way a decode with SkAndroidCodec's sampleSize does.
+class SampledSwizzleBench : public Benchmark {
+public:
+    SampledSwizzleBench(const char* name, SkEncodedInfo::Color color, SkEncodedInfo::Alpha alpha,
+                        int bitsPerComponent, int sampleX)
+        : fColor(color)
+        , fAlpha(alpha)
+        , fBitsPerComponent(bitsPerComponent)
+        , fSampleX(sampleX)
+    {
+        fName.printf("SkSwizzler_%s_sample%d", name, sampleX);
+    }
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        const SkEncodedInfo info = SkEncodedInfo::Make(K, 1, fColor, fAlpha, fBitsPerComponent);
+        fSrc.reset(K * info.bitsPerPixel() / 8);
+        for (int i = 0; i < K * info.bitsPerPixel() / 8; i++) {
+            fSrc[i] = i * 31;
+        }
+        for (int i = 0; i < 256; i++) {
+            fColorTable[i] = 0xFF000000 | i * 0x010101;
+        }
+        fSwizzler = SkSwizzler::Make(info, fColorTable,
+                                     SkImageInfo::MakeN32Premul(K, 1), SkCodec::Options());
+        fDst.reset(fSwizzler->setSampleX(fSampleX));
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        while (loops --> 0) {
+            fSwizzler->swizzle(fDst.get(), fSrc.get());
+        }
+    }
+
+private:
+    SkString                    fName;
+    const SkEncodedInfo::Color  fColor;
+    const SkEncodedInfo::Alpha  fAlpha;
+    const int                   fBitsPerComponent;
+    const int                   fSampleX;
+    SkAutoTMalloc<uint8_t>      fSrc;
+    SkAutoTMalloc<uint32_t>     fDst;
+    SkPMColor                   fColorTable[256];
+    std::unique_ptr<SkSwizzler> fSwizzler;
+
+    typedef Benchmark INHERITED;
+};
+
+#define SAMPLED_BENCHES(name, color, alpha, bits)                                          \
+    DEF_BENCH(return new SampledSwizzleBench(name, SkEncodedInfo::color,                   \
+                                             SkEncodedInfo::alpha, bits, 1));              \
+    DEF_BENCH(return new SampledSwizzleBench(name, SkEncodedInfo::color,                   \
+                                             SkEncodedInfo::alpha, bits, 2));              \
+    DEF_BENCH(return new SampledSwizzleBench(name, SkEncodedInfo::color,                   \
+                                             SkEncodedInfo::alpha, bits, 4));
+
+SAMPLED_BENCHES("rgba",    kRGBA_Color,      kUnpremul_Alpha,  8)
+SAMPLED_BENCHES("rgb",     kRGB_Color,       kOpaque_Alpha,    8)
+SAMPLED_BENCHES("grayA",   kGrayAlpha_Color, kUnpremul_Alpha,  8)
+SAMPLED_BENCHES("index",   kPalette_Color,   kOpaque_Alpha,    8)
+SAMPLED_BENCHES("rgba16",  kRGBA_Color,      kUnpremul_Alpha, 16)
+SAMPLED_BENCHES("rgb16",   kRGB_Color,       kOpaque_Alpha,   16)
+
+#undef SAMPLED_BENCHES
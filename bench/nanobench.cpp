@@ -123,6 +123,8 @@ DEFINE_string(zoom, "1.0,0", "Comma-separated zoomMax,zoomPeriodMs factors for a
                              "function that ping-pongs between 1.0 and zoomMax.");
 DEFINE_bool(bbh, true, "Build a BBH for SKPs?");
 DEFINE_bool(lite, false, "Use SkLiteRecorder in recording benchmarks?");
+DEFINE_bool(optimizeSKPs, false,
+            "Time SkRecordOptimize2() on each .skp, and report how many ops each pass removes.");
 DEFINE_bool(mpd, true, "Use MultiPictureDraw for the SKPs?");
 DEFINE_bool(loopSKP, true, "Loop SKPs like we do for micro benches?");
 DEFINE_int32(flushEvery, 10, "Flush --outResultsFile every Nth run.");
@@ -592,7 +594,9 @@ public:
     BenchmarkStream() : fBenches(BenchRegistry::Head())
                       , fGMs(skiagm::GMRegistry::Head())
                       , fCurrentRecording(0)
+                      , fCurrentFinishRecording(0)
                       , fCurrentDeserialPicture(0)
+                      , fCurrentOptimize(0)
                       , fCurrentScale(0)
                       , fCurrentSKP(0)
                       , fCurrentSVG(0)
@@ -737,6 +741,22 @@ public:
             return new RecordingBench(name.c_str(), pic.get(), FLAGS_bbh, FLAGS_lite);
         }
 
+        // With a BBH, time finishing the recording on its own, in parallel unless --threads 0.
+        while (FLAGS_bbh && !FLAGS_lite && fCurrentFinishRecording < fSKPs.count()) {
+            const SkString& path = fSKPs[fCurrentFinishRecording++];
+            sk_sp<SkPicture> pic = ReadPicture(path.c_str());
+            if (!pic) {
+                continue;
+            }
+            SkString name = SkOSPath::Basename(path.c_str());
+            fSourceType = "skp";
+            fBenchType  = "recording";
+            fSKPBytes = static_cast<double>(pic->approximateBytesUsed());
+            fSKPOps   = pic->approximateOpCount();
+            return new FinishRecordingBench(name.c_str(), pic.get(),
+                                            FLAGS_threads ? &SkExecutor::GetDefault() : nullptr);
+        }
+
         // Add all .skps as DeserializePictureBenchs.
         while (fCurrentDeserialPicture < fSKPs.count()) {
             const SkString& path = fSKPs[fCurrentDeserialPicture++];
@@ -752,6 +772,23 @@ public:
             return new DeserializePictureBench(name.c_str(), std::move(data));
         }
 
+        // With --optimizeSKPs, time SkRecordOptimize2() on each .skp too.
+        while (FLAGS_optimizeSKPs && fCurrentOptimize < fSKPs.count()) {
+            const SkString& path = fSKPs[fCurrentOptimize++];
+            sk_sp<SkPicture> pic = ReadPicture(path.c_str());
+            if (!pic) {
+                continue;
+            }
+            SkString name = SkOSPath::Basename(path.c_str());
+            fSourceType = "skp";
+            fBenchType  = "optimize";
+            fSKPBytes = static_cast<double>(pic->approximateBytesUsed());
+            fSKPOps   = pic->approximateOpCount();
+            auto bench = new OptimizeRecordBench(name.c_str(), pic.get());
+            fOptimizeStats = bench->stats();
+            return bench;
+        }
+
         // Then once each for each scale as SKPBenches (playback).
         while (fCurrentScale < fScales.count()) {
             while (fCurrentSKP < fSKPs.count()) {
@@ -951,7 +988,7 @@ public:
 
             while (fCurrentColorType < fColorTypes.count()) {
                 while (fCurrentSampleSize < (int) SK_ARRAY_COUNT(brdSampleSizes)) {
-                    while (fCurrentSubsetType <= kLastSingle_SubsetType) {
+                    while (fCurrentSubsetType <= kTileGrid_SubsetType) {
 
                         sk_sp<SkData> encoded(SkData::MakeFromFileName(path.c_str()));
                         const SkColorType colorType = fColorTypes[fCurrentColorType];
@@ -993,6 +1030,13 @@ public:
                                 subset = SkIRect::MakeXYWH(width - subsetSize,
                                         height - subsetSize, subsetSize, subsetSize);
                                 break;
+                            case kTileGrid_SubsetType:
+                                // Decode the whole image in tiles, one quarter the size of the
+                                // single subsets.
+                                basename.append("_TileGrid");
+                                return new BitmapRegionDecoderBench(basename.c_str(),
+                                        encoded.get(), colorType, sampleSize,
+                                        SkIRect::MakeWH(width, height), subsetSize / 2);
                             default:
                                 SkASSERT(false);
                         }
@@ -1034,6 +1078,19 @@ public:
             log.appendMetric("bytes", fSKPBytes);
             log.appendMetric("ops", fSKPOps);
         }
+        if (0 == strcmp(fBenchType, "optimize")) {
+            // How many ops each pass of SkRecordOptimize2() removed.
+            log.appendMetric("ops", fSKPOps);
+            log.appendMetric("set_matrices_removed",    fOptimizeStats.fSetMatrices);
+            log.appendMetric("culled_draws_removed",    fOptimizeStats.fCulledDraws);
+            log.appendMetric("occluded_draws_removed",  fOptimizeStats.fOccludedDraws);
+            log.appendMetric("redundant_clips_removed", fOptimizeStats.fRedundantClips);
+            log.appendMetric("merged_draws_removed",    fOptimizeStats.fMergedDraws);
+            log.appendMetric("save_restores_removed",   fOptimizeStats.fSaveRestores);
+            log.appendMetric("save_layers_removed",     fOptimizeStats.fSaveLayers);
+            log.appendMetric("svg_layers_removed",      fOptimizeStats.fSvgLayers);
+            log.appendMetric("ops_removed",             fOptimizeStats.total());
+        }
     }
 
 private:
@@ -1043,8 +1100,9 @@ private:
         kMiddle_SubsetType      = 2,
         kBottomLeft_SubsetType  = 3,
         kBottomRight_SubsetType = 4,
-        kTranslate_SubsetType   = 5,
-        kZoom_SubsetType        = 6,
+        kTileGrid_SubsetType    = 5,
+        kTranslate_SubsetType   = 6,
+        kZoom_SubsetType        = 7,
         kLast_SubsetType        = kZoom_SubsetType,
         kLastSingle_SubsetType  = kBottomRight_SubsetType,
     };
@@ -1066,7 +1124,10 @@ private:
     const char* fSourceType;  // What we're benching: bench, GM, SKP, ...
     const char* fBenchType;   // How we bench it: micro, recording, playback, ...
     int fCurrentRecording;
+    int fCurrentFinishRecording;
     int fCurrentDeserialPicture;
+    int fCurrentOptimize;
+    SkRecordOptimizeStats fOptimizeStats;
     int fCurrentScale;
     int fCurrentSKP;
     int fCurrentSVG;
@@ -9,13 +9,16 @@
 #define SkAnimatedImage_DEFINED
 
 #include "SkBitmap.h"
+#include "SkCodec.h"
 #include "SkCodecAnimation.h"
 #include "SkDrawable.h"
 #include "SkMatrix.h"
 #include "SkRect.h"
 
 class SkAndroidCodec;
+class SkExecutor;
 class SkPicture;
+class SkTaskGroup;
 
 /**
  *  Thread unsafe drawable for drawing animated images (e.g. GIF).
@@ -110,6 +113,15 @@ public:
         return fRepetitionCount;
     }
 
+    /**
+     *  Decode the frame after the current one on executor, while the current one is drawn.
+     *  decodeNextFrame will then only need to wait for it, if it is not done.
+     *
+     *  Pass null to decode every frame in decodeNextFrame, which is the default. The executor
+     *  must outlive this object, or the next call.
+     */
+    void setLookAheadExecutor(SkExecutor* executor);
+
 protected:
     SkRect onGetBounds() override;
     void onDraw(SkCanvas*) override;
@@ -154,12 +166,24 @@ private:
     int                             fRepetitionCount;
     int                             fRepetitionsCompleted;
 
+    // Decodes into fDecodingFrame (and may modify fRestoreFrame) while it has a task pending.
+    std::unique_ptr<SkTaskGroup>    fLookAhead;
+
     SkAnimatedImage(std::unique_ptr<SkAndroidCodec>, SkISize scaledSize,
             SkImageInfo decodeInfo, SkIRect cropRect, sk_sp<SkPicture> postProcess);
     SkAnimatedImage(std::unique_ptr<SkAndroidCodec>);
 
     int computeNextFrame(int current, bool* animationEnded);
     double finish();
+    int advanceFrame();
+
+    /**
+     *  Decode frameToDecode into fDecodingFrame, drawing it on top of whichever frame it
+     *  depends on.
+     */
+    bool decodeFrame(int frameToDecode, const SkCodec::FrameInfo& frameInfo);
+    void startLookAhead();
+    void finishLookAhead();
 
     typedef SkDrawable INHERITED;
 };
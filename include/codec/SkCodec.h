@@ -26,6 +26,7 @@
 
 class SkColorSpace;
 class SkData;
+class SkExecutor;
 class SkFrameHolder;
 class SkPngChunkReader;
 class SkSampler;
@@ -248,6 +249,13 @@ public:
         kNo_ZeroInitialized,
     };
 
+    /**
+     *  Called by incrementalDecode() each time it has written a preview of the whole image
+     *  to the destination.  previewPass is the number of interlace passes (PNG) or
+     *  progressive scans (JPEG) that the preview was made from.
+     */
+    typedef void (*PreviewProc)(void* context, int previewPass);
+
     /**
      *  Additional options to pass to getPixels.
      */
@@ -257,6 +265,9 @@ public:
             , fSubset(nullptr)
             , fFrameIndex(0)
             , fPriorFrame(kNoFrame)
+            , fExecutor(nullptr)
+            , fPreviewProc(nullptr)
+            , fPreviewContext(nullptr)
         {}
 
         ZeroInitialized            fZeroInitialized;
@@ -300,6 +311,27 @@ public:
          *  If set to kNoFrame, the codec will decode any necessary required frame(s) first.
          */
         int                        fPriorFrame;
+
+        /**
+         *  If not NULL, getPixels() may split the decode into independent parts and run them on
+         *  this executor, returning once they are all done.
+         *
+         *  Currently only used for sequential JPEGs with restart markers, whose data is in memory
+         *  (i.e. the stream has a memory base).
+         */
+        SkExecutor*                fExecutor;
+
+        /**
+         *  If not NULL, incrementalDecode() writes a lower resolution preview of the image to
+         *  every row of the destination as soon as one is available, and then calls this with
+         *  fPreviewContext.  Each interlace pass or progressive scan that completes before the
+         *  input runs out replaces the last preview, until the final image overwrites it.
+         *
+         *  Used for interlaced PNGs, and for progressive JPEGs, which only support incremental
+         *  decoding with this set (and no fSubset).
+         */
+        PreviewProc                fPreviewProc;
+        void*                      fPreviewContext;
     };
 
     /**
@@ -394,6 +426,7 @@ public:
         if (!this->rewindIfNeeded()) {
             return kCouldNotRewind;
         }
+        this->willDecode();
 
         return this->onGetYUV8Planes(sizeInfo, planes);
     }
@@ -441,6 +474,7 @@ public:
      *      Note that some implementations may have initialized this many rows, but
      *      not necessarily finished those rows (e.g. interlaced PNG). This may be
      *      useful for determining what rows the client needs to initialize.
+     *      Once Options::fPreviewProc has been called, this is all of the rows.
      *  @return kSuccess if all lines requested in startIncrementalDecode have
      *      been completely decoded. kIncompleteInput otherwise.
      */
@@ -823,6 +857,8 @@ private:
     const XformFormat                  fSrcXformFormat;
     std::unique_ptr<SkStream>          fStream;
     bool                               fNeedsRewind;
+    // The file mapping the stream reads, if it was made from one, which we hint before decoding.
+    sk_sp<SkData>                      fFileMapping;
     const SkEncodedOrigin              fOrigin;
 
     SkImageInfo                        fDstInfo;
@@ -845,6 +881,11 @@ private:
 
     bool initializeColorXform(const SkImageInfo& dstInfo, SkEncodedInfo::Alpha, bool srcIsOpaque);
 
+    /**
+     *  Called when a decode starts, after rewinding, to hint that the stream is about to be read.
+     */
+    void willDecode();
+
     /**
      *  Return whether these dimensions are supported as a scale.
      *
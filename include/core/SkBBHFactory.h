@@ -10,6 +10,7 @@
 
 #include "SkTypes.h"
 class SkBBoxHierarchy;
+class SkExecutor;
 struct SkRect;
 
 class SK_API SkBBHFactory {
@@ -19,6 +20,17 @@ public:
      */
     virtual SkBBoxHierarchy* operator()(const SkRect& bounds) const = 0;
     virtual ~SkBBHFactory() {}
+
+    /**
+     *  If set, SkPictureRecorder computes the bounds of a large picture's ops in parallel on this
+     *  executor, and hierarchies that can use it build themselves in parallel too.  The executor
+     *  is not owned, and must outlive any recording made with this factory.
+     */
+    void setExecutor(SkExecutor* executor) { fExecutor = executor; }
+    SkExecutor* executor() const { return fExecutor; }
+
+private:
+    SkExecutor* fExecutor = nullptr;
 };
 
 class SK_API SkRTreeFactory : public SkBBHFactory {
@@ -28,4 +40,15 @@ private:
     typedef SkBBHFactory INHERITED;
 };
 
+/**
+ *  Makes an R-Tree laid out for SIMD: it tests all of a node's children at once, which makes
+ *  searches faster, at the cost of slightly slower recording.
+ */
+class SK_API SkPackedRTreeFactory : public SkBBHFactory {
+public:
+    SkBBoxHierarchy* operator()(const SkRect& bounds) const override;
+private:
+    typedef SkBBHFactory INHERITED;
+};
+
 #endif
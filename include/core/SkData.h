@@ -159,6 +159,7 @@ public:
 
 private:
     friend class SkNVRefCnt<SkData>;
+    friend class SkDataPriv;
     ReleaseProc fReleaseProc;
     void*       fReleaseProcContext;
     void*       fPtr;
@@ -87,6 +87,22 @@ public:
     static sk_sp<SkPicture> MakeFromData(const void* data, size_t size,
                                          const SkDeserialProcs* procs = nullptr);
 
+    /** Recreates SkPicture that was serialized into data, like MakeFromData(), but plays back
+        the serialized drawing commands where they lie in data rather than recording them
+        again, and parses the paints, paths, and other objects they use the first time
+        SkPicture is drawn. Returned SkPicture keeps a reference to data, which may be
+        memory mapped, as by SkData::MakeFromFileName.
+
+        If procs has any custom decoders, the objects are parsed before returning, since
+        procs need not outlive this call.
+
+        @param data   container for serial data
+        @param procs  custom serial data decoders; may be nullptr
+        @return       SkPicture constructed from data
+    */
+    static sk_sp<SkPicture> MakeFromDataInPlace(sk_sp<SkData> data,
+                                                const SkDeserialProcs* procs = nullptr);
+
     /** \class SkPicture::AbortCallback
         AbortCallback is an abstract class. An implementation of AbortCallback may
         passed as a parameter to SkPicture::playback, to stop it before all drawing
@@ -208,12 +224,13 @@ private:
     SkPicture();
     friend class SkBigPicture;
     friend class SkEmptyPicture;
+    friend class SkInPlacePicture;
     friend class SkPicturePriv;
     template <typename> friend class SkMiniPicture;
 
     void serialize(SkWStream*, const SkSerialProcs*, class SkRefCntSet* typefaces) const;
     static sk_sp<SkPicture> MakeFromStream(SkStream*, const SkDeserialProcs*,
-                                           class SkTypefacePlayback*);
+                                           class SkTypefacePlayback*, SkData* inPlaceData);
     friend class SkPictureData;
 
     /** Return true if the SkStream/Buffer represents a serialized picture, and
@@ -267,10 +284,12 @@ private:
     // V66: Add saveBehind
     // V67: Blobs serialize fonts instead of paints
     // V68: Paint doesn't serialize font-related stuff
+    // V69: Pad the op data and the buffer so they can be read in place
+    // V70: Index the ops and resources of pictures recorded with a BBH
 
     // Only SKPs within the min/current picture version range (inclusive) can be read.
     static const uint32_t     MIN_PICTURE_VERSION = 56;     // august 2017
-    static const uint32_t CURRENT_PICTURE_VERSION = 68;
+    static const uint32_t CURRENT_PICTURE_VERSION = 70;
 
     static_assert(MIN_PICTURE_VERSION <= 62, "Remove kFontAxes_bad from SkFontDescriptor.cpp");
 
@@ -280,7 +299,7 @@ private:
                                         class SkReadBuffer* buffer);
 
     struct SkPictInfo createHeader() const;
-    class SkPictureData* backport() const;
+    class SkPictureData* backport(bool withOpIndex = false) const;
 
     uint32_t fUniqueID;
 };
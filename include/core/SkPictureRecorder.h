@@ -22,6 +22,7 @@ namespace android {
 class GrContext;
 class SkCanvas;
 class SkDrawable;
+class SkExecutor;
 class SkMiniRecorder;
 class SkPictureRecord;
 class SkRecord;
@@ -115,6 +116,7 @@ private:
     uint32_t                    fFlags;
     SkRect                      fCullRect;
     sk_sp<SkBBoxHierarchy>      fBBH;
+    SkExecutor*                 fExecutor;
     std::unique_ptr<SkRecorder> fRecorder;
     sk_sp<SkRecord>             fRecord;
     std::unique_ptr<SkMiniRecorder> fMiniRecorder;
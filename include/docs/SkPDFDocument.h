@@ -142,6 +142,20 @@ struct Metadata {
     */
     int fEncodingQuality = 101;
 
+    /** Preferred level of compression for the deflated streams in the
+        document: page contents, fonts, and lossless images.  LowButFast is
+        several times quicker than the default on the large, repetitive
+        content streams of busy pages, for somewhat bigger files.  None leaves
+        page contents and fonts uncompressed.
+    */
+    enum class CompressionLevel : int {
+        Default = -1,
+        None = 0,
+        LowButFast = 1,
+        Average = 6,
+        HighButSlow = 9,
+    } fCompressionLevel = CompressionLevel::Default;
+
     /** An optional tree of structured document tags that provide
         a semantic representation of the content. The caller
         should retain ownership.
@@ -151,14 +165,34 @@ struct Metadata {
     /** Executor to handle threaded work within PDF Backend. If this is nullptr,
         then all work will be done serially on the main thread. To have worker
         threads assist with various tasks, set this to a valid SkExecutor
-        instance. Currently used for executing Deflate algorithm in parallel.
+        instance. Currently used for compressing page contents and images,
+        subsetting fonts, and building their ToUnicode maps in parallel.
 
-        If set, the PDF output will be non-reproducible in the order and
-        internal numbering of objects, but should render the same.
+        The PDF output is the same whether or not this is set.
 
         Experimental.
     */
     SkExecutor* fExecutor = nullptr;
+
+    /** If true, each page is written out as soon as it is finished, rather
+        than kept until the document is closed, so that memory use does not
+        grow with the number of pages.  Only objects that later pages may
+        still refer to, like fonts, are retained.  The page tree is built
+        from runs of pages as they are written, so it may be shaped a little
+        differently.
+
+        Experimental.
+    */
+    bool fStreaming = false;
+
+    /** If not null, set when the document is closed to an estimate of the
+        most memory it retained at once: objects waiting to be written,
+        unwritten pages, and per-font tables, but not the page being drawn.
+        Measuring this costs a little time, so leave it null unless needed.
+
+        Experimental.
+    */
+    size_t* fPeakRetainedBytes = nullptr;
 };
 
 /** Associate a node ID with subsequent drawing commands in an
@@ -12,9 +12,36 @@
 #include "../private/SkTemplates.h"
 #include "SkPixmap.h"
 
+class SkPicture;
+
 class SK_API SkEncoder : SkNoncopyable {
 public:
 
+    /**
+     *  Supplies the pixels of an image a strip of rows at a time, so that an encoder can stream
+     *  an image without ever holding all of it in memory.
+     */
+    class RowSource {
+    public:
+        virtual ~RowSource() {}
+
+        /**
+         *  Write rows [y, y + rows.height()) of the image into |rows|, which has the width,
+         *  color type, alpha type, and color space of the image.  Rows are requested in order,
+         *  top to bottom, each exactly once.
+         *
+         *  Returns false on failure, which fails the encode.
+         */
+        virtual bool getRows(int y, const SkPixmap& rows) = 0;
+
+        /**
+         *  Returns a source that rasterizes |picture| into each strip.  The picture is played
+         *  back once per strip, clipped to the strip, so it helps if it was recorded with a
+         *  bounding box hierarchy.
+         */
+        static std::unique_ptr<RowSource> MakeFromPicture(sk_sp<SkPicture> picture);
+    };
+
     /**
      *  Encode |numRows| rows of input.  If the caller requests more rows than are remaining
      *  in the src, this will encode all of the remaining rows.  |numRows| must be greater
@@ -26,6 +53,9 @@ public:
 
 protected:
 
+    /**
+     *  Encode the |numRows| rows in fRows, which start at fCurrRow.
+     */
     virtual bool onEncodeRows(int numRows) = 0;
 
     SkEncoder(const SkPixmap& src, size_t storageBytes)
@@ -34,9 +64,28 @@ protected:
         , fStorage(storageBytes)
     {}
 
+    /**
+     *  Pulls the rows of an image described by |info| from |source|, |stripHeight| rows at a
+     *  time.  fSrc has the image's info, but no pixels.
+     */
+    SkEncoder(const SkImageInfo& info, RowSource* source, int stripHeight, size_t storageBytes);
+
+private:
+    // With a RowSource, fSrc refers to this.
+    SkPixmap               fSourceInfo;
+
+protected:
     const SkPixmap&        fSrc;
     int                    fCurrRow;
     SkAutoTMalloc<uint8_t> fStorage;
+
+    // The rows passed to onEncodeRows(): either part of fSrc, or a strip from the RowSource.
+    SkPixmap               fRows;
+
+private:
+    RowSource*             fRowSource = nullptr;
+    int                    fStripHeight = 0;
+    SkAutoTMalloc<uint8_t> fStrip;
 };
 
 #endif
@@ -61,6 +61,15 @@ public:
          *  In the second case, the encoder supports linear or legacy blending.
          */
         AlphaOption fAlphaOption = AlphaOption::kIgnore;
+
+        /**
+         *  If positive, a restart marker is written after every |fRestartRows| rows of MCUs
+         *  (16 pixels tall with k420 downsampling, 8 otherwise).
+         *
+         *  Each marker costs a few bytes, but lets SkCodec decode the image in parallel.
+         *  See SkCodec::Options::fExecutor.
+         */
+        int fRestartRows = 0;
     };
 
     /**
@@ -82,6 +91,19 @@ public:
     static std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkPixmap& src,
                                            const Options& options);
 
+    /**
+     *  Create a jpeg encoder for an image described by |info|, whose pixels are pulled from
+     *  |source| in strips of |stripHeight| rows as they are encoded.  Only one strip is held in
+     *  memory at a time, so this can encode images far too large to rasterize all at once.
+     *
+     *  |dst| and |source| are unowned but must remain valid for the lifetime of the object.
+     *
+     *  This returns nullptr on an invalid or unsupported |info|.
+     */
+    static std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkImageInfo& info,
+                                           RowSource* source, int stripHeight,
+                                           const Options& options);
+
     ~SkJpegEncoder() override;
 
 protected:
@@ -89,6 +111,8 @@ protected:
 
 private:
     SkJpegEncoder(std::unique_ptr<SkJpegEncoderMgr>, const SkPixmap& src);
+    SkJpegEncoder(std::unique_ptr<SkJpegEncoderMgr>, const SkImageInfo& info, RowSource* source,
+                  int stripHeight);
 
     std::unique_ptr<SkJpegEncoderMgr> fEncoderMgr;
     typedef SkEncoder INHERITED;
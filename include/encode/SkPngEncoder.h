@@ -11,6 +11,7 @@
 #include "SkEncoder.h"
 #include "SkDataTable.h"
 
+class SkExecutor;
 class SkPngEncoderMgr;
 class SkWStream;
 
@@ -59,6 +60,16 @@ public:
          *  and the (2i + 1)-th entry is the text for the i-th comment.
          */
         sk_sp<SkDataTable> fComments;
+
+        /**
+         *  If not null, and all of the rows are encoded at once, they are split into bands which
+         *  are filtered and compressed in parallel on this executor.  The pieces are joined into
+         *  one zlib stream, so the png is still valid, but each band costs a few extra bytes
+         *  and starts with a little less history to compress against.
+         *
+         *  Bands hold at least a megabyte of pixels, so small images are unaffected.
+         */
+        SkExecutor* fExecutor = nullptr;
     };
 
     /**
@@ -80,12 +91,27 @@ public:
     static std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkPixmap& src,
                                            const Options& options);
 
+    /**
+     *  Create a png encoder for an image described by |info|, whose pixels are pulled from
+     *  |source| in strips of |stripHeight| rows as they are encoded.  Only one strip is held in
+     *  memory at a time, so this can encode images far too large to rasterize all at once.
+     *
+     *  |dst| and |source| are unowned but must remain valid for the lifetime of the object.
+     *
+     *  This returns nullptr on an invalid or unsupported |info|.
+     */
+    static std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkImageInfo& info,
+                                           RowSource* source, int stripHeight,
+                                           const Options& options);
+
     ~SkPngEncoder() override;
 
 protected:
     bool onEncodeRows(int numRows) override;
 
     SkPngEncoder(std::unique_ptr<SkPngEncoderMgr>, const SkPixmap& src);
+    SkPngEncoder(std::unique_ptr<SkPngEncoderMgr>, const SkImageInfo& info, RowSource* source,
+                 int stripHeight);
 
     std::unique_ptr<SkPngEncoderMgr> fEncoderMgr;
     typedef SkEncoder INHERITED;
@@ -587,6 +587,11 @@ public:
     AI static SkNx Load(const void* ptr) {
         return vld1q_u32((const uint32_t*)ptr);
     }
+    AI static void Load2(const void* ptr, SkNx* x, SkNx* y) {
+        uint32x4x2_t xy = vld2q_u32((const uint32_t*) ptr);
+        *x = xy.val[0];
+        *y = xy.val[1];
+    }
     AI void store(void* ptr) const {
         return vst1q_u32((uint32_t*)ptr, fVec);
     }
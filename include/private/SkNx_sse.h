@@ -367,6 +367,15 @@ public:
     AI static SkNx Load(const void* ptr) { return _mm_loadu_si128((const __m128i*)ptr); }
     AI SkNx(uint32_t a, uint32_t b, uint32_t c, uint32_t d) : fVec(_mm_setr_epi32(a,b,c,d)) {}
 
+    AI static void Load2(const void* ptr, SkNx* x, SkNx* y) {
+        __m128i lo = _mm_loadu_si128(((const __m128i*)ptr) + 0),  // x0 y0 x1 y1
+                hi = _mm_loadu_si128(((const __m128i*)ptr) + 1);  // x2 y2 x3 y3
+        lo = _mm_shuffle_epi32(lo, _MM_SHUFFLE(3,1,2,0));         // x0 x1 y0 y1
+        hi = _mm_shuffle_epi32(hi, _MM_SHUFFLE(3,1,2,0));         // x2 x3 y2 y3
+        *x = _mm_unpacklo_epi64(lo, hi);
+        *y = _mm_unpackhi_epi64(lo, hi);
+    }
+
     AI void store(void* ptr) const { _mm_storeu_si128((__m128i*)ptr, fVec); }
 
     AI SkNx operator + (const SkNx& o) const { return _mm_add_epi32(fVec, o.fVec); }
@@ -8,9 +8,12 @@
 #ifndef SkAnimCodecPlayer_DEFINED
 #define SkAnimCodecPlayer_DEFINED
 
+#include "../private/SkMutex.h"
 #include "SkCodec.h"
 
+class SkExecutor;
 class SkImage;
+class SkTaskGroup;
 
 class SkAnimCodecPlayer {
 public:
@@ -44,6 +47,23 @@ public:
      */
     bool seek(uint32_t msec);
 
+    /**
+     *  Limits the memory used by decoded frames. Once they take up more than this many bytes,
+     *  the least recently used frames (other than the current one) are dropped, and decoded
+     *  again if they are needed. By default, every frame is kept.
+     */
+    void setCacheBudget(size_t bytes);
+
+    /**
+     *  Decodes up to frameCount frames after the current one on executor, so that they are
+     *  ready by the time seek() reaches them. Frames that depend on earlier ones are decoded on
+     *  top of them (see SkCodec::Options::fPriorFrame). The cache budget also limits how far
+     *  ahead this decodes.
+     *
+     *  Pass a null executor to stop. The executor must outlive this player, or the next call.
+     *  getFrame() only waits on a decode if the current frame is not decoded yet.
+     */
+    void setLookAhead(SkExecutor* executor, int frameCount);
 
 private:
     std::unique_ptr<SkCodec>        fCodec;
@@ -53,7 +73,27 @@ private:
     int                             fCurrIndex = 0;
     uint32_t                        fTotalDuration;
 
+    // For choosing which frames to drop.
+    std::vector<uint64_t>           fLastUsed;
+    uint64_t                        fUseCount = 0;
+    size_t                          fCacheBudget = SIZE_MAX;
+    size_t                          fCachedBytes = 0;
+
+    // Guards everything above once frames are decoded ahead, except fCodec. Frames are decoded
+    // holding only fCodecMutex, and then published under fMutex.
+    SkMutex                         fMutex;
+    SkMutex                         fCodecMutex;
+    std::unique_ptr<SkTaskGroup>    fLookAheadTasks;
+    int                             fLookAheadCount = 0;
+    bool                            fLookAheadRunning = false;
+    bool                            fStopLookAhead = false;
+
+    size_t frameBytes() const;
     sk_sp<SkImage> getFrameAt(int index);
+    void purge(int keepIndex);
+    void startLookAhead();
+    void lookAhead();
+    void stopLookAhead();
 };
 
 #endif
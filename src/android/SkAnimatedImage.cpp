@@ -10,10 +10,12 @@
 #include "SkCanvas.h"
 #include "SkCodec.h"
 #include "SkCodecPriv.h"
+#include "SkExecutor.h"
 #include "SkImagePriv.h"
 #include "SkPicture.h"
 #include "SkPictureRecorder.h"
 #include "SkPixelRef.h"
+#include "SkTaskGroup.h"
 
 #include <utility>
 
@@ -99,7 +101,9 @@ SkAnimatedImage::SkAnimatedImage(std::unique_ptr<SkAndroidCodec> codec, SkISize
     this->decodeNextFrame();
 }
 
-SkAnimatedImage::~SkAnimatedImage() { }
+SkAnimatedImage::~SkAnimatedImage() {
+    this->finishLookAhead();
+}
 
 SkRect SkAnimatedImage::onGetBounds() {
     return SkRect::MakeIWH(fCropRect.width(), fCropRect.height());
@@ -147,6 +151,7 @@ bool SkAnimatedImage::Frame::copyTo(Frame* dst) const {
 }
 
 void SkAnimatedImage::reset() {
+    this->finishLookAhead();
     fFinished = false;
     fRepetitionsCompleted = 0;
     if (fDisplayFrame.fIndex != 0) {
@@ -184,6 +189,15 @@ double SkAnimatedImage::finish() {
 }
 
 int SkAnimatedImage::decodeNextFrame() {
+    this->finishLookAhead();
+    const int duration = this->advanceFrame();
+    if (duration != kFinished) {
+        this->startLookAhead();
+    }
+    return duration;
+}
+
+int SkAnimatedImage::advanceFrame() {
     if (fFinished) {
         return kFinished;
     }
@@ -235,6 +249,20 @@ int SkAnimatedImage::decodeNextFrame() {
         }
     }
 
+    if (!this->decodeFrame(frameToDecode, frameInfo)) {
+        return this->finish();
+    }
+
+    using std::swap;
+    swap(fDecodingFrame, fDisplayFrame);
+
+    if (animationEnded) {
+        return this->finish();
+    }
+    return fCurrentFrameDuration;
+}
+
+bool SkAnimatedImage::decodeFrame(int frameToDecode, const SkCodec::FrameInfo& frameInfo) {
     // The following code makes an effort to avoid overwriting a frame that will
     // be used again. If frame |i| is_restore_previous, frame |i+1| will not
     // depend on frame |i|, so do not overwrite frame |i-1|, which may be needed
@@ -273,7 +301,7 @@ int SkAnimatedImage::decodeNextFrame() {
         } else if (validPriorFrame(fDisplayFrame)) {
             if (!fDisplayFrame.copyTo(&fDecodingFrame)) {
                 SkCodecPrintf("Failed to allocate pixels for frame\n");
-                return this->finish();
+                return false;
             }
             options.fPriorFrame = fDecodingFrame.fIndex;
         } else if (validPriorFrame(fRestoreFrame)) {
@@ -282,7 +310,7 @@ int SkAnimatedImage::decodeNextFrame() {
                 swap(fDecodingFrame, fRestoreFrame);
             } else if (!fRestoreFrame.copyTo(&fDecodingFrame)) {
                 SkCodecPrintf("Failed to restore frame\n");
-                return this->finish();
+                return false;
             }
             options.fPriorFrame = fDecodingFrame.fIndex;
         }
@@ -293,27 +321,57 @@ int SkAnimatedImage::decodeNextFrame() {
     auto info = fDecodeInfo.makeAlphaType(alphaType);
     SkBitmap* dst = &fDecodingFrame.fBitmap;
     if (!fDecodingFrame.init(info, Frame::OnInit::kRestoreIfNecessary)) {
-        return this->finish();
+        return false;
     }
 
     auto result = fCodec->codec()->getPixels(dst->info(), dst->getPixels(), dst->rowBytes(),
                                              &options);
     if (result != SkCodec::kSuccess) {
         SkCodecPrintf("error %i, frame %i of %i\n", result, frameToDecode, fFrameCount);
-        return this->finish();
+        return false;
     }
 
     fDecodingFrame.fIndex = frameToDecode;
     fDecodingFrame.fDisposalMethod = frameInfo.fDisposalMethod;
+    fDecodingFrame.fBitmap.notifyPixelsChanged();
+    return true;
+}
 
-    using std::swap;
-    swap(fDecodingFrame, fDisplayFrame);
-    fDisplayFrame.fBitmap.notifyPixelsChanged();
+void SkAnimatedImage::setLookAheadExecutor(SkExecutor* executor) {
+    this->finishLookAhead();
+    fLookAhead.reset(executor ? new SkTaskGroup(*executor) : nullptr);
+}
 
-    if (animationEnded) {
-        return this->finish();
+void SkAnimatedImage::startLookAhead() {
+    if (!fLookAhead) {
+        return;
+    }
+
+    // Guess that the next frame follows this one. If the animation ends or is reset instead,
+    // decodeNextFrame will decode what it needs as usual.
+    const int frameToDecode = fDisplayFrame.fIndex + 1 == fFrameCount ? 0
+                                                                       : fDisplayFrame.fIndex + 1;
+    if (frameToDecode == fDisplayFrame.fIndex || frameToDecode == fDecodingFrame.fIndex ||
+            frameToDecode == fRestoreFrame.fIndex) {
+        return;
+    }
+
+    SkCodec::FrameInfo frameInfo;
+    if (!fCodec->codec()->getFrameInfo(frameToDecode, &frameInfo) || !frameInfo.fFullyReceived) {
+        return;
+    }
+    fLookAhead->add([this, frameToDecode, frameInfo] {
+        if (!this->decodeFrame(frameToDecode, frameInfo)) {
+            // Leave the frame for decodeNextFrame to decode (and report).
+            fDecodingFrame.fIndex = SkCodec::kNoFrame;
+        }
+    });
+}
+
+void SkAnimatedImage::finishLookAhead() {
+    if (fLookAhead) {
+        fLookAhead->wait();
     }
-    return fCurrentFrameDuration;
 }
 
 void SkAnimatedImage::onDraw(SkCanvas* canvas) {
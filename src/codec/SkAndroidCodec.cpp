@@ -118,7 +118,7 @@ std::unique_ptr<SkAndroidCodec> SkAndroidCodec::MakeFromData(sk_sp<SkData> data,
         return nullptr;
     }
 
-    return MakeFromStream(SkMemoryStream::Make(std::move(data)), chunkReader);
+    return MakeFromCodec(SkCodec::MakeFromData(std::move(data), chunkReader));
 }
 
 SkColorType SkAndroidCodec::computeOutputColorType(SkColorType requestedColorType) {
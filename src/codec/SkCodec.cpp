@@ -10,6 +10,7 @@
 #include "SkCodecPriv.h"
 #include "SkColorSpace.h"
 #include "SkData.h"
+#include "SkDataPriv.h"
 #include "SkFrameHolder.h"
 #include "SkHalf.h"
 #ifdef SK_HAS_HEIF_LIBRARY
@@ -17,6 +18,7 @@
 #endif
 #include "SkIcoCodec.h"
 #include "SkJpegCodec.h"
+#include "SkOSFile.h"
 #ifdef SK_HAS_PNG_LIBRARY
 #include "SkPngCodec.h"
 #endif
@@ -130,7 +132,12 @@ std::unique_ptr<SkCodec> SkCodec::MakeFromData(sk_sp<SkData> data, SkPngChunkRea
     if (!data) {
         return nullptr;
     }
-    return MakeFromStream(SkMemoryStream::Make(std::move(data)), nullptr, reader);
+    sk_sp<SkData> fileMapping = SkDataPriv::IsFileMapping(*data) ? data : nullptr;
+    auto codec = MakeFromStream(SkMemoryStream::Make(std::move(data)), nullptr, reader);
+    if (codec) {
+        codec->fFileMapping = std::move(fileMapping);
+    }
+    return codec;
 }
 
 SkCodec::SkCodec(SkEncodedInfo&& info, XformFormat srcFormat, std::unique_ptr<SkStream> stream,
@@ -172,6 +179,14 @@ bool SkCodec::conversionSupported(const SkImageInfo& dst, bool srcIsOpaque, bool
     }
 }
 
+void SkCodec::willDecode() {
+    // Decoders read a stream in memory in place, mostly front to back. If that memory is a file
+    // we mapped, ask the OS to start paging it in now.
+    if (fFileMapping) {
+        sk_fmmap_will_read(fFileMapping->data(), fFileMapping->size());
+    }
+}
+
 bool SkCodec::rewindIfNeeded() {
     // Store the value of fNeedsRewind so we can update it. Next read will
     // require a rewind.
@@ -325,6 +340,7 @@ SkCodec::Result SkCodec::getPixels(const SkImageInfo& dstInfo, void* pixels, siz
     if (!this->rewindIfNeeded()) {
         return kCouldNotRewind;
     }
+    this->willDecode();
 
     // Default options.
     Options optsStorage;
@@ -403,6 +419,7 @@ SkCodec::Result SkCodec::startIncrementalDecode(const SkImageInfo& dstInfo, void
     if (!this->rewindIfNeeded()) {
         return kCouldNotRewind;
     }
+    this->willDecode();
 
     // Set options.
     Options optsStorage;
@@ -466,6 +483,7 @@ SkCodec::Result SkCodec::startScanlineDecode(const SkImageInfo& dstInfo,
     if (!this->rewindIfNeeded()) {
         return kCouldNotRewind;
     }
+    this->willDecode();
 
     // Set options.
     Options optsStorage;
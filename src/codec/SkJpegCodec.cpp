@@ -12,7 +12,9 @@
 #include "SkColorData.h"
 #include "SkJpegDecoderMgr.h"
 #include "SkJpegInfo.h"
+#include "SkJpegRestartIndex.h"
 #include "SkStream.h"
+#include "SkTaskGroup.h"
 #include "SkTemplates.h"
 #include "SkTo.h"
 #include "SkTypes.h"
@@ -302,10 +304,14 @@ SkJpegCodec::SkJpegCodec(SkEncodedInfo&& info, std::unique_ptr<SkStream> stream,
                          JpegDecoderMgr* decoderMgr, SkEncodedOrigin origin)
     : INHERITED(std::move(info), skcms_PixelFormat_RGBA_8888, std::move(stream), origin)
     , fDecoderMgr(decoderMgr)
+    , fTriedRestartIndex(false)
     , fReadyState(decoderMgr->dinfo()->global_state)
     , fSwizzleSrcRow(nullptr)
     , fColorXformSrcRow(nullptr)
     , fSwizzlerSubset(SkIRect::MakeEmpty())
+    , fIncrementalDst(nullptr)
+    , fIncrementalRowBytes(0)
+    , fPreviewScans(0)
 {}
 
 /*
@@ -376,6 +382,7 @@ bool SkJpegCodec::onRewind() {
     }
     SkASSERT(nullptr != decoderMgr);
     fDecoderMgr.reset(decoderMgr);
+    fSeekDecoderMgr.reset();
 
     fSwizzler.reset(nullptr);
     fSwizzleSrcRow = nullptr;
@@ -494,12 +501,23 @@ bool SkJpegCodec::onDimensionsSupported(const SkISize& size) {
 
 int SkJpegCodec::readRows(const SkImageInfo& dstInfo, void* dst, size_t rowBytes, int count,
                           const Options& opts) {
+    JpegDecoderMgr* decoderMgr = this->scanlineDecoderMgr();
+
     // Set the jump location for libjpeg-turbo errors
-    skjpeg_error_mgr::AutoPushJmpBuf jmp(fDecoderMgr->errorMgr());
+    skjpeg_error_mgr::AutoPushJmpBuf jmp(decoderMgr->errorMgr());
     if (setjmp(jmp)) {
         return 0;
     }
 
+    return this->readRows(decoderMgr->dinfo(), fSwizzleSrcRow, fColorXformSrcRow, dstInfo, dst,
+                          rowBytes, count, opts);
+}
+
+int SkJpegCodec::readRows(jpeg_decompress_struct* dinfo, uint8_t* swizzleSrcRow,
+                          uint32_t* colorXformSrcRow, const SkImageInfo& dstInfo, void* dst,
+                          size_t rowBytes, int count, const Options& opts) {
+    SkASSERT(!swizzleSrcRow == !fSwizzleSrcRow && !colorXformSrcRow == !fColorXformSrcRow);
+
     // When fSwizzleSrcRow is non-null, it means that we need to swizzle.  In this case,
     // we will always decode into fSwizzlerSrcRow before swizzling into the next buffer.
     // We can never swizzle "in place" because the swizzler may perform sampling and/or
@@ -513,25 +531,25 @@ int SkJpegCodec::readRows(const SkImageInfo& dstInfo, void* dst, size_t rowBytes
     size_t decodeDstRowBytes = rowBytes;
     size_t swizzleDstRowBytes = rowBytes;
     int dstWidth = opts.fSubset ? opts.fSubset->width() : dstInfo.width();
-    if (fSwizzleSrcRow && fColorXformSrcRow) {
-        decodeDst = (JSAMPLE*) fSwizzleSrcRow;
-        swizzleDst = fColorXformSrcRow;
+    if (swizzleSrcRow && colorXformSrcRow) {
+        decodeDst = (JSAMPLE*) swizzleSrcRow;
+        swizzleDst = colorXformSrcRow;
         decodeDstRowBytes = 0;
         swizzleDstRowBytes = 0;
         dstWidth = fSwizzler->swizzleWidth();
-    } else if (fColorXformSrcRow) {
-        decodeDst = (JSAMPLE*) fColorXformSrcRow;
-        swizzleDst = fColorXformSrcRow;
+    } else if (colorXformSrcRow) {
+        decodeDst = (JSAMPLE*) colorXformSrcRow;
+        swizzleDst = colorXformSrcRow;
         decodeDstRowBytes = 0;
         swizzleDstRowBytes = 0;
-    } else if (fSwizzleSrcRow) {
-        decodeDst = (JSAMPLE*) fSwizzleSrcRow;
+    } else if (swizzleSrcRow) {
+        decodeDst = (JSAMPLE*) swizzleSrcRow;
         decodeDstRowBytes = 0;
         dstWidth = fSwizzler->swizzleWidth();
     }
 
     for (int y = 0; y < count; y++) {
-        uint32_t lines = jpeg_read_scanlines(fDecoderMgr->dinfo(), &decodeDst, 1);
+        uint32_t lines = jpeg_read_scanlines(dinfo, &decodeDst, 1);
         if (0 == lines) {
             return y;
         }
@@ -605,6 +623,10 @@ SkCodec::Result SkJpegCodec::onGetPixels(const SkImageInfo& dstInfo,
 
     this->allocateStorage(dstInfo);
 
+    if (options.fExecutor && this->decodeInBands(dstInfo, dst, dstRowBytes, options)) {
+        return kSuccess;
+    }
+
     int rows = this->readRows(dstInfo, dst, dstRowBytes, dstInfo.height(), options);
     if (rows < dstInfo.height()) {
         *rowsDecoded = rows;
@@ -614,6 +636,250 @@ SkCodec::Result SkJpegCodec::onGetPixels(const SkImageInfo& dstInfo,
     return kSuccess;
 }
 
+SkCodec::Result SkJpegCodec::onStartIncrementalDecode(const SkImageInfo& dstInfo, void* dst,
+                                                     size_t rowBytes, const Options& options) {
+    if (options.fSubset || !options.fPreviewProc) {
+        return kUnimplemented;
+    }
+
+    jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
+    skjpeg_error_mgr::AutoPushJmpBuf jmp(fDecoderMgr->errorMgr());
+    if (setjmp(jmp)) {
+        return fDecoderMgr->returnFailure("setjmp", kInvalidInput);
+    }
+
+    if (!jpeg_has_multiple_scans(dinfo)) {
+        return kUnimplemented;
+    }
+
+    // In buffered image mode, this only sets up the decoder, without reading any scans.
+    dinfo->buffered_image = true;
+    if (!jpeg_start_decompress(dinfo)) {
+        return fDecoderMgr->returnFailure("startDecompress", kInvalidInput);
+    }
+
+    if (needs_swizzler_to_convert_from_cmyk(dinfo->out_color_space,
+                                            this->getEncodedInfo().profile(), this->colorXform())) {
+        this->initializeSwizzler(dstInfo, options, true);
+    }
+    this->allocateStorage(dstInfo);
+
+    fIncrementalDst = dst;
+    fIncrementalRowBytes = rowBytes;
+    fPreviewScans = 0;
+    return kSuccess;
+}
+
+SkCodec::Result SkJpegCodec::onIncrementalDecode(int* rowsDecoded) {
+    jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
+    const int height = this->dstInfo().height();
+    // Once a preview has been emitted every row holds one, whether or not a later scan fails.
+    auto reportRows = [this, rowsDecoded, height]() {
+        if (rowsDecoded) {
+            *rowsDecoded = fPreviewScans ? height : 0;
+        }
+    };
+    auto fail = [this, &reportRows](const char* caller) {
+        reportRows();
+        return fDecoderMgr->returnFailure(caller, kErrorInInput);
+    };
+
+    skjpeg_error_mgr::AutoPushJmpBuf jmp(fDecoderMgr->errorMgr());
+    if (setjmp(jmp)) {
+        return fail("setjmp");
+    }
+
+    fDecoderMgr->sourceMgr()->readAvailableData();
+    int status;
+    do {
+        status = jpeg_consume_input(dinfo);
+    } while (JPEG_SUSPENDED != status && JPEG_REACHED_EOI != status);
+
+    // Once the next scan has started, the ones before it are complete.
+    const bool complete = jpeg_input_complete(dinfo);
+    const int scans = complete ? dinfo->input_scan_number : dinfo->input_scan_number - 1;
+    if (scans > fPreviewScans) {
+        // None of these scans need more input, so this reads every row.
+        if (!jpeg_start_output(dinfo, scans)) {
+            return fail("startOutput");
+        }
+        const int rows = this->readRows(this->dstInfo(), fIncrementalDst, fIncrementalRowBytes,
+                                        height, this->options());
+        if (!jpeg_finish_output(dinfo) || rows < height) {
+            return fail("finishOutput");
+        }
+        fPreviewScans = scans;
+        if (complete) {
+            return kSuccess;
+        }
+        this->options().fPreviewProc(this->options().fPreviewContext, fPreviewScans);
+    }
+
+    reportRows();
+    return kIncompleteInput;
+}
+
+const SkJpegRestartIndex* SkJpegCodec::restartIndex() {
+    if (!fTriedRestartIndex) {
+        fTriedRestartIndex = true;
+        SkStream* stream = this->stream();
+        if (stream->hasLength() && stream->getMemoryBase()) {
+            fRestartIndex = SkJpegRestartIndex::Make(stream->getMemoryBase(),
+                                                     stream->getLength());
+        }
+    }
+    return fRestartIndex.get();
+}
+
+/*
+ * Returns the height of a decoded MCU row, or 0 if it is not a whole number of rows.
+ */
+static int scaled_mcu_height(const SkJpegRestartIndex& index,
+                             const jpeg_decompress_struct* dinfo) {
+    const unsigned scaledHeight = index.mcuHeight() * dinfo->scale_num;
+    if (0 != scaledHeight % dinfo->scale_denom) {
+        return 0;
+    }
+    return scaledHeight / dinfo->scale_denom;
+}
+
+/*
+ * Reads the header of a strip, and starts decoding it exactly as the whole image (described by
+ * imageInfo) is decoded.
+ */
+static bool start_strip_decode(JpegDecoderMgr* decoderMgr,
+                               const jpeg_decompress_struct* imageInfo) {
+    // Set the jump location for libjpeg-turbo errors
+    skjpeg_error_mgr::AutoPushJmpBuf jmp(decoderMgr->errorMgr());
+    if (setjmp(jmp)) {
+        return decoderMgr->returnFalse("start_strip_decode");
+    }
+
+    decoderMgr->init();
+    jpeg_decompress_struct* dinfo = decoderMgr->dinfo();
+    if (JPEG_HEADER_OK != jpeg_read_header(dinfo, true)) {
+        return decoderMgr->returnFalse("start_strip_decode");
+    }
+
+    dinfo->out_color_space = imageInfo->out_color_space;
+    dinfo->scale_num = imageInfo->scale_num;
+    dinfo->scale_denom = imageInfo->scale_denom;
+    dinfo->dither_mode = imageInfo->dither_mode;
+    dinfo->dct_method = imageInfo->dct_method;
+    dinfo->do_fancy_upsampling = imageInfo->do_fancy_upsampling;
+    dinfo->do_block_smoothing = imageInfo->do_block_smoothing;
+    return jpeg_start_decompress(dinfo);
+}
+
+// Bands cover at least this many encoded pixels (which every scale entropy decodes in full), so
+// that setting up a decoder for each one costs little next to decoding the band itself.
+static constexpr int kMinBandPixels = 1 << 19;
+
+bool SkJpegCodec::decodeInBands(const SkImageInfo& dstInfo, void* dst, size_t rowBytes,
+                                const Options& options) {
+    const SkJpegRestartIndex* index = this->restartIndex();
+    if (!index) {
+        return false;
+    }
+
+    // Bands meet exactly only if each MCU row scales to a whole number of rows.
+    const int scaledMCUHeight = scaled_mcu_height(*index, fDecoderMgr->dinfo());
+    if (0 == scaledMCUHeight) {
+        return false;
+    }
+
+    // Bands start at restart rows.  Give each one at least minRows MCU rows, leaving enough for
+    // the last one too.  If bands also decode the MCU rows around them, make them long enough
+    // that this adds little.
+    const int rowCount = index->mcuRowCount();
+    int minRows = SkTMax(1, kMinBandPixels / (index->width() * index->mcuHeight()));
+    if (index->needsContextRows()) {
+        minRows = SkTMax(minRows, 16 * index->rowsPerRestart());
+    }
+    SkTArray<int> bandStarts;
+    bandStarts.push_back(0);
+    for (int row = minRows; row <= rowCount - minRows; row++) {
+        if (row - bandStarts.back() >= minRows && index->isRestartRow(row)) {
+            bandStarts.push_back(row);
+        }
+    }
+    if (bandStarts.count() < 2) {
+        return false;
+    }
+    bandStarts.push_back(rowCount);
+    const int bandCount = bandStarts.count() - 1;
+
+    std::atomic<bool> failed{false};
+    SkTaskGroup taskGroup(*options.fExecutor);
+    taskGroup.batch(bandCount, [&](int i) {
+        const int startRow = bandStarts[i],
+                  endRow = bandStarts[i + 1];
+
+        // Extend the strip to the neighbouring restart rows, if upsampling needs them.
+        int top = startRow,
+            bottom = endRow;
+        if (index->needsContextRows()) {
+            if (i > 0) {
+                do {
+                    top--;
+                } while (!index->isRestartRow(top));
+            }
+            if (i < bandCount - 1) {
+                do {
+                    bottom++;
+                } while (bottom < rowCount && !index->isRestartRow(bottom));
+            }
+        }
+
+        const int startY = startRow * scaledMCUHeight,
+                  endY = SkTMin(endRow * scaledMCUHeight, dstInfo.height());
+        if (!this->decodeBand(index->makeStrip(top, bottom), (startRow - top) * scaledMCUHeight,
+                              dstInfo, SkTAddOffset<void>(dst, startY * rowBytes), rowBytes,
+                              endY - startY, options)) {
+            failed = true;
+        }
+    });
+    taskGroup.wait();
+    return !failed;
+}
+
+bool SkJpegCodec::decodeBand(const SkJpegRestartIndex::Strip& strip, int skipRows,
+                             const SkImageInfo& dstInfo, void* dst, size_t rowBytes, int count,
+                             const Options& options) {
+    JpegDecoderMgr decoderMgr(strip.fHeader, strip.fData, strip.fLength);
+    if (!start_strip_decode(&decoderMgr, fDecoderMgr->dinfo()) ||
+            decoderMgr.dinfo()->output_width != fDecoderMgr->dinfo()->output_width) {
+        return false;
+    }
+
+    // Set the jump location for libjpeg-turbo errors
+    skjpeg_error_mgr::AutoPushJmpBuf jmp(decoderMgr.errorMgr());
+    if (setjmp(jmp)) {
+        return decoderMgr.returnFalse("decodeBand");
+    }
+
+    // Each band needs its own scratch rows.  The first one doubles as the row that the rows
+    // above the band are decoded into and dropped.
+    jpeg_decompress_struct* dinfo = decoderMgr.dinfo();
+    const size_t decodeBytes = get_row_bytes(dinfo);
+    const size_t xformBytes = fColorXformSrcRow ? (fSwizzler ? fSwizzler->swizzleWidth()
+                                                             : dstInfo.width()) * sizeof(uint32_t)
+                                                : 0;
+    SkAutoTMalloc<uint8_t> storage(decodeBytes + xformBytes);
+    uint8_t* swizzleSrcRow = fSwizzleSrcRow ? storage.get() : nullptr;
+    uint32_t* colorXformSrcRow = fColorXformSrcRow ?
+            SkTAddOffset<uint32_t>(storage.get(), decodeBytes) : nullptr;
+
+    JSAMPLE* skipRow = storage.get();
+    for (int y = 0; y < skipRows; y++) {
+        if (1 != jpeg_read_scanlines(dinfo, &skipRow, 1)) {
+            return false;
+        }
+    }
+    return count == this->readRows(dinfo, swizzleSrcRow, colorXformSrcRow, dstInfo, dst, rowBytes,
+                                   count, options);
+}
+
 void SkJpegCodec::allocateStorage(const SkImageInfo& dstInfo) {
     int dstWidth = dstInfo.width();
 
@@ -768,20 +1034,85 @@ int SkJpegCodec::onGetScanlines(void* dst, int count, size_t dstRowBytes) {
     int rows = this->readRows(this->dstInfo(), dst, dstRowBytes, count, this->options());
     if (rows < count) {
         // This allows us to skip calling jpeg_finish_decompress().
-        fDecoderMgr->dinfo()->output_scanline = this->dstInfo().height();
+        jpeg_decompress_struct* dinfo = this->scanlineDecoderMgr()->dinfo();
+        dinfo->output_scanline = dinfo->output_height;
     }
 
     return rows;
 }
 
+// Seeking sets up a new decoder, so only seek past enough MCU rows to pay for it.
+static constexpr int kMinSeekRows = 4;
+
+int SkJpegCodec::seekScanline(int target) {
+    const int currRow = this->currScanline();
+    const SkJpegRestartIndex* index = this->restartIndex();
+    if (!index) {
+        return currRow;
+    }
+    const jpeg_decompress_struct* imageInfo = fDecoderMgr->dinfo();
+    const int scaledMCUHeight = scaled_mcu_height(*index, imageInfo);
+    if (0 == scaledMCUHeight) {
+        return currRow;
+    }
+
+    // Start from the restart row at or above the MCU row holding the target, or above the one
+    // before it if upsampling needs the rows around the target.
+    int row = SkTMin(target / scaledMCUHeight, index->mcuRowCount() - 1);
+    if (index->needsContextRows() && row > 0) {
+        row--;
+    }
+    while (!index->isRestartRow(row)) {
+        row--;
+    }
+    const int startY = row * scaledMCUHeight;
+    if (startY < currRow + kMinSeekRows * scaledMCUHeight) {
+        return currRow;
+    }
+
+    const SkJpegRestartIndex::Strip strip = index->makeStrip(row, index->mcuRowCount());
+    std::unique_ptr<JpegDecoderMgr> decoderMgr(new JpegDecoderMgr(strip.fHeader, strip.fData,
+                                                                  strip.fLength));
+    if (!start_strip_decode(decoderMgr.get(), imageInfo)) {
+        return currRow;
+    }
+
+    {
+        // Set the jump location for libjpeg-turbo errors
+        skjpeg_error_mgr::AutoPushJmpBuf jmp(decoderMgr->errorMgr());
+        if (setjmp(jmp)) {
+            return currRow;
+        }
+
+        // Crop exactly as onStartScanlineDecode() did.
+        jpeg_decompress_struct* dinfo = decoderMgr->dinfo();
+        if (const SkIRect* subset = this->options().fSubset) {
+            uint32_t startX = subset->x();
+            uint32_t width = subset->width();
+            jpeg_crop_scanline(dinfo, &startX, &width);
+        }
+        if (dinfo->output_width != this->scanlineDecoderMgr()->dinfo()->output_width) {
+            return currRow;
+        }
+    }
+
+    fSeekDecoderMgr = std::move(decoderMgr);
+    return startY;
+}
+
 bool SkJpegCodec::onSkipScanlines(int count) {
+    // Skip from the nearest restart row, rather than entropy decoding everything before it.
+    const int target = this->currScanline() + count;
+    const int row = this->seekScanline(target);
+    JpegDecoderMgr* decoderMgr = this->scanlineDecoderMgr();
+
     // Set the jump location for libjpeg errors
-    skjpeg_error_mgr::AutoPushJmpBuf jmp(fDecoderMgr->errorMgr());
+    skjpeg_error_mgr::AutoPushJmpBuf jmp(decoderMgr->errorMgr());
     if (setjmp(jmp)) {
-        return fDecoderMgr->returnFalse("onSkipScanlines");
+        return decoderMgr->returnFalse("onSkipScanlines");
     }
 
-    return (uint32_t) count == jpeg_skip_scanlines(fDecoderMgr->dinfo(), count);
+    return (uint32_t) (target - row) == jpeg_skip_scanlines(decoderMgr->dinfo(), target - row);
 }
 
 static bool is_yuv_supported(jpeg_decompress_struct* dinfo) {
@@ -10,11 +10,13 @@
 
 #include "SkCodec.h"
 #include "SkImageInfo.h"
+#include "SkJpegRestartIndex.h"
 #include "SkSwizzler.h"
 #include "SkStream.h"
 #include "SkTemplates.h"
 
 class JpegDecoderMgr;
+struct jpeg_decompress_struct;
 
 /*
  *
@@ -55,6 +57,15 @@ protected:
 
     bool onRewind() override;
 
+    /*
+     * Only progressive jpegs support incremental decoding, and only to show previews (i.e.
+     * with Options::fPreviewProc).  Decodes every scan into a buffered image, and writes a
+     * preview from it each time more of the scans have arrived.
+     */
+    Result onStartIncrementalDecode(const SkImageInfo& dstInfo, void* dst, size_t rowBytes,
+                                    const Options&) override;
+    Result onIncrementalDecode(int* rowsDecoded) override;
+
     bool onDimensionsSupported(const SkISize&) override;
 
     bool conversionSupported(const SkImageInfo&, bool, bool) override;
@@ -109,6 +120,48 @@ private:
     void allocateStorage(const SkImageInfo& dstInfo);
     int readRows(const SkImageInfo& dstInfo, void* dst, size_t rowBytes, int count, const Options&);
 
+    /*
+     * Reads rows from dinfo, which has been started.  swizzleSrcRow and colorXformSrcRow are
+     * scratch rows, which must be non-null exactly when fSwizzleSrcRow and fColorXformSrcRow are.
+     * Does not set a jump location for libjpeg-turbo errors.
+     */
+    int readRows(jpeg_decompress_struct* dinfo, uint8_t* swizzleSrcRow, uint32_t* colorXformSrcRow,
+                 const SkImageInfo& dstInfo, void* dst, size_t rowBytes, int count, const Options&);
+
+    /*
+     * Indexes the restart markers the first time it is called, if the stream is in memory.
+     * Returns nullptr if the jpeg cannot be indexed.
+     */
+    const SkJpegRestartIndex* restartIndex();
+
+    /*
+     * If the jpeg has restart markers at the start of enough MCU rows, splits it into bands and
+     * decodes each one on options.fExecutor with its own decompress struct.
+     *
+     * Returns false if the image cannot be split, or if any band fails.  The caller should then
+     * decode the image serially, which reports errors as usual.
+     */
+    bool decodeInBands(const SkImageInfo& dstInfo, void* dst, size_t rowBytes, const Options&);
+
+    /*
+     * Decodes 'count' rows of a stand-alone strip made by SkJpegRestartIndex, after discarding
+     * its first 'skipRows' rows.
+     */
+    bool decodeBand(const SkJpegRestartIndex::Strip& strip, int skipRows,
+                    const SkImageInfo& dstInfo, void* dst, size_t rowBytes, int count,
+                    const Options&);
+
+    /*
+     * Before skipping to scanline 'target', moves the scanline decoder to the last restart row
+     * that still decodes 'target' exactly, if that is well past the current scanline.  Returns
+     * the scanline that the decoder is now on.
+     */
+    int seekScanline(int target);
+
+    JpegDecoderMgr* scanlineDecoderMgr() {
+        return fSeekDecoderMgr ? fSeekDecoderMgr.get() : fDecoderMgr.get();
+    }
+
     /*
      * Scanline decoding.
      */
@@ -120,6 +173,13 @@ private:
 
     std::unique_ptr<JpegDecoderMgr>    fDecoderMgr;
 
+    // After seekScanline(), scanlines come from this decoder, which reads the rest of the image
+    // from a restart row.  fDecoderMgr still describes the whole image.
+    std::unique_ptr<JpegDecoderMgr>    fSeekDecoderMgr;
+
+    std::unique_ptr<SkJpegRestartIndex> fRestartIndex;
+    bool                               fTriedRestartIndex;
+
     // We will save the state of the decompress struct after reading the header.
     // This allows us to safely call onGetScaledDimensions() at any time.
     const int                          fReadyState;
@@ -136,6 +196,11 @@ private:
 
     std::unique_ptr<SkSwizzler>        fSwizzler;
 
+    // Incremental decoding.  The number of scans in the last preview written to fIncrementalDst.
+    void*                              fIncrementalDst;
+    size_t                             fIncrementalRowBytes;
+    int                                fPreviewScans;
+
     friend class SkRawCodec;
 
     typedef SkCodec INHERITED;
@@ -84,6 +84,14 @@ JpegDecoderMgr::JpegDecoderMgr(SkStream* stream)
     fErrorMgr.error_exit = skjpeg_err_exit;
 }
 
+JpegDecoderMgr::JpegDecoderMgr(sk_sp<SkData> header, const void* data, size_t length)
+    : fSrcMgr(std::move(header), data, length)
+    , fInit(false)
+{
+    fDInfo.err = jpeg_std_error(&fErrorMgr);
+    fErrorMgr.error_exit = skjpeg_err_exit;
+}
+
 void JpegDecoderMgr::init() {
     jpeg_create_decompress(&fDInfo);
     fInit = true;
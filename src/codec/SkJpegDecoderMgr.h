@@ -36,6 +36,12 @@ public:
      */
     JpegDecoderMgr(SkStream* stream);
 
+    /*
+     * Create a decode manager for a strip made by SkJpegRestartIndex
+     * Does not copy data
+     */
+    JpegDecoderMgr(sk_sp<SkData> header, const void* data, size_t length);
+
     /*
      * Initialize decompress struct
      * Initialize the source manager
@@ -63,6 +69,11 @@ public:
      */
     jpeg_decompress_struct* dinfo() { return &fDInfo; }
 
+    /*
+     * Get the source manager, e.g. to read more data for an incremental decode
+     */
+    skjpeg_source_mgr* sourceMgr() { return &fSrcMgr; }
+
 private:
 
     jpeg_decompress_struct fDInfo;
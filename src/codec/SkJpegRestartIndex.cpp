@@ -0,0 +1,210 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkJpegRestartIndex.h"
+
+#include "SkCodecPriv.h"
+#include "SkTo.h"
+
+#include <string.h>
+
+static constexpr uint8_t kMarkerSOF0 = 0xC0;  // Baseline
+static constexpr uint8_t kMarkerSOF1 = 0xC1;  // Extended sequential, Huffman
+static constexpr uint8_t kMarkerDHT  = 0xC4;
+static constexpr uint8_t kMarkerJPG  = 0xC8;
+static constexpr uint8_t kMarkerDAC  = 0xCC;
+static constexpr uint8_t kMarkerSOFn = 0xCF;
+static constexpr uint8_t kMarkerRST0 = 0xD0;
+static constexpr uint8_t kMarkerRST7 = 0xD7;
+static constexpr uint8_t kMarkerSOI  = 0xD8;
+static constexpr uint8_t kMarkerEOI  = 0xD9;
+static constexpr uint8_t kMarkerSOS  = 0xDA;
+static constexpr uint8_t kMarkerDRI  = 0xDD;
+static constexpr uint8_t kMarkerAPP0 = 0xE0;
+static constexpr uint8_t kMarkerAPP14 = 0xEE;
+static constexpr uint8_t kMarkerAPP15 = 0xEF;
+static constexpr uint8_t kMarkerCOM  = 0xFE;
+
+static int read_u16(const uint8_t* p) {
+    return (p[0] << 8) | p[1];
+}
+
+// Application data and comments do not affect decoding, apart from the JFIF and Adobe markers,
+// which libjpeg-turbo uses to guess the color space.
+static bool is_needed_to_decode(uint8_t marker) {
+    if (kMarkerAPP0 <= marker && marker <= kMarkerAPP15) {
+        return kMarkerAPP0 == marker || kMarkerAPP14 == marker;
+    }
+    return kMarkerCOM != marker;
+}
+
+std::unique_ptr<SkJpegRestartIndex> SkJpegRestartIndex::Make(const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    if (length < 4 || 0xFF != bytes[0] || kMarkerSOI != bytes[1]) {
+        return nullptr;
+    }
+
+    std::unique_ptr<SkJpegRestartIndex> index(new SkJpegRestartIndex(bytes, length));
+    index->fHeader.append(2, bytes);
+
+    int componentCount = 0;
+    int maxH = 0, maxV = 0;
+    size_t scanStart = 0;
+    for (size_t i = 2; 0 == scanStart;) {
+        if (i + 4 > length || 0xFF != bytes[i]) {
+            return nullptr;
+        }
+        const uint8_t marker = bytes[i + 1];
+        if (0xFF == marker) {
+            // Markers may be preceded by any number of fill bytes.
+            i++;
+            continue;
+        }
+
+        const size_t segmentLength = 2 + read_u16(bytes + i + 2);
+        if (segmentLength < 4 || i + segmentLength > length) {
+            return nullptr;
+        }
+        const uint8_t* segment = bytes + i;
+
+        switch (marker) {
+            case kMarkerSOF0:
+            case kMarkerSOF1: {
+                if (componentCount || segmentLength < 10 || 8 != segment[4]) {
+                    return nullptr;
+                }
+                index->fHeight = read_u16(segment + 5);
+                index->fWidth = read_u16(segment + 7);
+                componentCount = segment[9];
+                if (0 == index->fHeight || 0 == index->fWidth || 0 == componentCount ||
+                        segmentLength < 10 + 3 * SkToSizeT(componentCount)) {
+                    // A height of zero means it is given by a DNL marker after the scan.
+                    return nullptr;
+                }
+                int minV = 4;
+                for (int c = 0; c < componentCount; c++) {
+                    const int h = segment[11 + 3 * c] >> 4,
+                              v = segment[11 + 3 * c] & 0xF;
+                    if (h < 1 || h > 4 || v < 1 || v > 4) {
+                        return nullptr;
+                    }
+                    maxH = SkTMax(maxH, h);
+                    maxV = SkTMax(maxV, v);
+                    minV = SkTMin(minV, v);
+                }
+                // A scan of one component has one block per MCU, whatever its sampling factors.
+                // Skip the unusual case where those factors are not 1x1.
+                if (1 == componentCount && (1 != maxH || 1 != maxV)) {
+                    return nullptr;
+                }
+                index->fHeightOffset = index->fHeader.count() + 5;
+                index->fMCUHeight = 8 * maxV;
+                index->fMCUsPerRow = (index->fWidth + 8 * maxH - 1) / (8 * maxH);
+                index->fNeedsContextRows = minV < maxV;
+                break;
+            }
+            case kMarkerDHT:
+            case kMarkerJPG:
+            case kMarkerDAC:
+                break;
+            case kMarkerDRI:
+                index->fRestartInterval = read_u16(segment + 4);
+                break;
+            case kMarkerSOS:
+                if (0 == componentCount || segment[4] != componentCount) {
+                    return nullptr;
+                }
+                scanStart = i + segmentLength;
+                break;
+            default:
+                if (marker > kMarkerSOF1 && marker <= kMarkerSOFn) {
+                    // Progressive, lossless, hierarchical, or arithmetic coded.
+                    return nullptr;
+                }
+                if (kMarkerRST0 <= marker && marker <= kMarkerEOI) {
+                    return nullptr;
+                }
+                break;
+        }
+
+        if (is_needed_to_decode(marker)) {
+            index->fHeader.append(SkToInt(segmentLength), segment);
+        }
+        i += segmentLength;
+    }
+
+    if (0 == index->fRestartInterval) {
+        return nullptr;
+    }
+
+    // Find the restart markers.  Within the entropy-coded data, 0xFF is always followed by a
+    // stuffed zero, or starts a marker.
+    index->fSegments.push_back(scanStart);
+    size_t i = scanStart;
+    for (;;) {
+        const void* next = memchr(bytes + i, 0xFF, length - i);
+        if (!next) {
+            return nullptr;
+        }
+        i = static_cast<const uint8_t*>(next) - bytes;
+        if (i + 1 >= length) {
+            return nullptr;
+        }
+        const uint8_t marker = bytes[i + 1];
+        if (0x00 == marker || 0xFF == marker) {
+            i += 0xFF == marker ? 1 : 2;
+            continue;
+        }
+        if (kMarkerRST0 <= marker && marker <= kMarkerRST7) {
+            if (marker != kMarkerRST0 + ((index->fSegments.count() - 1) & 7)) {
+                return nullptr;
+            }
+            i += 2;
+            index->fSegments.push_back(i);
+            continue;
+        }
+        break;
+    }
+
+    // Anything but EOI means another scan (or a DNL marker) follows this one.
+    if (kMarkerEOI != bytes[i + 1]) {
+        return nullptr;
+    }
+
+    const int64_t mcuCount = (int64_t) index->fMCUsPerRow * index->mcuRowCount();
+    if (index->fSegments.count() !=
+            (mcuCount + index->fRestartInterval - 1) / index->fRestartInterval) {
+        SkCodecPrintf("Restart markers do not match the image size.\n");
+        return nullptr;
+    }
+    return index;
+}
+
+int SkJpegRestartIndex::segmentForRow(int row) const {
+    SkASSERT(this->isRestartRow(row));
+    return SkToInt((int64_t) row * fMCUsPerRow / fRestartInterval);
+}
+
+bool SkJpegRestartIndex::isRestartRow(int row) const {
+    SkASSERT(0 <= row && row < this->mcuRowCount());
+    return 0 == ((int64_t) row * fMCUsPerRow) % fRestartInterval;
+}
+
+SkJpegRestartIndex::Strip SkJpegRestartIndex::makeStrip(int startRow, int endRow) const {
+    SkASSERT(startRow < endRow && endRow <= this->mcuRowCount());
+    Strip strip;
+    strip.fHeader = SkData::MakeWithCopy(fHeader.begin(), fHeader.count());
+    const int height = SkTMin(endRow * fMCUHeight, fHeight) - startRow * fMCUHeight;
+    uint8_t* header = static_cast<uint8_t*>(strip.fHeader->writable_data());
+    header[fHeightOffset + 0] = height >> 8;
+    header[fHeightOffset + 1] = height & 0xFF;
+
+    const size_t start = fSegments[this->segmentForRow(startRow)];
+    strip.fData = fData + start;
+    strip.fLength = fLength - start;
+    return strip;
+}
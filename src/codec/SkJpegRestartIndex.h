@@ -0,0 +1,106 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkJpegRestartIndex_DEFINED
+#define SkJpegRestartIndex_DEFINED
+
+#include "SkData.h"
+#include "SkRefCnt.h"
+#include "SkTDArray.h"
+
+#include <memory>
+
+/*
+ * Indexes the restart markers of a sequential jpeg.
+ *
+ * Restart markers reset the entropy decoder, so a run of MCU rows that begins right after one
+ * (a "restart row") can be decoded without the data that comes before it.  makeStrip() puts a
+ * copy of the image's tables in front of such a run to make a stand-alone jpeg, which
+ * libjpeg-turbo can decode on any thread, or use to seek.
+ *
+ * SkJpegCodec builds the index the first time it needs it, and keeps it.
+ */
+class SkJpegRestartIndex {
+public:
+    /*
+     * Returns nullptr unless data holds a complete baseline or extended sequential jpeg with a
+     * single scan of all of its components, and a restart interval.
+     *
+     * Does not copy the data, which must outlive the index.
+     */
+    static std::unique_ptr<SkJpegRestartIndex> Make(const void* data, size_t length);
+
+    int width() const { return fWidth; }
+    int height() const { return fHeight; }
+
+    /*
+     * The height of an MCU row in encoded pixels.  Always a multiple of 8.
+     */
+    int mcuHeight() const { return fMCUHeight; }
+    int mcuRowCount() const { return (fHeight + fMCUHeight - 1) / fMCUHeight; }
+
+    /*
+     * True if a component is subsampled vertically.  libjpeg-turbo's upsampling then reads the
+     * rows on either side of each MCU row, so a strip only decodes its edge rows exactly as the
+     * whole image would if it includes the neighbouring MCU rows as well.
+     */
+    bool needsContextRows() const { return fNeedsContextRows; }
+
+    /*
+     * Roughly how many MCU rows lie between one restart row and the next.
+     */
+    int rowsPerRestart() const {
+        return (fRestartInterval + fMCUsPerRow - 1) / fMCUsPerRow;
+    }
+
+    /*
+     * True if a strip may start at this MCU row.  Row 0 always qualifies.
+     */
+    bool isRestartRow(int row) const;
+
+    struct Strip {
+        // A copy of the image's header, with the height of the strip.
+        sk_sp<SkData> fHeader;
+        // The image's own entropy-coded data, starting at the strip.  It runs on to the end of
+        // the image, and its restart markers keep their original numbers, so decode it with
+        // a JpegDecoderMgr made for strips.
+        const void*   fData;
+        size_t        fLength;
+    };
+
+    /*
+     * Returns a stand-alone jpeg holding MCU rows [startRow, endRow).  startRow must be a restart
+     * row.  Copies only the header.
+     */
+    Strip makeStrip(int startRow, int endRow) const;
+
+private:
+    SkJpegRestartIndex(const uint8_t* data, size_t length) : fData(data), fLength(length) {}
+
+    int segmentForRow(int row) const;
+
+    const uint8_t*  fData;
+    const size_t    fLength;
+
+    // All of the image's marker segments from SOI up to and including SOS, less any application
+    // data (besides the JFIF and Adobe markers, which affect color conversion) and comments.
+    SkTDArray<uint8_t> fHeader;
+    size_t             fHeightOffset = 0;
+
+    int fWidth = 0;
+    int fHeight = 0;
+    int fMCUHeight = 0;
+    int fMCUsPerRow = 0;
+    int fRestartInterval = 0;
+    bool fNeedsContextRows = false;
+
+    // Offsets into fData of the start of each restart interval's entropy-coded data.  The restart
+    // marker before interval i (for i > 0) is the two bytes before fSegments[i].
+    SkTDArray<size_t> fSegments;
+};
+
+#endif
@@ -8,6 +8,7 @@
 #include "SkJpegUtility.h"
 
 #include "SkCodecPriv.h"
+#include "SkTo.h"
 
 /*
  * Call longjmp to continue execution on an error
@@ -117,12 +118,74 @@ static boolean sk_fill_mem_input_buffer (j_decompress_ptr cinfo) {
     return false;
 }
 
+// Functions for split sources //
+
+/*
+ * Move on from the header to the entropy-coded data, once
+ */
+static boolean sk_fill_split_input_buffer(j_decompress_ptr dinfo) {
+    skjpeg_source_mgr* src = (skjpeg_source_mgr*) dinfo->src;
+    if (!src->fData) {
+        return false;
+    }
+
+    src->next_input_byte = static_cast<const JOCTET*>(src->fData);
+    src->bytes_in_buffer = src->fLength;
+    src->fData = nullptr;
+    return true;
+}
+
+static void sk_skip_split_input_data(j_decompress_ptr dinfo, long numBytes) {
+    skjpeg_source_mgr* src = (skjpeg_source_mgr*) dinfo->src;
+    size_t bytes = static_cast<size_t>(numBytes);
+    if (bytes > src->bytes_in_buffer && src->fData) {
+        bytes -= src->bytes_in_buffer;
+        sk_fill_split_input_buffer(dinfo);
+    }
+    sk_skip_mem_input_data(dinfo, static_cast<long>(bytes));
+}
+
+/*
+ * The entropy-coded data may start at any restart interval, so its markers need not count up
+ * from RST0.  Accept whichever one comes next.
+ */
+static boolean sk_split_resync_to_restart(j_decompress_ptr dinfo, int desired) {
+    if (JPEG_RST0 <= dinfo->unread_marker && dinfo->unread_marker <= JPEG_RST0 + 7) {
+        dinfo->unread_marker = 0;
+        return true;
+    }
+    return jpeg_resync_to_restart(dinfo, desired);
+}
+
+// Functions for suspending sources //
+
+/*
+ * Tell libjpeg to suspend.  readAvailableData() adds any new data before it resumes.
+ */
+static boolean sk_fill_suspending_input_buffer(j_decompress_ptr dinfo) {
+    return false;
+}
+
+static void sk_skip_suspending_input_data(j_decompress_ptr dinfo, long numBytes) {
+    skjpeg_source_mgr* src = (skjpeg_source_mgr*) dinfo->src;
+    size_t bytes = static_cast<size_t>(numBytes);
+    if (bytes > src->bytes_in_buffer) {
+        src->fBytesToSkip += bytes - src->bytes_in_buffer;
+        bytes = src->bytes_in_buffer;
+    }
+    src->next_input_byte += bytes;
+    src->bytes_in_buffer -= bytes;
+}
+
 /*
  * Constructor for the source manager that we provide to libjpeg
  * We provide skia implementations of all of the stream processing functions required by libjpeg
  */
 skjpeg_source_mgr::skjpeg_source_mgr(SkStream* stream)
     : fStream(stream)
+    , fData(nullptr)
+    , fLength(0)
+    , fBytesToSkip(0)
 {
     if (stream->hasLength() && stream->getMemoryBase()) {
         init_source = sk_init_mem_source;
@@ -140,3 +203,48 @@ skjpeg_source_mgr::skjpeg_source_mgr(SkStream* stream)
         term_source = sk_term_source;
     }
 }
+
+skjpeg_source_mgr::skjpeg_source_mgr(sk_sp<SkData> header, const void* data, size_t length)
+    : fStream(nullptr)
+    , fHeader(std::move(header))
+    , fData(data)
+    , fLength(length)
+    , fBytesToSkip(0)
+{
+    init_source = sk_init_mem_source;
+    fill_input_buffer = sk_fill_split_input_buffer;
+    skip_input_data = sk_skip_split_input_data;
+    resync_to_restart = sk_split_resync_to_restart;
+    term_source = sk_term_source;
+    bytes_in_buffer = fHeader->size();
+    next_input_byte = fHeader->bytes();
+}
+
+void skjpeg_source_mgr::readAvailableData() {
+    if (!fStream || sk_fill_mem_input_buffer == fill_input_buffer) {
+        return;
+    }
+
+    if (sk_fill_suspending_input_buffer != fill_input_buffer) {
+        // Keep what is left of the last buffer read.
+        fSuspendedData.append(SkToInt(bytes_in_buffer), next_input_byte);
+        fill_input_buffer = sk_fill_suspending_input_buffer;
+        skip_input_data = sk_skip_suspending_input_data;
+    } else {
+        // libjpeg only moves next_input_byte past data that it is finished with.
+        fSuspendedData.remove(0, SkToInt(next_input_byte - fSuspendedData.begin()));
+    }
+
+    while (true) {
+        size_t bytes = fStream->read(fBuffer, kBufferSize);
+        if (0 == bytes) {
+            break;
+        }
+        const size_t skip = SkTMin(fBytesToSkip, bytes);
+        fBytesToSkip -= skip;
+        fSuspendedData.append(SkToInt(bytes - skip), fBuffer + skip);
+    }
+
+    next_input_byte = fSuspendedData.begin();
+    bytes_in_buffer = fSuspendedData.count();
+}
@@ -9,8 +9,10 @@
 #ifndef SkJpegUtility_codec_DEFINED
 #define SkJpegUtility_codec_DEFINED
 
+#include "SkData.h"
 #include "SkJpegPriv.h"
 #include "SkStream.h"
+#include "SkTDArray.h"
 
 #include <setjmp.h>
 // stdio is needed for jpeglib
@@ -32,13 +34,36 @@ void skjpeg_err_exit(j_common_ptr cinfo);
 struct skjpeg_source_mgr : jpeg_source_mgr {
     skjpeg_source_mgr(SkStream* stream);
 
+    /*
+     * Reads a jpeg in two pieces: a header, and then a run of entropy-coded data whose restart
+     * markers may be numbered from anywhere.  Used to decode strips made by SkJpegRestartIndex.
+     * Does not copy data, which must outlive the source manager.
+     */
+    skjpeg_source_mgr(sk_sp<SkData> header, const void* data, size_t length);
+
+    /*
+     * For incremental decoding.  The first call switches a buffered source to suspend libjpeg
+     * when the stream runs dry, rather than to fail, and to hold on to the bytes that libjpeg
+     * has not consumed so it can resume.  Every call then adds whatever the stream now has.
+     * A memory backed source already has all of its data, so this does nothing.
+     */
+    void readAvailableData();
+
     SkStream* fStream; // unowned
+
+    sk_sp<SkData> fHeader;
+    const void*   fData;
+    size_t        fLength;
     enum {
         // TODO (msarett): Experiment with different buffer sizes.
         // This size was chosen because it matches SkImageDecoder.
         kBufferSize = 1024
     };
     uint8_t fBuffer[kBufferSize];
+
+    // Unconsumed data, and data still to skip, once readAvailableData() has been called.
+    SkTDArray<uint8_t> fSuspendedData;
+    size_t             fBytesToSkip;
 };
 
 #endif
@@ -133,16 +133,32 @@ static inline bool is_chunk(const png_byte* chunk, const char* tag) {
     return memcmp(chunk + 4, tag, 4) == 0;
 }
 
+// Passes up to *bytesLeft bytes of the stream to libpng, counting them off before libpng sees
+// them (it may longjmp out), so that a later call can pick up where this one stopped.
+// Returns false if the stream ran out of data first.
 static inline bool process_data(png_structp png_ptr, png_infop info_ptr,
-        SkStream* stream, void* buffer, size_t bufferSize, size_t length) {
-    while (length > 0) {
-        const size_t bytesToProcess = std::min(bufferSize, length);
+        SkStream* stream, void* buffer, size_t bufferSize, size_t* bytesLeft) {
+    if (stream->getMemoryBase() && stream->hasPosition() && stream->hasLength()) {
+        // Hand libpng the stream's own memory. It only reads from it, and copies what it needs
+        // to keep. Move past the data first, as libpng may longjmp out before it returns.
+        const size_t streamLength = stream->getLength();
+        const size_t position = std::min(stream->getPosition(), streamLength);
+        const size_t bytes = std::min(*bytesLeft, streamLength - position);
+        const png_bytep data = (png_bytep) stream->getMemoryBase() + position;
+        stream->skip(bytes);
+        *bytesLeft -= bytes;
+        png_process_data(png_ptr, info_ptr, data, bytes);
+        return 0 == *bytesLeft;
+    }
+
+    while (*bytesLeft > 0) {
+        const size_t bytesToProcess = std::min(bufferSize, *bytesLeft);
         const size_t bytesRead = stream->read(buffer, bytesToProcess);
+        *bytesLeft -= bytesRead;
         png_process_data(png_ptr, info_ptr, (png_bytep) buffer, bytesRead);
         if (bytesRead < bytesToProcess) {
             return false;
         }
-        length -= bytesToProcess;
     }
     return true;
 }
@@ -186,7 +202,8 @@ bool AutoCleanPng::decodeBounds() {
 
         png_process_data(fPng_ptr, fInfo_ptr, chunk, 8);
         // Process the full chunk + CRC.
-        if (!process_data(fPng_ptr, fInfo_ptr, fStream, buffer, kBufferSize, length + 4)) {
+        size_t bytesLeft = length + 4;
+        if (!process_data(fPng_ptr, fInfo_ptr, fStream, buffer, kBufferSize, &bytesLeft)) {
             return false;
         }
     }
@@ -217,31 +234,37 @@ bool SkPngCodec::processData() {
 
     bool iend = false;
     while (true) {
-        size_t length;
-        if (fDecodedIdat) {
-            // Parse chunk length and type.
-            if (this->stream()->read(buffer, 8) < 8) {
-                break;
-            }
+        if (0 == fChunkBytesLeft) {
+            size_t length;
+            if (fDecodedIdat) {
+                // Parse chunk length and type. The stream may only have part of them so far.
+                fChunkHeaderLength += this->stream()->read(fChunkHeader + fChunkHeaderLength,
+                                                           8 - fChunkHeaderLength);
+                if (fChunkHeaderLength < 8) {
+                    break;
+                }
+                fChunkHeaderLength = 0;
+
+                png_process_data(fPng_ptr, fInfo_ptr, fChunkHeader, 8);
+                if (is_chunk(fChunkHeader, "IEND")) {
+                    iend = true;
+                }
 
-            png_byte* chunk = reinterpret_cast<png_byte*>(buffer);
-            png_process_data(fPng_ptr, fInfo_ptr, chunk, 8);
-            if (is_chunk(chunk, "IEND")) {
-                iend = true;
+                length = png_get_uint_32(fChunkHeader);
+            } else {
+                length = fIdatLength;
+                png_byte idat[] = {0, 0, 0, 0, 'I', 'D', 'A', 'T'};
+                png_save_uint_32(idat, length);
+                png_process_data(fPng_ptr, fInfo_ptr, idat, 8);
+                fDecodedIdat = true;
             }
 
-            length = png_get_uint_32(chunk);
-        } else {
-            length = fIdatLength;
-            png_byte idat[] = {0, 0, 0, 0, 'I', 'D', 'A', 'T'};
-            png_save_uint_32(idat, length);
-            png_process_data(fPng_ptr, fInfo_ptr, idat, 8);
-            fDecodedIdat = true;
+            // The full chunk + CRC.
+            fChunkBytesLeft = length + 4;
         }
 
-        // Process the full chunk + CRC.
-        if (!process_data(fPng_ptr, fInfo_ptr, this->stream(), buffer, kBufferSize, length + 4)
-                || iend) {
+        if (!process_data(fPng_ptr, fInfo_ptr, this->stream(), buffer, kBufferSize,
+                          &fChunkBytesLeft) || iend) {
             break;
         }
     }
@@ -617,6 +640,8 @@ public:
         , fLastRow(0)
         , fLinesDecoded(0)
         , fInterlacedComplete(false)
+        , fPassesComplete(0)
+        , fPreviewPasses(0)
         , fPng_rowbytes(0)
     {}
 
@@ -633,8 +658,13 @@ private:
     size_t                  fRowBytes;
     int                     fLinesDecoded;
     bool                    fInterlacedComplete;
+    // Passes that libpng has finished for rows [fFirstRow, fLastRow], and that the last preview
+    // showed.
+    int                     fPassesComplete;
+    int                     fPreviewPasses;
     size_t                  fPng_rowbytes;
     SkAutoTMalloc<png_byte> fInterlaceBuffer;
+    SkAutoTMalloc<png_byte> fPreviewRow;
 
     typedef SkPngCodec INHERITED;
 
@@ -642,6 +672,10 @@ private:
     // as expensive as the subset version of non-interlaced, but it still does extra
     // work.
     void interlacedRowCallback(png_bytep row, int rowNum, int pass) {
+        // Each pass visits the rows in order, so it is done with ours once it reaches fLastRow,
+        // or once the next pass begins.
+        fPassesComplete = SkTMax(fPassesComplete, rowNum >= fLastRow ? pass + 1 : pass);
+
         if (rowNum < fFirstRow || rowNum > fLastRow || fInterlacedComplete) {
             // Ignore this row
             return;
@@ -715,6 +749,21 @@ private:
     Result decode(int* rowsDecoded) override {
         const bool success = this->processData();
 
+        if (success && !fInterlacedComplete && this->options().fPreviewProc &&
+                fPassesComplete > fPreviewPasses && this->writePreview(fPassesComplete)) {
+            fPreviewPasses = fPassesComplete;
+            this->options().fPreviewProc(this->options().fPreviewContext, fPreviewPasses);
+        }
+
+        if (fPreviewPasses && !(success && fInterlacedComplete)) {
+            // The preview fills every row, and shows everything the rows so far would.
+            if (rowsDecoded) {
+                const int sampleY = this->swizzler() ? this->swizzler()->sampleY() : 1;
+                *rowsDecoded = get_scaled_dimension(fLastRow - fFirstRow + 1, sampleY);
+            }
+            return log_and_return_error(success);
+        }
+
         // Now apply Xforms on all the rows that were decoded.
         if (!fLinesDecoded) {
             if (rowsDecoded) {
@@ -757,6 +806,53 @@ private:
         fPng_rowbytes = png_get_rowbytes(this->png_ptr(), this->info_ptr());
         fInterlaceBuffer.reset(fPng_rowbytes * height);
         fInterlacedComplete = false;
+        fPassesComplete = 0;
+        fPreviewPasses = 0;
+    }
+
+    /*
+     *  Writes every output row from the pixels that the first 'passes' Adam7 passes decoded,
+     *  each one repeated over the block of pixels that later passes fill in.  Returns false if
+     *  no row in [fFirstRow, fLastRow] has been decoded yet.
+     */
+    bool writePreview(int passes) {
+        // After each pass, the decoded pixels are the ones whose coordinates are multiples of
+        // these.
+        static constexpr int kBlockWidths[]  = { 8, 4, 4, 2, 2, 1, 1 };
+        static constexpr int kBlockHeights[] = { 8, 8, 4, 4, 2, 2, 1 };
+        SkASSERT(0 < passes && passes <= 7);
+        const int blockWidth = kBlockWidths[passes - 1];
+        const int blockHeight = kBlockHeights[passes - 1];
+
+        const int firstDecodedRow = (fFirstRow + blockHeight - 1) / blockHeight * blockHeight;
+        if (firstDecodedRow > fLastRow) {
+            return false;
+        }
+
+        const int width = this->dimensions().width();
+        const size_t bytesPerPixel = fPng_rowbytes / width;
+        fPreviewRow.reset(fPng_rowbytes);
+
+        const int sampleY = this->swizzler() ? this->swizzler()->sampleY() : 1;
+        const int rowsNeeded = get_scaled_dimension(fLastRow - fFirstRow + 1, sampleY);
+        void* dst = fDst;
+        int previewRow = -1;
+        for (int i = 0; i < rowsNeeded; i++) {
+            const int y = fFirstRow + get_start_coord(sampleY) + i * sampleY;
+            const int srcY = SkTMax(y - y % blockHeight, firstDecodedRow);
+            if (srcY != previewRow) {
+                const png_byte* src = fInterlaceBuffer.get() + (srcY - fFirstRow) * fPng_rowbytes;
+                png_byte* row = fPreviewRow.get();
+                for (int x = 0; x < width; x++) {
+                    memcpy(row + x * bytesPerPixel, src + (x - x % blockWidth) * bytesPerPixel,
+                           bytesPerPixel);
+                }
+                previewRow = srcY;
+            }
+            this->applyXformRow(dst, fPreviewRow.get());
+            dst = SkTAddOffset<void>(dst, fRowBytes);
+        }
+        return true;
     }
 };
 
@@ -979,6 +1075,8 @@ SkPngCodec::SkPngCodec(SkEncodedInfo&& encodedInfo, std::unique_ptr<SkStream> st
     , fBitDepth(bitDepth)
     , fIdatLength(0)
     , fDecodedIdat(false)
+    , fChunkBytesLeft(0)
+    , fChunkHeaderLength(0)
 {}
 
 SkPngCodec::~SkPngCodec() {
@@ -1133,6 +1231,8 @@ bool SkPngCodec::onRewind() {
     fPng_ptr = png_ptr;
     fInfo_ptr = info_ptr;
     fDecodedIdat = false;
+    fChunkBytesLeft = 0;
+    fChunkHeaderLength = 0;
     return true;
 }
 
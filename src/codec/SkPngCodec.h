@@ -116,6 +116,12 @@ private:
     size_t                         fIdatLength;
     bool                           fDecodedIdat;
 
+    // Where processData() stopped when the stream ran out of data, so that it can resume in
+    // the middle of a chunk (or of a chunk's length and type) once there is more.
+    size_t                         fChunkBytesLeft;
+    uint8_t                        fChunkHeader[8];
+    size_t                         fChunkHeaderLength;
+
     typedef SkCodec INHERITED;
 };
 #endif  // SkPngCodec_DEFINED
@@ -108,6 +108,9 @@ private:
     // The second call to get() needs to only truly buffer the part that was
     // not already buffered.
     mutable size_t              fTrulyBuffered;
+    // If the stream is also in memory (e.g. a file mapped by SkData::MakeFromFileName), get()
+    // and getDataAtPosition() point into it instead of copying, and fTrulyBuffered stays 0.
+    const char*                 fMemoryBase;
     // Only used if !fHasLengthAndPosition. In that case, markPosition will
     // copy into an SkData, stored here.
     SkTHashMap<size_t, SkData*> fMarkedData;
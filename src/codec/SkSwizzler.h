@@ -12,6 +12,7 @@
 #include "SkColor.h"
 #include "SkImageInfo.h"
 #include "SkSampler.h"
+#include "SkTemplates.h"
 
 class SkSwizzler : public SkSampler {
 public:
@@ -120,11 +121,15 @@ private:
     const RowProc       fFastProc;
     // Always non-NULL.  Supports sampling.
     const RowProc       fSlowProc;
+    // May be NULL.  Copies the sampled pixels of a row so fFastProc can convert them.
+    const RowProc       fGatherProc;
     // The actual RowProc we are using.  This depends on if fFastProc is non-NULL and
     // whether or not we are sampling.
     RowProc             fActualProc;
 
     const SkPMColor*    fColorTable;      // Unowned pointer
+    // Non-NULL only while sampling with fGatherProc.  Holds the pixels it gathers.
+    SkAutoTMalloc<uint8_t> fSampledRow;
 
     // Subset Swizzles
     // There are two types of subset swizzles that we support.  We do not
@@ -210,8 +215,8 @@ private:
                                           //     fBPP is bitsPerPixel
     const int           fDstBPP;          // Bytes per pixel for the destination color type
 
-    SkSwizzler(RowProc fastProc, RowProc proc, const SkPMColor* ctable, int srcOffset,
-            int srcWidth, int dstOffset, int dstWidth, int srcBPP, int dstBPP);
+    SkSwizzler(RowProc fastProc, RowProc proc, RowProc gatherProc, const SkPMColor* ctable,
+            int srcOffset, int srcWidth, int dstOffset, int dstWidth, int srcBPP, int dstBPP);
     static std::unique_ptr<SkSwizzler> Make(const SkImageInfo& dstInfo, RowProc fastProc,
             RowProc proc, const SkPMColor* ctable, int srcBPP, int dstBPP,
             const SkCodec::Options& options, const SkIRect* frame);
@@ -568,6 +568,91 @@ SkCodec::Result SkWebpCodec::onGetPixels(const SkImageInfo& dstInfo, void* dst,
     return result;
 }
 
+bool SkWebpCodec::onQueryYUV8(SkYUVASizeInfo* sizeInfo, SkYUVColorSpace* colorSpace) const {
+    // Lossy VP8 data is natively 4:2:0 YUV.  Only offer it for opaque, still images, whose one
+    // frame covers the canvas; anything else needs to be composited in RGB.
+    if (SkEncodedInfo::kYUV_Color != this->getEncodedInfo().color() ||
+            (WebPDemuxGetI(fDemux.get(), WEBP_FF_FORMAT_FLAGS) & ANIMATION_FLAG)) {
+        return false;
+    }
+
+    const int width = this->dimensions().width(),
+              height = this->dimensions().height();
+    sizeInfo->fSizes[0].set(width, height);
+    sizeInfo->fSizes[1].set((width + 1) / 2, (height + 1) / 2);
+    sizeInfo->fSizes[2] = sizeInfo->fSizes[1];
+    for (int i = 0; i < 3; ++i) {
+        sizeInfo->fWidthBytes[i] = SkAlign8(sizeInfo->fSizes[i].width());
+    }
+
+    sizeInfo->fSizes[3].fHeight = sizeInfo->fSizes[3].fWidth = sizeInfo->fWidthBytes[3] = 0;
+
+    sizeInfo->fOrigin = this->getOrigin();
+
+    if (colorSpace) {
+        // VP8 uses the limited ("studio swing") range of Rec. 601.
+        *colorSpace = kRec601_SkYUVColorSpace;
+    }
+
+    return true;
+}
+
+SkCodec::Result SkWebpCodec::onGetYUV8Planes(const SkYUVASizeInfo& sizeInfo,
+                                             void* planes[SkYUVASizeInfo::kMaxCount]) {
+    SkYUVASizeInfo defaultInfo;
+    if (!this->onQueryYUV8(&defaultInfo, nullptr) ||
+            sizeInfo.fSizes[0] != defaultInfo.fSizes[0] ||
+            sizeInfo.fSizes[1] != defaultInfo.fSizes[1] ||
+            sizeInfo.fSizes[2] != defaultInfo.fSizes[2] ||
+            sizeInfo.fWidthBytes[0] < defaultInfo.fWidthBytes[0] ||
+            sizeInfo.fWidthBytes[1] < defaultInfo.fWidthBytes[1] ||
+            sizeInfo.fWidthBytes[2] < defaultInfo.fWidthBytes[2]) {
+        return kInvalidInput;
+    }
+
+    WebPDecoderConfig config;
+    if (0 == WebPInitDecoderConfig(&config)) {
+        return kInvalidInput;
+    }
+
+    // Free any memory associated with the buffer. Must be called last, so we declare it first.
+    SkAutoTCallVProc<WebPDecBuffer, WebPFreeDecBuffer> autoFree(&(config.output));
+
+    WebPIterator frame;
+    SkAutoTCallVProc<WebPIterator, WebPDemuxReleaseIterator> autoFrame(&frame);
+    if (!WebPDemuxGetFrame(fDemux, 1, &frame)) {
+        return kIncompleteInput;
+    }
+
+    // libwebp writes the planes directly, skipping its conversion to RGB.
+    config.output.colorspace = MODE_YUV;
+    config.output.is_external_memory = 1;
+    WebPYUVABuffer& yuva = config.output.u.YUVA;
+    yuva.y = static_cast<uint8_t*>(planes[0]);
+    yuva.u = static_cast<uint8_t*>(planes[1]);
+    yuva.v = static_cast<uint8_t*>(planes[2]);
+    yuva.y_stride = SkToInt(sizeInfo.fWidthBytes[0]);
+    yuva.u_stride = SkToInt(sizeInfo.fWidthBytes[1]);
+    yuva.v_stride = SkToInt(sizeInfo.fWidthBytes[2]);
+    yuva.y_size = sizeInfo.fWidthBytes[0] * sizeInfo.fSizes[0].height();
+    yuva.u_size = sizeInfo.fWidthBytes[1] * sizeInfo.fSizes[1].height();
+    yuva.v_size = sizeInfo.fWidthBytes[2] * sizeInfo.fSizes[2].height();
+
+    SkAutoTCallVProc<WebPIDecoder, WebPIDelete> idec(WebPIDecode(nullptr, 0, &config));
+    if (!idec) {
+        return kInvalidInput;
+    }
+
+    switch (WebPIUpdate(idec, frame.fragment.bytes, frame.fragment.size)) {
+        case VP8_STATUS_OK:
+            return kSuccess;
+        case VP8_STATUS_SUSPENDED:
+            return kIncompleteInput;
+        default:
+            return kInvalidInput;
+    }
+}
+
 SkWebpCodec::SkWebpCodec(SkEncodedInfo&& info, std::unique_ptr<SkStream> stream,
                          WebPDemuxer* demux, sk_sp<SkData> data, SkEncodedOrigin origin)
     : INHERITED(std::move(info), skcms_PixelFormat_BGRA_8888, std::move(stream),
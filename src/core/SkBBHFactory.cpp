@@ -6,11 +6,16 @@
  */
 
 #include "SkBBHFactory.h"
+#include "SkPackedRTree.h"
 #include "SkRect.h"
 #include "SkRTree.h"
 #include "SkScalar.h"
 
 SkBBoxHierarchy* SkRTreeFactory::operator()(const SkRect& bounds) const {
     SkScalar aspectRatio = bounds.width() / bounds.height();
-    return new SkRTree(aspectRatio);
+    return new SkRTree(aspectRatio, this->executor());
+}
+
+SkBBoxHierarchy* SkPackedRTreeFactory::operator()(const SkRect&) const {
+    return new SkPackedRTree;
 }
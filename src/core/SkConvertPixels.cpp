@@ -12,7 +12,10 @@
 #include "SkHalf.h"
 #include "SkImageInfoPriv.h"
 #include "SkOpts.h"
+#include "SkPixmap.h"
 #include "SkRasterPipeline.h"
+#include "SkTo.h"
+#include "SkYUVASizeInfo.h"
 
 static bool rect_memcpy(const SkImageInfo& dstInfo,       void* dstPixels, size_t dstRB,
                         const SkImageInfo& srcInfo, const void* srcPixels, size_t srcRB,
@@ -193,3 +196,81 @@ void SkConvertPixels(const SkImageInfo& dstInfo,       void* dstPixels, size_t d
     }
     convert_with_pipeline(dstInfo, dstPixels, dstRB, srcInfo, srcPixels, srcRB, steps);
 }
+
+// Returns log2 of how many samples of a plane of size full each sample of one of size sub covers.
+static int subsampling_shift(int full, int sub) {
+    for (int shift = 0; shift <= 2; shift++) {
+        if (sub == ((full + (1 << shift) - 1) >> shift)) {
+            return shift;
+        }
+    }
+    return -1;
+}
+
+// Each converts (Y,U,V) in r,g,b to (R,G,B), for matrix_3x4: the Y, U, and V columns, then the
+// offsets, which account for the range of Y and the center of U and V (128/255).
+static const float kJPEG_YUVToRGB[] = {
+    1.0f,       1.0f,       1.0f,
+    0.0f,      -0.344136f,  1.772f,
+    1.402f,    -0.714136f,  0.0f,
+   -0.703749f,  0.531211f, -0.889475f,
+};
+static const float kRec601_YUVToRGB[] = {
+    1.164383f,  1.164383f,  1.164383f,
+    0.0f,      -0.391762f,  2.017232f,
+    1.596027f, -0.812968f,  0.0f,
+   -0.874202f,  0.531668f, -1.085631f,
+};
+static const float kRec709_YUVToRGB[] = {
+    1.164383f,  1.164383f,  1.164383f,
+    0.0f,      -0.213249f,  2.112402f,
+    1.792741f, -0.532909f,  0.0f,
+   -0.972945f,  0.301483f, -1.133402f,
+};
+
+bool SkConvertYUVPixels(const SkPixmap& dst, const SkYUVASizeInfo& sizeInfo,
+                        const void* const planes[3], SkYUVColorSpace colorSpace) {
+    const SkISize& ySize = sizeInfo.fSizes[0];
+    const SkISize& uvSize = sizeInfo.fSizes[1];
+    if (dst.width() != ySize.width() || dst.height() != ySize.height() ||
+            sizeInfo.fSizes[2] != uvSize || !planes[0] || !planes[1] || !planes[2]) {
+        return false;
+    }
+    const int shiftX = subsampling_shift(ySize.width(), uvSize.width()),
+              shiftY = subsampling_shift(ySize.height(), uvSize.height());
+    if (shiftX < 0 || shiftY < 0) {
+        return false;
+    }
+
+    SkRasterPipeline_YUVCtx yuv;
+    yuv.y = { const_cast<void*>(planes[0]), SkToInt(sizeInfo.fWidthBytes[0]) };
+    yuv.u = { const_cast<void*>(planes[1]), SkToInt(sizeInfo.fWidthBytes[1]) };
+    yuv.v = { const_cast<void*>(planes[2]), SkToInt(sizeInfo.fWidthBytes[2]) };
+    yuv.uvScaleX = 1.0f / (1 << shiftX);
+    yuv.uvWidth = uvSize.width();
+    yuv.uvShiftY = shiftY;
+
+    SkRasterPipeline_MemoryCtx dstCtx = { dst.writable_addr(),
+                                          (int)(dst.rowBytes() / dst.info().bytesPerPixel()) };
+
+    SkRasterPipeline_<256> pipeline;
+    pipeline.append(SkRasterPipeline::load_yuv, &yuv);
+    switch (colorSpace) {
+        case kJPEG_SkYUVColorSpace:
+            pipeline.append(SkRasterPipeline::matrix_3x4, kJPEG_YUVToRGB);
+            break;
+        case kRec601_SkYUVColorSpace:
+            pipeline.append(SkRasterPipeline::matrix_3x4, kRec601_YUVToRGB);
+            break;
+        case kRec709_SkYUVColorSpace:
+            pipeline.append(SkRasterPipeline::matrix_3x4, kRec709_YUVToRGB);
+            break;
+        case kIdentity_SkYUVColorSpace:
+            break;
+    }
+    pipeline.append(SkRasterPipeline::clamp_0);
+    pipeline.append(SkRasterPipeline::clamp_1);
+    pipeline.append_store(dst.colorType(), &dstCtx);
+    pipeline.run(0,0, dst.width(), dst.height());
+    return true;
+}
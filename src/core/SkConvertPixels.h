@@ -12,10 +12,22 @@
 #include "SkTemplates.h"
 
 class SkColorTable;
+class SkPixmap;
+struct SkYUVASizeInfo;
 
 void SkConvertPixels(const SkImageInfo& dstInfo, void* dstPixels, size_t dstRowBytes,
                      const SkImageInfo& srcInfo, const void* srcPixels, size_t srcRowBytes);
 
+/**
+ *  Converts the 8-bit Y, U, and V planes described by sizeInfo, like those from
+ *  SkCodec::getYUV8Planes(), to opaque dst pixels of the same size as the Y plane.  No color space
+ *  conversion is done, and sizeInfo.fOrigin is ignored.
+ *
+ *  Returns false if U and V differ in size, or are not subsampled from Y by 1, 2, or 4.
+ */
+bool SkConvertYUVPixels(const SkPixmap& dst, const SkYUVASizeInfo& sizeInfo,
+                        const void* const planes[3], SkYUVColorSpace colorSpace);
+
 static inline void SkRectMemcpy(void* dst, size_t dstRB, const void* src, size_t srcRB,
                                 size_t trimRowBytes, int rowCount) {
     SkASSERT(trimRowBytes <= dstRB);
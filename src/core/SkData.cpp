@@ -6,6 +6,7 @@
  */
 
 #include "SkData.h"
+#include "SkDataPriv.h"
 #include "SkOSFile.h"
 #include "SkOnce.h"
 #include "SkReadBuffer.h"
@@ -119,6 +120,10 @@ static void sk_mmap_releaseproc(const void* addr, void* ctx) {
     sk_fmunmap(addr, length);
 }
 
+bool SkDataPriv::IsFileMapping(const SkData& data) {
+    return data.fReleaseProc == sk_mmap_releaseproc;
+}
+
 sk_sp<SkData> SkData::MakeFromFILE(FILE* f) {
     size_t size;
     void* addr = sk_fmmap(f, &size);
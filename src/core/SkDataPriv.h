@@ -0,0 +1,21 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkDataPriv_DEFINED
+#define SkDataPriv_DEFINED
+
+#include "SkData.h"
+
+class SkDataPriv {
+public:
+    /** Returns true if the data is a file mapped by sk_fmmap or sk_fdmmap, i.e. it was made by
+     *  SkData::MakeFromFILE, MakeFromFileName or MakeFromFD.
+     */
+    static bool IsFileMapping(const SkData& data);
+};
+
+#endif
@@ -26,6 +26,7 @@ class SkMatrix;
 class SkPath;
 class SkRegion;
 class SkRasterClip;
+struct SkDAARecord;
 struct SkRect;
 class SkRRect;
 
@@ -134,7 +135,8 @@ private:
                   const SkMatrix* preMatrix,
                   bool pathIsMutable,
                   bool drawCoverage,
-                  SkBlitter* customBlitter = nullptr) const;
+                  SkBlitter* customBlitter = nullptr,
+                  SkDAARecord* daaRecord = nullptr) const;
 
     void drawLine(const SkPoint[2], const SkPaint&) const;
 
@@ -142,7 +144,8 @@ private:
                      const SkPaint& paint,
                      bool drawCoverage,
                      SkBlitter* customBlitter,
-                     bool doFill) const;
+                     bool doFill,
+                     SkDAARecord* daaRecord = nullptr) const;
     /**
      *  Return the current clip bounds, in local coordinates, with slop to account
      *  for antialiasing or hairlines (i.e. device-bounds outset by 1, and then
@@ -153,6 +156,8 @@ private:
      */
     bool SK_WARN_UNUSED_RESULT computeConservativeLocalClipBounds(SkRect* bounds) const;
 
+    friend class SkThreadedBMPDevice;   // records DAA coverage once, then blits it per tile
+
 public:
     SkPixmap        fDst;
     const SkMatrix* fMatrix{nullptr};        // required
@@ -11,6 +11,7 @@
 #include "SkSemaphore.h"
 #include "SkSpinlock.h"
 #include "SkTArray.h"
+#include <atomic>
 #include <deque>
 #include <thread>
 
@@ -131,6 +132,134 @@ private:
     SkSemaphore           fWorkAvailable;
 };
 
+// An SkWorkStealingThreadPool gives each of its threads its own deque of work.
+// Work added from a pool thread goes onto that thread's own deque; work added from elsewhere is
+// dealt out round-robin.  Each thread pops its own deque LIFO, and when that runs dry, steals
+// FIFO from the other deques, starting at a random victim.  Each deque has its own lock, so
+// unlike SkThreadPool, threads adding and doing work rarely contend with each other.
+class SkWorkStealingThreadPool final : public SkExecutor {
+public:
+    explicit SkWorkStealingThreadPool(int threads) : fQueues(new Queue[threads]), fCount(threads) {
+        for (int i = 0; i < threads; i++) {
+            fThreads.emplace_back(&Loop, this, i);
+        }
+    }
+
+    ~SkWorkStealingThreadPool() override {
+        // Signal each thread that it's time to shut down.
+        for (int i = 0; i < fThreads.count(); i++) {
+            this->add(nullptr);
+        }
+        // Wait for each thread to shut down.
+        for (int i = 0; i < fThreads.count(); i++) {
+            fThreads[i].join();
+        }
+    }
+
+    void add(std::function<void(void)> work) override {
+        int index = this->currentThreadIndex();
+        if (index < 0) {
+            index = (int)(fNextQueue.fetch_add(1, std::memory_order_relaxed) % (unsigned)fCount);
+        }
+        {
+            Queue& queue = fQueues[index];
+            SkAutoExclusive lock(queue.fLock);
+            queue.fWork.emplace_back(std::move(work));
+        }
+        fWorkAvailable.signal(1);
+    }
+
+    void borrow() override {
+        // If there is work waiting, do it, preferring work from this thread's own deque.
+        if (fWorkAvailable.try_wait()) {
+            SkAssertResult(this->do_work(this->currentThreadIndex()));
+        }
+    }
+
+private:
+    struct Queue {
+        SkSpinlock                            fLock;
+        std::deque<std::function<void(void)>> fWork;
+        char                                  fPad[64];  // Keep neighboring locks apart.
+    };
+
+    // Which of our threads is calling, or -1 if it's not one of ours.
+    int currentThreadIndex() const {
+        return gCurrentPool == this ? gCurrentIndex : -1;
+    }
+
+    bool pop_own(int index, std::function<void(void)>* work) {
+        Queue& queue = fQueues[index];
+        SkAutoExclusive lock(queue.fLock);
+        if (queue.fWork.empty()) {
+            return false;
+        }
+        *work = std::move(queue.fWork.back());
+        queue.fWork.pop_back();
+        return true;
+    }
+
+    bool steal(int victim, std::function<void(void)>* work) {
+        Queue& queue = fQueues[victim];
+        // Don't wait around for a busy victim; there are plenty of other deques to try.
+        if (!queue.fLock.tryAcquire()) {
+            return false;
+        }
+        bool stole = false;
+        if (!queue.fWork.empty()) {
+            *work = std::move(queue.fWork.front());
+            queue.fWork.pop_front();
+            stole = true;
+        }
+        queue.fLock.release();
+        return stole;
+    }
+
+    // This method should be called only when fWorkAvailable indicates there's work to do.
+    bool do_work(int index) {
+        std::function<void(void)> work;
+        if (index < 0 || !this->pop_own(index, &work)) {
+            // Each successful wait() on fWorkAvailable is matched by exactly one queued piece of
+            // work, so this loop will find something, though perhaps not on the first pass.
+            gStealSeed = gStealSeed * 1664525 + 1013904223;
+            int victim = (int)((gStealSeed >> 16) % (unsigned)fCount);
+            while (!this->steal(victim, &work)) {
+                victim = (victim + 1) % fCount;
+            }
+        }
+
+        if (!work) {
+            return false;  // This is Loop()'s signal to shut down.
+        }
+
+        work();
+        return true;
+    }
+
+    static void Loop(SkWorkStealingThreadPool* pool, int index) {
+        gCurrentPool  = pool;
+        gCurrentIndex = index;
+        gStealSeed    = index;
+        do {
+            pool->fWorkAvailable.wait();
+        } while (pool->do_work(index));
+    }
+
+    static thread_local const SkWorkStealingThreadPool* gCurrentPool;
+    static thread_local int                             gCurrentIndex;
+    static thread_local uint32_t                        gStealSeed;
+
+    SkTArray<std::thread>    fThreads;
+    std::unique_ptr<Queue[]> fQueues;
+    const int                fCount;
+    std::atomic<unsigned>    fNextQueue{0};
+    SkSemaphore              fWorkAvailable;
+};
+
+thread_local const SkWorkStealingThreadPool* SkWorkStealingThreadPool::gCurrentPool  = nullptr;
+thread_local int                             SkWorkStealingThreadPool::gCurrentIndex = -1;
+thread_local uint32_t                        SkWorkStealingThreadPool::gStealSeed    = 0;
+
 std::unique_ptr<SkExecutor> SkExecutor::MakeFIFOThreadPool(int threads) {
     using WorkList = std::deque<std::function<void(void)>>;
     return skstd::make_unique<SkThreadPool<WorkList>>(threads > 0 ? threads : num_cores());
@@ -139,3 +268,6 @@ std::unique_ptr<SkExecutor> SkExecutor::MakeLIFOThreadPool(int threads) {
     using WorkList = SkTArray<std::function<void(void)>>;
     return skstd::make_unique<SkThreadPool<WorkList>>(threads > 0 ? threads : num_cores());
 }
+std::unique_ptr<SkExecutor> SkExecutor::MakeWorkStealingThreadPool(int threads) {
+    return skstd::make_unique<SkWorkStealingThreadPool>(threads > 0 ? threads : num_cores());
+}
@@ -217,14 +217,15 @@ void SkGlyphRunListPainter::drawForBitmapDevice(
                     SkSpan<const SkPathPos>{pathsAndPositions.begin(), pathsAndPositions.size()},
                     textScale, pathPaint);
         } else {
-            auto cache = SkStrikeCache::FindOrCreateStrikeExclusive(
+            // Share the strike, so threads drawing the same text don't wait on each other.
+            auto cache = SkStrikeCache::FindOrCreateStrikeShared(
                                         runFont, runPaint, props,
                                         fScalerContextFlags, deviceMatrix);
 
             // Add rounding and origin.
             SkMatrix matrix = deviceMatrix;
             matrix.preTranslate(origin.x(), origin.y());
-            SkPoint rounding = cache->rounding();
+            SkPoint rounding = cache.rounding();
             matrix.postTranslate(rounding.x(), rounding.y());
             matrix.mapPoints(fPositions, glyphRun.positions().data(), runSize);
 
@@ -234,10 +235,10 @@ void SkGlyphRunListPainter::drawForBitmapDevice(
             for (auto glyphID : glyphRun.glyphsIDs()) {
                 auto position = *positionCursor++;
                 if (check_glyph_position(position)) {
-                    const SkGlyph& glyph = cache->getGlyphMetrics(glyphID, position);
-                    const void* image;
-                    if (!glyph.isEmpty() && (image = cache->findImage(glyph))) {
-                        masks.push_back(create_mask(glyph, position, image));
+                    // Shared glyphs come with their images already found.
+                    const SkGlyph& glyph = cache.getGlyphMetrics(glyphID, position);
+                    if (!glyph.isEmpty() && glyph.fImage != nullptr) {
+                        masks.push_back(create_mask(glyph, position, glyph.fImage));
                     }
                 }
             }
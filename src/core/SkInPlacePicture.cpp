@@ -0,0 +1,53 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkInPlacePicture.h"
+
+#include "SkCanvas.h"
+#include "SkPictureData.h"
+#include "SkPicturePlayback.h"
+#include "SkRTree.h"
+#include "SkTextBlob.h"
+
+SkInPlacePicture::SkInPlacePicture(const SkRect& cull, std::unique_ptr<SkPictureData> data)
+    : fCullRect(cull)
+    , fData(std::move(data)) {}
+
+SkInPlacePicture::~SkInPlacePicture() {}
+
+void SkInPlacePicture::playback(SkCanvas* canvas, AbortCallback* callback) const {
+    fPrepareOnce([this] {
+        fPrepared = fData->prepareForPlayback();
+        if (fPrepared && fData->opIndexCount() > 0) {
+            fBBH = sk_make_sp<SkRTree>();
+            fBBH->insert(fData->opIndexBounds(), fData->opIndexCount());
+        }
+    });
+    if (!fPrepared) {
+        return;
+    }
+
+    SkPicturePlayback playback(fData.get());
+    // If the query contains the whole picture, don't bother with the BBH.
+    const SkRect query = canvas->getLocalClipBounds();
+    if (fBBH && !query.contains(fCullRect)) {
+        SkTDArray<int> ops;
+        fBBH->search(query, &ops);
+        playback.draw(canvas, callback, fData->opIndexOffsets(), ops);
+    } else {
+        playback.draw(canvas, callback, nullptr);
+    }
+}
+
+int SkInPlacePicture::approximateOpCount() const {
+    fOpCountOnce([this] { fOpCount = SkPicturePlayback::FindOps(*fData->opData(), nullptr); });
+    return fOpCount;
+}
+
+size_t SkInPlacePicture::approximateBytesUsed() const {
+    return sizeof(*this) + sizeof(SkPictureData) + fData->opData()->size();
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkInPlacePicture_DEFINED
+#define SkInPlacePicture_DEFINED
+
+#include "SkBBoxHierarchy.h"
+#include "SkOnce.h"
+#include "SkPicture.h"
+#include "SkRect.h"
+
+#include <memory>
+
+class SkPictureData;
+
+// An SkPicture that plays back serialized SkPictureData as it lies, rather than recording it again
+// into an SkRecord.  See SkPicture::MakeFromDataInPlace().
+//
+// If the data has an op index, playback skips the ops outside the canvas's clip, as SkBigPicture
+// does with its BBH, without reading them, and parses each paint, path, image, and so on only when
+// an op that uses it is drawn.
+class SkInPlacePicture final : public SkPicture {
+public:
+    SkInPlacePicture(const SkRect& cull, std::unique_ptr<SkPictureData>);
+    ~SkInPlacePicture() override;
+
+// SkPicture overrides
+    void playback(SkCanvas*, AbortCallback*) const override;
+    SkRect cullRect() const override { return fCullRect; }
+    int approximateOpCount() const override;
+    size_t approximateBytesUsed() const override;
+
+private:
+    const SkRect                         fCullRect;
+    const std::unique_ptr<SkPictureData> fData;
+
+    // The first playback parses what fData deferred, and bulk loads fBBH from its op index.
+    mutable SkOnce                 fPrepareOnce;
+    mutable bool                   fPrepared = false;
+    mutable sk_sp<SkBBoxHierarchy> fBBH;
+
+    mutable SkOnce fOpCountOnce;
+    mutable int    fOpCount = 0;
+};
+
+#endif//SkInPlacePicture_DEFINED
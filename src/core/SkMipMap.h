@@ -17,6 +17,7 @@
 
 class SkBitmap;
 class SkDiscardableMemory;
+class SkExecutor;
 
 typedef SkDiscardableMemory* (*SkDiscardableFactoryProc)(size_t bytes);
 
@@ -29,8 +30,12 @@ typedef SkDiscardableMemory* (*SkDiscardableFactoryProc)(size_t bytes);
  */
 class SkMipMap : public SkCachedData {
 public:
-    static SkMipMap* Build(const SkPixmap& src, SkDiscardableFactoryProc);
-    static SkMipMap* Build(const SkBitmap& src, SkDiscardableFactoryProc);
+    // If an executor is given, large levels are split into bands of rows which are built in
+    // parallel on it. The result is the same either way.
+    static SkMipMap* Build(const SkPixmap& src, SkDiscardableFactoryProc,
+                           SkExecutor* = nullptr);
+    static SkMipMap* Build(const SkBitmap& src, SkDiscardableFactoryProc,
+                           SkExecutor* = nullptr);
 
     // Determines how many levels a SkMipMap will have without creating that mipmap.
     // This does not include the base mipmap level that the user provided when
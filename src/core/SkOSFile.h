@@ -49,6 +49,11 @@ void*   sk_fdmmap(int fd, size_t* length);
  */
 void    sk_fmunmap(const void* addr, size_t length);
 
+/** Hints that a mapping from sk_fmmap or sk_fdmmap (or any range within one) is about to be read
+ *  from start to end, so the OS may read ahead. Does nothing where that is not supported.
+ */
+void    sk_fmmap_will_read(const void* addr, size_t length);
+
 /** Returns true if the two point at the exact same filesystem object. */
 bool    sk_fidentical(FILE* a, FILE* b);
 
@@ -41,7 +41,14 @@ namespace SkOpts {
                            RGB_to_BGR1,     // i.e. swap RB and insert an opaque alpha
                            gray_to_RGB1,    // i.e. expand to color channels + an opaque alpha
                            grayA_to_RGBA,   // i.e. expand to color channels
-                           grayA_to_rgbA;   // i.e. expand to color channels and premultiply
+                           grayA_to_rgbA,   // i.e. expand to color channels and premultiply
+                           RGB16_to_RGB1,   // i.e. keep 8 of 16 bits and insert an opaque alpha
+                           RGB16_to_BGR1,   // i.e. keep 8 of 16 bits, swap RB, insert opaque alpha
+                           RGBA16_to_RGBA,  // i.e. keep 8 of 16 bits
+                           RGBA16_to_BGRA;  // i.e. keep 8 of 16 bits and swap RB
+
+    // Look up 8-bit indices in a table of colors.
+    extern void (*index_to_8888)(uint32_t*, const uint8_t*, int, const uint32_t ctable[]);
 
     extern void (*memset16)(uint16_t[], uint16_t, int);
     extern void SK_API (*memset32)(uint32_t[], uint32_t, int);
@@ -68,6 +75,11 @@ namespace SkOpts {
     extern void (*start_pipeline_highp)(size_t,size_t,size_t,size_t, void**);
     extern void (*start_pipeline_lowp )(size_t,size_t,size_t,size_t, void**);
 #undef M
+
+#define M(fused, ...) +1
+    extern StageFn fused_stages_highp[SK_RASTER_PIPELINE_FUSED_STAGES(M)];
+    extern StageFn fused_stages_lowp [SK_RASTER_PIPELINE_FUSED_STAGES(M)];
+#undef M
 }
 
 #endif//SkOpts_DEFINED
@@ -0,0 +1,164 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkPackedRTree.h"
+
+#include "SkNx.h"
+#include "SkTArray.h"
+
+SkPackedRTree::SkPackedRTree() : fDepth(0), fRootBounds(SkRect::MakeEmpty()), fFirstLeaf(0) {}
+
+SkRect SkPackedRTree::getRootBound() const {
+    return fRootBounds;
+}
+
+void SkPackedRTree::insert(const SkRect boundsArray[], int N) {
+    SkASSERT(fOps.isEmpty());
+
+    // The bounds of the items on the level being built: first the rects, then the nodes below.
+    SkTDArray<SkRect> bounds;
+    bounds.setReserve(N);
+    fOps.setReserve(N);
+    for (int i = 0; i < N; i++) {
+        if (!boundsArray[i].isEmpty()) {
+            bounds.push_back(boundsArray[i]);
+            fOps.push_back(i);
+        }
+    }
+    if (fOps.isEmpty()) {
+        return;
+    }
+
+    // Build the levels bottom up.  Each node's children are a run of items on the level below.
+    struct Level {
+        SkTDArray<Node> fNodes;
+        SkTDArray<int>  fFirstChild;
+    };
+    SkTArray<Level> levels;
+    do {
+        Level& level = levels.push_back();
+        const int count = bounds.count();
+        SkTDArray<SkRect> parentBounds;
+        parentBounds.setReserve(count / kMinChildren + 1);
+
+        // Group the items as SkRTree does: kMaxChildren at a time, but if that would leave too
+        // few for the last group, take a few less for the first ones.
+        int shortfall = 0;
+        const int remainder = count % kMaxChildren;
+        if (remainder > 0 && remainder < kMinChildren) {
+            shortfall = kMinChildren - remainder;
+        }
+        for (int item = 0; item < count;) {
+            int n = kMaxChildren;
+            if (shortfall > 0) {
+                const int fewer = SkTMin(shortfall, kMaxChildren - kMinChildren);
+                n -= fewer;
+                shortfall -= fewer;
+            }
+            n = SkTMin(n, count - item);
+
+            Node* node = level.fNodes.append();
+            SkRect joined = bounds[item];
+            for (int i = 0; i < kMaxChildren; i++) {
+                if (i < n) {
+                    const SkRect& b = bounds[item + i];
+                    node->fLeft[i]   = b.fLeft;
+                    node->fTop[i]    = b.fTop;
+                    node->fRight[i]  = b.fRight;
+                    node->fBottom[i] = b.fBottom;
+                    joined.join(b);
+                } else {
+                    node->fLeft[i] = node->fTop[i]    = +SK_ScalarInfinity;
+                    node->fRight[i] = node->fBottom[i] = -SK_ScalarInfinity;
+                }
+            }
+            level.fFirstChild.push_back(item);
+            parentBounds.push_back(joined);
+            item += n;
+        }
+        bounds.swap(parentBounds);
+    } while (bounds.count() > 1);
+    fRootBounds = bounds[0];
+    fDepth = levels.count();
+
+    // Lay the levels out from the root down.  Each level's children follow right after it.
+    int nodeCount = 0;
+    for (const Level& level : levels) {
+        nodeCount += level.fNodes.count();
+    }
+    fNodes.setReserve(nodeCount);
+    fFirstChild.setReserve(nodeCount);
+    for (int i = levels.count() - 1; i >= 0; i--) {
+        const Level& level = levels[i];
+        fFirstLeaf = fNodes.count();
+        const int childOffset = i > 0 ? fNodes.count() + level.fNodes.count() : 0;
+        fNodes.append(level.fNodes.count(), level.fNodes.begin());
+        for (int first : level.fFirstChild) {
+            fFirstChild.push_back(childOffset + first);
+        }
+    }
+}
+
+void SkPackedRTree::search(const SkRect& query, SkTDArray<int>* results) const {
+    if (fOps.isEmpty() || !SkRect::Intersects(fRootBounds, query)) {
+        return;
+    }
+
+    const Sk8f queryLeft(query.fLeft),
+               queryTop(query.fTop),
+               queryRight(query.fRight),
+               queryBottom(query.fBottom);
+
+    // Nodes still to visit, the next one last.  Every node has at least two children, apart from
+    // a lone leaf, so the tree is at most 31 levels deep, and each level leaves at most
+    // kMaxChildren - 1 nodes behind on this stack.
+    int pending[32 * kMaxChildren];
+    int pendingCount = 0;
+    pending[pendingCount++] = 0;
+    while (pendingCount > 0) {
+        const int index = pending[--pendingCount];
+        const Node& node = fNodes[index];
+
+        // This is SkRect::Intersects() for all of the children at once.
+        const Sk8f intersectsX = Sk8f::Max(Sk8f::Load(node.fLeft), queryLeft) <
+                                 Sk8f::Min(Sk8f::Load(node.fRight), queryRight),
+                   intersectsY = Sk8f::Max(Sk8f::Load(node.fTop), queryTop) <
+                                 Sk8f::Min(Sk8f::Load(node.fBottom), queryBottom),
+                   intersects = intersectsX.thenElse(intersectsY, Sk8f(0));
+        if (!intersects.anyTrue()) {
+            continue;
+        }
+        uint32_t hits[kMaxChildren];
+        intersects.store(hits);
+
+        const int first = fFirstChild[index];
+        if (index >= fFirstLeaf) {
+            for (int i = 0; i < kMaxChildren; i++) {
+                if (hits[i]) {
+                    results->push_back(fOps[first + i]);
+                }
+            }
+        } else {
+            // Push the children in reverse, so that they are visited in order.
+            for (int i = kMaxChildren - 1; i >= 0; i--) {
+                if (hits[i]) {
+                    pending[pendingCount++] = first + i;
+                }
+            }
+        }
+    }
+}
+
+size_t SkPackedRTree::bytesUsed() const {
+    size_t byteCount = sizeof(SkPackedRTree);
+
+    byteCount += fNodes.reserved() * sizeof(Node);
+    byteCount += fFirstChild.reserved() * sizeof(int);
+    byteCount += fOps.reserved() * sizeof(int);
+
+    return byteCount;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPackedRTree_DEFINED
+#define SkPackedRTree_DEFINED
+
+#include "SkBBoxHierarchy.h"
+#include "SkRect.h"
+#include "SkTDArray.h"
+
+/**
+ * An R-Tree laid out for searching with SIMD.
+ *
+ * Like SkRTree, it is bulk-loaded by grouping runs of consecutive rectangles, so a search finds
+ * them in the order they were inserted.  Unlike SkRTree, each node keeps the bounds of its
+ * children as separate arrays of lefts, tops, rights, and bottoms, one SIMD vector each, so that
+ * search() tests all of a node's children with one vector compare.  The nodes are stored in one
+ * array in breadth-first order, which puts each node's children next to each other, so a node
+ * needs only the index of its first child, rather than a pointer per child.
+ */
+class SkPackedRTree : public SkBBoxHierarchy {
+public:
+    SkPackedRTree();
+    ~SkPackedRTree() override {}
+
+    void insert(const SkRect[], int N) override;
+    void search(const SkRect& query, SkTDArray<int>* results) const override;
+    size_t bytesUsed() const override;
+
+    // Methods and constants below here are only public for tests.
+
+    // Return the depth of the tree structure.
+    int getDepth() const { return fDepth; }
+    // Insertion count (not overall node count, which may be greater).
+    int getCount() const { return fOps.count(); }
+
+    // Get the root bound.
+    SkRect getRootBound() const override;
+
+    // kMaxChildren is the width of an Sk8f.
+    static const int kMinChildren = 4,
+                     kMaxChildren = 8;
+
+private:
+    struct Node {
+        // Lanes past the node's last child hold the bounds [+inf, -inf], which intersect nothing.
+        float fLeft  [kMaxChildren];
+        float fTop   [kMaxChildren];
+        float fRight [kMaxChildren];
+        float fBottom[kMaxChildren];
+    };
+
+    int fDepth;
+    SkRect fRootBounds;
+
+    // The root is fNodes[0].  Nodes from fFirstLeaf on are leaves.
+    SkTDArray<Node> fNodes;
+    int fFirstLeaf;
+
+    // For each node, the index of its first child, in fNodes, or for a leaf, in fOps.
+    SkTDArray<int> fFirstChild;
+
+    // The indices of the non-empty rectangles that were inserted, in order.
+    SkTDArray<int> fOps;
+
+    typedef SkBBoxHierarchy INHERITED;
+};
+
+#endif
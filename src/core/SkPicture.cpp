@@ -7,7 +7,9 @@
 
 #include "SkPicture.h"
 
+#include "SkBigPicture.h"
 #include "SkImageGenerator.h"
+#include "SkInPlacePicture.h"
 #include "SkMathPriv.h"
 #include "SkPictureCommon.h"
 #include "SkPictureData.h"
@@ -15,6 +17,7 @@
 #include "SkPicturePriv.h"
 #include "SkPictureRecord.h"
 #include "SkPictureRecorder.h"
+#include "SkRecordDraw.h"
 #include "SkSerialProcs.h"
 #include "SkTo.h"
 #include <atomic>
@@ -132,7 +135,7 @@ sk_sp<SkPicture> SkPicture::Forwardport(const SkPictInfo& info,
 }
 
 sk_sp<SkPicture> SkPicture::MakeFromStream(SkStream* stream, const SkDeserialProcs* procs) {
-    return MakeFromStream(stream, procs, nullptr);
+    return MakeFromStream(stream, procs, nullptr, nullptr);
 }
 
 sk_sp<SkPicture> SkPicture::MakeFromData(const void* data, size_t size,
@@ -141,7 +144,7 @@ sk_sp<SkPicture> SkPicture::MakeFromData(const void* data, size_t size,
         return nullptr;
     }
     SkMemoryStream stream(data, size);
-    return MakeFromStream(&stream, procs, nullptr);
+    return MakeFromStream(&stream, procs, nullptr, nullptr);
 }
 
 sk_sp<SkPicture> SkPicture::MakeFromData(const SkData* data, const SkDeserialProcs* procs) {
@@ -149,11 +152,20 @@ sk_sp<SkPicture> SkPicture::MakeFromData(const SkData* data, const SkDeserialPro
         return nullptr;
     }
     SkMemoryStream stream(data->data(), data->size());
-    return MakeFromStream(&stream, procs, nullptr);
+    return MakeFromStream(&stream, procs, nullptr, nullptr);
+}
+
+sk_sp<SkPicture> SkPicture::MakeFromDataInPlace(sk_sp<SkData> data,
+                                                const SkDeserialProcs* procs) {
+    if (!data) {
+        return nullptr;
+    }
+    SkMemoryStream stream(data);
+    return MakeFromStream(&stream, procs, nullptr, data.get());
 }
 
 sk_sp<SkPicture> SkPicture::MakeFromStream(SkStream* stream, const SkDeserialProcs* procsPtr,
-                                           SkTypefacePlayback* typefaces) {
+                                           SkTypefacePlayback* typefaces, SkData* inPlaceData) {
     SkPictInfo info;
     if (!StreamIsSKP(stream, &info)) {
         return nullptr;
@@ -169,7 +181,13 @@ sk_sp<SkPicture> SkPicture::MakeFromStream(SkStream* stream, const SkDeserialPro
     switch (trailingStreamByteAfterPictInfo) {
         case kPictureData_TrailingStreamByteAfterPictInfo: {
             std::unique_ptr<SkPictureData> data(
-                    SkPictureData::CreateFromStream(stream, info, procs, typefaces));
+                    SkPictureData::CreateFromStream(stream, info, procs, typefaces, inPlaceData));
+            if (inPlaceData) {
+                if (!data || !data->opData()) {
+                    return nullptr;
+                }
+                return sk_make_sp<SkInPlacePicture>(info.fCullRect, std::move(data));
+            }
             return Forwardport(info, data.get(), nullptr);
         }
         case kCustom_TrailingStreamByteAfterPictInfo: {
@@ -213,13 +231,59 @@ sk_sp<SkPicture> SkPicturePriv::MakeFromBuffer(SkReadBuffer& buffer) {
     return SkPicture::Forwardport(info, data.get(), &buffer);
 }
 
-SkPictureData* SkPicture::backport() const {
+// Gives each of the serialized ops the bounds of the picture's SkRecord op it was written for.
+// starts holds the offset in ops where each SkRecord op started, and where the last one ended.
+static sk_sp<SkData> make_op_index(const SkBigPicture& picture, const SkTDArray<size_t>& starts,
+                                   const SkData& ops) {
+    const SkRecord& record = *picture.record();
+    SkAutoTMalloc<SkRect> recordBounds(record.count());
+    SkRecordFillBounds(picture.cullRect(), record, recordBounds.get());
+
+    SkTDArray<uint32_t> offsets;
+    const int count = SkPicturePlayback::FindOps(ops, &offsets);
+    sk_sp<SkData> index = SkData::MakeUninitialized(count * (sizeof(uint32_t) + sizeof(SkRect)));
+    uint32_t* indexOffsets = static_cast<uint32_t*>(index->writable_data());
+    SkRect* indexBounds = reinterpret_cast<SkRect*>(indexOffsets + count);
+
+    int op = 0;
+    for (int i = 0; i < count; i++) {
+        while (op < record.count() && starts[op + 1] <= offsets[i]) {
+            op++;
+        }
+        indexOffsets[i] = offsets[i];
+        // SkPictureRecord's own save and restore around the ops get the whole picture's bounds.
+        indexBounds[i] = offsets[i] < starts[0] || op == record.count() ? picture.cullRect()
+                                                                         : recordBounds[op];
+    }
+    return index;
+}
+
+SkPictureData* SkPicture::backport(bool withOpIndex) const {
     SkPictInfo info = this->createHeader();
     SkPictureRecord rec(SkISize::Make(info.fCullRect.width(), info.fCullRect.height()), 0/*flags*/);
+    const SkBigPicture* big = withOpIndex ? this->asSkBigPicture() : nullptr;
+    if (!big || !big->bbh()) {
+        rec.beginRecording();
+            this->playback(&rec);
+        rec.endRecording();
+        return new SkPictureData(rec, info);
+    }
+
+    // Play back all of the ops, noting where each lands in rec.
+    const SkRecord& record = *big->record();
+    SkTDArray<size_t> starts;
+    starts.setReserve(record.count() + 1);
     rec.beginRecording();
-        this->playback(&rec);
+        SkRecords::Draw draw(&rec, big->drawablePicts(), nullptr, big->drawableCount());
+        for (int i = 0; i < record.count(); i++) {
+            starts.push_back(rec.writeStream().bytesWritten());
+            record.visit(i, draw);
+        }
+        starts.push_back(rec.writeStream().bytesWritten());
     rec.endRecording();
-    return new SkPictureData(rec, info);
+    SkPictureData* data = new SkPictureData(rec, info);
+    data->setOpIndex(make_op_index(*big, starts, *data->opData()));
+    return data;
 }
 
 void SkPicture::serialize(SkWStream* stream, const SkSerialProcs* procs) const {
@@ -279,7 +343,7 @@ void SkPicture::serialize(SkWStream* stream, const SkSerialProcs* procsPtr,
         return;
     }
 
-    std::unique_ptr<SkPictureData> data(this->backport());
+    std::unique_ptr<SkPictureData> data(this->backport(true));
     if (data) {
         stream->write8(kPictureData_TrailingStreamByteAfterPictInfo);
         data->serialize(stream, procs, typefaceSet);
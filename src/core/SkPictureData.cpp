@@ -13,6 +13,7 @@
 #include "SkPictureRecord.h"
 #include "SkPicturePriv.h"
 #include "SkReadBuffer.h"
+#include "SkSafeMath.h"
 #include "SkTextBlobPriv.h"
 #include "SkTypeface.h"
 #include "SkWriteBuffer.h"
@@ -93,6 +94,17 @@ static void write_tag_size(SkWStream* stream, uint32_t tag, size_t size) {
     stream->write32(SkToU32(size));
 }
 
+// Pads the stream so that the data of the next tag starts on a 4-byte boundary.  If the picture
+// is written from the start of an aligned buffer, that data can then be read where it lies.
+static void write_pad_tag(SkWStream* stream) {
+    const size_t pad = (4 - (stream->bytesWritten() & 3)) & 3;
+    if (pad > 0) {
+        const uint32_t zero = 0;
+        write_tag_size(stream, SK_PICT_PAD_TAG, pad);
+        stream->write(&zero, pad);
+    }
+}
+
 void SkPictureData::WriteFactories(SkWStream* stream, const SkFactorySet& rec) {
     int count = rec.count();
 
@@ -144,12 +156,14 @@ void SkPictureData::WriteTypefaces(SkWStream* stream, const SkRefCntSet& rec,
     }
 }
 
-void SkPictureData::flattenToBuffer(SkWriteBuffer& buffer) const {
+template <typename NoteResourceFn>
+void SkPictureData::flattenToBuffer(SkWriteBuffer& buffer, NoteResourceFn noteResource) const {
     int i, n;
 
     if ((n = fPaints.count()) > 0) {
         write_tag_size(buffer, SK_PICT_PAINT_BUFFER_TAG, n);
         for (i = 0; i < n; i++) {
+            noteResource(kPaint_ResourceType);
             buffer.writePaint(fPaints[i]);
         }
     }
@@ -158,6 +172,7 @@ void SkPictureData::flattenToBuffer(SkWriteBuffer& buffer) const {
         write_tag_size(buffer, SK_PICT_PATH_BUFFER_TAG, n);
         buffer.writeInt(n);
         for (int i = 0; i < n; i++) {
+            noteResource(kPath_ResourceType);
             buffer.writePath(fPaths[i]);
         }
     }
@@ -165,6 +180,7 @@ void SkPictureData::flattenToBuffer(SkWriteBuffer& buffer) const {
     if (!fTextBlobs.empty()) {
         write_tag_size(buffer, SK_PICT_TEXTBLOB_BUFFER_TAG, fTextBlobs.count());
         for (const auto& blob : fTextBlobs) {
+            noteResource(kTextBlob_ResourceType);
             SkTextBlobPriv::Flatten(*blob, buffer);
         }
     }
@@ -172,6 +188,7 @@ void SkPictureData::flattenToBuffer(SkWriteBuffer& buffer) const {
     if (!fVertices.empty()) {
         write_tag_size(buffer, SK_PICT_VERTICES_BUFFER_TAG, fVertices.count());
         for (const auto& vert : fVertices) {
+            noteResource(kVertices_ResourceType);
             buffer.writeDataAsByteArray(vert->encode().get());
         }
     }
@@ -179,6 +196,7 @@ void SkPictureData::flattenToBuffer(SkWriteBuffer& buffer) const {
     if (!fImages.empty()) {
         write_tag_size(buffer, SK_PICT_IMAGE_BUFFER_TAG, fImages.count());
         for (const auto& img : fImages) {
+            noteResource(kImage_ResourceType);
             buffer.writeImage(img.get());
         }
     }
@@ -199,9 +217,16 @@ static SkSerialProcs skip_typeface_proc(const SkSerialProcs& procs) {
 void SkPictureData::serialize(SkWStream* stream, const SkSerialProcs& procs,
                               SkRefCntSet* topLevelTypeFaceSet) const {
     // This can happen at pretty much any time, so might as well do it first.
+    write_pad_tag(stream);
     write_tag_size(stream, SK_PICT_READER_TAG, fOpData->size());
     stream->write(fOpData->bytes(), fOpData->size());
 
+    if (fOpIndex) {
+        write_pad_tag(stream);
+        write_tag_size(stream, SK_PICT_OP_INDEX_TAG, this->opIndexCount());
+        stream->write(fOpIndex->data(), fOpIndex->size());
+    }
+
     // We serialize all typefaces into the typeface section of the top-level picture.
     SkRefCntSet localTypefaceSet;
     SkRefCntSet* typefaceSet = topLevelTypeFaceSet ? topLevelTypeFaceSet : &localTypefaceSet;
@@ -213,7 +238,10 @@ void SkPictureData::serialize(SkWStream* stream, const SkSerialProcs& procs,
     buffer.setFactoryRecorder(sk_ref_sp(&factSet));
     buffer.setSerialProcs(skip_typeface_proc(procs));
     buffer.setTypefaceRecorder(sk_ref_sp(typefaceSet));
-    this->flattenToBuffer(buffer);
+    SkTDArray<uint32_t> resourceOffsets[kResourceTypeCount];
+    this->flattenToBuffer(buffer, [&](ResourceType type) {
+        resourceOffsets[type].push_back(SkToU32(buffer.bytesWritten()));
+    });
 
     // Dummy serialize our sub-pictures for the side effect of filling
     // typefaceSet with typefaces from sub-pictures.
@@ -237,7 +265,25 @@ void SkPictureData::serialize(SkWStream* stream, const SkSerialProcs& procs,
         WriteTypefaces(stream, *typefaceSet, procs);
     }
 
+    // Only a picture with an op index can be played back piecemeal, so only it needs to say where
+    // its resources are.
+    if (fOpIndex) {
+        size_t count = kResourceTypeCount;
+        for (const auto& offsets : resourceOffsets) {
+            count += offsets.count();
+        }
+        write_pad_tag(stream);
+        write_tag_size(stream, SK_PICT_RESOURCE_INDEX_TAG, count);
+        for (const auto& offsets : resourceOffsets) {
+            stream->write32(offsets.count());
+        }
+        for (const auto& offsets : resourceOffsets) {
+            stream->write(offsets.begin(), offsets.count() * sizeof(uint32_t));
+        }
+    }
+
     // Write the buffer.
+    write_pad_tag(stream);
     write_tag_size(stream, SK_PICT_BUFFER_SIZE_TAG, buffer.bytesWritten());
     buffer.writeToStream(stream);
 
@@ -271,25 +317,82 @@ void SkPictureData::flatten(SkWriteBuffer& buffer) const {
     }
 
     // Write this picture playback's data into a writebuffer
-    this->flattenToBuffer(buffer);
+    this->flattenToBuffer(buffer, [](ResourceType) {});
     buffer.write32(SK_PICT_EOF_TAG);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// Reads size bytes from a stream that is reading from inPlaceData.  They are only copied if they
+// are not aligned for SkReadBuffer.
+static sk_sp<SkData> read_in_place(SkStream* stream, SkData* inPlaceData, size_t size) {
+    SkASSERT(stream->getMemoryBase() == inPlaceData->data());
+    const size_t offset = stream->getPosition();
+    if (stream->skip(size) != size) {
+        return nullptr;
+    }
+    if (SkIsAlign4(reinterpret_cast<uintptr_t>(inPlaceData->bytes() + offset))) {
+        return SkData::MakeSubset(inPlaceData, offset, size);
+    }
+    return SkData::MakeWithCopy(inPlaceData->bytes() + offset, size);
+}
+
+static bool has_custom_procs(const SkDeserialProcs& procs) {
+    return procs.fPictureProc || procs.fImageProc || procs.fTypefaceProc;
+}
+
 bool SkPictureData::parseStreamTag(SkStream* stream,
                                    uint32_t tag,
                                    uint32_t size,
                                    const SkDeserialProcs& procs,
-                                   SkTypefacePlayback* topLevelTFPlayback) {
+                                   SkTypefacePlayback* topLevelTFPlayback,
+                                   SkData* inPlaceData) {
     switch (tag) {
         case SK_PICT_READER_TAG:
             SkASSERT(nullptr == fOpData);
-            fOpData = SkData::MakeFromStream(stream, size);
+            fOpData = inPlaceData ? read_in_place(stream, inPlaceData, size)
+                                  : SkData::MakeFromStream(stream, size);
             if (!fOpData) {
                 return false;
             }
             break;
+        case SK_PICT_OP_INDEX_TAG: {
+            // Only a picture played back in place can use the index.
+            SkSafeMath safe;
+            const size_t indexSize = safe.mul(size, kOpIndexEntrySize);
+            if (!safe) {
+                return false;
+            }
+            if (inPlaceData) {
+                fOpIndex = read_in_place(stream, inPlaceData, indexSize);
+                if (!fOpIndex) {
+                    return false;
+                }
+            } else if (stream->skip(indexSize) != indexSize) {
+                return false;
+            }
+        } break;
+        case SK_PICT_RESOURCE_INDEX_TAG: {
+            // As with the op index, only a picture played back in place uses this.
+            SkSafeMath safe;
+            const size_t indexSize = safe.mul(size, sizeof(uint32_t));
+            if (!safe) {
+                return false;
+            }
+            if (inPlaceData && !has_custom_procs(procs)) {
+                fResourceIndex = read_in_place(stream, inPlaceData, indexSize);
+                if (!fResourceIndex) {
+                    return false;
+                }
+            } else if (stream->skip(indexSize) != indexSize) {
+                return false;
+            }
+        } break;
+        case SK_PICT_PAD_TAG:
+            if (stream->skip(size) != size) {
+                return false;
+            }
+            break;
         case SK_PICT_FACTORY_TAG: {
             if (!stream->readU32(&size)) { return false; }
             fFactoryPlayback = skstd::make_unique<SkFactoryPlayback>(size);
@@ -321,7 +424,8 @@ bool SkPictureData::parseStreamTag(SkStream* stream,
             fPictures.reserve(SkToInt(size));
 
             for (uint32_t i = 0; i < size; i++) {
-                auto pic = SkPicture::MakeFromStream(stream, &procs, topLevelTFPlayback);
+                auto pic = SkPicture::MakeFromStream(stream, &procs, topLevelTFPlayback,
+                                                     inPlaceData);
                 if (!pic) {
                     return false;
                 }
@@ -329,34 +433,35 @@ bool SkPictureData::parseStreamTag(SkStream* stream,
             }
         } break;
         case SK_PICT_BUFFER_SIZE_TAG: {
-            SkAutoMalloc storage(size);
-            if (stream->read(storage.get(), size) != size) {
+            if (!fFactoryPlayback) {
                 return false;
             }
 
-            SkReadBuffer buffer(storage.get(), size);
-            buffer.setVersion(fInfo.getVersion());
+            if (inPlaceData && !has_custom_procs(procs)) {
+                fDeferredBuffer = read_in_place(stream, inPlaceData, size);
+                if (!fDeferredBuffer) {
+                    return false;
+                }
+                // This picture may outlive the top picture, so hold on to the typefaces here.
+                if (0 == fTFPlayback.count()) {
+                    fTFPlayback.setCount(topLevelTFPlayback->count());
+                    for (size_t i = 0; i < fTFPlayback.count(); i++) {
+                        fTFPlayback[i] = (*topLevelTFPlayback)[i];
+                    }
+                }
+                break;
+            }
 
-            if (!fFactoryPlayback) {
+            SkAutoMalloc storage(size);
+            if (stream->read(storage.get(), size) != size) {
                 return false;
             }
-            fFactoryPlayback->setupBuffer(buffer);
-            buffer.setDeserialProcs(procs);
-
-            if (fTFPlayback.count() > 0) {
-                // .skp files <= v43 have typefaces serialized with each sub picture.
-                fTFPlayback.setupBuffer(buffer);
-            } else {
-                // Newer .skp files serialize all typefaces with the top picture.
-                topLevelTFPlayback->setupBuffer(buffer);
-            }
 
-            while (!buffer.eof() && buffer.isValid()) {
-                tag = buffer.readUInt();
-                size = buffer.readUInt();
-                this->parseBufferTag(buffer, tag, size);
-            }
-            if (!buffer.isValid()) {
+            // .skp files <= v43 have typefaces serialized with each sub picture.
+            // Newer .skp files serialize all typefaces with the top picture.
+            const SkTypefacePlayback& typefaces =
+                    fTFPlayback.count() > 0 ? fTFPlayback : *topLevelTFPlayback;
+            if (!this->parseBufferTags(storage.get(), size, procs, typefaces)) {
                 return false;
             }
         } break;
@@ -364,6 +469,106 @@ bool SkPictureData::parseStreamTag(SkStream* stream,
     return true;    // success
 }
 
+bool SkPictureData::parseBufferTags(const void* data, size_t size,
+                                    const SkDeserialProcs& procs,
+                                    const SkTypefacePlayback& typefaces) {
+    SkReadBuffer buffer(data, size);
+    buffer.setVersion(fInfo.getVersion());
+    fFactoryPlayback->setupBuffer(buffer);
+    buffer.setDeserialProcs(procs);
+    typefaces.setupBuffer(buffer);
+
+    while (!buffer.eof() && buffer.isValid()) {
+        uint32_t tag = buffer.readUInt();
+        uint32_t tagSize = buffer.readUInt();
+        this->parseBufferTag(buffer, tag, tagSize);
+    }
+    return buffer.isValid();
+}
+
+bool SkPictureData::prepareForPlayback() {
+    if (fOpIndex && !this->opIndexIsValid()) {
+        fOpIndex = nullptr;
+    }
+    if (fDeferredBuffer) {
+        sk_sp<SkData> buffer = std::move(fDeferredBuffer);
+        // Parsing the resources lazily only pays off if playback can skip the ops that use them.
+        if (!(fOpIndex && fResourceIndex && this->initLazyResources(buffer)) &&
+            !this->parseBufferTags(buffer->data(), buffer->size(), SkDeserialProcs(),
+                                   fTFPlayback)) {
+            return false;
+        }
+    }
+    fResourceIndex = nullptr;
+    this->initForPlayback();
+    return true;
+}
+
+bool SkPictureData::opIndexIsValid() const {
+    const uint32_t* offsets = this->opIndexOffsets();
+    const SkRect* bounds = this->opIndexBounds();
+    for (int i = 0; i < this->opIndexCount(); i++) {
+        if (!SkIsAlign4(offsets[i]) || offsets[i] >= fOpData->size() ||
+            (i > 0 && offsets[i] <= offsets[i - 1]) || !bounds[i].isFinite()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SkPictureData::initLazyResources(sk_sp<SkData> buffer) {
+    // The index holds the number of each type of resource, then the offsets of them all.
+    const uint32_t* index = static_cast<const uint32_t*>(fResourceIndex->data());
+    const size_t indexCount = fResourceIndex->size() / sizeof(uint32_t);
+    if (indexCount < kResourceTypeCount) {
+        return false;
+    }
+    size_t total = kResourceTypeCount;
+    for (int type = 0; type < kResourceTypeCount; type++) {
+        if (index[type] > indexCount) {
+            return false;
+        }
+        total += index[type];
+    }
+    if (total != indexCount) {
+        return false;
+    }
+    for (size_t i = kResourceTypeCount; i < indexCount; i++) {
+        if (!SkIsAlign4(index[i]) || index[i] >= buffer->size()) {
+            return false;
+        }
+    }
+
+    auto lazy = skstd::make_unique<LazyResources>();
+    const uint32_t* offsets = index + kResourceTypeCount;
+    for (int type = 0; type < kResourceTypeCount; type++) {
+        const int count = SkToInt(index[type]);
+        lazy->fOffsets[type] = offsets;
+        lazy->fOnce[type].reset(new SkOnce[count]);
+        lazy->fValid[type].reset(new bool[count]());
+        offsets += count;
+    }
+    fPaints.reset(SkToInt(index[kPaint_ResourceType]));
+    fPaths.reset(SkToInt(index[kPath_ResourceType]));
+    fTextBlobs.reset(SkToInt(index[kTextBlob_ResourceType]));
+    fVertices.reset(SkToInt(index[kVertices_ResourceType]));
+    fImages.reset(SkToInt(index[kImage_ResourceType]));
+
+    lazy->fBuffer = std::move(buffer);
+    lazy->fIndex = std::move(fResourceIndex);
+    fLazyResources = std::move(lazy);
+    return true;
+}
+
+bool SkPictureData::materializeLazily(ResourceType type, int index, SkReadBuffer* reader) const {
+    LazyResources& lazy = *fLazyResources;
+    lazy.fOnce[type][index]([&] {
+        // Each resource is written only here, once, before anyone reads it.
+        lazy.fValid[type][index] = const_cast<SkPictureData*>(this)->parseResource(type, index);
+    });
+    return reader->validate(lazy.fValid[type][index]);
+}
+
 static sk_sp<SkImage> create_image_from_buffer(SkReadBuffer& buffer) {
     return buffer.readImage();
 }
@@ -464,16 +669,49 @@ void SkPictureData::parseBufferTag(SkReadBuffer& buffer, uint32_t tag, uint32_t
     }
 }
 
+bool SkPictureData::parseResource(ResourceType type, int index) {
+    const LazyResources& lazy = *fLazyResources;
+    const size_t offset = lazy.fOffsets[type][index];
+    SkReadBuffer buffer(lazy.fBuffer->bytes() + offset, lazy.fBuffer->size() - offset);
+    buffer.setVersion(fInfo.getVersion());
+    fFactoryPlayback->setupBuffer(buffer);
+    fTFPlayback.setupBuffer(buffer);
+
+    switch (type) {
+        case kPaint_ResourceType:
+            buffer.validate(kFailed_ReadPaint != buffer.readPaint(&fPaints[index], nullptr));
+            break;
+        case kPath_ResourceType:
+            buffer.readPath(&fPaths[index]);
+            fPaths[index].updateBoundsCache();
+            break;
+        case kTextBlob_ResourceType:
+            fTextBlobs[index] = SkTextBlobPriv::MakeFromBuffer(buffer);
+            buffer.validate(fTextBlobs[index] != nullptr);
+            break;
+        case kVertices_ResourceType:
+            fVertices[index] = create_vertices_from_buffer(buffer);
+            buffer.validate(fVertices[index] != nullptr);
+            break;
+        case kImage_ResourceType:
+            fImages[index] = create_image_from_buffer(buffer);
+            buffer.validate(fImages[index] != nullptr);
+            break;
+    }
+    return buffer.isValid();
+}
+
 SkPictureData* SkPictureData::CreateFromStream(SkStream* stream,
                                                const SkPictInfo& info,
                                                const SkDeserialProcs& procs,
-                                               SkTypefacePlayback* topLevelTFPlayback) {
+                                               SkTypefacePlayback* topLevelTFPlayback,
+                                               SkData* inPlaceData) {
     std::unique_ptr<SkPictureData> data(new SkPictureData(info));
     if (!topLevelTFPlayback) {
         topLevelTFPlayback = &data->fTFPlayback;
     }
 
-    if (!data->parseStream(stream, procs, topLevelTFPlayback)) {
+    if (!data->parseStream(stream, procs, topLevelTFPlayback, inPlaceData)) {
         return nullptr;
     }
     return data.release();
@@ -492,7 +730,8 @@ SkPictureData* SkPictureData::CreateFromBuffer(SkReadBuffer& buffer,
 
 bool SkPictureData::parseStream(SkStream* stream,
                                 const SkDeserialProcs& procs,
-                                SkTypefacePlayback* topLevelTFPlayback) {
+                                SkTypefacePlayback* topLevelTFPlayback,
+                                SkData* inPlaceData) {
     for (;;) {
         uint32_t tag;
         if (!stream->readU32(&tag)) { return false; }
@@ -502,7 +741,7 @@ bool SkPictureData::parseStream(SkStream* stream,
 
         uint32_t size;
         if (!stream->readU32(&size)) { return false; }
-        if (!this->parseStreamTag(stream, tag, size, procs, topLevelTFPlayback)) {
+        if (!this->parseStreamTag(stream, tag, size, procs, topLevelTFPlayback, inPlaceData)) {
             return false; // we're invalid
         }
     }
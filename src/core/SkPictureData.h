@@ -9,10 +9,13 @@
 #define SkPictureData_DEFINED
 
 #include "SkBitmap.h"
+#include "SkData.h"
 #include "SkDrawable.h"
+#include "SkOnce.h"
 #include "SkPicture.h"
 #include "SkPictureFlat.h"
 #include "SkTArray.h"
+#include "SkTo.h"
 
 #include <memory>
 
@@ -56,6 +59,16 @@ public:
 #define SK_PICT_PICTURE_TAG    SkSetFourByteTag('p', 'c', 't', 'r')
 #define SK_PICT_DRAWABLE_TAG   SkSetFourByteTag('d', 'r', 'a', 'w')
 
+// The offset and bounds of each op, for pictures recorded with a bounding box hierarchy.
+#define SK_PICT_OP_INDEX_TAG   SkSetFourByteTag('o', 'p', 'i', 'x')
+
+// Where each paint, path, text blob, vertices, and image starts in the SK_PICT_BUFFER_SIZE_TAG
+// data, so that they can be parsed one at a time.  Written along with the op index.
+#define SK_PICT_RESOURCE_INDEX_TAG  SkSetFourByteTag('r', 's', 'i', 'x')
+
+// Zero bytes that align the data of the tag after it to 4 bytes, so it can be read in place.
+#define SK_PICT_PAD_TAG        SkSetFourByteTag('p', 'a', 'd', ' ')
+
 // This tag specifies the size of the ReadBuffer, needed for the following tags
 #define SK_PICT_BUFFER_SIZE_TAG     SkSetFourByteTag('a', 'r', 'a', 'y')
 // these are all inside the ARRAYS tag
@@ -78,10 +91,16 @@ class SkPictureData {
 public:
     SkPictureData(const SkPictureRecord& record, const SkPictInfo&);
     // Does not affect ownership of SkStream.
+    //
+    // If inPlaceData is not null, the stream must be reading from it.  The op data then refers to
+    // inPlaceData rather than being copied, where it is aligned for that, and unless there are
+    // custom procs, the paints, paths, and other resources are left unparsed until
+    // prepareForPlayback().
     static SkPictureData* CreateFromStream(SkStream*,
                                            const SkPictInfo&,
                                            const SkDeserialProcs&,
-                                           SkTypefacePlayback*);
+                                           SkTypefacePlayback*,
+                                           SkData* inPlaceData = nullptr);
     static SkPictureData* CreateFromBuffer(SkReadBuffer&, const SkPictInfo&);
 
     void serialize(SkWStream*, const SkSerialProcs&, SkRefCntSet*) const;
@@ -89,24 +108,50 @@ public:
 
     const sk_sp<SkData>& opData() const { return fOpData; }
 
+    // If the picture was recorded with a bounding box hierarchy, these give the offset of each op
+    // in opData() and its bounds, so that a playback can skip the ops that miss its clip.
+    // Otherwise opIndexCount() is zero.
+    int opIndexCount() const {
+        return fOpIndex ? SkToInt(fOpIndex->size() / kOpIndexEntrySize) : 0;
+    }
+    const uint32_t* opIndexOffsets() const {
+        return static_cast<const uint32_t*>(fOpIndex->data());
+    }
+    const SkRect* opIndexBounds() const {
+        return reinterpret_cast<const SkRect*>(this->opIndexOffsets() + this->opIndexCount());
+    }
+    // The index holds the offset of each op, then the bounds of each.
+    void setOpIndex(sk_sp<SkData> opIndex) { fOpIndex = std::move(opIndex); }
+
+    // Parses anything that CreateFromStream() left for later, and readies the data to be played
+    // back, possibly on several threads at once.  Returns false if the deferred data is invalid.
+    // Drops the op index if it does not match the ops.
+    //
+    // If there is a valid resource index, the paints, paths, and other resources are not parsed
+    // here, but one by one, the first time playback asks for each.
+    bool prepareForPlayback();
+
 protected:
     explicit SkPictureData(const SkPictInfo& info);
 
     // Does not affect ownership of SkStream.
-    bool parseStream(SkStream*, const SkDeserialProcs&, SkTypefacePlayback*);
+    bool parseStream(SkStream*, const SkDeserialProcs&, SkTypefacePlayback*, SkData* inPlaceData);
     bool parseBuffer(SkReadBuffer& buffer);
 
 public:
     const SkImage* getImage(SkReadBuffer* reader) const {
         // images are written base-0, unlike paths, pictures, drawables, etc.
         const int index = reader->readInt();
-        return reader->validateIndex(index, fImages.count()) ? fImages[index].get() : nullptr;
+        return reader->validateIndex(index, fImages.count()) &&
+               this->materialize(kImage_ResourceType, index, reader) ? fImages[index].get()
+                                                                     : nullptr;
     }
 
     const SkPath& getPath(SkReadBuffer* reader) const {
         int index = reader->readInt();
-        return reader->validate(index > 0 && index <= fPaths.count()) ?
-                fPaths[index - 1] : fEmptyPath;
+        return reader->validate(index > 0 && index <= fPaths.count()) &&
+               this->materialize(kPath_ResourceType, index - 1, reader) ? fPaths[index - 1]
+                                                                        : fEmptyPath;
     }
 
     const SkPicture* getPicture(SkReadBuffer* reader) const {
@@ -122,31 +167,79 @@ public:
         if (index == 0) {
             return nullptr; // recorder wrote a zero for no paint (likely drawimage)
         }
-        return reader->validate(index > 0 && index <= fPaints.count()) ?
-                &fPaints[index - 1] : nullptr;
+        return reader->validate(index > 0 && index <= fPaints.count()) &&
+               this->materialize(kPaint_ResourceType, index - 1, reader) ? &fPaints[index - 1]
+                                                                         : nullptr;
     }
 
     const SkTextBlob* getTextBlob(SkReadBuffer* reader) const {
-        return read_index_base_1_or_null(reader, fTextBlobs);
+        int index = reader->readInt();
+        return reader->validate(index > 0 && index <= fTextBlobs.count()) &&
+               this->materialize(kTextBlob_ResourceType, index - 1, reader)
+                ? fTextBlobs[index - 1].get() : nullptr;
     }
 
     const SkVertices* getVertices(SkReadBuffer* reader) const {
-        return read_index_base_1_or_null(reader, fVertices);
+        int index = reader->readInt();
+        return reader->validate(index > 0 && index <= fVertices.count()) &&
+               this->materialize(kVertices_ResourceType, index - 1, reader)
+                ? fVertices[index - 1].get() : nullptr;
     }
 
 private:
     // these help us with reading/writing
     // Does not affect ownership of SkStream.
     bool parseStreamTag(SkStream*, uint32_t tag, uint32_t size,
-                        const SkDeserialProcs&, SkTypefacePlayback*);
+                        const SkDeserialProcs&, SkTypefacePlayback*, SkData* inPlaceData);
+    bool parseBufferTags(const void* data, size_t size,
+                         const SkDeserialProcs&, const SkTypefacePlayback&);
     void parseBufferTag(SkReadBuffer&, uint32_t tag, uint32_t size);
-    void flattenToBuffer(SkWriteBuffer&) const;
+    // Calls noteResource(type) just before writing each paint, path, and so on.
+    template <typename NoteResourceFn>
+    void flattenToBuffer(SkWriteBuffer&, NoteResourceFn noteResource) const;
+
+    // In the order they are written by flattenToBuffer().
+    enum ResourceType {
+        kPaint_ResourceType,
+        kPath_ResourceType,
+        kTextBlob_ResourceType,
+        kVertices_ResourceType,
+        kImage_ResourceType,
+
+        kLast_ResourceType = kImage_ResourceType
+    };
+    static constexpr int kResourceTypeCount = kLast_ResourceType + 1;
+
+    // Resources that are parsed the first time they are used.
+    struct LazyResources {
+        sk_sp<SkData>             fBuffer;      // the SK_PICT_BUFFER_SIZE_TAG data
+        sk_sp<SkData>             fIndex;       // offsets into fBuffer, by type
+        const uint32_t*           fOffsets[kResourceTypeCount];
+        std::unique_ptr<SkOnce[]> fOnce[kResourceTypeCount];
+        std::unique_ptr<bool[]>   fValid[kResourceTypeCount];
+    };
+
+    // Makes sure the resource is parsed.  Invalidates reader if it fails to parse.
+    bool materialize(ResourceType type, int index, SkReadBuffer* reader) const {
+        return !fLazyResources || this->materializeLazily(type, index, reader);
+    }
+    bool materializeLazily(ResourceType, int index, SkReadBuffer*) const;
+    bool parseResource(ResourceType, int index);
+    bool initLazyResources(sk_sp<SkData> buffer);
 
     SkTArray<SkPaint>  fPaints;
     SkTArray<SkPath>   fPaths;
 
     sk_sp<SkData>   fOpData;    // opcodes and parameters
 
+    static constexpr size_t kOpIndexEntrySize = sizeof(uint32_t) + sizeof(SkRect);
+    sk_sp<SkData>   fOpIndex;
+
+    // The SK_PICT_BUFFER_SIZE_TAG data, when its parsing is deferred to prepareForPlayback().
+    sk_sp<SkData>   fDeferredBuffer;
+    sk_sp<SkData>   fResourceIndex;
+    std::unique_ptr<LazyResources> fLazyResources;
+
     const SkPath    fEmptyPath;
     const SkBitmap  fEmptyBitmap;
 
@@ -165,6 +258,7 @@ private:
     static void WriteTypefaces(SkWStream* stream, const SkRefCntSet& rec, const SkSerialProcs&);
 
     void initForPlayback() const;
+    bool opIndexIsValid() const;
 };
 
 #endif
@@ -17,6 +17,7 @@
 #include "SkReadBuffer.h"
 #include "SkRSXform.h"
 #include "SkSafeMath.h"
+#include "SkTo.h"
 #include "SkTextBlob.h"
 #include "SkTDArray.h"
 #include "SkTypes.h"
@@ -103,6 +104,72 @@ void SkPicturePlayback::draw(SkCanvas* canvas,
     }
 }
 
+void SkPicturePlayback::draw(SkCanvas* canvas,
+                             SkPicture::AbortCallback* callback,
+                             const uint32_t offsets[],
+                             const SkTDArray<int>& ops) {
+    AutoResetOpID aroi(this);
+    SkASSERT(0 == fCurOffset);
+
+    SkReadBuffer reader(fPictureData->opData()->bytes(),
+                        fPictureData->opData()->size());
+
+    // Record this, so we can concat w/ it if we encounter a setMatrix()
+    SkMatrix initialMatrix = canvas->getTotalMatrix();
+
+    SkAutoCanvasRestore acr(canvas, false);
+
+    for (int index : ops) {
+        if (callback && callback->abort()) {
+            return;
+        }
+
+        const uint32_t offset = offsets[index];
+        if (offset < reader.offset()) {
+            // A clip op found the clip empty and already skipped us past this op.
+            continue;
+        }
+        if (!reader.skip(offset - reader.offset())) {
+            return;
+        }
+
+        fCurOffset = reader.offset();
+        uint32_t size;
+        DrawType op = ReadOpAndSize(&reader, &size);
+        if (!reader.validate(op > UNUSED && op <= LAST_DRAWTYPE_ENUM)) {
+            return;
+        }
+
+        this->handleOp(&reader, op, size, canvas, initialMatrix);
+    }
+}
+
+int SkPicturePlayback::FindOps(const SkData& opData, SkTDArray<uint32_t>* offsets) {
+    const uint8_t* ops = opData.bytes();
+    const size_t size = opData.size();
+    int count = 0;
+    size_t offset = 0;
+    while (offset + 4 <= size) {
+        uint32_t packed;
+        memcpy(&packed, ops + offset, 4);
+        uint32_t opSize = packed & MASK_24;
+        if (MASK_24 == opSize && offset + 8 <= size) {
+            // SkPictureRecord::addDraw() adds one byte, not a word, to a size it writes this way.
+            memcpy(&opSize, ops + offset + 4, 4);
+            opSize = SkAlign4(opSize);
+        }
+        if (opSize < 4) {
+            break;
+        }
+        if (offsets) {
+            offsets->push_back(SkToU32(offset));
+        }
+        offset += opSize;
+        count++;
+    }
+    return count;
+}
+
 static void validate_offsetToRestore(SkReadBuffer* reader, size_t offsetToRestore) {
     if (offsetToRestore) {
         reader->validate(SkIsAlign4(offsetToRestore) && offsetToRestore >= reader->offset());
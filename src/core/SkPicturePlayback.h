@@ -9,6 +9,7 @@
 #define SkPicturePlayback_DEFINED
 
 #include "SkPictureFlat.h"  // for DrawType
+#include "SkTDArray.h"
 
 class SkBitmap;
 class SkCanvas;
@@ -25,6 +26,14 @@ public:
 
     void draw(SkCanvas* canvas, SkPicture::AbortCallback*, SkReadBuffer* buffer);
 
+    // Replays only the ops whose offsets into the op data are offsets[ops[0]], offsets[ops[1]],
+    // and so on.  Those offsets must increase.
+    void draw(SkCanvas* canvas, SkPicture::AbortCallback*,
+              const uint32_t offsets[], const SkTDArray<int>& ops);
+
+    // Returns the number of ops in opData, and if offsets is not null, appends their offsets.
+    static int FindOps(const SkData& opData, SkTDArray<uint32_t>* offsets);
+
     // TODO: remove the curOp calls after cleaning up GrGatherDevice
     // Return the ID of the operation currently being executed when playing
     // back. 0 indicates no call is active.
@@ -19,6 +19,7 @@
 
 SkPictureRecorder::SkPictureRecorder() {
     fActivelyRecording = false;
+    fExecutor = nullptr;
     fMiniRecorder.reset(new SkMiniRecorder);
     fRecorder.reset(new SkRecorder(nullptr, SkRect::MakeEmpty(), fMiniRecorder.get()));
 }
@@ -32,10 +33,12 @@ SkCanvas* SkPictureRecorder::beginRecording(const SkRect& userCullRect,
 
     fCullRect = cullRect;
     fFlags = recordFlags;
+    fExecutor = nullptr;
 
     if (bbhFactory) {
         fBBH.reset((*bbhFactory)(cullRect));
         SkASSERT(fBBH.get());
+        fExecutor = bbhFactory->executor();
     }
 
     if (!fRecord) {
@@ -72,7 +75,7 @@ sk_sp<SkPicture> SkPictureRecorder::finishRecordingAsPicture(uint32_t finishFlag
 
     if (fBBH.get()) {
         SkAutoTMalloc<SkRect> bounds(fRecord->count());
-        SkRecordFillBounds(fCullRect, *fRecord, bounds);
+        SkRecordFillBounds(fCullRect, *fRecord, bounds, fExecutor);
         fBBH->insert(bounds, fRecord->count());
 
         // Now that we've calculated content bounds, we can update fCullRect, often trimming it.
@@ -122,7 +125,7 @@ sk_sp<SkDrawable> SkPictureRecorder::finishRecordingAsDrawable(uint32_t finishFl
 
     if (fBBH.get()) {
         SkAutoTMalloc<SkRect> bounds(fRecord->count());
-        SkRecordFillBounds(fCullRect, *fRecord, bounds);
+        SkRecordFillBounds(fCullRect, *fRecord, bounds, fExecutor);
         fBBH->insert(bounds, fRecord->count());
     }
 
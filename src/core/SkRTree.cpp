@@ -6,9 +6,10 @@
  */
 
 #include "SkRTree.h"
+#include "SkTaskGroup.h"
 
-SkRTree::SkRTree(SkScalar aspectRatio)
-    : fCount(0), fAspectRatio(isfinite(aspectRatio) ? aspectRatio : 1) {}
+SkRTree::SkRTree(SkScalar aspectRatio, SkExecutor* executor)
+    : fCount(0), fAspectRatio(isfinite(aspectRatio) ? aspectRatio : 1), fExecutor(executor) {}
 
 SkRect SkRTree::getRootBound() const {
     if (fCount) {
@@ -109,9 +110,9 @@ SkRTree::Branch SkRTree::bulkLoad(SkTDArray<Branch>* branches, int level) {
     // We might sort our branches here, but we expect Blink gives us a reasonable x,y order.
     // Skipping a call to sort (in Y) here resulted in a 17% win for recording with negligible
     // difference in playback speed.
-    int numBranches = branches->count() / kMaxChildren;
-    int remainder   = branches->count() % kMaxChildren;
-    int newBranches = 0;
+    const int count = branches->count();
+    int numBranches = count / kMaxChildren;
+    int remainder   = count % kMaxChildren;
 
     if (remainder > 0) {
         ++numBranches;
@@ -123,42 +124,53 @@ SkRTree::Branch SkRTree::bulkLoad(SkTDArray<Branch>* branches, int level) {
         }
     }
 
-    int numStrips = SkScalarCeilToInt(SkScalarSqrt(SkIntToScalar(numBranches) / fAspectRatio));
-    int numTiles  = SkScalarCeilToInt(SkIntToScalar(numBranches) / SkIntToScalar(numStrips));
-    int currentBranch = 0;
+    // Without a sort, the strips and tiles are just runs of consecutive branches: each node takes
+    // kMaxChildren of them, less whatever it can give up (down to kMinChildren) to make up the
+    // remainder.  That lets us find any node's first child directly, and fill the nodes of a
+    // level in any order.
+    auto firstChild = [remainder](int node) {
+        return node * kMaxChildren - SkTMin(node * (kMaxChildren - kMinChildren), remainder);
+    };
 
-    for (int i = 0; i < numStrips; ++i) {
-        // Might be worth sorting by X here too.
-        for (int j = 0; j < numTiles && currentBranch < branches->count(); ++j) {
-            int incrementBy = kMaxChildren;
-            if (remainder != 0) {
-                // if need be, omit some nodes to make up for remainder
-                if (remainder <= kMaxChildren - kMinChildren) {
-                    incrementBy -= remainder;
-                    remainder = 0;
-                } else {
-                    incrementBy = kMinChildren;
-                    remainder -= kMaxChildren - kMinChildren;
-                }
-            }
-            Node* n = allocateNodeAtLevel(level);
-            n->fNumChildren = 1;
-            n->fChildren[0] = (*branches)[currentBranch];
-            Branch b;
-            b.fBounds = (*branches)[currentBranch].fBounds;
-            b.fSubtree = n;
-            ++currentBranch;
-            for (int k = 1; k < incrementBy && currentBranch < branches->count(); ++k) {
-                b.fBounds.join((*branches)[currentBranch].fBounds);
-                n->fChildren[k] = (*branches)[currentBranch];
-                ++n->fNumChildren;
-                ++currentBranch;
+    SkDEBUGCODE(Node* p = fNodes.begin());
+    Node* nodes = fNodes.append(numBranches);
+    SkASSERT(fNodes.begin() == p);  // If this fails, we didn't setReserve() enough.
+
+    SkTDArray<Branch> newBranches;
+    newBranches.setCount(numBranches);
+
+    auto fill = [&](int firstNode, int lastNode) {
+        for (int i = firstNode; i < lastNode; ++i) {
+            const int first = firstChild(i),
+                      last  = SkTMin(firstChild(i + 1), count);
+            Node* n = nodes + i;
+            n->fLevel = level;
+            n->fNumChildren = last - first;
+
+            Branch* b = &newBranches[i];
+            b->fBounds = (*branches)[first].fBounds;
+            b->fSubtree = n;
+            n->fChildren[0] = (*branches)[first];
+            for (int k = first + 1; k < last; ++k) {
+                b->fBounds.join((*branches)[k].fBounds);
+                n->fChildren[k - first] = (*branches)[k];
             }
-            (*branches)[newBranches] = b;
-            ++newBranches;
         }
+    };
+
+    static constexpr int kNodesPerTask = 1024;
+    const int tasks = (numBranches + kNodesPerTask - 1) / kNodesPerTask;
+    if (fExecutor && tasks > 1) {
+        SkTaskGroup group(*fExecutor);
+        group.batch(tasks, [&](int t) {
+            fill(t * kNodesPerTask, SkTMin((t + 1) * kNodesPerTask, numBranches));
+        });
+        group.wait();
+    } else {
+        fill(0, numBranches);
     }
-    branches->setCount(newBranches);
+
+    branches->swap(newBranches);
     return this->bulkLoad(branches, level + 1);
 }
 
@@ -12,6 +12,8 @@
 #include "SkRect.h"
 #include "SkTDArray.h"
 
+class SkExecutor;
+
 /**
  * An R-Tree implementation. In short, it is a balanced n-ary tree containing a hierarchy of
  * bounding rectangles.
@@ -36,8 +38,11 @@ public:
      * If you have some prior information about the distribution of bounds you're expecting, you
      * can provide an optional aspect ratio parameter. This allows the bulk-load algorithm to
      * create better proportioned tiles of rectangles.
+     *
+     * If an executor is given, insert() fills the nodes of each large level of the tree in
+     * parallel on it.
      */
-    explicit SkRTree(SkScalar aspectRatio = 1);
+    explicit SkRTree(SkScalar aspectRatio = 1, SkExecutor* executor = nullptr);
     ~SkRTree() override {}
 
     void insert(const SkRect[], int N) override;
@@ -80,7 +85,7 @@ private:
     // Consumes the input array.
     Branch bulkLoad(SkTDArray<Branch>* branches, int level = 0);
 
-    // How many times will bulkLoad() call allocateNodeAtLevel()?
+    // How many nodes will bulkLoad() allocate?
     static int CountNodes(int branches, SkScalar aspectRatio);
 
     Node* allocateNodeAtLevel(uint16_t level);
@@ -88,6 +93,7 @@ private:
     // This is the count of data elements (rather than total nodes in the tree)
     int fCount;
     SkScalar fAspectRatio;
+    SkExecutor* fExecutor;
     Branch fRoot;
     SkTDArray<Node> fNodes;
 
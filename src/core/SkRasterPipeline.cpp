@@ -8,6 +8,53 @@
 #include "SkRasterPipeline.h"
 #include "SkOpts.h"
 #include <algorithm>
+#include <atomic>
+
+#define M(fused, ...) +1
+static constexpr int kNumFusedStages = SK_RASTER_PIPELINE_FUSED_STAGES(M);
+#undef M
+
+static std::atomic<uint64_t> gFusedStageHits[kNumFusedStages];
+
+uint64_t SkRasterPipeline::FusedStageHits(FusedStage fused) {
+    return gFusedStageHits[fused].load(std::memory_order_relaxed);
+}
+
+template <typename... Stages>
+static constexpr int count_stages(Stages...) { return sizeof...(Stages); }
+
+int SkRasterPipeline::find_fused_run(const StageList* st, int* len) {
+    struct Run {
+        FusedStage fused;
+        int        len;
+        StockStage stages[4];
+    };
+    static const Run kRuns[] = {
+    #define M(fused, ...) { fused, count_stages(__VA_ARGS__), { __VA_ARGS__ } },
+        SK_RASTER_PIPELINE_FUSED_STAGES(M)
+    #undef M
+    };
+
+    // st is the last stage of the run, so we match each run back to front.
+    int best = -1;
+    *len = 0;
+    for (const Run& run : kRuns) {
+        if (run.len <= *len) {
+            continue;
+        }
+        const StageList* prev = st;
+        int i = run.len;
+        while (i > 0 && prev && !prev->rawFunction && prev->stage == (uint64_t)run.stages[i-1]) {
+            prev = prev->prev;
+            i--;
+        }
+        if (i == 0) {
+            best = run.fused;
+            *len = run.len;
+        }
+    }
+    return best;
+}
 
 SkRasterPipeline::SkRasterPipeline(SkArenaAlloc* alloc) : fAlloc(alloc) {
     this->reset();
@@ -259,13 +306,44 @@ void SkRasterPipeline::append_gamut_clamp_if_normalized(const SkImageInfo& dstIn
     }
 }
 
-SkRasterPipeline::StartPipelineFn SkRasterPipeline::build_pipeline(void** ip) const {
+SkRasterPipeline::StartPipelineFn SkRasterPipeline::build_pipeline(void**& ip) const {
     // We'll try to build a lowp pipeline, but if that fails fallback to a highp float pipeline.
     void** reset_point = ip;
 
+    // If a run of stages ending at st can be fused, write its fused stage followed by all the
+    // run's contexts, leaving st at the first stage of the run.
+    int hits[kNumFusedStages] = {};
+    auto fuse = [&](const StageList*& st, const SkOpts::StageFn fusedStages[]) {
+        int len, fused = fFusionEnabled ? find_fused_run(st, &len) : -1;
+        if (fused < 0 || !fusedStages[fused]) {
+            return false;
+        }
+        for (int i = 0; i < len; i++) {
+            if (st->ctx) {
+                *--ip = st->ctx;
+            }
+            if (i+1 < len) {
+                st = st->prev;
+            }
+        }
+        *--ip = (void*)fusedStages[fused];
+        hits[fused]++;
+        return true;
+    };
+    auto count_hits = [&] {
+        for (int i = 0; i < kNumFusedStages; i++) {
+            if (hits[i]) {
+                gFusedStageHits[i].fetch_add(hits[i], std::memory_order_relaxed);
+            }
+        }
+    };
+
     // Stages are stored backwards in fStages, so we reverse here, back to front.
     *--ip = (void*)SkOpts::just_return_lowp;
     for (const StageList* st = fStages; st; st = st->prev) {
+        if (fuse(st, SkOpts::fused_stages_lowp)) {
+            continue;
+        }
         SkOpts::StageFn fn;
         if (!st->rawFunction && (fn = SkOpts::stages_lowp[st->stage])) {
             if (st->ctx) {
@@ -278,11 +356,16 @@ SkRasterPipeline::StartPipelineFn SkRasterPipeline::build_pipeline(void** ip) co
         }
     }
     if (ip != reset_point) {
+        count_hits();
         return SkOpts::start_pipeline_lowp;
     }
 
+    std::fill(std::begin(hits), std::end(hits), 0);
     *--ip = (void*)SkOpts::just_return_highp;
     for (const StageList* st = fStages; st; st = st->prev) {
+        if (fuse(st, SkOpts::fused_stages_highp)) {
+            continue;
+        }
         if (st->ctx) {
             *--ip = st->ctx;
         }
@@ -292,6 +375,7 @@ SkRasterPipeline::StartPipelineFn SkRasterPipeline::build_pipeline(void** ip) co
             *--ip = (void*)SkOpts::stages_highp[st->stage];
         }
     }
+    count_hits();
     return SkOpts::start_pipeline_highp;
 }
 
@@ -303,8 +387,9 @@ void SkRasterPipeline::run(size_t x, size_t y, size_t w, size_t h) const {
     // Best to not use fAlloc here... we can't bound how often run() will be called.
     SkAutoSTMalloc<64, void*> program(fSlotsNeeded);
 
-    auto start_pipeline = this->build_pipeline(program.get() + fSlotsNeeded);
-    start_pipeline(x,y,x+w,y+h, program.get());
+    void** ip = program.get() + fSlotsNeeded;
+    auto start_pipeline = this->build_pipeline(ip);
+    start_pipeline(x,y,x+w,y+h, ip);
 }
 
 std::function<void(size_t, size_t, size_t, size_t)> SkRasterPipeline::compile() const {
@@ -314,7 +399,8 @@ std::function<void(size_t, size_t, size_t, size_t)> SkRasterPipeline::compile()
 
     void** program = fAlloc->makeArray<void*>(fSlotsNeeded);
 
-    auto start_pipeline = this->build_pipeline(program + fSlotsNeeded);
+    program += fSlotsNeeded;
+    auto start_pipeline = this->build_pipeline(program);
     return [=](size_t x, size_t y, size_t w, size_t h) {
         start_pipeline(x,y,x+w,y+h, program);
     };
@@ -49,6 +49,7 @@
     M(load_f32)  M(load_f32_dst)  M(store_f32)  M(gather_f32)      \
     M(load_8888) M(load_8888_dst) M(store_8888) M(gather_8888)     \
     M(load_1010102) M(load_1010102_dst) M(store_1010102) M(gather_1010102) \
+    M(load_yuv)                                                    \
     M(alpha_to_gray) M(alpha_to_gray_dst) M(luminance_to_alpha)    \
     M(bilerp_clamp_8888)                                           \
     M(store_u16_be)                                                \
@@ -95,7 +96,23 @@
     M(gauss_a_to_rgba)                                             \
     M(emboss)
 
-// The largest number of pixels we handle at a time.
+// Runs of stages common enough that we fuse each into a single stage function, running all their
+// bodies back to back without the calls and register shuffling between them.  When a pipeline is
+// built, any run listed here is replaced by its fused stage.
+//
+// Every stage in a run must have a lowp implementation, and (for lowp's sake) a run must not end
+// with a stage that only produces coordinates, like seed_shader or the matrix stages.
+#define SK_RASTER_PIPELINE_FUSED_STAGES(M)                                                    \
+    M(srcover_8888,               load_8888_dst, srcover, store_8888)                         \
+    M(scale_u8_srcover_8888,      scale_u8,      load_8888_dst, srcover, store_8888)          \
+    M(scale_1_float_srcover_8888, scale_1_float, load_8888_dst, srcover, store_8888)          \
+    M(gather_8888_translate,      seed_shader, matrix_translate,       gather_8888)           \
+    M(gather_8888_scale_translate, seed_shader, matrix_scale_translate, gather_8888)          \
+    M(gather_8888_2x3,            seed_shader, matrix_2x3,             gather_8888)           \
+    M(bilerp_clamp_8888_2x3,      seed_shader, matrix_2x3,             bilerp_clamp_8888)
+
+// The largest number of pixels we handle at a time in highp.
+// (lowp may go wider, but never fills more than this many 32-bit lanes in these structs.)
 static const int SkRasterPipeline_kMaxStride = 16;
 
 // Structs representing the arguments to some common stages.
@@ -167,6 +184,15 @@ struct SkRasterPipeline_UniformColorCtx {
     uint16_t rgba[4];  // [0,255] in a 16-bit lane.
 };
 
+// Three planes of 8-bit samples, loaded by load_yuv into r, g, and b.  The U and V planes share
+// a size, and may be subsampled by a power of two in either direction.
+struct SkRasterPipeline_YUVCtx {
+    SkRasterPipeline_MemoryCtx y, u, v;
+    float uvScaleX;   // The width of a U or V sample, in Y samples: 1, 1/2, or 1/4.
+    float uvWidth;
+    int   uvShiftY;   // log2 of the height of a U or V sample, in Y samples.
+};
+
 struct SkRasterPipeline_EmbossCtx {
     SkRasterPipeline_MemoryCtx mul,
                                add;
@@ -191,6 +217,12 @@ public:
         SK_RASTER_PIPELINE_STAGES(M)
     #undef M
     };
+    enum FusedStage {
+    #define M(fused, ...) fused,
+        SK_RASTER_PIPELINE_FUSED_STAGES(M)
+    #undef M
+    };
+
     void append(StockStage, void* = nullptr);
     void append(StockStage stage, const void* ctx) { this->append(stage, const_cast<void*>(ctx)); }
     // For raw functions (i.e. from a JIT).  Don't use this unless you know exactly what fn needs to
@@ -235,6 +267,12 @@ public:
 
     bool empty() const { return fStages == nullptr; }
 
+    // By default runs of stages are replaced by fused stages (see SK_RASTER_PIPELINE_FUSED_STAGES)
+    // when we build the pipeline.  Turning that off is mostly useful for testing and benchmarks.
+    void set_fusion_enabled(bool enabled) { fFusionEnabled = enabled; }
+
+    // How many times has this fused stage been built into any pipeline?
+    static uint64_t FusedStageHits(FusedStage);
 
 private:
     struct StageList {
@@ -245,7 +283,13 @@ private:
     };
 
     using StartPipelineFn = void(*)(size_t,size_t,size_t,size_t, void** program);
-    StartPipelineFn build_pipeline(void**) const;
+    // Writes the program backwards from ip, leaving ip pointing at its first stage.
+    // Fused stages mean the program may not fill all of fSlotsNeeded.
+    StartPipelineFn build_pipeline(void**& ip) const;
+
+    // Finds the longest fusable run of stages ending with st, returning its FusedStage and
+    // setting len to its length, or returning -1 if there's none.
+    static int find_fused_run(const StageList* st, int* len);
 
     void unchecked_append(StockStage, void*);
 
@@ -254,6 +298,7 @@ private:
     StageList*    fStages;
     int           fNumStages;
     int           fSlotsNeeded;
+    bool          fFusionEnabled = true;
 };
 
 template <size_t bytes>
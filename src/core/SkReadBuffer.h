@@ -47,6 +47,8 @@ public:
         kSaveBehind_Version                = 66,
         kSerializeFonts_Version            = 67,
         kPaintDoesntSerializeFonts_Version = 68,
+        kAlignedPictureData_Version        = 69,
+        kPictureOpIndex_Version            = 70,
     };
 
     /**
@@ -255,6 +257,8 @@ public:
         kSaveBehind_Version                = 66,
         kSerializeFonts_Version            = 67,
         kPaintDoesntSerializeFonts_Version = 68,
+        kAlignedPictureData_Version        = 69,
+        kPictureOpIndex_Version            = 70,
     };
 
     bool isVersionLT(Version) const { return false; }
@@ -9,6 +9,9 @@
 #include "SkCanvasPriv.h"
 #include "SkImage.h"
 #include "SkPatchUtils.h"
+#include "SkTaskGroup.h"
+
+#include <vector>
 
 void SkRecordDraw(const SkRecord& record,
                   SkCanvas* canvas,
@@ -167,18 +170,38 @@ template <> void Draw::draw(const DrawDrawable& r) {
 // the block, and control ops are stashed away for later.  When we finish the
 // block with a Restore, our bounds are complete, and we go back and fill them
 // in for all the control ops we stashed away.
+//
+// The bounds of a drawing op depend only on the CTM and the SaveLayer paints in effect when it
+// is drawn, so a large record can be split between threads: a quick pass tracks just that state
+// to the start of each chunk, then each chunk bounds its own drawing ops, and a last pass over
+// the whole record bounds the control ops from them.
 class FillBounds : SkNoncopyable {
 public:
-    FillBounds(const SkRect& cullRect, const SkRecord& record, SkRect bounds[])
+    enum Pass {
+        kAllOps_Pass,      // Bound every op.
+        kStateOnly_Pass,   // Only track the CTM and the Save blocks.
+        kDrawOps_Pass,     // Bound the drawing ops, but not the control ops.
+        kControlOps_Pass,  // Bound the control ops, from the bounds of the drawing ops.
+    };
+
+    FillBounds(const SkRect& cullRect, const SkRecord& record, SkRect bounds[],
+               Pass pass = kAllOps_Pass)
         : fNumRecords(record.count())
         , fCullRect(cullRect)
-        , fBounds(bounds) {
+        , fBounds(bounds)
+        , fPass(pass) {
         fCTM = SkMatrix::I();
 
         // We push an extra save block to track the bounds of any top-level control operations.
         fSaveStack.push_back({ 0, Bounds::MakeEmpty(), nullptr, fCTM });
     }
 
+    // Pick up where a kStateOnly_Pass visitor is, to start part way through the record.
+    void copyStateFrom(const FillBounds& other) {
+        fCTM = other.fCTM;
+        fSaveStack = other.fSaveStack;
+    }
+
     void cleanUp() {
         // If we have any lingering unpaired Saves, simulate restores to make
         // sure all ops in those Save blocks have their bounds calculated.
@@ -255,7 +278,12 @@ private:
     void trackBounds(const Save&)          { this->pushSaveBlock(nullptr); }
     void trackBounds(const SaveLayer& op)  { this->pushSaveBlock(op.paint); }
     void trackBounds(const SaveBehind&)    { this->pushSaveBlock(nullptr); }
-    void trackBounds(const Restore&) { fBounds[fCurrentOp] = this->popSaveBlock(); }
+    void trackBounds(const Restore&) {
+        Bounds bounds = this->popSaveBlock();
+        if (this->boundsControlOps()) {
+            fBounds[fCurrentOp] = bounds;
+        }
+    }
 
     void trackBounds(const SetMatrix&)         { this->pushControl(); }
     void trackBounds(const Concat&)            { this->pushControl(); }
@@ -268,10 +296,21 @@ private:
 
     // For all other ops, we can calculate and store the bounds directly now.
     template <typename T> void trackBounds(const T& op) {
-        fBounds[fCurrentOp] = this->bounds(op);
+        if (kStateOnly_Pass == fPass) {
+            return;
+        }
+        if (kControlOps_Pass != fPass) {
+            fBounds[fCurrentOp] = this->bounds(op);
+        }
         this->updateSaveBounds(fBounds[fCurrentOp]);
     }
 
+    // A kDrawOps_Pass may share fBounds with other threads, so it must leave the bounds of the
+    // control ops alone.  Those may lie in another thread's part of the record.
+    bool boundsControlOps() const {
+        return kAllOps_Pass == fPass || kControlOps_Pass == fPass;
+    }
+
     void pushSaveBlock(const SkPaint* paint) {
         // Starting a new Save block.  Push a new entry to represent that.
         SaveBounds sb;
@@ -325,7 +364,7 @@ private:
         SaveBounds sb;
         fSaveStack.pop(&sb);
 
-        while (sb.controlOps --> 0) {
+        while (this->boundsControlOps() && sb.controlOps --> 0) {
             this->popControl(sb.bounds);
         }
 
@@ -337,6 +376,9 @@ private:
     }
 
     void pushControl() {
+        if (!this->boundsControlOps()) {
+            return;
+        }
         fControlIndices.push_back(fCurrentOp);
         if (!fSaveStack.isEmpty()) {
             fSaveStack.top().controlOps++;
@@ -494,6 +536,8 @@ private:
     // Conservative identity-space bounds for each op in the SkRecord.
     Bounds* fBounds;
 
+    const Pass fPass;
+
     // We walk fCurrentOp through the SkRecord,
     // as we go using updateCTM() to maintain the exact CTM (fCTM).
     int fCurrentOp;
@@ -506,12 +550,51 @@ private:
 
 }  // namespace SkRecords
 
-void SkRecordFillBounds(const SkRect& cullRect, const SkRecord& record, SkRect bounds[]) {
-    SkRecords::FillBounds visitor(cullRect, record, bounds);
-    for (int curOp = 0; curOp < record.count(); curOp++) {
-        visitor.setCurrentOp(curOp);
-        record.visit(curOp, visitor);
+static void fill_bounds(SkRecords::FillBounds* visitor, const SkRecord& record,
+                        int start, int stop) {
+    for (int curOp = start; curOp < stop; curOp++) {
+        visitor->setCurrentOp(curOp);
+        record.visit(curOp, *visitor);
     }
+}
+
+void SkRecordFillBounds(const SkRect& cullRect, const SkRecord& record, SkRect bounds[],
+                        SkExecutor* executor) {
+    using SkRecords::FillBounds;
+
+    // Splitting the record costs two extra (quick) passes over it, so only split large ones.
+    static constexpr int kOpsPerTask = 4096;
+    const int chunks = (record.count() + kOpsPerTask - 1) / kOpsPerTask;
+    if (!executor || chunks < 2) {
+        FillBounds visitor(cullRect, record, bounds);
+        fill_bounds(&visitor, record, 0, record.count());
+        visitor.cleanUp();
+        return;
+    }
+
+    // Find the CTM and Save blocks at the start of each chunk, then bound its drawing ops.
+    {
+        SkTaskGroup tasks(*executor);
+        FillBounds state(cullRect, record, bounds, FillBounds::kStateOnly_Pass);
+        std::vector<std::unique_ptr<FillBounds>> chunkVisitors(chunks);
+        for (int i = 0; i < chunks; i++) {
+            const int start = i * kOpsPerTask,
+                      stop  = SkTMin(start + kOpsPerTask, record.count());
+            chunkVisitors[i].reset(
+                    new FillBounds(cullRect, record, bounds, FillBounds::kDrawOps_Pass));
+            chunkVisitors[i]->copyStateFrom(state);
+            FillBounds* visitor = chunkVisitors[i].get();
+            tasks.add([visitor, &record, start, stop] {
+                fill_bounds(visitor, record, start, stop);
+            });
+            fill_bounds(&state, record, start, stop);
+        }
+        tasks.wait();
+    }
+
+    // Then the control ops, whose bounds are the union of the drawing ops they affect.
+    FillBounds visitor(cullRect, record, bounds, FillBounds::kControlOps_Pass);
+    fill_bounds(&visitor, record, 0, record.count());
     visitor.cleanUp();
 }
 
@@ -15,10 +15,13 @@
 #include "SkRecord.h"
 
 class SkDrawable;
+class SkExecutor;
 class SkLayerInfo;
 
 // Calculate conservative identity space bounds for each op in the record.
-void SkRecordFillBounds(const SkRect& cullRect, const SkRecord&, SkRect bounds[]);
+// If an executor is given, a large record is split into chunks bounded in parallel on it.
+void SkRecordFillBounds(const SkRect& cullRect, const SkRecord&, SkRect bounds[],
+                        SkExecutor* = nullptr);
 
 // SkRecordFillBounds(), and gathers information about saveLayers and stores it for later
 // use (e.g., layer hoisting). The gathered information is sufficient to determine
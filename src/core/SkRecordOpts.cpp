@@ -8,8 +8,11 @@
 #include "SkRecordOpts.h"
 
 #include "SkCanvasPriv.h"
+#include "SkRecordDraw.h"
 #include "SkRecordPattern.h"
 #include "SkRecords.h"
+#include "SkRectPriv.h"
+#include "SkRegion.h"
 #include "SkTDArray.h"
 
 using namespace SkRecords;
@@ -289,6 +292,488 @@ void SkRecordMergeSvgOpacityAndFilterLayers(SkRecord* record) {
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
+struct IsCullable {
+    // A drawable may draw something else by the time the picture is played back.
+    bool operator()(const DrawDrawable&) { return false; }
+    template <typename T>
+    bool operator()(const T&) { return SkToBool(T::kTags & kDraw_Tag); }
+};
+
+void SkRecordNoopCulledDraws(SkRecord* record, const SkRect& cullRect) {
+    // SkRecordFillBounds() gives draws that land wholly outside the cull rect empty bounds, just as
+    // it does draws that can't touch any pixels at all.
+    SkAutoTMalloc<SkRect> bounds(record->count());
+    SkRecordFillBounds(cullRect, *record, bounds.get());
+
+    IsCullable isCullable;
+    for (int i = 0; i < record->count(); i++) {
+        if (bounds[i].isEmpty() && record->visit(i, isCullable)) {
+            record->replace<NoOp>(i);
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// True if drawing paint fills its clip with the same pixels, whatever was there before.
+static bool paints_over_everything(const SkPaint& paint) {
+    if (paint.getShader()      ||
+        paint.getMaskFilter()  ||
+        paint.getImageFilter() ||
+        paint.getLooper()      ||
+        paint.getPathEffect()) {
+        return false;
+    }
+    switch (paint.getBlendMode()) {
+        case SkBlendMode::kClear:
+        case SkBlendMode::kSrc:
+            return true;
+        case SkBlendMode::kSrcOver:
+            return 0xFF == paint.getAlpha() && !paint.getColorFilter();
+        default:
+            return false;
+    }
+}
+
+// Finds draws that a later DrawPaint or opaque DrawRect paints over entirely, and noops them.
+//
+// The clips in effect form a tree: each clip op adds a node whose parent is the clip it narrows.
+// A DrawPaint covers everything an earlier draw in the same layer touched if its clip is the same
+// as, or an ancestor of, the earlier draw's clip, and none of its clips are anti-aliased.  A
+// DrawRect that is not anti-aliased and drawn under a translate covers the same way, but only
+// those draws whose conservative bounds (see SkRecordFillBounds()) lie within the whole pixels
+// inside its rect.
+class OccludedDrawNooper {
+public:
+    explicit OccludedDrawNooper(SkRecord* record) : fRecord(record) {
+        fClips.push_back({-1, false});
+    }
+
+    void run() {
+        for (fIndex = 0; fIndex < fRecord->count() && !fGaveUp; fIndex++) {
+            fRecord->visit(fIndex, *this);
+        }
+    }
+
+    void operator()(const Save&)       { fSaves.push_back({fClip, fMatrix, false}); }
+    void operator()(const SaveLayer&)  { this->saveLayer(); }
+    void operator()(const SaveBehind&) { this->saveLayer(); }
+    void operator()(const Restore&) {
+        if (fSaves.isEmpty()) {
+            fGaveUp = true;
+            return;
+        }
+        if (fSaves.top().fIsLayer) {
+            fPending.rewind();
+        }
+        fClip   = fSaves.top().fClip;
+        fMatrix = fSaves.top().fMatrix;
+        fSaves.pop();
+    }
+
+    void operator()(const SetMatrix& op) { fMatrix = op.matrix; }
+    void operator()(const Concat& op)    { fMatrix.preConcat(op.matrix); }
+    void operator()(const Translate& op) { fMatrix.preTranslate(op.dx, op.dy); }
+
+    void operator()(const ClipPath& op)   { this->clip(op.opAA.op(), op.opAA.aa()); }
+    void operator()(const ClipRRect& op)  { this->clip(op.opAA.op(), op.opAA.aa()); }
+    void operator()(const ClipRect& op)   { this->clip(op.opAA.op(), op.opAA.aa()); }
+    void operator()(const ClipRegion& op) { this->clip(op.op, false); }
+
+    void operator()(const DrawPaint& op) {
+        if (paints_over_everything(op.paint)) {
+            this->cover(nullptr);
+        }
+        fPending.push_back({fIndex, fClip});
+    }
+
+    void operator()(const DrawRect& op) {
+        if (paints_over_everything(op.paint) &&
+            SkPaint::kFill_Style == op.paint.getStyle() &&
+            !op.paint.isAntiAlias() &&
+            fMatrix.isTranslate()) {
+            // Without anti-aliasing, every pixel wholly inside the rect is painted.
+            SkIRect covered;
+            fMatrix.mapRect(op.rect).roundIn(&covered);
+            if (!covered.isEmpty()) {
+                this->cover(&covered);
+            }
+        }
+        fPending.push_back({fIndex, fClip});
+    }
+
+    // These may read what was drawn before them (e.g. with a backdrop filter inside a picture),
+    // and spread it outside their clip, so nothing before them may be noopped.
+    void operator()(const DrawBehind&)   { fPending.rewind(); }
+    void operator()(const DrawDrawable&) { fPending.rewind(); }
+    void operator()(const DrawPicture&)  { fPending.rewind(); }
+
+    template <typename T>
+    SK_WHEN(T::kTags & kDraw_Tag, void) operator()(const T&) {
+        fPending.push_back({fIndex, fClip});
+    }
+    template <typename T>
+    SK_WHEN(!(T::kTags & kDraw_Tag), void) operator()(const T&) {}
+
+private:
+    struct Clip {
+        int  fParent;
+        bool fAA;       // This clip or any it narrows is anti-aliased.
+    };
+    struct SaveRec {
+        int      fClip;
+        SkMatrix fMatrix;
+        bool     fIsLayer;
+    };
+    struct Draw {
+        int fIndex;
+        int fClip;
+    };
+
+    void saveLayer() {
+        fSaves.push_back({fClip, fMatrix, true});
+        fPending.rewind();
+    }
+
+    // Noops the pending draws that a draw in the current clip covers, within covered if not null.
+    void cover(const SkIRect* covered) {
+        if (fClips[fClip].fAA) {
+            return;
+        }
+        if (covered && !fBounds) {
+            // The bounds are the same whatever we noop, so we only need them once.  Nothing clips
+            // playback to the cull rect, so bound the draws as if there were none.
+            fBounds.reset(fRecord->count());
+            SkRecordFillBounds(SkRectPriv::MakeLargeS32(), *fRecord, fBounds.get());
+        }
+        for (int i = fPending.count() - 1; i >= 0; i--) {
+            if (this->isAncestorOrSame(fClip, fPending[i].fClip) &&
+                (!covered || covered->contains(fBounds[fPending[i].fIndex].roundOut()))) {
+                fRecord->replace<NoOp>(fPending[i].fIndex);
+                fPending.removeShuffle(i);
+            }
+        }
+    }
+
+    void clip(SkClipOp op, bool aa) {
+        if (SkClipOp::kIntersect != op && SkClipOp::kDifference != op) {
+            // This clip may grow what came before, so we can no longer tell what covers what.
+            fGaveUp = true;
+            return;
+        }
+        fClips.push_back({fClip, fClips[fClip].fAA || aa});
+        fClip = fClips.count() - 1;
+    }
+
+    // A clip's parent always comes before it.
+    bool isAncestorOrSame(int ancestor, int clip) const {
+        while (clip > ancestor) {
+            clip = fClips[clip].fParent;
+        }
+        return clip == ancestor;
+    }
+
+    SkRecord*             fRecord;
+    int                   fIndex = 0;
+    bool                  fGaveUp = false;
+    SkTDArray<Clip>       fClips;
+    int                   fClip = 0;
+    SkMatrix              fMatrix = SkMatrix::I();
+    SkTDArray<SaveRec>    fSaves;
+    SkTDArray<Draw>       fPending;    // Draws since the last barrier that may yet be covered.
+    SkAutoTMalloc<SkRect> fBounds;     // Each op's bounds, once an occluding DrawRect needs them.
+};
+
+void SkRecordNoopOccludedDraws(SkRecord* record) {
+    OccludedDrawNooper pass(record);
+    pass.run();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Joins Save-ClipRect-Draw*-Restore-Save-ClipRect into one block, if the two clips are the same.
+struct SaveClipRestoreSaveClipMerger {
+    typedef Pattern<Is<Save>,
+                    Is<ClipRect>,
+                    Greedy<Or<Is<NoOp>, IsDraw>>,
+                    Is<Restore>,
+                    Is<Save>,
+                    Is<ClipRect>>
+        Match;
+
+    bool onMatch(SkRecord* record, Match* match, int begin, int end) {
+        const ClipRect* first = match->second<ClipRect>();
+        const ClipRect* second = match->sixth<ClipRect>();
+        if (first->rect != second->rect ||
+            first->opAA.op() != second->opAA.op() ||
+            first->opAA.aa() != second->opAA.aa()) {
+            return false;
+        }
+        record->replace<NoOp>(end-3);  // Restore
+        record->replace<NoOp>(end-2);  // Save
+        record->replace<NoOp>(end-1);  // ClipRect
+        return true;
+    }
+};
+
+// Noops non-anti-aliased clips that repeat one still in effect under the same matrix.
+// Clipping to the same shape again changes nothing, but for anti-aliased clips, we can't count
+// on the partly covered pixels along their edges coming out the same.
+class RepeatedClipNooper {
+public:
+    explicit RepeatedClipNooper(SkRecord* record) : fRecord(record) {}
+
+    void run() {
+        for (fIndex = 0; fIndex < fRecord->count(); fIndex++) {
+            fRecord->visit(fIndex, *this);
+        }
+    }
+
+    void operator()(const Save&)       { this->save(); }
+    void operator()(const SaveLayer&)  { this->save(); }
+    void operator()(const SaveBehind&) { this->save(); }
+    void operator()(const Restore&) {
+        if (fSaves.isEmpty()) {
+            fClips.rewind();
+            fMatrix = fNextMatrix++;
+            return;
+        }
+        fClips.setCount(fSaves.top().fClipCount);
+        fMatrix = fSaves.top().fMatrix;
+        fSaves.pop();
+    }
+
+    void operator()(const SetMatrix&) { fMatrix = fNextMatrix++; }
+    void operator()(const Concat&)    { fMatrix = fNextMatrix++; }
+    void operator()(const Translate&) { fMatrix = fNextMatrix++; }
+
+    void operator()(const ClipRect& op) {
+        this->clip(SkRRect::MakeRect(op.rect), op.opAA);
+    }
+    void operator()(const ClipRRect& op) {
+        this->clip(op.rrect, op.opAA);
+    }
+    void operator()(const ClipPath& op)   { this->otherClip(op.opAA.op()); }
+    void operator()(const ClipRegion& op) { this->otherClip(op.op); }
+
+    template <typename T>
+    void operator()(const T&) {}
+
+private:
+    struct Clip {
+        SkRRect  fShape;
+        SkClipOp fOp;
+        int      fMatrix;
+    };
+    struct SaveRec {
+        int fClipCount;
+        int fMatrix;
+    };
+
+    void save() { fSaves.push_back({fClips.count(), fMatrix}); }
+
+    void clip(const SkRRect& shape, ClipOpAndAA opAA) {
+        if (SkClipOp::kIntersect != opAA.op() && SkClipOp::kDifference != opAA.op()) {
+            this->otherClip(opAA.op());
+            return;
+        }
+        if (opAA.aa()) {
+            return;
+        }
+        // Intersecting and differencing both commute, so any clip in effect can be repeated.
+        for (const Clip& clip : fClips) {
+            if (clip.fMatrix == fMatrix && clip.fOp == opAA.op() && clip.fShape == shape) {
+                fRecord->replace<NoOp>(fIndex);
+                return;
+            }
+        }
+        fClips.push_back({shape, opAA.op(), fMatrix});
+    }
+
+    void otherClip(SkClipOp op) {
+        if (SkClipOp::kIntersect != op && SkClipOp::kDifference != op) {
+            // This clip may grow what came before, so a repeat of an earlier clip may not be.
+            fClips.rewind();
+        }
+    }
+
+    SkRecord*          fRecord;
+    int                fIndex = 0;
+    int                fMatrix = 0;
+    int                fNextMatrix = 1;  // Each change to the matrix gets a new number.
+    SkTDArray<Clip>    fClips;
+    SkTDArray<SaveRec> fSaves;
+};
+
+void SkRecordNoopRedundantClips(SkRecord* record) {
+    RepeatedClipNooper repeats(record);
+    repeats.run();
+
+    SaveClipRestoreSaveClipMerger merger;
+    while (apply(&merger, record));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Can rect be drawn with paint as part of an SkRegion?  Only if the region draws the same pixels,
+// which needs whole pixel, non-anti-aliased rects, and a paint that draws each pixel by itself.
+static bool is_region_rect(const SkPaint& paint, const SkRect& rect) {
+    return SkPaint::kFill_Style == paint.getStyle() &&
+           !paint.isAntiAlias()   &&
+           !paint.getPathEffect() &&
+           !paint.getMaskFilter() &&
+           !paint.getLooper()     &&
+           !paint.getImageFilter() &&
+           !rect.isEmpty()        &&
+           rect == SkRect::Make(rect.round());
+}
+
+// Can this image draw be one entry of a DrawImageSet?  SkCanvas::experimental_DrawImageSetV1()
+// takes just the alpha, anti-aliasing, filter quality, and blend mode from a paint, and won't
+// filter any better than kLow, nor keep to a src rect that is smaller than the image.
+static bool as_image_set_entry(const SkPaint* paint, const sk_sp<const SkImage>& image,
+                               const SkRect& src, const SkRect& dst,
+                               SkCanvas::SrcRectConstraint constraint,
+                               SkCanvas::ImageSetEntry* entry,
+                               SkFilterQuality* quality, SkBlendMode* mode) {
+    const SkRect bounds = SkRect::Make(image->bounds());
+    if (image->isAlphaOnly() || !bounds.contains(src) ||
+        (SkCanvas::kStrict_SrcRectConstraint == constraint && src != bounds)) {
+        return false;
+    }
+    SkPaint defaultPaint;
+    if (!paint) {
+        paint = &defaultPaint;
+    }
+    if (paint->getShader()      ||
+        paint->getColorFilter() ||
+        paint->getMaskFilter()  ||
+        paint->getImageFilter() ||
+        paint->getLooper()      ||
+        paint->isDither()       ||
+        paint->getFilterQuality() > kLow_SkFilterQuality) {
+        return false;
+    }
+    *entry = {image, src, dst, paint->getAlpha() / 255.0f,
+              paint->isAntiAlias() ? SkCanvas::kAll_QuadAAFlags : SkCanvas::kNone_QuadAAFlags};
+    *quality = paint->getFilterQuality();
+    *mode = paint->getBlendMode();
+    return true;
+}
+
+// Merges runs of DrawRects that share a paint into a DrawRegion, and runs of simple DrawImages
+// and DrawImageRects into a DrawImageSet.
+class DrawMerger {
+public:
+    explicit DrawMerger(SkRecord* record) : fRecord(record) {}
+
+    void run() {
+        for (fIndex = 0; fIndex < fRecord->count(); fIndex++) {
+            fRecord->visit(fIndex, *this);
+        }
+        this->flush();
+    }
+
+    void operator()(const NoOp&) {}
+
+    void operator()(const DrawRect& op) {
+        const SkIRect rect = op.rect.round();
+        // Overlapping rects would blend twice where they overlap, where the region blends once.
+        if (kRects != fRun || op.paint != fPaint || fRegion.intersects(rect)) {
+            this->flush();
+            if (!is_region_rect(op.paint, op.rect)) {
+                return;
+            }
+            fRun = kRects;
+            fPaint = op.paint;
+        } else if (!is_region_rect(op.paint, op.rect)) {
+            this->flush();
+            return;
+        }
+        fRegion.op(rect, SkRegion::kUnion_Op);
+        fIndices.push_back(fIndex);
+    }
+
+    void operator()(const DrawImage& op) {
+        const SkRect dst = SkRect::MakeXYWH(op.left, op.top,
+                                            op.image->width(), op.image->height());
+        this->image(op.paint, op.image, SkRect::Make(op.image->bounds()), dst,
+                    SkCanvas::kFast_SrcRectConstraint);
+    }
+
+    void operator()(const DrawImageRect& op) {
+        const SkRect src = op.src ? *op.src : SkRect::Make(op.image->bounds());
+        this->image(op.paint, op.image, src, op.dst, op.constraint);
+    }
+
+    template <typename T>
+    void operator()(const T&) { this->flush(); }
+
+private:
+    enum Run { kNone, kRects, kImages };
+
+    void image(const SkPaint* paint, const sk_sp<const SkImage>& image,
+               const SkRect& src, const SkRect& dst, SkCanvas::SrcRectConstraint constraint) {
+        SkCanvas::ImageSetEntry entry;
+        SkFilterQuality quality;
+        SkBlendMode mode;
+        if (!as_image_set_entry(paint, image, src, dst, constraint, &entry, &quality, &mode)) {
+            this->flush();
+            return;
+        }
+        if (kImages != fRun || quality != fQuality || mode != fMode) {
+            this->flush();
+            fRun = kImages;
+            fQuality = quality;
+            fMode = mode;
+        }
+        fEntries.push_back(std::move(entry));
+        fIndices.push_back(fIndex);
+    }
+
+    void flush() {
+        if (fIndices.count() > 1) {
+            for (int i = 1; i < fIndices.count(); i++) {
+                fRecord->replace<NoOp>(fIndices[i]);
+            }
+            if (kRects == fRun) {
+                new (fRecord->replace<DrawRegion>(fIndices[0])) DrawRegion{fPaint, fRegion};
+            } else {
+                const int count = fEntries.count();
+                SkAutoTArray<SkCanvas::ImageSetEntry> set(count);
+                for (int i = 0; i < count; i++) {
+                    set[i] = std::move(fEntries[i]);
+                }
+                new (fRecord->replace<DrawImageSet>(fIndices[0]))
+                        DrawImageSet{std::move(set), count, fQuality, fMode};
+            }
+        }
+        fRun = kNone;
+        fIndices.rewind();
+        fRegion.setEmpty();
+        fEntries.reset();
+    }
+
+    SkRecord*       fRecord;
+    int             fIndex = 0;
+    Run             fRun = kNone;
+    SkTDArray<int>  fIndices;   // The ops in the current run.
+
+    SkPaint         fPaint;
+    SkRegion        fRegion;
+
+    SkTArray<SkCanvas::ImageSetEntry> fEntries;
+    SkFilterQuality fQuality = kNone_SkFilterQuality;
+    SkBlendMode     fMode = SkBlendMode::kSrcOver;
+};
+
+void SkRecordMergeDraws(SkRecord* record) {
+    DrawMerger pass(record);
+    pass.run();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
 void SkRecordOptimize(SkRecord* record) {
     // This might be useful  as a first pass in the future if we want to weed
     // out junk for other optimization passes.  Right now, nothing needs it,
@@ -310,14 +795,69 @@ void SkRecordOptimize(SkRecord* record) {
     record->defrag();
 }
 
-void SkRecordOptimize2(SkRecord* record) {
-    multiple_set_matrices(record);
-    SkRecordNoopSaveRestores(record);
+int SkRecordOptimizeStats::total() const {
+    return fSetMatrices + fCulledDraws + fOccludedDraws + fRedundantClips + fMergedDraws +
+           fSaveRestores + fSaveLayers + fSvgLayers;
+}
+
+struct IsNoOp {
+    bool operator()(const NoOp&) { return true; }
+    template <typename T>
+    bool operator()(const T&) { return false; }
+};
+
+static int count_noops(const SkRecord& record) {
+    IsNoOp isNoOp;
+    int count = 0;
+    for (int i = 0; i < record.count(); i++) {
+        count += record.visit(i, isNoOp);
+    }
+    return count;
+}
+
+// Runs pass, adding the number of ops it turns into NoOps to *noopped, if that's not null.
+template <typename Pass>
+static void measure(SkRecord* record, int* noopped, Pass&& pass) {
+    const int before = noopped ? count_noops(*record) : 0;
+    pass();
+    if (noopped) {
+        *noopped += count_noops(*record) - before;
+    }
+}
+
+void SkRecordOptimize2(SkRecord* record, const SkRect& cullRect, SkRecordOptimizeStats* stats) {
+    // Find how many ops each pass removes only if we're asked to.
+    auto noopped = [stats](int SkRecordOptimizeStats::* count) {
+        return stats ? &(stats->*count) : nullptr;
+    };
+
+    measure(record, noopped(&SkRecordOptimizeStats::fSetMatrices), [&] {
+        multiple_set_matrices(record);
+    });
+    measure(record, noopped(&SkRecordOptimizeStats::fCulledDraws), [&] {
+        SkRecordNoopCulledDraws(record, cullRect);
+    });
+    measure(record, noopped(&SkRecordOptimizeStats::fOccludedDraws), [&] {
+        SkRecordNoopOccludedDraws(record);
+    });
+    measure(record, noopped(&SkRecordOptimizeStats::fRedundantClips), [&] {
+        SkRecordNoopRedundantClips(record);
+    });
+    measure(record, noopped(&SkRecordOptimizeStats::fMergedDraws), [&] {
+        SkRecordMergeDraws(record);
+    });
+    measure(record, noopped(&SkRecordOptimizeStats::fSaveRestores), [&] {
+        SkRecordNoopSaveRestores(record);
+    });
     // See why we turn this off in SkRecordOptimize above.
 #ifndef SK_BUILD_FOR_ANDROID_FRAMEWORK
-    SkRecordNoopSaveLayerDrawRestores(record);
+    measure(record, noopped(&SkRecordOptimizeStats::fSaveLayers), [&] {
+        SkRecordNoopSaveLayerDrawRestores(record);
+    });
 #endif
-    SkRecordMergeSvgOpacityAndFilterLayers(record);
+    measure(record, noopped(&SkRecordOptimizeStats::fSvgLayers), [&] {
+        SkRecordMergeSvgOpacityAndFilterLayers(record);
+    });
 
     record->defrag();
 }
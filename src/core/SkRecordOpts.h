@@ -26,7 +26,38 @@ void SkRecordNoopSaveLayerDrawRestores(SkRecord*);
 // the alpha of the first SaveLayer to the second SaveLayer.
 void SkRecordMergeSvgOpacityAndFilterLayers(SkRecord*);
 
-// Experimental optimizers
-void SkRecordOptimize2(SkRecord*);
+// Turns draws that would land wholly outside cullRect into NoOps.
+void SkRecordNoopCulledDraws(SkRecord*, const SkRect& cullRect);
+
+// Turns draws that a later DrawPaint (e.g. a clear), or opaque, aliased and untransformed but for a
+// translate DrawRect, paints over entirely into NoOps.  This ignores any anti-aliased clip around
+// the whole playback, along whose edges those draws would still show through a little.
+void SkRecordNoopOccludedDraws(SkRecord*);
+
+// Turns clips that repeat one already in effect into NoOps, and joins Save-ClipRect-Draw*-Restore
+// blocks that clip to the same rect.
+void SkRecordNoopRedundantClips(SkRecord*);
+
+// Merges runs of DrawRects that share a paint into a DrawRegion, and runs of DrawImages and
+// DrawImageRects that need nothing more of their paints than an SkCanvas::ImageSetEntry holds into
+// a DrawImageSet.
+void SkRecordMergeDraws(SkRecord*);
+
+// How many ops each pass of SkRecordOptimize2() turned into NoOps.
+struct SkRecordOptimizeStats {
+    int fSetMatrices    = 0;
+    int fCulledDraws    = 0;
+    int fOccludedDraws  = 0;
+    int fRedundantClips = 0;
+    int fMergedDraws    = 0;
+    int fSaveRestores   = 0;
+    int fSaveLayers     = 0;
+    int fSvgLayers      = 0;
+
+    int total() const;
+};
+
+// Experimental optimizers.  If stats is not null, adds what each pass removed to it.
+void SkRecordOptimize2(SkRecord*, const SkRect& cullRect, SkRecordOptimizeStats* stats = nullptr);
 
 #endif//SkRecordOpts_DEFINED
@@ -142,6 +142,8 @@ public:
     template <typename T> T* second() { return fRest.template first<T>();  }
     template <typename T> T* third()  { return fRest.template second<T>(); }
     template <typename T> T* fourth() { return fRest.template third<T>();  }
+    template <typename T> T* fifth()  { return fRest.template fourth<T>(); }
+    template <typename T> T* sixth()  { return fRest.template fifth<T>();  }
 
 private:
     // If first isn't a Greedy, try to match at i once.
@@ -11,6 +11,7 @@
 #include "SkMessageBus.h"
 #include "SkMipMap.h"
 #include "SkMutex.h"
+#include "SkOnce.h"
 #include "SkOpts.h"
 #include "SkTo.h"
 #include "SkTraceMemoryDump.h"
@@ -84,6 +85,7 @@ void SkResourceCache::init() {
     fTotalBytesUsed = 0;
     fCount = 0;
     fSingleAllocationByteLimit = 0;
+    fDiscardableCountLimit = SK_DISCARDABLEMEMORY_SCALEDIMAGECACHE_COUNT_LIMIT;
 
     // One of these should be explicit set by the caller after we return.
     fTotalByteLimit = 0;
@@ -203,7 +205,7 @@ void SkResourceCache::purgeAsNeeded(bool forcePurge) {
     int    countLimit;
 
     if (fDiscardableFactory) {
-        countLimit = SK_DISCARDABLEMEMORY_SCALEDIMAGECACHE_COUNT_LIMIT;
+        countLimit = fDiscardableCountLimit;
         byteLimit = UINT32_MAX;  // no limit based on bytes
     } else {
         countLimit = SK_MaxS32; // no limit based on count
@@ -449,85 +451,216 @@ void SkResourceCache::checkMessages() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-SK_DECLARE_STATIC_MUTEX(gMutex);
-static SkResourceCache* gResourceCache = nullptr;
+SkShardedResourceCache::SkShardedResourceCache(int shardCount,
+                                               SkResourceCache::DiscardableFactory factory)
+        : fDiscardableFactory(factory) {
+    SkASSERT(shardCount > 0);
+    for (int i = 0; i < shardCount; ++i) {
+        fShards.emplace_back(new Shard(factory));
+        // Split the count limit like we split byte budgets, but never below one entry.
+        fShards[i]->fCache.fDiscardableCountLimit =
+                SkTMax(1, SK_DISCARDABLEMEMORY_SCALEDIMAGECACHE_COUNT_LIMIT / shardCount);
+    }
+}
+
+SkShardedResourceCache::SkShardedResourceCache(int shardCount, size_t byteLimit)
+        : fDiscardableFactory(nullptr) {
+    SkASSERT(shardCount > 0);
+    for (int i = 0; i < shardCount; ++i) {
+        fShards.emplace_back(new Shard(byteLimit));
+    }
+    this->divideByteLimit(byteLimit);
+}
+
+SkShardedResourceCache::~SkShardedResourceCache() {}
+
+size_t SkShardedResourceCache::divideByteLimit(size_t byteLimit) {
+    const size_t count = fShards.count();
+    size_t prevLimit = 0;
+    for (size_t i = 0; i < count; ++i) {
+        // Hand out the remainder one byte at a time so the slices add up to the total.
+        size_t slice = byteLimit / count + (i < byteLimit % count ? 1 : 0);
+        SkAutoMutexAcquire am(fShards[i]->fMutex);
+        prevLimit += fShards[i]->fCache.setTotalByteLimit(slice);
+    }
+    return prevLimit;
+}
+
+bool SkShardedResourceCache::find(const Key& key, SkResourceCache::FindVisitor visitor,
+                                  void* context) {
+    Shard* shard = this->shardFor(key);
+    SkAutoMutexAcquire am(shard->fMutex);
+    return shard->fCache.find(key, visitor, context);
+}
 
-/** Must hold gMutex when calling. */
-static SkResourceCache* get_cache() {
-    // gMutex is always held when this is called, so we don't need to be fancy in here.
-    gMutex.assertHeld();
-    if (nullptr == gResourceCache) {
+void SkShardedResourceCache::add(Rec* rec, void* payload) {
+    Shard* shard = this->shardFor(rec->getKey());
+    SkAutoMutexAcquire am(shard->fMutex);
+    shard->fCache.add(rec, payload);
+}
+
+void SkShardedResourceCache::visitAll(SkResourceCache::Visitor visitor, void* context) {
+    for (const auto& shard : fShards) {
+        SkAutoMutexAcquire am(shard->fMutex);
+        shard->fCache.visitAll(visitor, context);
+    }
+}
+
+size_t SkShardedResourceCache::getTotalBytesUsed() const {
+    size_t used = 0;
+    for (const auto& shard : fShards) {
+        SkAutoMutexAcquire am(shard->fMutex);
+        used += shard->fCache.getTotalBytesUsed();
+    }
+    return used;
+}
+
+size_t SkShardedResourceCache::getTotalByteLimit() const {
+    size_t limit = 0;
+    for (const auto& shard : fShards) {
+        SkAutoMutexAcquire am(shard->fMutex);
+        limit += shard->fCache.getTotalByteLimit();
+    }
+    return limit;
+}
+
+size_t SkShardedResourceCache::setTotalByteLimit(size_t newLimit) {
+    if (fDiscardableFactory) {
+        return 0;
+    }
+    return this->divideByteLimit(newLimit);
+}
+
+size_t SkShardedResourceCache::setSingleAllocationByteLimit(size_t newLimit) {
+    size_t oldLimit = 0;
+    for (const auto& shard : fShards) {
+        SkAutoMutexAcquire am(shard->fMutex);
+        oldLimit = shard->fCache.setSingleAllocationByteLimit(newLimit);
+    }
+    return oldLimit;
+}
+
+size_t SkShardedResourceCache::getSingleAllocationByteLimit() const {
+    SkAutoMutexAcquire am(fShards[0]->fMutex);
+    return fShards[0]->fCache.getSingleAllocationByteLimit();
+}
+
+size_t SkShardedResourceCache::getEffectiveSingleAllocationByteLimit() const {
+    // An allocation has to fit in whichever shard its key lands in, so answer for the shard
+    // with the smallest budget.
+    size_t limit = SIZE_MAX;
+    for (const auto& shard : fShards) {
+        SkAutoMutexAcquire am(shard->fMutex);
+        limit = SkTMin(limit, shard->fCache.getEffectiveSingleAllocationByteLimit());
+    }
+    return limit;
+}
+
+void SkShardedResourceCache::purgeSharedID(uint64_t sharedID) {
+    for (const auto& shard : fShards) {
+        SkAutoMutexAcquire am(shard->fMutex);
+        shard->fCache.purgeSharedID(sharedID);
+    }
+}
+
+void SkShardedResourceCache::purgeAll() {
+    for (const auto& shard : fShards) {
+        SkAutoMutexAcquire am(shard->fMutex);
+        shard->fCache.purgeAll();
+    }
+}
+
+SkCachedData* SkShardedResourceCache::newCachedData(size_t bytes) {
+    // This doesn't touch any shard's state, so there's nothing to lock.  Each shard still picks
+    // up pending purge messages on its next find() or add().
+    if (fDiscardableFactory) {
+        SkDiscardableMemory* dm = fDiscardableFactory(bytes);
+        return dm ? new SkCachedData(bytes, dm) : nullptr;
+    } else {
+        return new SkCachedData(sk_malloc_throw(bytes), bytes);
+    }
+}
+
+void SkShardedResourceCache::dump() const {
+    SkDebugf("SkShardedResourceCache: shards=%d\n", fShards.count());
+    for (const auto& shard : fShards) {
+        SkAutoMutexAcquire am(shard->fMutex);
+        shard->fCache.dump();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// This can be defined by the caller's build system to spread the global cache over several
+// independently locked shards.
+#ifndef SK_RESOURCE_CACHE_SHARD_COUNT
+    #define SK_RESOURCE_CACHE_SHARD_COUNT 1
+#endif
+
+static SkShardedResourceCache* get_cache() {
+    static SkShardedResourceCache* gResourceCache;
+    static SkOnce once;
+    once([] {
 #ifdef SK_USE_DISCARDABLE_SCALEDIMAGECACHE
-        gResourceCache = new SkResourceCache(SkDiscardableMemory::Create);
+        gResourceCache = new SkShardedResourceCache(SK_RESOURCE_CACHE_SHARD_COUNT,
+                                                    SkDiscardableMemory::Create);
 #else
-        gResourceCache = new SkResourceCache(SK_DEFAULT_IMAGE_CACHE_LIMIT);
+        gResourceCache = new SkShardedResourceCache(SK_RESOURCE_CACHE_SHARD_COUNT,
+                                                    SK_DEFAULT_IMAGE_CACHE_LIMIT);
 #endif
-    }
+    });
     return gResourceCache;
 }
 
 size_t SkResourceCache::GetTotalBytesUsed() {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->getTotalBytesUsed();
 }
 
 size_t SkResourceCache::GetTotalByteLimit() {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->getTotalByteLimit();
 }
 
 size_t SkResourceCache::SetTotalByteLimit(size_t newLimit) {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->setTotalByteLimit(newLimit);
 }
 
 SkResourceCache::DiscardableFactory SkResourceCache::GetDiscardableFactory() {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->discardableFactory();
 }
 
 SkCachedData* SkResourceCache::NewCachedData(size_t bytes) {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->newCachedData(bytes);
 }
 
 void SkResourceCache::Dump() {
-    SkAutoMutexAcquire am(gMutex);
     get_cache()->dump();
 }
 
 size_t SkResourceCache::SetSingleAllocationByteLimit(size_t size) {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->setSingleAllocationByteLimit(size);
 }
 
 size_t SkResourceCache::GetSingleAllocationByteLimit() {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->getSingleAllocationByteLimit();
 }
 
 size_t SkResourceCache::GetEffectiveSingleAllocationByteLimit() {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->getEffectiveSingleAllocationByteLimit();
 }
 
 void SkResourceCache::PurgeAll() {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->purgeAll();
 }
 
 bool SkResourceCache::Find(const Key& key, FindVisitor visitor, void* context) {
-    SkAutoMutexAcquire am(gMutex);
     return get_cache()->find(key, visitor, context);
 }
 
 void SkResourceCache::Add(Rec* rec, void* payload) {
-    SkAutoMutexAcquire am(gMutex);
     get_cache()->add(rec, payload);
 }
 
 void SkResourceCache::VisitAll(Visitor visitor, void* context) {
-    SkAutoMutexAcquire am(gMutex);
     get_cache()->visitAll(visitor, context);
 }
 
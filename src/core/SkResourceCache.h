@@ -10,8 +10,12 @@
 
 #include "SkBitmap.h"
 #include "SkMessageBus.h"
+#include "SkMutex.h"
+#include "SkTArray.h"
 #include "SkTDArray.h"
 
+#include <memory>
+
 class SkCachedData;
 class SkDiscardableMemory;
 class SkTraceMemoryDump;
@@ -25,6 +29,8 @@ class SkTraceMemoryDump;
  *
  *  As a convenience, a global instance is also defined, which can be safely
  *  access across threads via the static methods (e.g. FindAndLock, etc.).
+ *  The global instance is an SkShardedResourceCache with SK_RESOURCE_CACHE_SHARD_COUNT
+ *  shards (by default 1, i.e. a single lock).
  */
 class SkResourceCache {
 public:
@@ -269,6 +275,7 @@ private:
     size_t  fTotalByteLimit;
     size_t  fSingleAllocationByteLimit;
     int     fCount;
+    int     fDiscardableCountLimit;
 
     SkMessageBus<PurgeSharedIDMessage>::Inbox fPurgeSharedIDInbox;
 
@@ -288,5 +295,72 @@ private:
 #else
     void validate() const {}
 #endif
+
+    friend class SkShardedResourceCache;
 };
+
+/**
+ *  A thread-safe cache that hashes each Key to one of several SkResourceCaches ("shards"),
+ *  each guarded by its own mutex, so that threads looking up unrelated keys rarely contend.
+ *
+ *  Each shard keeps its own LRU list and an equal slice of the total budget (or of the
+ *  discardable count limit), so together they never hold more than the total.  The flip side
+ *  is that a single allocation is limited to one shard's slice, and LRU order is only kept
+ *  within each shard.  With one shard this behaves exactly like a mutex around SkResourceCache.
+ */
+class SkShardedResourceCache {
+public:
+    typedef SkResourceCache::Key Key;
+    typedef SkResourceCache::Rec Rec;
+
+    SkShardedResourceCache(int shardCount, SkResourceCache::DiscardableFactory);
+    SkShardedResourceCache(int shardCount, size_t byteLimit);
+    ~SkShardedResourceCache();
+
+    int shardCount() const { return fShards.count(); }
+
+    bool find(const Key&, SkResourceCache::FindVisitor, void* context);
+    void add(Rec*, void* payload = nullptr);
+
+    // Visits each shard in turn, holding only that shard's lock.
+    void visitAll(SkResourceCache::Visitor, void* context);
+
+    size_t getTotalBytesUsed() const;
+    size_t getTotalByteLimit() const;
+    size_t setTotalByteLimit(size_t newLimit);
+
+    size_t setSingleAllocationByteLimit(size_t maximumAllocationSize);
+    size_t getSingleAllocationByteLimit() const;
+    size_t getEffectiveSingleAllocationByteLimit() const;
+
+    void purgeSharedID(uint64_t sharedID);
+    void purgeAll();
+
+    SkResourceCache::DiscardableFactory discardableFactory() const { return fDiscardableFactory; }
+
+    SkCachedData* newCachedData(size_t bytes);
+
+    void dump() const;
+
+private:
+    struct Shard {
+        template <typename... Args>
+        Shard(Args&&... args) : fCache(std::forward<Args>(args)...) {}
+
+        mutable SkMutex fMutex;
+        SkResourceCache fCache;
+    };
+
+    Shard* shardFor(const Key& key) const {
+        // Use the high bits of the hash; each shard's hash table indexes with the low bits.
+        return fShards[(int)(((uint64_t)key.hash() * fShards.count()) >> 32)].get();
+    }
+
+    // Splits byteLimit between the shards, returning the previous total.
+    size_t divideByteLimit(size_t byteLimit);
+
+    SkTArray<std::unique_ptr<Shard>>    fShards;
+    SkResourceCache::DiscardableFactory fDiscardableFactory;
+};
+
 #endif
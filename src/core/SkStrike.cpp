@@ -121,6 +121,79 @@ SkGlyph* SkStrike::lookupByPackedGlyphID(SkPackedGlyphID packedGlyphID, MetricsT
     return glyphPtr;
 }
 
+const SkGlyph* SkStrike::SharedGlyphTable::find(SkPackedGlyphID id) const {
+    const int mask = fCapacity - 1;
+    for (int i = id.hash() & mask; ; i = (i + 1) & mask) {
+        const SkGlyph* glyph = fSlots[i].load(std::memory_order_acquire);
+        if (glyph == nullptr || glyph->getPackedID() == id) {
+            return glyph;
+        }
+    }
+}
+
+void SkStrike::SharedGlyphTable::add(SkGlyph* glyph) {
+    SkASSERT(2 * (fCount + 1) <= fCapacity);
+    const int mask = fCapacity - 1;
+    int i = glyph->getPackedID().hash() & mask;
+    while (fSlots[i].load(std::memory_order_relaxed) != nullptr) {
+        i = (i + 1) & mask;
+    }
+    // Release, so anyone who sees this glyph sees all of its metrics and its image.
+    fSlots[i].store(glyph, std::memory_order_release);
+    fCount++;
+}
+
+const SkGlyph& SkStrike::getSharedGlyph(SkPackedGlyphID id, size_t* memoryAdded) {
+    if (const SharedGlyphTable* table = fSharedGlyphs.load(std::memory_order_acquire)) {
+        if (const SkGlyph* glyph = table->find(id)) {
+            return *glyph;
+        }
+    }
+
+    SkAutoMutexAcquire lock(fSharedMutex);
+    SharedGlyphTable* table = fSharedGlyphs.load(std::memory_order_relaxed);
+    if (table) {
+        // Another thread may have published this glyph while we waited for the lock.
+        if (const SkGlyph* glyph = table->find(id)) {
+            return *glyph;
+        }
+    }
+
+    const size_t memoryUsed = fMemoryUsed;
+    SkGlyph* glyph = this->lookupByPackedGlyphID(id, kFull_MetricsType);
+    this->findImage(*glyph);
+
+    if (table == nullptr || 2 * (table->fCount + 1) > table->fCapacity) {
+        const int capacity = table ? 2 * table->fCapacity : kMinSharedGlyphs;
+        SharedGlyphTable* grown = fAlloc.make<SharedGlyphTable>();
+        grown->fCapacity = capacity;
+        grown->fCount    = 0;
+        grown->fSlots    = fAlloc.makeArray<std::atomic<SkGlyph*>>(capacity);
+        fMemoryUsed += sizeof(SharedGlyphTable) + capacity * sizeof(std::atomic<SkGlyph*>);
+        if (table) {
+            for (int i = 0; i < table->fCapacity; i++) {
+                if (SkGlyph* old = table->fSlots[i].load(std::memory_order_relaxed)) {
+                    grown->add(old);
+                }
+            }
+        }
+        fSharedGlyphs.store(grown, std::memory_order_release);
+        table = grown;
+    }
+    table->add(glyph);
+    *memoryAdded += fMemoryUsed - memoryUsed;
+    return *glyph;
+}
+
+const SkGlyph& SkStrike::getSharedGlyph(SkGlyphID glyphID, SkPoint position,
+                                        size_t* memoryAdded) {
+    if (!fIsSubpixel) {
+        return this->getSharedGlyph(SkPackedGlyphID(glyphID), memoryAdded);
+    }
+    SkIPoint lookupPosition = SkStrikeCommon::SubpixelLookup(fAxisAlignment, position);
+    return this->getSharedGlyph(SkPackedGlyphID(glyphID, lookupPosition), memoryAdded);
+}
+
 const void* SkStrike::findImage(const SkGlyph& glyph) {
     if (glyph.fWidth > 0 && glyph.fWidth < kMaxGlyphWidth) {
         if (nullptr == glyph.fImage) {
@@ -459,6 +532,12 @@ void SkStrike::forceValidate() const {
             memoryUsed += compute_path_size(glyphPtr->fPathData->fPath);
         }
     });
+    // Each shared glyph table is twice the size of the one before, and they're all still here.
+    if (const SharedGlyphTable* table = fSharedGlyphs.load(std::memory_order_acquire)) {
+        for (int capacity = kMinSharedGlyphs; capacity <= table->fCapacity; capacity *= 2) {
+            memoryUsed += sizeof(SharedGlyphTable) + capacity * sizeof(std::atomic<SkGlyph*>);
+        }
+    }
     SkASSERT(fMemoryUsed == memoryUsed);
 }
 
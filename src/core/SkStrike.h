@@ -13,11 +13,13 @@
 #include "SkFontTypes.h"
 #include "SkGlyph.h"
 #include "SkGlyphRunPainter.h"
+#include "SkMutex.h"
 #include "SkPaint.h"
 #include "SkTHash.h"
 #include "SkScalerContext.h"
 #include "SkStrikeInterface.h"
 #include "SkTemplates.h"
+#include <atomic>
 #include <memory>
 
 /** \class SkGlyphCache
@@ -31,7 +33,8 @@
     either Find{OrCreate}Exclusive().
 
     The Find*Exclusive() method returns SkExclusiveStrikePtr, which releases exclusive ownership
-    when they go out of scope.
+    when they go out of scope.  FindOrCreateStrikeShared() instead returns a SharedStrikePtr,
+    which many threads can hold at once, each looking up glyphs with getSharedGlyph().
 */
 class SkStrike final : public SkStrikeInterface {
 public:
@@ -66,6 +69,19 @@ public:
 
     void getAdvances(SkSpan<const SkGlyphID>, SkPoint[]);
 
+    /** Returns a glyph with all fields valid, and its image (if it has one) already found, as
+        if by getGlyphIDMetrics() and findImage().  This is the only call that is safe to make
+        from several threads at once: glyphs are looked up without locking once they have been
+        generated, and generating them is serialized on a per-strike mutex.  A shared strike must
+        not be used through any other call until every thread is done with it, except by an
+        SkExclusiveStrikePtr, which holds that mutex.  Adds to
+        memoryAdded how many bytes the strike grew by, if it had to generate the glyph.
+    */
+    const SkGlyph& getSharedGlyph(SkPackedGlyphID, size_t* memoryAdded);
+
+    /** Like getGlyphMetrics(), but for a shared strike, as getSharedGlyph(). */
+    const SkGlyph& getSharedGlyph(SkGlyphID, SkPoint position, size_t* memoryAdded);
+
     /** Returns the number of glyphs for this strike.
     */
     unsigned getGlyphCount() const;
@@ -174,6 +190,8 @@ public:
     };
 
 private:
+    friend class SkStrikeCache;   // Locks fSharedMutex to look at a shared strike.
+
     enum MetricsType {
         kNothing_MetricsType,
         kJustAdvance_MetricsType,
@@ -231,6 +249,23 @@ private:
 
     SkArenaAlloc            fAlloc {kMinAllocAmount};
 
+    // The glyphs getSharedGlyph() has finished, in an open-addressed table that readers probe
+    // without locking.  Slots are only ever filled, never changed, so a reader sees either a
+    // null slot (and takes fSharedMutex to look again) or a complete glyph.  When a table gets
+    // half full we publish a copy twice its size; old tables stay alive in fAlloc.
+    struct SharedGlyphTable {
+        const SkGlyph* find(SkPackedGlyphID) const;
+        void add(SkGlyph*);
+
+        int                    fCapacity;   // A power of 2.
+        int                    fCount;
+        std::atomic<SkGlyph*>* fSlots;
+    };
+    static constexpr int kMinSharedGlyphs = 64;
+
+    SkMutex                        fSharedMutex;   // Guards everything else in shared strikes.
+    std::atomic<SharedGlyphTable*> fSharedGlyphs{nullptr};
+
     // used to track (approx) how much ram is tied-up in this cache
     size_t                  fMemoryUsed;
 
@@ -61,6 +61,11 @@ public:
     SkStrikeCache* const            fStrikeCache;
     Node*                           fNext{nullptr};
     Node*                           fPrev{nullptr};
+    int                             fSharedRefs{0};   // Guarded by fStrikeCache->fLock.
+    // Set while an exclusive find holds this strike though it is shared, along with how big the
+    // strike was then.  Guarded by fStrike.fSharedMutex, which that find holds.
+    bool                            fLockedShared{false};
+    size_t                          fMemoryUsedWhenLocked{0};
     SkStrike                        fStrike;
     std::unique_ptr<SkStrikePinner> fPinner;
 };
@@ -126,6 +131,70 @@ bool operator == (decltype(nullptr), const SkStrikeCache::ExclusiveStrikePtr& rh
     return nullptr == rhs.fNode;
 }
 
+SkStrikeCache::SharedStrikePtr::SharedStrikePtr(SkStrikeCache::Node* node)
+    : fNode{node} {}
+
+SkStrikeCache::SharedStrikePtr::SharedStrikePtr()
+    : fNode{nullptr} {}
+
+SkStrikeCache::SharedStrikePtr::SharedStrikePtr(SharedStrikePtr&& o)
+    : fNode{o.fNode} {
+    o.fNode = nullptr;
+}
+
+SkStrikeCache::SharedStrikePtr&
+SkStrikeCache::SharedStrikePtr::operator = (SharedStrikePtr&& o) {
+    if (fNode != nullptr) {
+        fNode->fStrikeCache->releaseSharedNode(fNode);
+    }
+    fNode = o.fNode;
+    o.fNode = nullptr;
+    return *this;
+}
+
+SkStrikeCache::SharedStrikePtr::~SharedStrikePtr() {
+    if (fNode != nullptr) {
+        fNode->fStrikeCache->releaseSharedNode(fNode);
+    }
+}
+
+const SkGlyph& SkStrikeCache::SharedStrikePtr::getGlyphIDMetrics(
+        SkGlyphID glyphID, SkFixed x, SkFixed y) const {
+    size_t memoryAdded = 0;
+    const SkGlyph& glyph = fNode->fStrike.getSharedGlyph(SkPackedGlyphID(glyphID, x, y),
+                                                         &memoryAdded);
+    if (memoryAdded > 0) {
+        fNode->fStrikeCache->addSharedMemoryUsed(memoryAdded);
+    }
+    return glyph;
+}
+
+const SkGlyph& SkStrikeCache::SharedStrikePtr::getGlyphMetrics(
+        SkGlyphID glyphID, SkPoint position) const {
+    size_t memoryAdded = 0;
+    const SkGlyph& glyph = fNode->fStrike.getSharedGlyph(glyphID, position, &memoryAdded);
+    if (memoryAdded > 0) {
+        fNode->fStrikeCache->addSharedMemoryUsed(memoryAdded);
+    }
+    return glyph;
+}
+
+SkVector SkStrikeCache::SharedStrikePtr::rounding() const {
+    return fNode->fStrike.rounding();
+}
+
+const SkFontMetrics& SkStrikeCache::SharedStrikePtr::getFontMetrics() const {
+    return fNode->fStrike.getFontMetrics();
+}
+
+const SkDescriptor& SkStrikeCache::SharedStrikePtr::getDescriptor() const {
+    return fNode->fStrike.getDescriptor();
+}
+
+SkStrikeCache::SharedStrikePtr::operator bool () const {
+    return fNode != nullptr;
+}
+
 SkStrikeCache::~SkStrikeCache() {
     Node* node = fHead;
     while (node) {
@@ -220,6 +289,41 @@ auto SkStrikeCache::findOrCreateStrike(
     return this->findOrCreateStrike(*desc, effects, *tf);
 }
 
+SkSharedStrikePtr SkStrikeCache::FindOrCreateStrikeShared(
+        const SkDescriptor& desc, const SkScalerContextEffects& effects, const SkTypeface& typeface)
+{
+    return GlobalStrikeCache()->findOrCreateStrikeShared(desc, effects, typeface);
+}
+
+SkSharedStrikePtr SkStrikeCache::findOrCreateStrikeShared(
+        const SkDescriptor& desc, const SkScalerContextEffects& effects, const SkTypeface& typeface)
+{
+    Node* node = this->findAndShareStrike(desc);
+    if (node == nullptr) {
+        auto scaler = CreateScalerContext(desc, effects, typeface);
+        node = this->shareNewStrike(this->createStrike(desc, std::move(scaler)));
+    }
+    return SkSharedStrikePtr(node);
+}
+
+SkSharedStrikePtr SkStrikeCache::FindOrCreateStrikeShared(
+        const SkFont& font,
+        const SkPaint& paint,
+        const SkSurfaceProps& surfaceProps,
+        SkScalerContextFlags scalerContextFlags,
+        const SkMatrix& deviceMatrix)
+{
+    SkAutoDescriptor ad;
+    SkScalerContextEffects effects;
+
+    auto desc = SkScalerContext::CreateDescriptorAndEffectsUsingPaint(
+            font, paint, surfaceProps, scalerContextFlags, deviceMatrix, &ad, &effects);
+
+    auto tf = font.getTypefaceOrDefault();
+
+    return GlobalStrikeCache()->findOrCreateStrikeShared(*desc, effects, *tf);
+}
+
 SkExclusiveStrikePtr SkStrikeCache::FindOrCreateStrikeWithNoDeviceExclusive(const SkFont& font) {
     return FindOrCreateStrikeWithNoDeviceExclusive(font, SkPaint());
 }
@@ -308,6 +412,17 @@ void SkStrikeCache::attachNode(Node* node) {
     if (node == nullptr) {
         return;
     }
+    if (node->fLockedShared) {
+        // This strike is still shared, so let the others at it, and hand back our reference.
+        node->fLockedShared = false;
+        const size_t memoryAdded = node->fStrike.getMemoryUsed() - node->fMemoryUsedWhenLocked;
+        node->fStrike.fSharedMutex.release();
+        if (memoryAdded > 0) {
+            this->addSharedMemoryUsed(memoryAdded);
+        }
+        this->releaseSharedNode(node);
+        return;
+    }
     SkAutoExclusive ac(fLock);
 
     this->validate();
@@ -317,23 +432,107 @@ void SkStrikeCache::attachNode(Node* node) {
     this->internalPurge();
 }
 
+void SkStrikeCache::releaseSharedNode(Node* node) {
+    SkAutoExclusive ac(fLock);
+
+    SkASSERT(node->fSharedRefs > 0);
+    if (--node->fSharedRefs > 0) {
+        return;
+    }
+    fSharedNodes.removeShuffle(fSharedNodes.find(node));
+
+    // No other thread can see the strike now, so it's safe to look at its size again.
+    this->validate();
+    node->fStrike.validate();
+
+    fSharedMemoryUsed -= node->fStrike.getMemoryUsed();
+    this->internalAttachToHead(node);
+    this->internalPurge();
+}
+
+void SkStrikeCache::addSharedMemoryUsed(size_t bytes) {
+    SkAutoExclusive ac(fLock);
+
+    fSharedMemoryUsed += bytes;
+    this->internalPurge();
+}
+
 SkExclusiveStrikePtr SkStrikeCache::findStrikeExclusive(const SkDescriptor& desc) {
     return SkExclusiveStrikePtr(this->findAndDetachStrike(desc));
 }
 
 auto SkStrikeCache::findAndDetachStrike(const SkDescriptor& desc) -> Node* {
-    SkAutoExclusive ac(fLock);
+    Node* shared;
+    {
+        SkAutoExclusive ac(fLock);
+
+        // Look among the shared strikes first, so we never make a second strike just like one.
+        shared = this->internalFindShared(desc);
+        if (shared == nullptr) {
+            for (Node* node = internalGetHead(); node != nullptr; node = node->fNext) {
+                if (node->fStrike.getDescriptor() == desc) {
+                    this->internalDetachCache(node);
+                    return node;
+                }
+            }
+            return nullptr;
+        }
+        shared->fSharedRefs++;
+    }
 
-    for (Node* node = internalGetHead(); node != nullptr; node = node->fNext) {
+    // Our reference keeps the strike alive and shared.  Holding its mutex keeps everyone else
+    // from changing it, just as detaching it would.  See forEachStrike() for why we take the
+    // mutex only after dropping fLock.
+    shared->fStrike.fSharedMutex.acquire();
+    shared->fLockedShared = true;
+    shared->fMemoryUsedWhenLocked = shared->fStrike.getMemoryUsed();
+    return shared;
+}
+
+auto SkStrikeCache::internalFindShared(const SkDescriptor& desc) const -> Node* {
+    for (Node* node : fSharedNodes) {
         if (node->fStrike.getDescriptor() == desc) {
-            this->internalDetachCache(node);
             return node;
         }
     }
-
     return nullptr;
 }
 
+auto SkStrikeCache::findAndShareStrike(const SkDescriptor& desc) -> Node* {
+    SkAutoExclusive ac(fLock);
+
+    Node* node = this->internalFindShared(desc);
+    if (node == nullptr) {
+        for (node = internalGetHead(); node != nullptr; node = node->fNext) {
+            if (node->fStrike.getDescriptor() == desc) {
+                this->internalDetachCache(node);
+                *fSharedNodes.append() = node;
+                fSharedMemoryUsed += node->fStrike.getMemoryUsed();
+                break;
+            }
+        }
+    }
+    if (node) {
+        node->fSharedRefs++;
+    }
+    return node;
+}
+
+auto SkStrikeCache::shareNewStrike(Node* node) -> Node* {
+    SkAutoExclusive ac(fLock);
+
+    if (Node* shared = this->internalFindShared(node->fStrike.getDescriptor())) {
+        // We lost the race to create this strike.  Keep ours around in the LRU list anyway.
+        this->internalAttachToHead(node);
+        this->internalPurge();
+        shared->fSharedRefs++;
+        return shared;
+    }
+    *fSharedNodes.append() = node;
+    fSharedMemoryUsed += node->fStrike.getMemoryUsed();
+    node->fSharedRefs++;
+    return node;
+}
 
 static bool loose_compare(const SkDescriptor& lhs, const SkDescriptor& rhs) {
     uint32_t size;
@@ -460,12 +659,12 @@ void SkStrikeCache::purgeAll() {
 
 size_t SkStrikeCache::getTotalMemoryUsed() const {
     SkAutoExclusive ac(fLock);
-    return fTotalMemoryUsed;
+    return fTotalMemoryUsed + fSharedMemoryUsed;
 }
 
 int SkStrikeCache::getCacheCountUsed() const {
     SkAutoExclusive ac(fLock);
-    return fCacheCount;
+    return fCacheCount + fSharedNodes.count();
 }
 
 int SkStrikeCache::getCacheCountLimit() const {
@@ -522,34 +721,56 @@ int SkStrikeCache::setCachePointSizeLimit(int newLimit) {
     return prevLimit;
 }
 
-void SkStrikeCache::forEachStrike(std::function<void(const SkStrike&)> visitor) const {
-    SkAutoExclusive ac(fLock);
+void SkStrikeCache::forEachStrike(std::function<void(const SkStrike&)> visitor) {
+    SkTDArray<Node*> shared;
+    {
+        SkAutoExclusive ac(fLock);
 
-    this->validate();
+        this->validate();
 
-    for (Node* node = this->internalGetHead(); node != nullptr; node = node->fNext) {
-        visitor(node->fStrike);
+        for (Node* node = this->internalGetHead(); node != nullptr; node = node->fNext) {
+            visitor(node->fStrike);
+        }
+        // Keep the shared strikes shared, and alive, until we've visited them.
+        shared = fSharedNodes;
+        for (Node* node : shared) {
+            node->fSharedRefs++;
+        }
+    }
+
+    // A strike's mutex may be held for a while, by a thread adding glyphs to it or by an exclusive
+    // find, and those threads take fLock too.  So we never wait on one while holding fLock.
+    for (Node* node : shared) {
+        {
+            SkAutoMutexAcquire lock(node->fStrike.fSharedMutex);
+            visitor(node->fStrike);
+        }
+        this->releaseSharedNode(node);
     }
 }
 
 size_t SkStrikeCache::internalPurge(size_t minBytesNeeded) {
     this->validate();
 
+    // Shared strikes can't be purged, but they still count against our budgets.
+    const size_t totalMemoryUsed = fTotalMemoryUsed + fSharedMemoryUsed;
+    const int    cacheCount      = fCacheCount + fSharedNodes.count();
+
     size_t bytesNeeded = 0;
-    if (fTotalMemoryUsed > fCacheSizeLimit) {
-        bytesNeeded = fTotalMemoryUsed - fCacheSizeLimit;
+    if (totalMemoryUsed > fCacheSizeLimit) {
+        bytesNeeded = totalMemoryUsed - fCacheSizeLimit;
     }
     bytesNeeded = SkTMax(bytesNeeded, minBytesNeeded);
     if (bytesNeeded) {
         // no small purges!
-        bytesNeeded = SkTMax(bytesNeeded, fTotalMemoryUsed >> 2);
+        bytesNeeded = SkTMax(bytesNeeded, totalMemoryUsed >> 2);
     }
 
     int countNeeded = 0;
-    if (fCacheCount > fCacheCountLimit) {
-        countNeeded = fCacheCount - fCacheCountLimit;
+    if (cacheCount > fCacheCountLimit) {
+        countNeeded = cacheCount - fCacheCountLimit;
         // no small purges!
-        countNeeded = SkMax32(countNeeded, fCacheCount >> 2);
+        countNeeded = SkMax32(countNeeded, cacheCount >> 2);
     }
 
     // early exit
@@ -629,7 +850,7 @@ void SkStrikeCache::ValidateGlyphCacheDataSize() {
 }
 
 #ifdef SK_DEBUG
-void SkStrikeCache::validateGlyphCacheDataSize() const {
+void SkStrikeCache::validateGlyphCacheDataSize() {
     this->forEachStrike(
             [](const SkStrike& cache) { cache.forceValidate();
     });
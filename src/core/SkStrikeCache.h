@@ -14,6 +14,7 @@
 #include "SkDescriptor.h"
 #include "SkStrike.h"
 #include "SkSpinlock.h"
+#include "SkTDArray.h"
 #include "SkTemplates.h"
 
 class SkStrike;
@@ -68,6 +69,34 @@ public:
         Node* fNode;
     };
 
+    // Any number of SharedStrikePtrs may hold the same strike at once, from any thread, and look
+    // up its glyphs concurrently with SkStrike::getSharedGlyph(); that's all they can do with it.
+    // While shared, a strike is kept out of the LRU list, so it can't be purged, but its memory
+    // still counts against the cache's budget.  An exclusive find returns the shared strike
+    // rather than making another, holding its mutex so shared lookups of new glyphs wait until
+    // the ExclusiveStrikePtr lets go; a thread must not look up new glyphs in a strike it holds
+    // both ways.  When the last SharedStrikePtr lets go, the strike goes back into the LRU list.
+    class SharedStrikePtr {
+    public:
+        explicit SharedStrikePtr(Node*);
+        SharedStrikePtr();
+        SharedStrikePtr(const SharedStrikePtr&) = delete;
+        SharedStrikePtr& operator = (const SharedStrikePtr&) = delete;
+        SharedStrikePtr(SharedStrikePtr&&);
+        SharedStrikePtr& operator = (SharedStrikePtr&&);
+        ~SharedStrikePtr();
+
+        const SkGlyph& getGlyphIDMetrics(SkGlyphID, SkFixed x = 0, SkFixed y = 0) const;
+        const SkGlyph& getGlyphMetrics(SkGlyphID, SkPoint position) const;
+        SkVector rounding() const;
+        const SkFontMetrics& getFontMetrics() const;
+        const SkDescriptor& getDescriptor() const;
+        explicit operator bool () const;
+
+    private:
+        Node* fNode;
+    };
+
     static SkStrikeCache* GlobalStrikeCache();
 
     static ExclusiveStrikePtr FindStrikeExclusive(const SkDescriptor&);
@@ -107,6 +136,23 @@ public:
             const SkScalerContextEffects& effects,
             const SkTypeface& typeface);
 
+    static SharedStrikePtr FindOrCreateStrikeShared(
+            const SkDescriptor& desc,
+            const SkScalerContextEffects& effects,
+            const SkTypeface& typeface);
+
+    SharedStrikePtr findOrCreateStrikeShared(
+            const SkDescriptor& desc,
+            const SkScalerContextEffects& effects,
+            const SkTypeface& typeface);
+
+    static SharedStrikePtr FindOrCreateStrikeShared(
+            const SkFont& font,
+            const SkPaint& paint,
+            const SkSurfaceProps& surfaceProps,
+            SkScalerContextFlags scalerContextFlags,
+            const SkMatrix& deviceMatrix);
+
     // Routines to find suitable data when working in a remote cache situation. These are
     // suitable as substitutes for similar calls in SkScalerContext.
     bool desperationSearchForImage(const SkDescriptor& desc,
@@ -152,6 +198,12 @@ public:
     // call when a glyphcache is available for caching (i.e. not in use)
     void attachNode(Node* node);
 
+    // call when a SharedStrikePtr is done with its node
+    void releaseSharedNode(Node* node);
+
+    // call when a shared strike grows
+    void addSharedMemoryUsed(size_t bytes);
+
     void purgeAll(); // does not change budget
 
     int getCacheCountLimit() const;
@@ -169,10 +221,10 @@ public:
     // A simple accounting of what each glyph cache reports and the strike cache total.
     void validate() const;
     // Make sure that each glyph cache's memory tracking and actual memory used are in sync.
-    void validateGlyphCacheDataSize() const;
+    void validateGlyphCacheDataSize();
 #else
     void validate() const {}
-    void validateGlyphCacheDataSize() const {}
+    void validateGlyphCacheDataSize() {}
 #endif
 
 private:
@@ -182,17 +234,26 @@ private:
     Node* internalGetTail() const { return fTail; }
     void internalDetachCache(Node*);
     void internalAttachToHead(Node*);
+    Node* internalFindShared(const SkDescriptor&) const;
+
+    // Find a shared strike, or share one from the LRU list, and add a reference to it.
+    Node* findAndShareStrike(const SkDescriptor&);
+    // Share a newly created strike, unless another thread has shared one just like it first.
+    Node* shareNewStrike(Node*);
 
     // Checkout budgets, modulated by the specified min-bytes-needed-to-purge,
     // and attempt to purge caches to match.
     // Returns number of bytes freed.
     size_t internalPurge(size_t minBytesNeeded = 0);
 
-    void forEachStrike(std::function<void(const SkStrike&)> visitor) const;
+    void forEachStrike(std::function<void(const SkStrike&)> visitor);
 
+    // Never held while waiting on a strike's fSharedMutex.
     mutable SkSpinlock fLock;
     Node*              fHead{nullptr};
     Node*              fTail{nullptr};
+    SkTDArray<Node*>   fSharedNodes;
+    size_t             fSharedMemoryUsed{0};   // Not included in fTotalMemoryUsed.
     size_t             fTotalMemoryUsed{0};
     size_t             fCacheSizeLimit{SK_DEFAULT_FONT_CACHE_LIMIT};
     int32_t            fCacheCountLimit{SK_DEFAULT_FONT_CACHE_COUNT_LIMIT};
@@ -201,5 +262,6 @@ private:
 };
 
 using SkExclusiveStrikePtr = SkStrikeCache::ExclusiveStrikePtr;
+using SkSharedStrikePtr = SkStrikeCache::SharedStrikePtr;
 
 #endif  // SkStrikeCache_DEFINED
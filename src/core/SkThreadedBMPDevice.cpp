@@ -0,0 +1,304 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkThreadedBMPDevice.h"
+
+#include "SkBlitter.h"
+#include "SkCoverageDelta.h"
+#include "SkPath.h"
+#include "SkRRect.h"
+#include "SkSpecialImage.h"
+#include "SkTaskGroup.h"
+
+#include <memory>
+#include <vector>
+
+// Like SkDrawTiler, we can't anti-alias anything whose supersampled coordinates overflow SkFixed.
+static constexpr int kMaxDim = 8192 - 1;
+
+// Paths with fewer verbs than this are cheaper to scan convert in each tile than to record once.
+static constexpr int kMinVerbsForDAA = 4;
+
+SkThreadedBMPDevice::TileDraw::TileDraw(const DrawState& ds, const SkIRect& tile)
+        : fTileRC(ds.fRC) {
+    fTileRC.op(tile, SkRegion::kIntersect_Op);
+    fDst    = ds.fDst;
+    fMatrix = &ds.fMatrix;
+    fRC     = &fTileRC;
+}
+
+SkThreadedBMPDevice::SkThreadedBMPDevice(const SkBitmap& bitmap, int tiles, int threads,
+                                         SkExecutor* executor)
+        : INHERITED(bitmap) {
+    if (!executor) {
+        fOwnedExecutor = SkExecutor::MakeFIFOThreadPool(threads);
+        executor = fOwnedExecutor.get();
+    }
+    fExecutor = executor;
+
+    // Split the device into horizontal bands, so each tile spans whole rows of pixels.
+    tiles = SkTMax(1, SkTMin(tiles, bitmap.height()));
+    for (int i = 0; i < tiles; i++) {
+        fTiles.push_back(SkIRect::MakeLTRB(0,              bitmap.height() *  i      / tiles,
+                                           bitmap.width(), bitmap.height() * (i + 1) / tiles));
+    }
+}
+
+SkThreadedBMPDevice::~SkThreadedBMPDevice() {
+    this->flush();
+}
+
+bool SkThreadedBMPDevice::canQueue() const {
+    return this->width() <= kMaxDim && this->height() <= kMaxDim;
+}
+
+void SkThreadedBMPDevice::queue(const SkRect* localBounds, const SkPaint& paint,
+                                DrawFn draw, InitFn init) {
+    // Like BDDraw, this dirties our genID, but we do it without flushing the queue.
+    SkPixmap dst;
+    if (!INHERITED::onPeekPixels(&dst)) {
+        return;
+    }
+    fBitmap.notifyPixelsChanged();
+    DrawState state(dst, this->ctm(), fRCStack.rc());
+
+    SkIRect bounds = state.fRC.getBounds();
+    if (localBounds && paint.canComputeFastBounds()) {
+        SkRect storage;
+        SkIRect devBounds = state.fMatrix.mapRect(paint.computeFastBounds(*localBounds, &storage))
+                                        .roundOut();
+        devBounds.outset(1, 1);   // Leave room for anti-aliasing and hairlines.
+        if (!bounds.intersect(devBounds)) {
+            return;
+        }
+    }
+    if (state.fRC.isEmpty()) {
+        return;
+    }
+
+    fQueue.push_back({std::move(state), bounds, std::move(init), std::move(draw)});
+}
+
+void SkThreadedBMPDevice::flush() {
+    if (fQueue.empty()) {
+        return;
+    }
+
+    // First, spread the one-time work (computing DAA coverage) across threads, giving each task
+    // its own arena to hold that coverage until every tile has been drawn.
+    const int tasks = fTiles.count();
+    std::vector<std::unique_ptr<SkArenaAlloc>> allocs;
+    for (int i = 0; i < tasks; i++) {
+        allocs.emplace_back(new SkArenaAlloc(4096));
+    }
+    SkTaskGroup initGroup(*fExecutor);
+    initGroup.batch(tasks, [&](int t) {
+        for (int i = t; i < fQueue.count(); i += tasks) {
+            const DrawElement& element = fQueue[i];
+            if (element.fInit) {
+                element.fInit(element.fState, allocs[t].get());
+            }
+        }
+    });
+    initGroup.wait();
+
+    // Then draw each tile, replaying the queue in order.
+    SkTaskGroup tileGroup(*fExecutor);
+    tileGroup.batch(fTiles.count(), [&](int t) {
+        const SkIRect& tile = fTiles[t];
+        for (const DrawElement& element : fQueue) {
+            if (SkIRect::Intersects(tile, element.fBounds)) {
+                element.fDraw(element.fState, tile);
+            }
+        }
+    });
+    tileGroup.wait();
+
+    fQueue.reset();
+    fAlloc.reset();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SkThreadedBMPDevice::drawPaint(const SkPaint& paint) {
+    if (!this->canQueue()) {
+        this->flush();
+        return INHERITED::drawPaint(paint);
+    }
+    this->queue(nullptr, paint, [=](const DrawState& ds, const SkIRect& tile) {
+        TileDraw(ds, tile).drawPaint(paint);
+    });
+}
+
+void SkThreadedBMPDevice::drawPoints(SkCanvas::PointMode mode, size_t count,
+                                     const SkPoint pts[], const SkPaint& paint) {
+    if (!this->canQueue()) {
+        this->flush();
+        return INHERITED::drawPoints(mode, count, pts, paint);
+    }
+    SkPoint* copy = fAlloc.makeArrayDefault<SkPoint>(count);
+    memcpy(copy, pts, count * sizeof(SkPoint));
+    this->queue(nullptr, paint, [=](const DrawState& ds, const SkIRect& tile) {
+        TileDraw(ds, tile).drawPoints(mode, count, copy, paint, nullptr);
+    });
+}
+
+void SkThreadedBMPDevice::drawRect(const SkRect& r, const SkPaint& paint) {
+    if (!this->canQueue()) {
+        this->flush();
+        return INHERITED::drawRect(r, paint);
+    }
+    this->queue(&r, paint, [=](const DrawState& ds, const SkIRect& tile) {
+        TileDraw(ds, tile).drawRect(r, paint);
+    });
+}
+
+void SkThreadedBMPDevice::drawRRect(const SkRRect& rrect, const SkPaint& paint) {
+    if (!this->canQueue()) {
+        this->flush();
+        return INHERITED::drawRRect(rrect, paint);
+    }
+    if (!paint.getMaskFilter()) {
+        // SkDraw would draw this as a path anyway, so let drawPath() share its coverage.
+        SkPath path;
+        path.addRRect(rrect);
+        return this->drawPath(path, paint, true);
+    }
+    this->queue(&rrect.getBounds(), paint, [=](const DrawState& ds, const SkIRect& tile) {
+        TileDraw(ds, tile).drawRRect(rrect, paint);
+    });
+}
+
+void SkThreadedBMPDevice::drawPath(const SkPath& path, const SkPaint& paint, bool pathIsMutable) {
+    if (!this->canQueue()) {
+        this->flush();
+        return INHERITED::drawPath(path, paint, pathIsMutable);
+    }
+    // Every tile draws this same path, so compute its lazy bounds now, rather than letting the
+    // tiles race to fill them in.
+    path.updateBoundsCache();
+    const SkRect* bounds = path.isInverseFillType() ? nullptr : &path.getBounds();
+
+#if !defined(SK_DISABLE_DAA)
+    // Record large anti-aliased paths' coverage once, then have each tile blit its part of it.
+    // Mask filters blit as they filter, and rects take a fast path that depends on the clip, so
+    // we leave those to be drawn from scratch in each tile.
+    if (paint.isAntiAlias() && !paint.getMaskFilter() &&
+        path.countVerbs() >= kMinVerbsForDAA && !path.isRect(nullptr)) {
+        SkDAARecord* record = fAlloc.make<SkDAARecord>(nullptr);
+        this->queue(bounds, paint, [=](const DrawState& ds, const SkIRect& tile) {
+            // If computing the coverage bailed out early, draw this tile without it.
+            bool computed = record->fType == SkDAARecord::Type::kMask ||
+                            record->fType == SkDAARecord::Type::kList;
+            TileDraw(ds, tile).drawPath(path, paint, nullptr, false, false, nullptr,
+                                        computed ? record : nullptr);
+        }, [=](const DrawState& ds, SkArenaAlloc* alloc) {
+            record->fAlloc = alloc;
+            SkNullBlitter nullBlitter;
+            SkDraw draw;
+            draw.fDst    = ds.fDst;
+            draw.fMatrix = &ds.fMatrix;
+            draw.fRC     = &ds.fRC;
+            draw.drawPath(path, paint, nullptr, false, false, &nullBlitter, record);
+        });
+        return;
+    }
+#endif
+
+    this->queue(bounds, paint, [=](const DrawState& ds, const SkIRect& tile) {
+        TileDraw(ds, tile).drawPath(path, paint, nullptr, false);
+    });
+}
+
+void SkThreadedBMPDevice::drawBitmap(const SkBitmap& bitmap, const SkMatrix& matrix,
+                                     const SkRect* dstOrNull, const SkPaint& paint) {
+    if (!this->canQueue()) {
+        this->flush();
+        return INHERITED::drawBitmap(bitmap, matrix, dstOrNull, paint);
+    }
+    SkRect bounds = SkRect::MakeIWH(bitmap.width(), bitmap.height());
+    if (dstOrNull) {
+        bounds = *dstOrNull;
+    } else {
+        matrix.mapRect(&bounds);
+    }
+    const bool hasDst = dstOrNull != nullptr;
+    this->queue(&bounds, paint, [=](const DrawState& ds, const SkIRect& tile) {
+        TileDraw(ds, tile).drawBitmap(bitmap, matrix, hasDst ? &bounds : nullptr, paint);
+    });
+}
+
+void SkThreadedBMPDevice::drawSprite(const SkBitmap& bitmap, int x, int y, const SkPaint& paint) {
+    if (!this->canQueue()) {
+        this->flush();
+        return INHERITED::drawSprite(bitmap, x, y, paint);
+    }
+    // Sprites ignore the CTM, so we can't bound them with local coordinates.
+    this->queue(nullptr, paint, [=](const DrawState& ds, const SkIRect& tile) {
+        TileDraw(ds, tile).drawSprite(bitmap, x, y, paint);
+    });
+}
+
+// These draws reference memory we can't easily hold on to or need our pixels right away,
+// so we flush the queue and draw them immediately on this thread.
+
+void SkThreadedBMPDevice::drawGlyphRunList(const SkGlyphRunList& glyphRunList) {
+    this->flush();
+    INHERITED::drawGlyphRunList(glyphRunList);
+}
+
+void SkThreadedBMPDevice::drawVertices(const SkVertices* vertices, const SkVertices::Bone bones[],
+                                       int boneCount, SkBlendMode bmode, const SkPaint& paint) {
+    this->flush();
+    INHERITED::drawVertices(vertices, bones, boneCount, bmode, paint);
+}
+
+void SkThreadedBMPDevice::drawDevice(SkBaseDevice* device, int x, int y, const SkPaint& paint) {
+    this->flush();
+    INHERITED::drawDevice(device, x, y, paint);
+}
+
+void SkThreadedBMPDevice::drawSpecial(SkSpecialImage* src, int x, int y, const SkPaint& paint,
+                                      SkImage* clipImage, const SkMatrix& clipMatrix) {
+    this->flush();
+    INHERITED::drawSpecial(src, x, y, paint, clipImage, clipMatrix);
+}
+
+sk_sp<SkSpecialImage> SkThreadedBMPDevice::snapSpecial() {
+    this->flush();
+    return INHERITED::snapSpecial();
+}
+
+sk_sp<SkSpecialImage> SkThreadedBMPDevice::snapBackImage(const SkIRect& bounds) {
+    this->flush();
+    return INHERITED::snapBackImage(bounds);
+}
+
+void SkThreadedBMPDevice::replaceBitmapBackendForRasterSurface(const SkBitmap& bm) {
+    this->flush();
+    INHERITED::replaceBitmapBackendForRasterSurface(bm);
+}
+
+bool SkThreadedBMPDevice::onReadPixels(const SkPixmap& pm, int x, int y) {
+    this->flush();
+    return INHERITED::onReadPixels(pm, x, y);
+}
+
+bool SkThreadedBMPDevice::onWritePixels(const SkPixmap& pm, int x, int y) {
+    this->flush();
+    return INHERITED::onWritePixels(pm, x, y);
+}
+
+bool SkThreadedBMPDevice::onPeekPixels(SkPixmap* pmap) {
+    this->flush();
+    return INHERITED::onPeekPixels(pmap);
+}
+
+bool SkThreadedBMPDevice::onAccessPixels(SkPixmap* pmap) {
+    this->flush();
+    return INHERITED::onAccessPixels(pmap);
+}
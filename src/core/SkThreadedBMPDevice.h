@@ -0,0 +1,119 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkThreadedBMPDevice_DEFINED
+#define SkThreadedBMPDevice_DEFINED
+
+#include "SkArenaAlloc.h"
+#include "SkBitmapDevice.h"
+#include "SkDraw.h"
+#include "SkExecutor.h"
+#include "SkRasterClip.h"
+#include "SkTArray.h"
+
+#include <functional>
+
+struct SkDAARecord;
+
+// An SkBitmapDevice that splits its pixels into horizontal tiles and rasterizes them in parallel.
+//
+// Draws are queued rather than executed.  When the queue is flushed (flush(), any pixel access,
+// any draw we can't defer, or destruction), we first compute each anti-aliased path's DAA
+// coverage once, with the paths spread across threads, and then draw every tile in parallel,
+// replaying the queue in order and clipped to that tile.  Tiles never share pixels, so no
+// locking is needed while drawing.
+//
+// Text, vertices, sprites of other devices, and special images are drawn immediately after a
+// flush, so they do not benefit from threading.
+//
+// Aliased paths and hairlines are clipped to each tile before they're scan converted, so their
+// edges may differ from SkBitmapDevice's by a pixel where they cross a tile boundary.
+class SkThreadedBMPDevice : public SkBitmapDevice {
+public:
+    // When executor is null, we make and own a thread pool with the given thread count
+    // (by default the number of cores).  Otherwise executor must outlive this device.
+    SkThreadedBMPDevice(const SkBitmap& bitmap, int tiles, int threads = 0,
+                        SkExecutor* executor = nullptr);
+
+    ~SkThreadedBMPDevice() override;
+
+    void flush() override;
+
+protected:
+    void drawPaint(const SkPaint& paint) override;
+    void drawPoints(SkCanvas::PointMode mode, size_t count,
+                    const SkPoint[], const SkPaint& paint) override;
+    void drawRect(const SkRect& r, const SkPaint& paint) override;
+    void drawRRect(const SkRRect& rr, const SkPaint& paint) override;
+    void drawPath(const SkPath&, const SkPaint&, bool pathIsMutable) override;
+    void drawBitmap(const SkBitmap&, const SkMatrix&, const SkRect* dstOrNull,
+                    const SkPaint&) override;
+    void drawSprite(const SkBitmap&, int x, int y, const SkPaint&) override;
+
+    void drawGlyphRunList(const SkGlyphRunList& glyphRunList) override;
+    void drawVertices(const SkVertices*, const SkVertices::Bone bones[], int boneCount,
+                      SkBlendMode, const SkPaint& paint) override;
+    void drawDevice(SkBaseDevice*, int x, int y, const SkPaint&) override;
+    void drawSpecial(SkSpecialImage*, int x, int y, const SkPaint&,
+                     SkImage*, const SkMatrix&) override;
+
+    sk_sp<SkSpecialImage> snapSpecial() override;
+    sk_sp<SkSpecialImage> snapBackImage(const SkIRect&) override;
+
+    bool onReadPixels(const SkPixmap&, int x, int y) override;
+    bool onWritePixels(const SkPixmap&, int, int) override;
+    bool onPeekPixels(SkPixmap*) override;
+    bool onAccessPixels(SkPixmap*) override;
+
+private:
+    // Everything an SkDraw needs, captured when the draw is queued.
+    struct DrawState {
+        DrawState(const SkPixmap& dst, const SkMatrix& matrix, const SkRasterClip& rc)
+            : fDst(dst), fMatrix(matrix), fRC(rc) {}
+
+        SkPixmap     fDst;
+        SkMatrix     fMatrix;
+        SkRasterClip fRC;
+    };
+
+    // An SkDraw restricted to one tile of a DrawState.
+    class TileDraw : public SkDraw {
+    public:
+        TileDraw(const DrawState& ds, const SkIRect& tile);
+    private:
+        SkRasterClip fTileRC;
+    };
+
+    using DrawFn = std::function<void(const DrawState&, const SkIRect& tile)>;
+    using InitFn = std::function<void(const DrawState&, SkArenaAlloc*)>;
+
+    struct DrawElement {
+        DrawState fState;
+        SkIRect   fBounds;   // Device space; tiles outside these bounds skip this draw.
+        InitFn    fInit;     // Optional, runs once before any tile draws.
+        DrawFn    fDraw;
+    };
+
+    // Queues a draw that touches at most the paint's fast bounds of the given local bounds,
+    // or anywhere in the clip if localBounds is null.
+    void queue(const SkRect* localBounds, const SkPaint&, DrawFn draw, InitFn init = nullptr);
+
+    void replaceBitmapBackendForRasterSurface(const SkBitmap&) override;
+
+    // Does this device fit within the limits of the anti-aliased scan converters?
+    bool canQueue() const;
+
+    std::unique_ptr<SkExecutor> fOwnedExecutor;
+    SkExecutor*                 fExecutor;
+    SkTArray<SkIRect>           fTiles;
+    SkTArray<DrawElement>       fQueue;
+    SkArenaAlloc                fAlloc{4096};   // Holds DAA records for the queued draws.
+
+    typedef SkBitmapDevice INHERITED;
+};
+
+#endif//SkThreadedBMPDevice_DEFINED
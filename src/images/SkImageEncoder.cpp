@@ -5,8 +5,10 @@
  * found in the LICENSE file.
  */
 
+#include "SkCanvas.h"
 #include "SkImageEncoderPriv.h"
 #include "SkJpegEncoder.h"
+#include "SkPicture.h"
 #include "SkPngEncoder.h"
 #include "SkWebpEncoder.h"
 
@@ -15,6 +17,10 @@ bool SkJpegEncoder::Encode(SkWStream*, const SkPixmap&, const Options&) { return
 std::unique_ptr<SkEncoder> SkJpegEncoder::Make(SkWStream*, const SkPixmap&, const Options&) {
     return nullptr;
 }
+std::unique_ptr<SkEncoder> SkJpegEncoder::Make(SkWStream*, const SkImageInfo&, RowSource*, int,
+                                               const Options&) {
+    return nullptr;
+}
 #endif
 
 #ifndef SK_HAS_PNG_LIBRARY
@@ -22,6 +28,10 @@ bool SkPngEncoder::Encode(SkWStream*, const SkPixmap&, const Options&) { return
 std::unique_ptr<SkEncoder> SkPngEncoder::Make(SkWStream*, const SkPixmap&, const Options&) {
     return nullptr;
 }
+std::unique_ptr<SkEncoder> SkPngEncoder::Make(SkWStream*, const SkImageInfo&, RowSource*, int,
+                                              const Options&) {
+    return nullptr;
+}
 #endif
 
 #ifndef SK_HAS_WEBP_LIBRARY
@@ -85,15 +95,77 @@ bool SkEncoder::encodeRows(int numRows) {
         numRows = fSrc.height() - fCurrRow;
     }
 
-    if (!this->onEncodeRows(numRows)) {
-        // If we fail, short circuit any future calls.
-        fCurrRow = fSrc.height();
-        return false;
+    if (!fRowSource) {
+        SkAssertResult(fSrc.extractSubset(&fRows,
+                                          SkIRect::MakeXYWH(0, fCurrRow, fSrc.width(), numRows)));
+        if (!this->onEncodeRows(numRows)) {
+            // If we fail, short circuit any future calls.
+            fCurrRow = fSrc.height();
+            return false;
+        }
+        return true;
     }
 
+    // Only one strip of the source is ever in memory.
+    while (numRows > 0) {
+        const int stripRows = SkTMin(numRows, fStripHeight);
+        fRows.reset(fSrc.info().makeWH(fSrc.width(), stripRows), fStrip.get(),
+                    fSrc.info().minRowBytes());
+        if (!fRowSource->getRows(fCurrRow, fRows) || !this->onEncodeRows(stripRows)) {
+            fCurrRow = fSrc.height();
+            return false;
+        }
+        numRows -= stripRows;
+    }
     return true;
 }
 
+SkEncoder::SkEncoder(const SkImageInfo& info, RowSource* source, int stripHeight,
+                     size_t storageBytes)
+    : fSourceInfo(info, nullptr, info.minRowBytes())
+    , fSrc(fSourceInfo)
+    , fCurrRow(0)
+    , fStorage(storageBytes)
+    , fRowSource(source)
+    , fStripHeight(SkTMin(stripHeight, info.height()))
+    , fStrip(fStripHeight * info.minRowBytes())
+{
+    SkASSERT(source && stripHeight > 0);
+}
+
+namespace {
+
+class PictureRowSource : public SkEncoder::RowSource {
+public:
+    PictureRowSource(sk_sp<SkPicture> picture) : fPicture(std::move(picture)) {}
+
+    bool getRows(int y, const SkPixmap& rows) override {
+        std::unique_ptr<SkCanvas> canvas = SkCanvas::MakeRasterDirect(rows.info(),
+                                                                      rows.writable_addr(),
+                                                                      rows.rowBytes());
+        if (!canvas) {
+            return false;
+        }
+        canvas->clear(SK_ColorTRANSPARENT);
+        canvas->translate(0, -SkIntToScalar(y));
+        canvas->drawPicture(fPicture);
+        return true;
+    }
+
+private:
+    sk_sp<SkPicture> fPicture;
+};
+
+}  // namespace
+
+std::unique_ptr<SkEncoder::RowSource> SkEncoder::RowSource::MakeFromPicture(
+        sk_sp<SkPicture> picture) {
+    if (!picture) {
+        return nullptr;
+    }
+    return std::unique_ptr<RowSource>(new PictureRowSource(std::move(picture)));
+}
+
 sk_sp<SkData> SkEncodePixmap(const SkPixmap& src, SkEncodedImageFormat format, int quality) {
     SkDynamicMemoryWStream stream;
     return SkEncodeImage(&stream, src, format, quality) ? stream.detachAsData() : nullptr;
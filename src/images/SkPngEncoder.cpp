@@ -10,15 +10,19 @@
 #ifdef SK_HAS_PNG_LIBRARY
 
 #include "SkColorTable.h"
+#include "SkExecutor.h"
 #include "SkImageEncoderFns.h"
 #include "SkImageInfoPriv.h"
 #include "SkStream.h"
 #include "SkString.h"
 #include "SkPngEncoder.h"
 #include "SkPngPriv.h"
+#include "SkTaskGroup.h"
+#include "SkTemplates.h"
 #include <vector>
 
 #include "png.h"
+#include "zlib.h"
 
 static_assert(PNG_FILTER_NONE  == (int)SkPngEncoder::FilterFlag::kNone,  "Skia libpng filter err.");
 static_assert(PNG_FILTER_SUB   == (int)SkPngEncoder::FilterFlag::kSub,   "Skia libpng filter err.");
@@ -62,6 +66,9 @@ public:
     png_infop infoPtr() { return fInfoPtr; }
     int pngBytesPerPixel() const { return fPngBytesPerPixel; }
     transform_scanline_proc proc() const { return fProc; }
+    int filters() const { return fFilters; }
+    int zlibLevel() const { return fZLibLevel; }
+    SkExecutor* executor() const { return fExecutor; }
 
     ~SkPngEncoderMgr() {
         png_destroy_write_struct(&fPngPtr, &fInfoPtr);
@@ -78,6 +85,9 @@ private:
     png_infop               fInfoPtr;
     int                     fPngBytesPerPixel;
     transform_scanline_proc fProc;
+    int                     fFilters;
+    int                     fZLibLevel;
+    SkExecutor*             fExecutor;
 };
 
 std::unique_ptr<SkPngEncoderMgr> SkPngEncoderMgr::Make(SkWStream* stream) {
@@ -196,10 +206,14 @@ bool SkPngEncoderMgr::setHeader(const SkImageInfo& srcInfo, const SkPngEncoder::
     int filters = (int)options.fFilterFlags & (int)SkPngEncoder::FilterFlag::kAll;
     SkASSERT(filters == (int)options.fFilterFlags);
     png_set_filter(fPngPtr, PNG_FILTER_TYPE_BASE, filters);
+    fFilters = filters;
 
     int zlibLevel = SkTMin(SkTMax(0, options.fZLibLevel), 9);
     SkASSERT(zlibLevel == options.fZLibLevel);
     png_set_compression_level(fPngPtr, zlibLevel);
+    fZLibLevel = zlibLevel;
+
+    fExecutor = options.fExecutor;
 
     // Set comments in tEXt chunk
     const sk_sp<SkDataTable>& comments = options.fComments;
@@ -372,47 +386,371 @@ void SkPngEncoderMgr::chooseProc(const SkImageInfo& srcInfo) {
     fProc = choose_proc(srcInfo);
 }
 
+static std::unique_ptr<SkPngEncoderMgr> make_encoder_mgr(SkWStream* dst, const SkImageInfo& info,
+                                                         const SkPngEncoder::Options& options) {
+    std::unique_ptr<SkPngEncoderMgr> encoderMgr = SkPngEncoderMgr::Make(dst);
+    if (!encoderMgr) {
+        return nullptr;
+    }
+
+    if (!encoderMgr->setHeader(info, options)) {
+        return nullptr;
+    }
+
+    if (!encoderMgr->setColorSpace(info)) {
+        return nullptr;
+    }
+
+    if (!encoderMgr->writeInfo(info)) {
+        return nullptr;
+    }
+
+    encoderMgr->chooseProc(info);
+    return encoderMgr;
+}
+
 std::unique_ptr<SkEncoder> SkPngEncoder::Make(SkWStream* dst, const SkPixmap& src,
                                               const Options& options) {
     if (!SkPixmapIsValid(src)) {
         return nullptr;
     }
 
-    std::unique_ptr<SkPngEncoderMgr> encoderMgr = SkPngEncoderMgr::Make(dst);
+    std::unique_ptr<SkPngEncoderMgr> encoderMgr = make_encoder_mgr(dst, src.info(), options);
     if (!encoderMgr) {
         return nullptr;
     }
 
-    if (!encoderMgr->setHeader(src.info(), options)) {
+    return std::unique_ptr<SkPngEncoder>(new SkPngEncoder(std::move(encoderMgr), src));
+}
+
+std::unique_ptr<SkEncoder> SkPngEncoder::Make(SkWStream* dst, const SkImageInfo& info,
+                                              RowSource* source, int stripHeight,
+                                              const Options& options) {
+    if (!source || stripHeight <= 0 || !SkImageInfoIsValid(info)) {
         return nullptr;
     }
 
-    if (!encoderMgr->setColorSpace(src.info())) {
+    std::unique_ptr<SkPngEncoderMgr> encoderMgr = make_encoder_mgr(dst, info, options);
+    if (!encoderMgr) {
         return nullptr;
     }
 
-    if (!encoderMgr->writeInfo(src.info())) {
-        return nullptr;
+    return std::unique_ptr<SkPngEncoder>(new SkPngEncoder(std::move(encoderMgr), info, source,
+                                                          stripHeight));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// When all the rows are encoded at once and we have an executor, we split the image into bands of
+// rows, filter and deflate each band on its own, and join the results into a single zlib stream.
+// Each band but the last ends with a sync flush, which leaves its deflate data byte-aligned and
+// not final, so the pieces can simply be concatenated. Each band's compressor is primed with the
+// last 32K of the data before it, as though it had seen the whole stream, so that joining them
+// costs only a few bytes. The adler32 of the whole stream is combined from those of the bands.
+//
+// Filtering follows libpng: a single allowed filter is always used, and otherwise each row gets
+// whichever allowed filter leaves the smallest sum of absolute (signed) byte values.
+
+// Bands are at least this large (in filtered bytes) so that the extra work for each is negligible.
+static constexpr size_t kMinBandBytes = 1 << 20;
+
+// zlib's largest window. This is how much history each band's compressor is primed with.
+static constexpr size_t kZLibWindowBytes = 1 << 15;
+
+static uint8_t paeth_predictor(int a, int b, int c) {
+    int p = a + b - c,
+        pa = SkTAbs(p - a),
+        pb = SkTAbs(p - b),
+        pc = SkTAbs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return a;
     }
+    return pb <= pc ? b : c;
+}
 
-    encoderMgr->chooseProc(src.info());
+// Writes the filter type, then the filtered row, to dst.
+static void apply_filter(uint8_t* dst, int type, const uint8_t* row, const uint8_t* prev,
+                         size_t len, size_t bpp) {
+    *dst++ = type;
+    switch (type) {
+        case PNG_FILTER_VALUE_NONE:
+            memcpy(dst, row, len);
+            break;
+        case PNG_FILTER_VALUE_SUB:
+            for (size_t i = 0; i < len; i++) {
+                dst[i] = row[i] - (i < bpp ? 0 : row[i - bpp]);
+            }
+            break;
+        case PNG_FILTER_VALUE_UP:
+            for (size_t i = 0; i < len; i++) {
+                dst[i] = row[i] - prev[i];
+            }
+            break;
+        case PNG_FILTER_VALUE_AVG:
+            for (size_t i = 0; i < len; i++) {
+                dst[i] = row[i] - (((i < bpp ? 0 : row[i - bpp]) + prev[i]) >> 1);
+            }
+            break;
+        case PNG_FILTER_VALUE_PAETH:
+            for (size_t i = 0; i < len; i++) {
+                dst[i] = i < bpp ? row[i] - prev[i]
+                                 : row[i] - paeth_predictor(row[i - bpp], prev[i], prev[i - bpp]);
+            }
+            break;
+        default:
+            SkASSERT(false);
+            break;
+    }
+}
 
-    return std::unique_ptr<SkPngEncoder>(new SkPngEncoder(std::move(encoderMgr), src));
+static size_t filter_cost(const uint8_t* filtered, size_t len) {
+    size_t cost = 0;
+    for (size_t i = 0; i < len; i++) {
+        cost += filtered[i] < 128 ? filtered[i] : 256 - filtered[i];
+    }
+    return cost;
+}
+
+// Produces the filtered rows of an image, one after another, starting from any row.
+class SkPngRowFilterer {
+public:
+    SkPngRowFilterer(const SkPixmap& src, const SkPngEncoderMgr& mgr, size_t rowBytes)
+        : fSrc(src)
+        , fProc(mgr.proc())
+        , fFilters(mgr.filters() ? mgr.filters() : PNG_FILTER_NONE)
+        , fRowBytes(rowBytes)
+        , fBpp(rowBytes / src.width())
+        , fRows(2 * rowBytes)
+        , fFiltered(2 * (rowBytes + 1))
+    {}
+
+    size_t filteredRowBytes() const { return fRowBytes + 1; }
+
+    // Returns filteredRowBytes() bytes, valid until the next call.
+    const uint8_t* filterRow(int y) {
+        uint8_t* row  = fRows.get();
+        uint8_t* prev = fRows.get() + fRowBytes;
+        if (y != fPrevY + 1) {
+            if (y == 0) {
+                memset(prev, 0, fRowBytes);
+            } else {
+                this->transform(prev, y - 1);
+            }
+        }
+        this->transform(row, y);
+
+        uint8_t* best  = fFiltered.get();
+        uint8_t* trial = fFiltered.get() + fRowBytes + 1;
+        size_t bestCost = SIZE_MAX;
+        for (int type = PNG_FILTER_VALUE_NONE; type <= PNG_FILTER_VALUE_PAETH; type++) {
+            if (!(fFilters & (PNG_FILTER_NONE << type))) {
+                continue;
+            }
+            apply_filter(trial, type, row, prev, fRowBytes, fBpp);
+            if (fFilters == (PNG_FILTER_NONE << type)) {
+                best = trial;
+                break;
+            }
+            size_t cost = filter_cost(trial + 1, fRowBytes);
+            if (cost < bestCost) {
+                bestCost = cost;
+                std::swap(best, trial);
+            }
+        }
+
+        // This row is the next one's prev.
+        memcpy(prev, row, fRowBytes);
+        fPrevY = y;
+        return best;
+    }
+
+private:
+    void transform(uint8_t* dst, int y) {
+        fProc((char*)dst, (const char*)fSrc.addr(0, y), fSrc.width(),
+              SkColorTypeBytesPerPixel(fSrc.colorType()));
+    }
+
+    const SkPixmap&         fSrc;
+    transform_scanline_proc fProc;
+    const int               fFilters;
+    const size_t            fRowBytes;
+    const size_t            fBpp;
+    SkAutoTMalloc<uint8_t>  fRows;
+    SkAutoTMalloc<uint8_t>  fFiltered;
+    int                     fPrevY = -2;
+};
+
+namespace {
+
+struct PngBand {
+    int                    fTop    = 0;
+    int                    fBottom = 0;
+    SkDynamicMemoryWStream fDeflated;
+    uLong                  fAdler  = 0;  // of the band's filtered rows
+    size_t                 fLength = 0;  // of the band's filtered rows
+    bool                   fSuccess = false;
+};
+
+}  // namespace
+
+// Runs deflate() with the given flush mode until it has nothing more to write.
+static bool deflate_into(z_stream* stream, int flush, SkWStream* dst) {
+    uint8_t buffer[4096];
+    for (;;) {
+        stream->next_out = buffer;
+        stream->avail_out = sizeof(buffer);
+        int result = deflate(stream, flush);
+        if (Z_STREAM_ERROR == result ||
+            !dst->write(buffer, sizeof(buffer) - stream->avail_out)) {
+            return false;
+        }
+        if (Z_FINISH == flush ? Z_STREAM_END == result : stream->avail_out != 0) {
+            return true;
+        }
+    }
 }
 
+static void encode_band(PngBand* band, bool last, const SkPixmap& src,
+                        const SkPngEncoderMgr& mgr, size_t rowBytes) {
+    SkPngRowFilterer filterer(src, mgr, rowBytes);
+    const size_t len = filterer.filteredRowBytes();
+
+    // libpng's choice of strategy.
+    int strategy = PNG_FILTER_NONE == mgr.filters() ? Z_DEFAULT_STRATEGY : Z_FILTERED;
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    // Negative window bits: raw deflate data, without zlib's header or checksum.
+    if (Z_OK != deflateInit2(&stream, mgr.zlibLevel(), Z_DEFLATED, -15, 8, strategy)) {
+        return;
+    }
+
+    bool success = true;
+    if (band->fTop > 0) {
+        int rows = SkTMin(band->fTop, SkToInt((kZLibWindowBytes + len - 1) / len));
+        SkAutoTMalloc<uint8_t> history(rows * len);
+        for (int i = 0; i < rows; i++) {
+            memcpy(history.get() + i * len, filterer.filterRow(band->fTop - rows + i), len);
+        }
+        size_t historyBytes = SkTMin(rows * len, kZLibWindowBytes);
+        success = Z_OK == deflateSetDictionary(&stream,
+                                               history.get() + rows * len - historyBytes,
+                                               SkToUInt(historyBytes));
+    }
+
+    uLong adler = adler32(0, nullptr, 0);
+    for (int y = band->fTop; success && y < band->fBottom; y++) {
+        const uint8_t* row = filterer.filterRow(y);
+        adler = adler32(adler, row, SkToUInt(len));
+        stream.next_in = const_cast<uint8_t*>(row);
+        stream.avail_in = SkToUInt(len);
+        success = deflate_into(&stream, Z_NO_FLUSH, &band->fDeflated);
+    }
+    success = success && deflate_into(&stream, last ? Z_FINISH : Z_SYNC_FLUSH, &band->fDeflated);
+    deflateEnd(&stream);
+
+    band->fAdler = adler;
+    band->fLength = (band->fBottom - band->fTop) * len;
+    band->fSuccess = success;
+}
+
+static bool write_idat_and_iend(png_structp pngPtr, int zlibLevel,
+                                const std::vector<sk_sp<SkData>>& pieces, uLong adler) {
+    if (setjmp(png_jmpbuf(pngPtr))) {
+        return false;
+    }
+
+    // zlib's header: deflate with a 32K window, a hint of the level, and a check value.
+    int levelHint = zlibLevel < 2 ? 0 : zlibLevel < 6 ? 1 : zlibLevel == 6 ? 2 : 3;
+    uint8_t header[2] = { 0x78, (uint8_t)(levelHint << 6) };
+    header[1] += (31 - (header[0] * 256 + header[1]) % 31) % 31;
+
+    const uint8_t checksum[4] = {
+        (uint8_t)(adler >> 24), (uint8_t)(adler >> 16), (uint8_t)(adler >> 8), (uint8_t)adler,
+    };
+
+    static const png_byte kIDAT[5] = { 'I', 'D', 'A', 'T', '\0' };
+    static const png_byte kIEND[5] = { 'I', 'E', 'N', 'D', '\0' };
+    for (size_t i = 0; i < pieces.size(); i++) {
+        const bool first = 0 == i,
+                   last  = pieces.size() - 1 == i;
+        size_t length = pieces[i]->size() + (first ? sizeof(header) : 0)
+                                          + (last ? sizeof(checksum) : 0);
+        png_write_chunk_start(pngPtr, kIDAT, SkToU32(length));
+        if (first) {
+            png_write_chunk_data(pngPtr, header, sizeof(header));
+        }
+        png_write_chunk_data(pngPtr, pieces[i]->bytes(), pieces[i]->size());
+        if (last) {
+            png_write_chunk_data(pngPtr, checksum, sizeof(checksum));
+        }
+        png_write_chunk_end(pngPtr);
+    }
+    png_write_chunk(pngPtr, kIEND, nullptr, 0);
+    return true;
+}
+
+static bool encode_in_bands(SkPngEncoderMgr* mgr, const SkPixmap& src, size_t rowBytes,
+                            int rowsPerBand) {
+    const int bandCount = (src.height() + rowsPerBand - 1) / rowsPerBand;
+    std::unique_ptr<PngBand[]> bands(new PngBand[bandCount]);
+    for (int i = 0; i < bandCount; i++) {
+        bands[i].fTop = i * rowsPerBand;
+        bands[i].fBottom = SkTMin(src.height(), (i + 1) * rowsPerBand);
+    }
+
+    SkTaskGroup tg(*mgr->executor());
+    tg.batch(bandCount, [&](int i) {
+        encode_band(&bands[i], bandCount - 1 == i, src, *mgr, rowBytes);
+    });
+    tg.wait();
+
+    std::vector<sk_sp<SkData>> pieces;
+    uLong adler = bands[0].fAdler;
+    for (int i = 0; i < bandCount; i++) {
+        if (!bands[i].fSuccess) {
+            return false;
+        }
+        if (i > 0) {
+            adler = adler32_combine(adler, bands[i].fAdler, bands[i].fLength);
+        }
+        pieces.push_back(bands[i].fDeflated.detachAsData());
+    }
+    return write_idat_and_iend(mgr->pngPtr(), mgr->zlibLevel(), pieces, adler);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
 SkPngEncoder::SkPngEncoder(std::unique_ptr<SkPngEncoderMgr> encoderMgr, const SkPixmap& src)
     : INHERITED(src, encoderMgr->pngBytesPerPixel() * src.width())
     , fEncoderMgr(std::move(encoderMgr))
 {}
 
+SkPngEncoder::SkPngEncoder(std::unique_ptr<SkPngEncoderMgr> encoderMgr, const SkImageInfo& info,
+                           RowSource* source, int stripHeight)
+    : INHERITED(info, source, stripHeight, encoderMgr->pngBytesPerPixel() * info.width())
+    , fEncoderMgr(std::move(encoderMgr))
+{}
+
 SkPngEncoder::~SkPngEncoder() {}
 
 bool SkPngEncoder::onEncodeRows(int numRows) {
+    if (fEncoderMgr->executor() && 0 == fCurrRow && fSrc.height() == numRows) {
+        // We can only filter rows ourselves if libpng would write them exactly as they come
+        // from our transform procs, e.g. without stripping filler bytes.
+        size_t rowBytes = fEncoderMgr->pngBytesPerPixel() * fSrc.width();
+        int rowsPerBand = SkToInt(SkTMax<size_t>(1, kMinBandBytes / (rowBytes + 1)));
+        if (rowBytes == png_get_rowbytes(fEncoderMgr->pngPtr(), fEncoderMgr->infoPtr()) &&
+            rowsPerBand < fSrc.height()) {
+            fCurrRow = numRows;
+            return encode_in_bands(fEncoderMgr.get(), fRows, rowBytes, rowsPerBand);
+        }
+    }
+
     if (setjmp(png_jmpbuf(fEncoderMgr->pngPtr()))) {
         return false;
     }
 
-    const void* srcRow = fSrc.addr(0, fCurrRow);
+    const void* srcRow = fRows.addr();
     for (int y = 0; y < numRows; y++) {
         fEncoderMgr->proc()((char*)fStorage.get(),
                             (const char*)srcRow,
@@ -421,7 +759,7 @@ bool SkPngEncoder::onEncodeRows(int numRows) {
 
         png_bytep rowPtr = (png_bytep) fStorage.get();
         png_write_rows(fEncoderMgr->pngPtr(), &rowPtr, 1);
-        srcRow = SkTAddOffset<const void>(srcRow, fSrc.rowBytes());
+        srcRow = SkTAddOffset<const void>(srcRow, fRows.rowBytes());
     }
 
     fCurrRow += numRows;
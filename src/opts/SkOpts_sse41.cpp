@@ -21,10 +21,20 @@ namespace SkOpts {
         start_pipeline_highp = SK_OPTS_NS::start_pipeline;
     #undef M
 
+    #define M(fused, ...) fused_stages_highp[SkRasterPipeline::fused] = \
+                                  (StageFn)SK_OPTS_NS::kernel::fused;
+        SK_RASTER_PIPELINE_FUSED_STAGES(M)
+    #undef M
+
     #define M(st) stages_lowp[SkRasterPipeline::st] = (StageFn)SK_OPTS_NS::lowp::st;
         SK_RASTER_PIPELINE_STAGES(M)
         just_return_lowp = (StageFn)SK_OPTS_NS::lowp::just_return;
         start_pipeline_lowp = SK_OPTS_NS::lowp::start_pipeline;
     #undef M
+
+    #define M(fused, ...) fused_stages_lowp[SkRasterPipeline::fused] = \
+                                  (StageFn)SK_OPTS_NS::lowp::kernel::fused;
+        SK_RASTER_PIPELINE_FUSED_STAGES(M)
+    #undef M
     }
 }
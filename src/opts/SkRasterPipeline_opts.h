@@ -9,6 +9,7 @@
 #define SkRasterPipeline_opts_DEFINED
 
 #include "SkTypes.h"
+#include <initializer_list>
 
 // Every function in this file should be marked static and inline using SI.
 #if defined(__clang__)
@@ -83,8 +84,9 @@ struct Ctx {
     #define JUMPER_IS_SCALAR
 #elif defined(SK_ARM_HAS_NEON)
     #define JUMPER_IS_NEON
-#elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX512
-    #define JUMPER_IS_AVX512
+#elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX512 && \
+      defined(__AVX512BW__) && defined(__AVX512DQ__) && defined(__AVX512VL__)
+    #define JUMPER_IS_SKX
 #elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
     #define JUMPER_IS_HSW
 #elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX
@@ -289,7 +291,169 @@ namespace SK_OPTS_NS {
         }
     }
 
-#elif defined(JUMPER_IS_AVX) || defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#elif defined(JUMPER_IS_SKX)
+    // These are __m512 and __m512i, but friendlier and strongly-typed.
+    template <typename T> using V = T __attribute__((ext_vector_type(16)));
+    using F   = V<float   >;
+    using I32 = V< int32_t>;
+    using U64 = V<uint64_t>;
+    using U32 = V<uint32_t>;
+    using U16 = V<uint16_t>;
+    using U8  = V<uint8_t >;
+
+    SI F   mad(F f, F m, F a)   { return _mm512_fmadd_ps(f,m,a); }
+    SI F   min(F a, F b)        { return _mm512_min_ps(a,b);     }
+    SI F   max(F a, F b)        { return _mm512_max_ps(a,b);     }
+    SI F   abs_  (F v)          { return _mm512_abs_ps    (v);   }
+    SI F   floor_(F v)          { return _mm512_floor_ps  (v);   }
+    SI F   rcp   (F v)          { return _mm512_rcp14_ps  (v);   }
+    SI F   rsqrt (F v)          { return _mm512_rsqrt14_ps(v);   }
+    SI F    sqrt_(F v)          { return _mm512_sqrt_ps   (v);   }
+    SI U32 round (F v, F scale) { return _mm512_cvtps_epi32(v*scale); }
+
+    // These saturate signed lanes to unsigned, just like _mm_packus_epi32() and friends.
+    SI U16 pack(U32 v) {
+        return _mm512_cvtusepi32_epi16(_mm512_max_epi32(v, _mm512_setzero_si512()));
+    }
+    SI U8 pack(U16 v) {
+        return _mm256_cvtusepi16_epi8(_mm256_max_epi16(v, _mm256_setzero_si256()));
+    }
+
+    SI F if_then_else(I32 c, F t, F e) {
+        return _mm512_mask_blend_ps(_mm512_movepi32_mask(c), e,t);
+    }
+
+    template <typename T>
+    SI V<T> gather(const T* p, U32 ix) {
+        return { p[ix[ 0]], p[ix[ 1]], p[ix[ 2]], p[ix[ 3]],
+                 p[ix[ 4]], p[ix[ 5]], p[ix[ 6]], p[ix[ 7]],
+                 p[ix[ 8]], p[ix[ 9]], p[ix[10]], p[ix[11]],
+                 p[ix[12]], p[ix[13]], p[ix[14]], p[ix[15]], };
+    }
+    SI F   gather(const float*    p, U32 ix) { return _mm512_i32gather_ps   (ix, p, 4); }
+    SI U32 gather(const uint32_t* p, U32 ix) { return _mm512_i32gather_epi32(ix, p, 4); }
+    SI U64 gather(const uint64_t* p, U32 ix) {
+        __m512i parts[] = {
+            _mm512_i32gather_epi64(_mm512_extracti64x4_epi64(ix,0), p, 8),
+            _mm512_i32gather_epi64(_mm512_extracti64x4_epi64(ix,1), p, 8),
+        };
+        return bit_cast<U64>(parts);
+    }
+
+    // AVX-512 can load or store any prefix of a vector under a mask register without touching
+    // the masked-off memory, so we handle tails this way rather than a lane at a time.
+    // These load or store the first n bytes of a T, zeroing the rest of a loaded T.
+    SI __mmask64 first_bytes(size_t n, size_t skip) {
+        n = n > skip ? n - skip : 0;
+        return n >= 64 ? ~0ull : (1ull << n) - 1;
+    }
+    template <typename T>
+    SI T load_first(const void* src, size_t n) {
+        n = n < sizeof(T) ? n : sizeof(T);
+        __m512i parts[(sizeof(T) + 63) / 64];
+        for (size_t i = 0; i < SK_ARRAY_COUNT(parts); i++) {
+            parts[i] = _mm512_maskz_loadu_epi8(first_bytes(n, 64*i), (const char*)src + 64*i);
+        }
+        return unaligned_load<T>(parts);
+    }
+    template <typename T>
+    SI void store_first(void* dst, T v, size_t n) {
+        n = n < sizeof(T) ? n : sizeof(T);
+        __m512i parts[(sizeof(T) + 63) / 64] = {};
+        memcpy(parts, &v, sizeof(T));
+        for (size_t i = 0; i < SK_ARRAY_COUNT(parts); i++) {
+            _mm512_mask_storeu_epi8((char*)dst + 64*i, first_bytes(n, 64*i), parts[i]);
+        }
+    }
+
+    // Loads or stores k interleaved channels of 16 pixels (or tail pixels) as k vectors,
+    // each holding 16 consecutive values straight from memory.
+    template <int k, typename T, typename P>
+    SI void load_interleaved(const P* ptr, size_t tail, T v[k]) {
+        static_assert(sizeof(T) == 16*sizeof(P), "");
+        for (int i = 0; i < k; i++) {
+            if (__builtin_expect(tail,0)) {
+                size_t n = tail*k > 16*(size_t)i ? tail*k - 16*i : 0;
+                v[i] = load_first<T>(ptr + 16*i, n*sizeof(P));
+            } else {
+                v[i] = unaligned_load<T>(ptr + 16*i);
+            }
+        }
+    }
+    template <int k, typename T, typename P>
+    SI void store_interleaved(P* ptr, size_t tail, const T v[k]) {
+        static_assert(sizeof(T) == 16*sizeof(P), "");
+        for (int i = 0; i < k; i++) {
+            if (__builtin_expect(tail,0)) {
+                size_t n = tail*k > 16*(size_t)i ? tail*k - 16*i : 0;
+                store_first(ptr + 16*i, v[i], n*sizeof(P));
+            } else {
+                unaligned_store(ptr + 16*i, v[i]);
+            }
+        }
+    }
+
+    // v[0] holds r0 g0 b0 a0 r1 g1 b1 a1 ... a3, v[1] holds pixels 4-7, and so on.
+    template <typename T>
+    SI void deinterleave4(const T v[4], T* r, T* g, T* b, T* a) {
+        T rg07 = __builtin_shufflevector(v[0],v[1], 0,1, 4,5,  8, 9, 12,13, 16,17, 20,21, 24,25, 28,29),
+          ba07 = __builtin_shufflevector(v[0],v[1], 2,3, 6,7, 10,11, 14,15, 18,19, 22,23, 26,27, 30,31),
+          rg8F = __builtin_shufflevector(v[2],v[3], 0,1, 4,5,  8, 9, 12,13, 16,17, 20,21, 24,25, 28,29),
+          ba8F = __builtin_shufflevector(v[2],v[3], 2,3, 6,7, 10,11, 14,15, 18,19, 22,23, 26,27, 30,31);
+
+        *r = __builtin_shufflevector(rg07,rg8F, 0,2,4,6,8,10,12,14,16,18,20,22,24,26,28,30);
+        *g = __builtin_shufflevector(rg07,rg8F, 1,3,5,7,9,11,13,15,17,19,21,23,25,27,29,31);
+        *b = __builtin_shufflevector(ba07,ba8F, 0,2,4,6,8,10,12,14,16,18,20,22,24,26,28,30);
+        *a = __builtin_shufflevector(ba07,ba8F, 1,3,5,7,9,11,13,15,17,19,21,23,25,27,29,31);
+    }
+    template <typename T>
+    SI void interleave4(T r, T g, T b, T a, T v[4]) {
+        T rg07 = __builtin_shufflevector(r,g, 0,16, 1,17,  2,18,  3,19,  4,20,  5,21,  6,22,  7,23),
+          rg8F = __builtin_shufflevector(r,g, 8,24, 9,25, 10,26, 11,27, 12,28, 13,29, 14,30, 15,31),
+          ba07 = __builtin_shufflevector(b,a, 0,16, 1,17,  2,18,  3,19,  4,20,  5,21,  6,22,  7,23),
+          ba8F = __builtin_shufflevector(b,a, 8,24, 9,25, 10,26, 11,27, 12,28, 13,29, 14,30, 15,31);
+
+        v[0] = __builtin_shufflevector(rg07,ba07, 0, 1,16,17,  2, 3,18,19,  4, 5,20,21,  6, 7,22,23);
+        v[1] = __builtin_shufflevector(rg07,ba07, 8, 9,24,25, 10,11,26,27, 12,13,28,29, 14,15,30,31);
+        v[2] = __builtin_shufflevector(rg8F,ba8F, 0, 1,16,17,  2, 3,18,19,  4, 5,20,21,  6, 7,22,23);
+        v[3] = __builtin_shufflevector(rg8F,ba8F, 8, 9,24,25, 10,11,26,27, 12,13,28,29, 14,15,30,31);
+    }
+
+    SI void load3(const uint16_t* ptr, size_t tail, U16* r, U16* g, U16* b) {
+        U16 v[3];
+        load_interleaved<3>(ptr, tail, v);
+
+        // Gather the first 11 (or 10) values of each channel from v[0] and v[1], then the rest.
+        U16 r0A = __builtin_shufflevector(v[0],v[1], 0,3,6,9,12,15,18,21,24,27,30, -1,-1,-1,-1,-1),
+            g0A = __builtin_shufflevector(v[0],v[1], 1,4,7,10,13,16,19,22,25,28,31, -1,-1,-1,-1,-1),
+            b09 = __builtin_shufflevector(v[0],v[1], 2,5,8,11,14,17,20,23,26,29, -1,-1,-1,-1,-1,-1);
+        *r = __builtin_shufflevector(r0A,v[2], 0,1,2,3,4,5,6,7,8,9,10, 17,20,23,26,29);
+        *g = __builtin_shufflevector(g0A,v[2], 0,1,2,3,4,5,6,7,8,9,10, 18,21,24,27,30);
+        *b = __builtin_shufflevector(b09,v[2], 0,1,2,3,4,5,6,7,8,9, 16,19,22,25,28,31);
+    }
+    SI void load4(const uint16_t* ptr, size_t tail, U16* r, U16* g, U16* b, U16* a) {
+        U16 v[4];
+        load_interleaved<4>(ptr, tail, v);
+        deinterleave4(v, r,g,b,a);
+    }
+    SI void store4(uint16_t* ptr, size_t tail, U16 r, U16 g, U16 b, U16 a) {
+        U16 v[4];
+        interleave4(r,g,b,a, v);
+        store_interleaved<4>(ptr, tail, v);
+    }
+
+    SI void load4(const float* ptr, size_t tail, F* r, F* g, F* b, F* a) {
+        F v[4];
+        load_interleaved<4>(ptr, tail, v);
+        deinterleave4(v, r,g,b,a);
+    }
+    SI void store4(float* ptr, size_t tail, F r, F g, F b, F a) {
+        F v[4];
+        interleave4(r,g,b,a, v);
+        store_interleaved<4>(ptr, tail, v);
+    }
+
+#elif defined(JUMPER_IS_AVX) || defined(JUMPER_IS_HSW)
     // These are __m256 and __m256i, but friendlier and strongly-typed.
     template <typename T> using V = T __attribute__((ext_vector_type(8)));
     using F   = V<float   >;
@@ -300,7 +464,7 @@ namespace SK_OPTS_NS {
     using U8  = V<uint8_t >;
 
     SI F mad(F f, F m, F a)  {
-    #if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+    #if defined(JUMPER_IS_HSW)
         return _mm256_fmadd_ps(f,m,a);
     #else
         return f*m+a;
@@ -332,7 +496,7 @@ namespace SK_OPTS_NS {
         return { p[ix[0]], p[ix[1]], p[ix[2]], p[ix[3]],
                  p[ix[4]], p[ix[5]], p[ix[6]], p[ix[7]], };
     }
-    #if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+    #if defined(JUMPER_IS_HSW)
         SI F   gather(const float*    p, U32 ix) { return _mm256_i32gather_ps   (p, ix, 4); }
         SI U32 gather(const uint32_t* p, U32 ix) { return _mm256_i32gather_epi32(p, ix, 4); }
         SI U64 gather(const uint64_t* p, U32 ix) {
@@ -732,7 +896,10 @@ SI F from_half(U16 h) {
 #if defined(SK_CPU_ARM64) && !defined(SK_BUILD_FOR_GOOGLE3)  // Temporary workaround for some Google3 builds.
     return vcvt_f32_f16(h);
 
-#elif defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#elif defined(JUMPER_IS_SKX)
+    return _mm512_cvtph_ps(h);
+
+#elif defined(JUMPER_IS_HSW)
     return _mm256_cvtph_ps(h);
 
 #else
@@ -752,7 +919,10 @@ SI U16 to_half(F f) {
 #if defined(SK_CPU_ARM64) && !defined(SK_BUILD_FOR_GOOGLE3)  // Temporary workaround for some Google3 builds.
     return vcvt_f16_f32(f);
 
-#elif defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#elif defined(JUMPER_IS_SKX)
+    return _mm512_cvtps_ph(f, _MM_FROUND_CUR_DIRECTION);
+
+#elif defined(JUMPER_IS_HSW)
     return _mm256_cvtps_ph(f, _MM_FROUND_CUR_DIRECTION);
 
 #else
@@ -843,10 +1013,21 @@ static void start_pipeline(size_t dx, size_t dy, size_t xlimit, size_t ylimit, v
     }
 }
 
+// Each STAGE() also wraps its body up as kernel::name, so fused stages can run it inline.
+#define SK_STAGE_KERNEL(name)                                                    \
+    namespace kernel {                                                           \
+        struct name {                                                            \
+            static constexpr bool kAvailable = true;                             \
+            template <typename... Args>                                          \
+            SI void run(Args&&... args) { name##_k(args...); }                   \
+        };                                                                       \
+    }
+
 #if JUMPER_NARROW_STAGES
     #define STAGE(name, ...)                                                    \
         SI void name##_k(__VA_ARGS__, size_t dx, size_t dy, size_t tail,        \
                          F& r, F& g, F& b, F& a, F& dr, F& dg, F& db, F& da);   \
+        SK_STAGE_KERNEL(name)                                                   \
         static void ABI name(Params* params, void** program,                    \
                              F r, F g, F b, F a) {                              \
             name##_k(Ctx{program},params->dx,params->dy,params->tail, r,g,b,a,  \
@@ -860,6 +1041,7 @@ static void start_pipeline(size_t dx, size_t dy, size_t xlimit, size_t ylimit, v
     #define STAGE(name, ...)                                                         \
         SI void name##_k(__VA_ARGS__, size_t dx, size_t dy, size_t tail,             \
                          F& r, F& g, F& b, F& a, F& dr, F& dg, F& db, F& da);        \
+        SK_STAGE_KERNEL(name)                                                        \
         static void ABI name(size_t tail, void** program, size_t dx, size_t dy,      \
                              F r, F g, F b, F a, F dr, F dg, F db, F da) {           \
             name##_k(Ctx{program},dx,dy,tail, r,g,b,a, dr,dg,db,da);                 \
@@ -879,6 +1061,29 @@ static void start_pipeline(size_t dx, size_t dy, size_t xlimit, size_t ylimit, v
     static void ABI just_return(size_t, void**, size_t,size_t, F,F,F,F, F,F,F,F) {}
 #endif
 
+// fuse<Kernels...> runs each kernel in turn, each pulling its context (if any) off the program,
+// then calls the next stage.  See SK_RASTER_PIPELINE_FUSED_STAGES.
+#if JUMPER_NARROW_STAGES
+    template <typename... Kernels>
+    static void ABI fuse(Params* params, void** program, F r, F g, F b, F a) {
+        int in_order[] = { (Kernels::run(Ctx{program}, params->dx,params->dy,params->tail,
+                                         r,g,b,a, params->dr,params->dg,params->db,params->da),
+                            0)... };
+        (void)in_order;
+        auto next = (Stage)load_and_inc(program);
+        next(params,program, r,g,b,a);
+    }
+#else
+    template <typename... Kernels>
+    static void ABI fuse(size_t tail, void** program, size_t dx, size_t dy,
+                         F r, F g, F b, F a, F dr, F dg, F db, F da) {
+        int in_order[] = { (Kernels::run(Ctx{program}, dx,dy,tail, r,g,b,a, dr,dg,db,da), 0)... };
+        (void)in_order;
+        auto next = (Stage)load_and_inc(program);
+        next(tail,program,dx,dy, r,g,b,a, dr,dg,db,da);
+    }
+#endif
+
 
 // We could start defining normal Stages now.  But first, some helper functions.
 
@@ -887,7 +1092,12 @@ static void start_pipeline(size_t dx, size_t dy, size_t xlimit, size_t ylimit, v
 
 template <typename V, typename T>
 SI V load(const T* src, size_t tail) {
-#if !defined(JUMPER_IS_SCALAR)
+#if defined(JUMPER_IS_SKX)
+    __builtin_assume(tail < N);
+    if (__builtin_expect(tail, 0)) {
+        return load_first<V>(src, tail*sizeof(T));  // Any inactive lanes are zeroed.
+    }
+#elif !defined(JUMPER_IS_SCALAR)
     __builtin_assume(tail < N);
     if (__builtin_expect(tail, 0)) {
         V v{};  // Any inactive lanes are zeroed.
@@ -908,7 +1118,13 @@ SI V load(const T* src, size_t tail) {
 
 template <typename V, typename T>
 SI void store(T* dst, V v, size_t tail) {
-#if !defined(JUMPER_IS_SCALAR)
+#if defined(JUMPER_IS_SKX)
+    __builtin_assume(tail < N);
+    if (__builtin_expect(tail, 0)) {
+        store_first(dst, v, tail*sizeof(T));
+        return;
+    }
+#elif !defined(JUMPER_IS_SCALAR)
     __builtin_assume(tail < N);
     if (__builtin_expect(tail, 0)) {
         switch (tail) {
@@ -1011,7 +1227,7 @@ STAGE(seed_shader, Ctx::None) {
 
 STAGE(dither, const float* rate) {
     // Get [(dx,dy), (dx+1,dy), (dx+2,dy), ...] loaded up in integer vectors.
-    uint32_t iota[] = {0,1,2,3,4,5,6,7};
+    uint32_t iota[] = {0,1,2,3,4,5,6,7, 8,9,10,11,12,13,14,15};
     U32 X = dx + unaligned_load<U32>(iota),
         Y = dy;
 
@@ -1590,7 +1806,7 @@ STAGE(to_srgb, Ctx::None) {
         U32 sign;
         l = strip_sign(l, &sign);
         // We tweak c and d for each instruction set to make sure fn(1) is exactly 1.
-    #if defined(JUMPER_IS_AVX512)
+    #if defined(JUMPER_IS_SKX)
         const float c = 1.130026340485f,
                     d = 0.141387879848f;
     #elif defined(JUMPER_IS_SSE2) || defined(JUMPER_IS_SSE41) || \
@@ -1621,6 +1837,21 @@ STAGE(load_a8, const SkRasterPipeline_MemoryCtx* ctx) {
     r = g = b = 0.0f;
     a = from_byte(load<U8>(ptr, tail));
 }
+STAGE(load_yuv, const SkRasterPipeline_YUVCtx* ctx) {
+    r = from_byte(load<U8>(ptr_at_xy<const uint8_t>(&ctx->y, dx,dy), tail));
+
+    // U and V may be subsampled, so we gather them.  Clamping keeps lanes past the tail in the row.
+    static const float iota[] = {
+        0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f,
+        8.5f, 9.5f,10.5f,11.5f,12.5f,13.5f,14.5f,15.5f,
+    };
+    U32 ix = trunc_(clamp((cast(dx) + unaligned_load<F>(iota)) * ctx->uvScaleX, ctx->uvWidth));
+    const size_t uvY = dy >> ctx->uvShiftY;
+    g = from_byte(gather(ptr_at_xy<const uint8_t>(&ctx->u, 0, uvY), ix));
+    b = from_byte(gather(ptr_at_xy<const uint8_t>(&ctx->v, 0, uvY), ix));
+    a = 1.0f;
+}
+
 STAGE(load_a8_dst, const SkRasterPipeline_MemoryCtx* ctx) {
     auto ptr = ptr_at_xy<const uint8_t>(ctx, dx,dy);
 
@@ -1933,7 +2164,18 @@ STAGE(matrix_perspective, const float* m) {
 SI void gradient_lookup(const SkRasterPipeline_GradientCtx* c, U32 idx, F t,
                         F* r, F* g, F* b, F* a) {
     F fr, br, fg, bg, fb, bb, fa, ba;
-#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#if defined(JUMPER_IS_SKX)
+    if (c->stopCount <= 16) {
+        fr = _mm512_permutexvar_ps(idx, _mm512_loadu_ps(c->fs[0]));
+        br = _mm512_permutexvar_ps(idx, _mm512_loadu_ps(c->bs[0]));
+        fg = _mm512_permutexvar_ps(idx, _mm512_loadu_ps(c->fs[1]));
+        bg = _mm512_permutexvar_ps(idx, _mm512_loadu_ps(c->bs[1]));
+        fb = _mm512_permutexvar_ps(idx, _mm512_loadu_ps(c->fs[2]));
+        bb = _mm512_permutexvar_ps(idx, _mm512_loadu_ps(c->bs[2]));
+        fa = _mm512_permutexvar_ps(idx, _mm512_loadu_ps(c->fs[3]));
+        ba = _mm512_permutexvar_ps(idx, _mm512_loadu_ps(c->bs[3]));
+    } else
+#elif defined(JUMPER_IS_HSW)
     if (c->stopCount <=8) {
         fr = _mm256_permutevar8x32_ps(_mm256_loadu_ps(c->fs[0]), idx);
         br = _mm256_permutevar8x32_ps(_mm256_loadu_ps(c->bs[0]), idx);
@@ -2256,6 +2498,13 @@ STAGE(bilerp_clamp_8888, const SkRasterPipeline_GatherCtx* ctx) {
     }
 }
 
+namespace kernel {
+    // In here, each stage's name means its kernel rather than its stage function.
+    #define M(fused, ...) static const Stage fused = fuse<__VA_ARGS__>;
+        SK_RASTER_PIPELINE_FUSED_STAGES(M)
+    #undef M
+}
+
 namespace lowp {
 #if defined(JUMPER_IS_SCALAR) || defined(SK_DISABLE_LOWP_RASTER_PIPELINE)
     // If we're not compiled by Clang, or otherwise switched into scalar mode (old Clang, manually),
@@ -2268,9 +2517,22 @@ namespace lowp {
 
     static void start_pipeline(size_t,size_t,size_t,size_t, void**) {}
 
+    namespace kernel {
+    #define M(fused, ...) static void (*fused)(void) = nullptr;
+        SK_RASTER_PIPELINE_FUSED_STAGES(M)
+    #undef M
+    }
+
 #else  // We are compiling vector code with Clang... let's make some lowp stages!
 
-#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#if defined(JUMPER_IS_SKX)
+    using U8  = uint8_t  __attribute__((ext_vector_type(32)));
+    using U16 = uint16_t __attribute__((ext_vector_type(32)));
+    using I16 =  int16_t __attribute__((ext_vector_type(32)));
+    using I32 =  int32_t __attribute__((ext_vector_type(32)));
+    using U32 = uint32_t __attribute__((ext_vector_type(32)));
+    using F   = float    __attribute__((ext_vector_type(32)));
+#elif defined(JUMPER_IS_HSW)
     using U8  = uint8_t  __attribute__((ext_vector_type(16)));
     using U16 = uint16_t __attribute__((ext_vector_type(16)));
     using I16 =  int16_t __attribute__((ext_vector_type(16)));
@@ -2335,6 +2597,35 @@ static void start_pipeline(const size_t x0,     const size_t y0,
     static void ABI just_return(size_t,void**,size_t,size_t, U16,U16,U16,U16, U16,U16,U16,U16) {}
 #endif
 
+// Like highp's fuse<Kernels...>.  Geometry kernels work on x and y, and pixel kernels on r,g,b,a.
+// We only fuse runs that end with pixels, so we never need to split x and y back into r,g,b,a.
+#if JUMPER_NARROW_STAGES
+    template <typename... Kernels>
+    static void ABI fuse(Params* params, void** program, U16 r, U16 g, U16 b, U16 a) {
+        auto x = join<F>(r,g),
+             y = join<F>(b,a);
+        int in_order[] = { (Kernels::run(Ctx{program}, params->dx,params->dy,params->tail, x,y,
+                                         r,g,b,a, params->dr,params->dg,params->db,params->da),
+                            0)... };
+        (void)in_order;
+        auto next = (Stage)load_and_inc(program);
+        next(params,program, r,g,b,a);
+    }
+#else
+    template <typename... Kernels>
+    static void ABI fuse(size_t tail, void** program, size_t dx, size_t dy,
+                         U16  r, U16  g, U16  b, U16  a,
+                         U16 dr, U16 dg, U16 db, U16 da) {
+        auto x = join<F>(r,g),
+             y = join<F>(b,a);
+        int in_order[] = { (Kernels::run(Ctx{program}, dx,dy,tail, x,y, r,g,b,a, dr,dg,db,da),
+                            0)... };
+        (void)in_order;
+        auto next = (Stage)load_and_inc(program);
+        next(tail,program,dx,dy, r,g,b,a, dr,dg,db,da);
+    }
+#endif
+
 // All stages use the same function call ABI to chain into each other, but there are three types:
 //   GG: geometry in, geometry out  -- think, a matrix
 //   GP: geometry in, pixels out.   -- think, a memory gather
@@ -2350,6 +2641,7 @@ static void start_pipeline(const size_t x0,     const size_t y0,
         SI void name##_k(__VA_ARGS__, size_t dx, size_t dy, size_t tail, F& x, F& y,           \
                          U16    , U16    , U16    , U16    ,                                   \
                          U16    , U16    , U16    , U16    );                                  \
+        SK_STAGE_KERNEL(name)                                                                  \
         static void ABI name(Params* params, void** program, U16 r, U16 g, U16 b, U16 a) {     \
             auto x = join<F>(r,g),                                                             \
                  y = join<F>(b,a);                                                             \
@@ -2367,6 +2659,7 @@ static void start_pipeline(const size_t x0,     const size_t y0,
         SI void name##_k(__VA_ARGS__, size_t dx, size_t dy, size_t tail, F x, F y,         \
                          U16&  r, U16&  g, U16&  b, U16&  a,                               \
                          U16& dr, U16& dg, U16& db, U16& da);                              \
+        SK_STAGE_KERNEL(name)                                                              \
         static void ABI name(Params* params, void** program, U16 r, U16 g, U16 b, U16 a) { \
             auto x = join<F>(r,g),                                                         \
                  y = join<F>(b,a);                                                         \
@@ -2383,6 +2676,7 @@ static void start_pipeline(const size_t x0,     const size_t y0,
         SI void name##_k(__VA_ARGS__, size_t dx, size_t dy, size_t tail, F  , F  ,         \
                          U16&  r, U16&  g, U16&  b, U16&  a,                               \
                          U16& dr, U16& dg, U16& db, U16& da);                              \
+        SK_STAGE_KERNEL(name)                                                              \
         static void ABI name(Params* params, void** program, U16 r, U16 g, U16 b, U16 a) { \
             name##_k(Ctx{program}, params->dx,params->dy,params->tail, 0,0, r,g,b,a,       \
                      params->dr,params->dg,params->db,params->da);                         \
@@ -2397,6 +2691,7 @@ static void start_pipeline(const size_t x0,     const size_t y0,
         SI void name##_k(__VA_ARGS__, size_t dx, size_t dy, size_t tail, F& x, F& y,       \
                          U16    , U16    , U16    , U16    ,                               \
                          U16    , U16    , U16    , U16    );                              \
+        SK_STAGE_KERNEL(name)                                                              \
         static void ABI name(size_t tail, void** program, size_t dx, size_t dy,            \
                              U16  r, U16  g, U16  b, U16  a,                               \
                              U16 dr, U16 dg, U16 db, U16 da) {                             \
@@ -2416,6 +2711,7 @@ static void start_pipeline(const size_t x0,     const size_t y0,
         SI void name##_k(__VA_ARGS__, size_t dx, size_t dy, size_t tail, F x, F y,         \
                          U16&  r, U16&  g, U16&  b, U16&  a,                               \
                          U16& dr, U16& dg, U16& db, U16& da);                              \
+        SK_STAGE_KERNEL(name)                                                              \
         static void ABI name(size_t tail, void** program, size_t dx, size_t dy,            \
                              U16  r, U16  g, U16  b, U16  a,                               \
                              U16 dr, U16 dg, U16 db, U16 da) {                             \
@@ -2433,6 +2729,7 @@ static void start_pipeline(const size_t x0,     const size_t y0,
         SI void name##_k(__VA_ARGS__, size_t dx, size_t dy, size_t tail, F  , F  ,         \
                          U16&  r, U16&  g, U16&  b, U16&  a,                               \
                          U16& dr, U16& dg, U16& db, U16& da);                              \
+        SK_STAGE_KERNEL(name)                                                              \
         static void ABI name(size_t tail, void** program, size_t dx, size_t dy,            \
                              U16  r, U16  g, U16  b, U16  a,                               \
                              U16 dr, U16 dg, U16 db, U16 da) {                             \
@@ -2504,7 +2801,11 @@ SI F mad(F f, F m, F a) { return f*m+a; }
 SI U32 trunc_(F x) { return (U32)cast<I32>(x); }
 
 SI F rcp(F x) {
-#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#if defined(JUMPER_IS_SKX)
+    __m512 lo,hi;
+    split(x, &lo,&hi);
+    return join<F>(_mm512_rcp14_ps(lo), _mm512_rcp14_ps(hi));
+#elif defined(JUMPER_IS_HSW)
     __m256 lo,hi;
     split(x, &lo,&hi);
     return join<F>(_mm256_rcp_ps(lo), _mm256_rcp_ps(hi));
@@ -2525,7 +2826,11 @@ SI F rcp(F x) {
 #endif
 }
 SI F sqrt_(F x) {
-#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#if defined(JUMPER_IS_SKX)
+    __m512 lo,hi;
+    split(x, &lo,&hi);
+    return join<F>(_mm512_sqrt_ps(lo), _mm512_sqrt_ps(hi));
+#elif defined(JUMPER_IS_HSW)
     __m256 lo,hi;
     split(x, &lo,&hi);
     return join<F>(_mm256_sqrt_ps(lo), _mm256_sqrt_ps(hi));
@@ -2560,7 +2865,11 @@ SI F floor_(F x) {
     float32x4_t lo,hi;
     split(x, &lo,&hi);
     return join<F>(vrndmq_f32(lo), vrndmq_f32(hi));
-#elif defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#elif defined(JUMPER_IS_SKX)
+    __m512 lo,hi;
+    split(x, &lo,&hi);
+    return join<F>(_mm512_floor_ps(lo), _mm512_floor_ps(hi));
+#elif defined(JUMPER_IS_HSW)
     __m256 lo,hi;
     split(x, &lo,&hi);
     return join<F>(_mm256_floor_ps(lo), _mm256_floor_ps(hi));
@@ -2580,8 +2889,10 @@ SI F abs_(F x) { return bit_cast<F>( bit_cast<I32>(x) & 0x7fffffff ); }
 
 STAGE_GG(seed_shader, Ctx::None) {
     static const float iota[] = {
-        0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f,
-        8.5f, 9.5f,10.5f,11.5f,12.5f,13.5f,14.5f,15.5f,
+         0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f,
+         8.5f, 9.5f,10.5f,11.5f,12.5f,13.5f,14.5f,15.5f,
+        16.5f,17.5f,18.5f,19.5f,20.5f,21.5f,22.5f,23.5f,
+        24.5f,25.5f,26.5f,27.5f,28.5f,29.5f,30.5f,31.5f,
     };
     x = cast<F>(I32(dx)) + unaligned_load<F>(iota);
     y = cast<F>(I32(dy)) + 0.5f;
@@ -2760,10 +3071,16 @@ SI U32 ix_and_ptr(T** ptr, const SkRasterPipeline_GatherCtx* ctx, F x, F y) {
 
 template <typename V, typename T>
 SI V load(const T* ptr, size_t tail) {
+#if defined(JUMPER_IS_SKX)
+    if (__builtin_expect(tail & (N-1), 0)) {
+        return load_first<V>(ptr, (tail & (N-1))*sizeof(T));
+    }
+    return unaligned_load<V>(ptr);
+#else
     V v = 0;
     switch (tail & (N-1)) {
         case  0: memcpy(&v, ptr, sizeof(v)); break;
-    #if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+    #if defined(JUMPER_IS_HSW)
         case 15: v[14] = ptr[14];
         case 14: v[13] = ptr[13];
         case 13: v[12] = ptr[12];
@@ -2782,12 +3099,20 @@ SI V load(const T* ptr, size_t tail) {
         case  1: v[ 0] = ptr[ 0];
     }
     return v;
+#endif
 }
 template <typename V, typename T>
 SI void store(T* ptr, size_t tail, V v) {
+#if defined(JUMPER_IS_SKX)
+    if (__builtin_expect(tail & (N-1), 0)) {
+        store_first(ptr, v, (tail & (N-1))*sizeof(T));
+        return;
+    }
+    unaligned_store(ptr, v);
+#else
     switch (tail & (N-1)) {
         case  0: memcpy(ptr, &v, sizeof(v)); break;
-    #if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+    #if defined(JUMPER_IS_HSW)
         case 15: ptr[14] = v[14];
         case 14: ptr[13] = v[13];
         case 13: ptr[12] = v[12];
@@ -2805,9 +3130,40 @@ SI void store(T* ptr, size_t tail, V v) {
         case  2: memcpy(ptr, &v,  2*sizeof(T)); break;
         case  1: ptr[ 0] = v[ 0];
     }
+#endif
 }
 
-#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#if defined(JUMPER_IS_SKX)
+    template <typename V, typename T>
+    SI V gather(const T* ptr, U32 ix) {
+        return V{ ptr[ix[ 0]], ptr[ix[ 1]], ptr[ix[ 2]], ptr[ix[ 3]],
+                  ptr[ix[ 4]], ptr[ix[ 5]], ptr[ix[ 6]], ptr[ix[ 7]],
+                  ptr[ix[ 8]], ptr[ix[ 9]], ptr[ix[10]], ptr[ix[11]],
+                  ptr[ix[12]], ptr[ix[13]], ptr[ix[14]], ptr[ix[15]],
+                  ptr[ix[16]], ptr[ix[17]], ptr[ix[18]], ptr[ix[19]],
+                  ptr[ix[20]], ptr[ix[21]], ptr[ix[22]], ptr[ix[23]],
+                  ptr[ix[24]], ptr[ix[25]], ptr[ix[26]], ptr[ix[27]],
+                  ptr[ix[28]], ptr[ix[29]], ptr[ix[30]], ptr[ix[31]], };
+    }
+
+    template<>
+    F gather(const float* ptr, U32 ix) {
+        __m512i lo, hi;
+        split(ix, &lo, &hi);
+
+        return join<F>(_mm512_i32gather_ps(lo, ptr, 4),
+                       _mm512_i32gather_ps(hi, ptr, 4));
+    }
+
+    template<>
+    U32 gather(const uint32_t* ptr, U32 ix) {
+        __m512i lo, hi;
+        split(ix, &lo, &hi);
+
+        return join<U32>(_mm512_i32gather_epi32(lo, ptr, 4),
+                         _mm512_i32gather_epi32(hi, ptr, 4));
+    }
+#elif defined(JUMPER_IS_HSW)
     template <typename V, typename T>
     SI V gather(const T* ptr, U32 ix) {
         return V{ ptr[ix[ 0]], ptr[ix[ 1]], ptr[ix[ 2]], ptr[ix[ 3]],
@@ -2845,7 +3201,7 @@ SI void store(T* ptr, size_t tail, V v) {
 // ~~~~~~ 32-bit memory loads and stores ~~~~~~ //
 
 SI void from_8888(U32 rgba, U16* r, U16* g, U16* b, U16* a) {
-#if 1 && defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#if 1 && defined(JUMPER_IS_HSW)
     // Swap the middle 128-bit lanes to make _mm256_packus_epi32() in cast_U16() work out nicely.
     __m256i _01,_23;
     split(rgba, &_01, &_23);
@@ -3180,7 +3536,29 @@ SI void gradient_lookup(const SkRasterPipeline_GradientCtx* c, U32 idx, F t,
                         U16* r, U16* g, U16* b, U16* a) {
 
     F fr, fg, fb, fa, br, bg, bb, ba;
-#if defined(JUMPER_IS_HSW) || defined(JUMPER_IS_AVX512)
+#if defined(JUMPER_IS_SKX)
+    if (c->stopCount <= 16) {
+        __m512i lo, hi;
+        split(idx, &lo, &hi);
+
+        fr = join<F>(_mm512_permutexvar_ps(lo, _mm512_loadu_ps(c->fs[0])),
+                     _mm512_permutexvar_ps(hi, _mm512_loadu_ps(c->fs[0])));
+        br = join<F>(_mm512_permutexvar_ps(lo, _mm512_loadu_ps(c->bs[0])),
+                     _mm512_permutexvar_ps(hi, _mm512_loadu_ps(c->bs[0])));
+        fg = join<F>(_mm512_permutexvar_ps(lo, _mm512_loadu_ps(c->fs[1])),
+                     _mm512_permutexvar_ps(hi, _mm512_loadu_ps(c->fs[1])));
+        bg = join<F>(_mm512_permutexvar_ps(lo, _mm512_loadu_ps(c->bs[1])),
+                     _mm512_permutexvar_ps(hi, _mm512_loadu_ps(c->bs[1])));
+        fb = join<F>(_mm512_permutexvar_ps(lo, _mm512_loadu_ps(c->fs[2])),
+                     _mm512_permutexvar_ps(hi, _mm512_loadu_ps(c->fs[2])));
+        bb = join<F>(_mm512_permutexvar_ps(lo, _mm512_loadu_ps(c->bs[2])),
+                     _mm512_permutexvar_ps(hi, _mm512_loadu_ps(c->bs[2])));
+        fa = join<F>(_mm512_permutexvar_ps(lo, _mm512_loadu_ps(c->fs[3])),
+                     _mm512_permutexvar_ps(hi, _mm512_loadu_ps(c->fs[3])));
+        ba = join<F>(_mm512_permutexvar_ps(lo, _mm512_loadu_ps(c->bs[3])),
+                     _mm512_permutexvar_ps(hi, _mm512_loadu_ps(c->bs[3])));
+    } else
+#elif defined(JUMPER_IS_HSW)
     if (c->stopCount <=8) {
         __m256i lo, hi;
         split(idx, &lo, &hi);
@@ -3291,6 +3669,7 @@ STAGE_PP(srcover_rgba_8888, const SkRasterPipeline_MemoryCtx* ctx) {
 
 #if defined(SK_DISABLE_LOWP_BILERP_CLAMP_CLAMP_STAGE)
     static void(*bilerp_clamp_8888)(void) = nullptr;
+    namespace kernel { struct bilerp_clamp_8888 { static constexpr bool kAvailable = false; }; }
 #else
 STAGE_GP(bilerp_clamp_8888, const SkRasterPipeline_GatherCtx* ctx) {
     // (cx,cy) are the center of our sample.
@@ -3356,6 +3735,28 @@ STAGE_GP(bilerp_clamp_8888, const SkRasterPipeline_GatherCtx* ctx) {
 }
 #endif
 
+// We leave a run unfused in lowp if any of its kernels has been compiled out.
+template <typename... Kernels>
+SI constexpr bool all_available() {
+    bool available = true;
+    for (bool k : {Kernels::kAvailable...}) {
+        available = available && k;
+    }
+    return available;
+}
+template <bool, typename... Kernels>
+struct Fused { static constexpr Stage stage = nullptr; };
+template <typename... Kernels>
+struct Fused<true, Kernels...> { static constexpr Stage stage = fuse<Kernels...>; };
+
+namespace kernel {
+    // As in highp, each stage's name means its kernel here.
+    #define M(fused, ...) \
+        static const Stage fused = Fused<all_available<__VA_ARGS__>(), __VA_ARGS__>::stage;
+        SK_RASTER_PIPELINE_FUSED_STAGES(M)
+    #undef M
+}
+
 // Now we'll add null stand-ins for stages we haven't implemented in lowp.
 // If a pipeline uses these stages, it'll boot it out of lowp into highp.
 #define NOT_IMPLEMENTED(st) static void (*st)(void) = nullptr;
@@ -3382,6 +3783,7 @@ STAGE_GP(bilerp_clamp_8888, const SkRasterPipeline_GatherCtx* ctx) {
     NOT_IMPLEMENTED(load_1010102_dst)
     NOT_IMPLEMENTED(store_1010102)
     NOT_IMPLEMENTED(gather_1010102)
+    NOT_IMPLEMENTED(load_yuv)
     NOT_IMPLEMENTED(store_u16_be)
     NOT_IMPLEMENTED(byte_tables)  // TODO
     NOT_IMPLEMENTED(colorburn)
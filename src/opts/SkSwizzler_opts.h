@@ -158,6 +158,68 @@ static void inverted_CMYK_to_BGR1_portable(uint32_t* dst, const uint32_t* src, i
     }
 }
 
+// 16-bit channels are big-endian, so we keep the first byte of each.
+static void RGB16_to_RGB1_portable(uint32_t dst[], const uint8_t* src, int count) {
+    for (int i = 0; i < count; i++) {
+        uint8_t r = src[0],
+                g = src[2],
+                b = src[4];
+        src += 6;
+        dst[i] = (uint32_t)0xFF << 24
+               | (uint32_t)b    << 16
+               | (uint32_t)g    <<  8
+               | (uint32_t)r    <<  0;
+    }
+}
+
+static void RGB16_to_BGR1_portable(uint32_t dst[], const uint8_t* src, int count) {
+    for (int i = 0; i < count; i++) {
+        uint8_t r = src[0],
+                g = src[2],
+                b = src[4];
+        src += 6;
+        dst[i] = (uint32_t)0xFF << 24
+               | (uint32_t)r    << 16
+               | (uint32_t)g    <<  8
+               | (uint32_t)b    <<  0;
+    }
+}
+
+static void RGBA16_to_RGBA_portable(uint32_t dst[], const uint8_t* src, int count) {
+    for (int i = 0; i < count; i++) {
+        uint8_t r = src[0],
+                g = src[2],
+                b = src[4],
+                a = src[6];
+        src += 8;
+        dst[i] = (uint32_t)a << 24
+               | (uint32_t)b << 16
+               | (uint32_t)g <<  8
+               | (uint32_t)r <<  0;
+    }
+}
+
+static void RGBA16_to_BGRA_portable(uint32_t dst[], const uint8_t* src, int count) {
+    for (int i = 0; i < count; i++) {
+        uint8_t r = src[0],
+                g = src[2],
+                b = src[4],
+                a = src[6];
+        src += 8;
+        dst[i] = (uint32_t)a << 24
+               | (uint32_t)r << 16
+               | (uint32_t)g <<  8
+               | (uint32_t)b <<  0;
+    }
+}
+
+static void index_to_8888_portable(uint32_t dst[], const uint8_t* src, int count,
+                                   const uint32_t ctable[]) {
+    for (int i = 0; i < count; i++) {
+        dst[i] = ctable[src[i]];
+    }
+}
+
 #if defined(SK_ARM_HAS_NEON)
 
 // Rounded divide by 255, (x + 127) / 255
@@ -477,6 +539,86 @@ static void inverted_cmyk_to(uint32_t* dst, const uint32_t* src, int count) {
     inverted_cmyk_to<kBGR1>(dst, src, count);
 }
 
+template <bool kSwapRB>
+static void strip16_rgb_should_swaprb(uint32_t dst[], const uint8_t* src, int count) {
+    while (count >= 8) {
+        // Load 8 pixels.  The low byte of each little-endian lane is the big-endian high byte.
+        uint16x8x3_t rgb = vld3q_u16((const uint16_t*) src);
+
+        // Keep the high bytes, insert an opaque alpha channel, and swap if needed.
+        uint8x8x4_t rgba;
+        if (kSwapRB) {
+            rgba.val[0] = vmovn_u16(rgb.val[2]);
+            rgba.val[2] = vmovn_u16(rgb.val[0]);
+        } else {
+            rgba.val[0] = vmovn_u16(rgb.val[0]);
+            rgba.val[2] = vmovn_u16(rgb.val[2]);
+        }
+        rgba.val[1] = vmovn_u16(rgb.val[1]);
+        rgba.val[3] = vdup_n_u8(0xFF);
+
+        // Store 8 pixels.
+        vst4_u8((uint8_t*) dst, rgba);
+        src += 8*6;
+        dst += 8;
+        count -= 8;
+    }
+
+    auto proc = kSwapRB ? RGB16_to_BGR1_portable : RGB16_to_RGB1_portable;
+    proc(dst, src, count);
+}
+
+/*not static*/ inline void RGB16_to_RGB1(uint32_t dst[], const uint8_t* src, int count) {
+    strip16_rgb_should_swaprb<false>(dst, src, count);
+}
+
+/*not static*/ inline void RGB16_to_BGR1(uint32_t dst[], const uint8_t* src, int count) {
+    strip16_rgb_should_swaprb<true>(dst, src, count);
+}
+
+template <bool kSwapRB>
+static void strip16_rgba_should_swaprb(uint32_t dst[], const uint8_t* src, int count) {
+    while (count >= 8) {
+        // Load 8 pixels.  The low byte of each little-endian lane is the big-endian high byte.
+        uint16x8x4_t rgba16 = vld4q_u16((const uint16_t*) src);
+
+        // Keep the high bytes, and swap if needed.
+        uint8x8x4_t rgba;
+        if (kSwapRB) {
+            rgba.val[0] = vmovn_u16(rgba16.val[2]);
+            rgba.val[2] = vmovn_u16(rgba16.val[0]);
+        } else {
+            rgba.val[0] = vmovn_u16(rgba16.val[0]);
+            rgba.val[2] = vmovn_u16(rgba16.val[2]);
+        }
+        rgba.val[1] = vmovn_u16(rgba16.val[1]);
+        rgba.val[3] = vmovn_u16(rgba16.val[3]);
+
+        // Store 8 pixels.
+        vst4_u8((uint8_t*) dst, rgba);
+        src += 8*8;
+        dst += 8;
+        count -= 8;
+    }
+
+    auto proc = kSwapRB ? RGBA16_to_BGRA_portable : RGBA16_to_RGBA_portable;
+    proc(dst, src, count);
+}
+
+/*not static*/ inline void RGBA16_to_RGBA(uint32_t dst[], const uint8_t* src, int count) {
+    strip16_rgba_should_swaprb<false>(dst, src, count);
+}
+
+/*not static*/ inline void RGBA16_to_BGRA(uint32_t dst[], const uint8_t* src, int count) {
+    strip16_rgba_should_swaprb<true>(dst, src, count);
+}
+
+// NEON's table lookups only reach 64 bytes, a quarter of a 256 color table.
+/*not static*/ inline void index_to_8888(uint32_t dst[], const uint8_t* src, int count,
+                                         const uint32_t ctable[]) {
+    index_to_8888_portable(dst, src, count, ctable);
+}
+
 #elif SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSSE3
 
 // Scale a byte by another.
@@ -774,6 +916,102 @@ static void inverted_cmyk_to(uint32_t* dst, const uint32_t* src, int count) {
     inverted_cmyk_to<kBGR1>(dst, src, count);
 }
 
+template <bool kSwapRB>
+static void strip16_rgb_should_swaprb(uint32_t dst[], const uint8_t* src, int count) {
+    const __m128i alphaMask = _mm_set1_epi32(0xFF000000);
+    __m128i keepLo, keepHi;
+    const uint8_t X = 0xFF; // Used a placeholder.  The value of X is irrelevant.
+    if (kSwapRB) {
+        keepLo = _mm_setr_epi8(4,2,0,X,  10, 8, 6,X, X,X,X,X, X,X,X,X);
+        keepHi = _mm_setr_epi8(8,6,4,X,  14,12,10,X, X,X,X,X, X,X,X,X);
+    } else {
+        keepLo = _mm_setr_epi8(0,2,4,X,   6, 8,10,X, X,X,X,X, X,X,X,X);
+        keepHi = _mm_setr_epi8(4,6,8,X,  10,12,14,X, X,X,X,X, X,X,X,X);
+    }
+
+    while (count >= 4) {
+        // Load 4 pixels, 24 bytes, as two overlapping vectors: pixels 0 and 1 start in lo,
+        // pixels 2 and 3 start 4 bytes into hi.
+        __m128i lo = _mm_loadu_si128((const __m128i*) (src + 0)),
+                hi = _mm_loadu_si128((const __m128i*) (src + 8));
+
+        // Keep the high byte of each channel, then mask in an opaque alpha.
+        __m128i rgba = _mm_unpacklo_epi64(_mm_shuffle_epi8(lo, keepLo),
+                                          _mm_shuffle_epi8(hi, keepHi));
+        _mm_storeu_si128((__m128i*) dst, _mm_or_si128(rgba, alphaMask));
+
+        src += 4*6;
+        dst += 4;
+        count -= 4;
+    }
+
+    auto proc = kSwapRB ? RGB16_to_BGR1_portable : RGB16_to_RGB1_portable;
+    proc(dst, src, count);
+}
+
+/*not static*/ inline void RGB16_to_RGB1(uint32_t dst[], const uint8_t* src, int count) {
+    strip16_rgb_should_swaprb<false>(dst, src, count);
+}
+
+/*not static*/ inline void RGB16_to_BGR1(uint32_t dst[], const uint8_t* src, int count) {
+    strip16_rgb_should_swaprb<true>(dst, src, count);
+}
+
+template <bool kSwapRB>
+static void strip16_rgba_should_swaprb(uint32_t dst[], const uint8_t* src, int count) {
+    __m128i keep;
+    if (kSwapRB) {
+        keep = _mm_setr_epi8(4,2,0,6, 12,10,8,14, 4,2,0,6, 12,10,8,14);
+    } else {
+        keep = _mm_setr_epi8(0,2,4,6, 8,10,12,14, 0,2,4,6, 8,10,12,14);
+    }
+
+    while (count >= 4) {
+        // Load 4 pixels.
+        __m128i lo = _mm_loadu_si128((const __m128i*) (src +  0)),
+                hi = _mm_loadu_si128((const __m128i*) (src + 16));
+
+        // Keep the high byte of each channel.
+        __m128i rgba = _mm_unpacklo_epi64(_mm_shuffle_epi8(lo, keep),
+                                          _mm_shuffle_epi8(hi, keep));
+        _mm_storeu_si128((__m128i*) dst, rgba);
+
+        src += 4*8;
+        dst += 4;
+        count -= 4;
+    }
+
+    auto proc = kSwapRB ? RGBA16_to_BGRA_portable : RGBA16_to_RGBA_portable;
+    proc(dst, src, count);
+}
+
+/*not static*/ inline void RGBA16_to_RGBA(uint32_t dst[], const uint8_t* src, int count) {
+    strip16_rgba_should_swaprb<false>(dst, src, count);
+}
+
+/*not static*/ inline void RGBA16_to_BGRA(uint32_t dst[], const uint8_t* src, int count) {
+    strip16_rgba_should_swaprb<true>(dst, src, count);
+}
+
+/*not static*/ inline void index_to_8888(uint32_t dst[], const uint8_t* src, int count,
+                                         const uint32_t ctable[]) {
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_AVX2
+    while (count >= 8) {
+        // Widen 8 indices to 32 bits, and look them all up at once.
+        __m256i indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*) src));
+        __m256i colors = _mm256_i32gather_epi32((const int*) ctable, indices, 4);
+        _mm256_storeu_si256((__m256i*) dst, colors);
+
+        src += 8;
+        dst += 8;
+        count -= 8;
+    }
+#endif
+
+    // Without AVX2 there is no gather, so this is as good as it gets.
+    index_to_8888_portable(dst, src, count, ctable);
+}
+
 #else
 
 /*not static*/ inline void RGBA_to_rgbA(uint32_t* dst, const uint32_t* src, int count) {
@@ -816,6 +1054,27 @@ static void inverted_cmyk_to(uint32_t* dst, const uint32_t* src, int count) {
     inverted_CMYK_to_BGR1_portable(dst, src, count);
 }
 
+/*not static*/ inline void RGB16_to_RGB1(uint32_t dst[], const uint8_t* src, int count) {
+    RGB16_to_RGB1_portable(dst, src, count);
+}
+
+/*not static*/ inline void RGB16_to_BGR1(uint32_t dst[], const uint8_t* src, int count) {
+    RGB16_to_BGR1_portable(dst, src, count);
+}
+
+/*not static*/ inline void RGBA16_to_RGBA(uint32_t dst[], const uint8_t* src, int count) {
+    RGBA16_to_RGBA_portable(dst, src, count);
+}
+
+/*not static*/ inline void RGBA16_to_BGRA(uint32_t dst[], const uint8_t* src, int count) {
+    RGBA16_to_BGRA_portable(dst, src, count);
+}
+
+/*not static*/ inline void index_to_8888(uint32_t dst[], const uint8_t* src, int count,
+                                         const uint32_t ctable[]) {
+    index_to_8888_portable(dst, src, count, ctable);
+}
+
 #endif
 
 }
@@ -36,10 +36,11 @@ void skia_free_func(void*, void* address) { sk_free(address); }
 static void do_deflate(int flush,
                        z_stream* zStream,
                        SkWStream* out,
-                       unsigned char* inBuffer,
+                       const void* inBuffer,
                        size_t inBufferSize) {
-    zStream->next_in = inBuffer;
-    zStream->avail_in = SkToInt(inBufferSize);
+    // zlib only reads from next_in, though some versions do not declare it const.
+    zStream->next_in = (Bytef*)const_cast<void*>(inBuffer);
+    zStream->avail_in = SkToUInt(inBufferSize);
     unsigned char outBuffer[SKDEFLATEWSTREAM_OUTPUT_BUFFER_SIZE];
     SkDEBUGCODE(int returnValue;)
     do {
@@ -103,6 +104,12 @@ bool SkDeflateWStream::write(const void* void_buffer, size_t len) {
     }
     const char* buffer = (const char*)void_buffer;
     while (len > 0) {
+        // Hand large writes straight to zlib, which keeps its own copy of the data it still needs,
+        // rather than copying them through fInBuffer a piece at a time.
+        if (0 == fImpl->fInBufferIndex && len >= sizeof(fImpl->fInBuffer)) {
+            do_deflate(Z_NO_FLUSH, &fImpl->fZStream, fImpl->fOut, buffer, len);
+            return true;
+        }
         size_t tocopy =
                 SkTMin(len, sizeof(fImpl->fInBuffer) - fImpl->fInBufferIndex);
         memcpy(fImpl->fInBuffer + fImpl->fInBufferIndex, buffer, tocopy);
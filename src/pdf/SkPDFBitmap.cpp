@@ -10,7 +10,6 @@
 #include "SkColorData.h"
 #include "SkData.h"
 #include "SkDeflate.h"
-#include "SkExecutor.h"
 #include "SkImage.h"
 #include "SkImageInfoPriv.h"
 #include "SkJpegInfo.h"
@@ -100,10 +99,10 @@ static void emit_image_stream(SkPDFDocument* doc,
 
 static void do_deflated_alpha(const SkPixmap& pm, SkPDFDocument* doc, SkPDFIndirectReference ref) {
     SkDynamicMemoryWStream buffer;
-    SkDeflateWStream deflateWStream(&buffer);
+    SkDeflateWStream deflateWStream(&buffer, (int)doc->metadata().fCompressionLevel);
     if (kAlpha_8_SkColorType == pm.colorType()) {
         SkASSERT(pm.rowBytes() == (size_t)pm.width());
-        buffer.write(pm.addr8(), pm.width() * pm.height());
+        deflateWStream.write(pm.addr8(), pm.width() * pm.height());
     } else {
         SkASSERT(pm.alphaType() == kUnpremul_SkAlphaType);
         SkASSERT(pm.colorType() == kBGRA_8888_SkColorType);
@@ -134,23 +133,39 @@ static void do_deflated_alpha(const SkPixmap& pm, SkPDFDocument* doc, SkPDFIndir
                       length, false);
 }
 
+// A soft mask that leaves its image as it is, for images we reserved one for that turned out to
+// be opaque.
+static void emit_opaque_smask(SkPDFDocument* doc, SkPDFIndirectReference sMask) {
+    if (!sMask) {
+        return;
+    }
+    SkDynamicMemoryWStream buffer;
+    SkDeflateWStream deflateWStream(&buffer, (int)doc->metadata().fCompressionLevel);
+    fill_stream(&deflateWStream, '\xFF', 1);
+    deflateWStream.finalize();
+
+    #ifdef SK_PDF_BASE85_BINARY
+    SkPDFUtils::Base85Encode(buffer.detachAsStream(), &buffer);
+    #endif
+    int length = SkToInt(buffer.bytesWritten());
+    emit_image_stream(doc, sMask, [&buffer](SkWStream* stream) { buffer.writeToAndReset(stream); },
+                      {1, 1}, "DeviceGray", SkPDFIndirectReference(), length, false);
+}
+
+// sMask is null for images known to be opaque. The caller writes the soft mask itself.
 static void do_deflated_image(const SkPixmap& pm,
                               SkPDFDocument* doc,
-                              bool isOpaque,
+                              SkPDFIndirectReference sMask,
                               SkPDFIndirectReference ref) {
-    SkPDFIndirectReference sMask;
-    if (!isOpaque) {
-        sMask = doc->reserveRef();
-    }
     SkDynamicMemoryWStream buffer;
-    SkDeflateWStream deflateWStream(&buffer);
+    SkDeflateWStream deflateWStream(&buffer, (int)doc->metadata().fCompressionLevel);
     const char* colorSpace = "DeviceGray";
     switch (pm.colorType()) {
         case kAlpha_8_SkColorType:
             fill_stream(&deflateWStream, '\x00', pm.width() * pm.height());
             break;
         case kGray_8_SkColorType:
-            SkASSERT(sMask.fValue = -1);
+            SkASSERT(!sMask);
             SkASSERT(pm.rowBytes() == (size_t)pm.width());
             deflateWStream.write(pm.addr8(), pm.width() * pm.height());
             break;
@@ -188,13 +203,10 @@ static void do_deflated_image(const SkPixmap& pm,
     int length = SkToInt(buffer.bytesWritten());
     emit_image_stream(doc, ref, [&buffer](SkWStream* stream) { buffer.writeToAndReset(stream); },
                       pm.info().dimensions(), colorSpace, sMask, length, false);
-    if (!isOpaque) {
-        do_deflated_alpha(pm, doc, sMask);
-    }
 }
 
 static bool do_jpeg(sk_sp<SkData> data, SkPDFDocument* doc, SkISize size,
-                    SkPDFIndirectReference ref) {
+                    SkPDFIndirectReference sMask, SkPDFIndirectReference ref) {
     SkISize jpegSize;
     SkEncodedInfo::Color jpegColorType;
     SkEncodedOrigin exifOrientation;
@@ -218,7 +230,7 @@ static bool do_jpeg(sk_sp<SkData> data, SkPDFDocument* doc, SkISize size,
     emit_image_stream(doc, ref,
                       [&data](SkWStream* dst) { dst->write(data->data(), data->size()); },
                       jpegSize, yuv ? "DeviceRGB" : "DeviceGray",
-                      SkPDFIndirectReference(), SkToInt(data->size()), true);
+                      sMask, SkToInt(data->size()), true);
     return true;
 }
 
@@ -248,25 +260,32 @@ static SkBitmap to_pixels(const SkImage* image) {
 void serialize_image(const SkImage* img,
                      int encodingQuality,
                      SkPDFDocument* doc,
-                     SkPDFIndirectReference ref) {
+                     SkPDFIndirectReference ref,
+                     SkPDFIndirectReference sMask) {
     SkASSERT(img);
     SkASSERT(doc);
     SkASSERT(encodingQuality >= 0);
     SkISize dimensions = img->dimensions();
     sk_sp<SkData> data = img->refEncodedData();
-    if (data && do_jpeg(std::move(data), doc, dimensions, ref)) {
-        return;
+    if (data && do_jpeg(std::move(data), doc, dimensions, sMask, ref)) {
+        return emit_opaque_smask(doc, sMask);
     }
     SkBitmap bm = to_pixels(img);
     SkPixmap pm = bm.pixmap();
     bool isOpaque = pm.isOpaque() || pm.computeIsOpaque();
+    SkASSERT(isOpaque || sMask);
     if (encodingQuality <= 100 && isOpaque) {
         sk_sp<SkData> data = img->encodeToData(SkEncodedImageFormat::kJPEG, encodingQuality);
-        if (data && do_jpeg(std::move(data), doc, dimensions, ref)) {
-            return;
+        if (data && do_jpeg(std::move(data), doc, dimensions, sMask, ref)) {
+            return emit_opaque_smask(doc, sMask);
         }
     }
-    do_deflated_image(pm, doc, isOpaque, ref);
+    do_deflated_image(pm, doc, sMask, ref);
+    if (isOpaque) {
+        emit_opaque_smask(doc, sMask);
+    } else if (sMask) {
+        do_deflated_alpha(pm, doc, sMask);
+    }
 }
 
 SkPDFIndirectReference SkPDFSerializeImage(const SkImage* img,
@@ -274,17 +293,18 @@ SkPDFIndirectReference SkPDFSerializeImage(const SkImage* img,
                                            int encodingQuality) {
     SkASSERT(img);
     SkASSERT(doc);
+    // Every reference has to be reserved before the job starts, to keep object numbers
+    // independent of the executor, so images that may not be opaque get a soft mask even if
+    // their pixels turn out to be.
     SkPDFIndirectReference ref = doc->reserveRef();
-    if (SkExecutor* executor = doc->executor()) {
-        SkRef(img);
-        doc->incrementJobCount();
-        executor->add([img, encodingQuality, doc, ref]() {
-            serialize_image(img, encodingQuality, doc, ref);
-            SkSafeUnref(img);
-            doc->signalJobComplete();
-        });
-        return ref;
+    SkPDFIndirectReference sMask;
+    if (!img->isOpaque()) {
+        sMask = doc->reserveRef();
     }
-    serialize_image(img, encodingQuality, doc, ref);
+    SkRef(img);
+    doc->runJob([img, encodingQuality, doc, ref, sMask]() {
+        serialize_image(img, encodingQuality, doc, ref, sMask);
+        SkSafeUnref(img);
+    });
     return ref;
 }
@@ -8,6 +8,7 @@
 #include "SkPDFDocument.h"
 #include "SkPDFDocumentPriv.h"
 
+#include "SkExecutor.h"
 #include "SkMakeUnique.h"
 #include "SkPDFDevice.h"
 #include "SkPDFDocument.h"
@@ -37,12 +38,16 @@ static size_t difference(size_t minuend, size_t subtrahend) {
 }
 
 void SkPDFOffsetMap::markStartOfObject(int referenceNumber, const SkWStream* s) {
+    this->markStartOfObject(referenceNumber, s->bytesWritten());
+}
+
+void SkPDFOffsetMap::markStartOfObject(int referenceNumber, size_t bytesWritten) {
     SkASSERT(referenceNumber > 0);
     size_t index = SkToSizeT(referenceNumber - 1);
     if (index >= fOffsets.size()) {
         fOffsets.resize(index + 1);
     }
-    fOffsets[index] = SkToInt(difference(s->bytesWritten(), fBaseOffset));
+    fOffsets[index] = SkToInt(difference(bytesWritten, fBaseOffset));
 }
 
 int SkPDFOffsetMap::objectCount() const {
@@ -80,10 +85,7 @@ static void serializeHeader(SkPDFOffsetMap* offsetMap, SkWStream* wStream) {
 }
 #undef SKPDF_MAGIC
 
-static void begin_indirect_object(SkPDFOffsetMap* offsetMap,
-                                  SkPDFIndirectReference ref,
-                                  SkWStream* s) {
-    offsetMap->markStartOfObject(ref.fValue, s);
+static void begin_indirect_object(SkPDFIndirectReference ref, SkWStream* s) {
     s->writeDecAsText(ref.fValue);
     s->writeText(" 0 obj\n");  // Generation number is always 0.
 }
@@ -113,55 +115,59 @@ static void serialize_footer(const SkPDFOffsetMap& offsetMap,
     wStream->writeText("\n%%EOF");
 }
 
+// PDF wants a tree describing all the pages in the document.  We arbitrary
+// choose 8 (kMaxNodeSize) as the number of allowed children.  The internal
+// nodes have type "Pages" with an array of children, a parent pointer, and
+// the number of leaves below the node as "Count."  The leaves have type
+// "Page" and need a parent pointer.
+static constexpr size_t kMaxNodeSize = 8;
+
+namespace {
+struct PageTreeNode {
+    std::unique_ptr<SkPDFDict> fNode;
+    SkPDFIndirectReference fReservedRef;
+    int fPageObjectDescendantCount;
+
+    static std::vector<PageTreeNode> Layer(std::vector<PageTreeNode> vec, SkPDFDocument* doc) {
+        std::vector<PageTreeNode> result;
+        const size_t n = vec.size();
+        SkASSERT(n >= 1);
+        const size_t result_len = (n - 1) / kMaxNodeSize + 1;
+        SkASSERT(result_len >= 1);
+        SkASSERT(n == 1 || result_len < n);
+        result.reserve(result_len);
+        size_t index = 0;
+        for (size_t i = 0; i < result_len; ++i) {
+            if (n != 1 && index + 1 == n) {  // No need to create a new node.
+                result.push_back(std::move(vec[index++]));
+                continue;
+            }
+            SkPDFIndirectReference parent = doc->reserveRef();
+            auto kids_list = SkPDFMakeArray();
+            int descendantCount = 0;
+            for (size_t j = 0; j < kMaxNodeSize && index < n; ++j) {
+                PageTreeNode& node = vec[index++];
+                node.fNode->insertRef("Parent", parent);
+                kids_list->appendRef(doc->emit(*node.fNode, node.fReservedRef));
+                descendantCount += node.fPageObjectDescendantCount;
+            }
+            auto next = SkPDFMakeDict("Pages");
+            next->insertInt("Count", descendantCount);
+            next->insertObject("Kids", std::move(kids_list));
+            result.push_back(PageTreeNode{std::move(next), parent, descendantCount});
+        }
+        return result;
+    }
+};
+}  // namespace
+
+// Builds the tree bottom up from the pages, skipping internal nodes that would have only
+// one child.
 static SkPDFIndirectReference generate_page_tree(
         SkPDFDocument* doc,
         std::vector<std::unique_ptr<SkPDFDict>> pages,
         const std::vector<SkPDFIndirectReference>& pageRefs) {
-    // PDF wants a tree describing all the pages in the document.  We arbitrary
-    // choose 8 (kNodeSize) as the number of allowed children.  The internal
-    // nodes have type "Pages" with an array of children, a parent pointer, and
-    // the number of leaves below the node as "Count."  The leaves are passed
-    // into the method, have type "Page" and need a parent pointer. This method
-    // builds the tree bottom up, skipping internal nodes that would have only
-    // one child.
     SkASSERT(pages.size() > 0);
-    struct PageTreeNode {
-        std::unique_ptr<SkPDFDict> fNode;
-        SkPDFIndirectReference fReservedRef;
-        int fPageObjectDescendantCount;
-
-        static std::vector<PageTreeNode> Layer(std::vector<PageTreeNode> vec, SkPDFDocument* doc) {
-            std::vector<PageTreeNode> result;
-            static constexpr size_t kMaxNodeSize = 8;
-            const size_t n = vec.size();
-            SkASSERT(n >= 1);
-            const size_t result_len = (n - 1) / kMaxNodeSize + 1;
-            SkASSERT(result_len >= 1);
-            SkASSERT(n == 1 || result_len < n);
-            result.reserve(result_len);
-            size_t index = 0;
-            for (size_t i = 0; i < result_len; ++i) {
-                if (n != 1 && index + 1 == n) {  // No need to create a new node.
-                    result.push_back(std::move(vec[index++]));
-                    continue;
-                }
-                SkPDFIndirectReference parent = doc->reserveRef();
-                auto kids_list = SkPDFMakeArray();
-                int descendantCount = 0;
-                for (size_t j = 0; j < kMaxNodeSize && index < n; ++j) {
-                    PageTreeNode& node = vec[index++];
-                    node.fNode->insertRef("Parent", parent);
-                    kids_list->appendRef(doc->emit(*node.fNode, node.fReservedRef));
-                    descendantCount += node.fPageObjectDescendantCount;
-                }
-                auto next = SkPDFMakeDict("Pages");
-                next->insertInt("Count", descendantCount);
-                next->insertObject("Kids", std::move(kids_list));
-                result.push_back(PageTreeNode{std::move(next), parent, descendantCount});
-            }
-            return result;
-        }
-    };
     std::vector<PageTreeNode> currentLayer;
     currentLayer.reserve(pages.size());
     SkASSERT(pages.size() == pageRefs.size());
@@ -177,6 +183,45 @@ static SkPDFIndirectReference generate_page_tree(
     return doc->emit(*root.fNode, root.fReservedRef);
 }
 
+// When streaming, each page has already been written pointing at the node for its run of
+// kMaxNodeSize pages, so we start the tree from those nodes.
+static SkPDFIndirectReference generate_streamed_page_tree(
+        SkPDFDocument* doc,
+        const std::vector<SkPDFIndirectReference>& nodeRefs,
+        const std::vector<SkPDFIndirectReference>& pageRefs) {
+    SkASSERT(nodeRefs.size() == (pageRefs.size() - 1) / kMaxNodeSize + 1);
+    std::vector<PageTreeNode> currentLayer;
+    currentLayer.reserve(nodeRefs.size());
+    size_t index = 0;
+    for (SkPDFIndirectReference nodeRef : nodeRefs) {
+        auto kids = SkPDFMakeArray();
+        int count = 0;
+        for (; count < (int)kMaxNodeSize && index < pageRefs.size(); ++count) {
+            kids->appendRef(pageRefs[index++]);
+        }
+        auto node = SkPDFMakeDict("Pages");
+        node->insertInt("Count", count);
+        node->insertObject("Kids", std::move(kids));
+        currentLayer.push_back(PageTreeNode{std::move(node), nodeRef, count});
+    }
+    while (currentLayer.size() > 1) {
+        currentLayer = PageTreeNode::Layer(std::move(currentLayer), doc);
+    }
+    const PageTreeNode& root = currentLayer[0];
+    return doc->emit(*root.fNode, root.fReservedRef);
+}
+
+// Objects that have been serialized, but can't be written to the document until every job
+// started before them has finished.
+struct SkPDFPendingOutput {
+    SkDynamicMemoryWStream fBytes;
+    std::vector<std::pair<int, size_t>> fObjectOffsets;  // Reference number, offset in fBytes.
+    bool fDone = false;
+};
+
+// The output of the job running on this thread, if any.
+static thread_local SkPDFPendingOutput* gJobOutput = nullptr;
+
 template<typename T, typename... Args>
 static void reset_object(T* dst, Args&&... args) {
     dst->~T();
@@ -206,20 +251,43 @@ SkPDFDocument::~SkPDFDocument() {
 }
 
 SkPDFIndirectReference SkPDFDocument::emit(const SkPDFObject& object, SkPDFIndirectReference ref){
-    object.emitObject(this->beginObject(ref));
-    this->endObject();
+    SkWStream* stream = this->beginObject(ref);
+    object.emitObject(stream);
+    this->endObject(stream);
     return ref;
 }
 
 SkWStream* SkPDFDocument::beginObject(SkPDFIndirectReference ref) {
-    fMutex.acquire();
-    begin_indirect_object(&fOffsetMap, ref, this->getStream());
-    return this->getStream();
+    SkPDFPendingOutput* output = gJobOutput;
+    if (!output) {
+        fMutex.acquire();
+        if (fPendingOutput.empty()) {
+            fOffsetMap.markStartOfObject(ref.fValue, this->getStream());
+            begin_indirect_object(ref, this->getStream());
+            return this->getStream();
+        }
+        // Queue this object up behind the jobs still running.  We hold fMutex until
+        // endObject(), so it's safe to add to output that is already done.
+        if (!fPendingOutput.back()->fDone) {
+            fPendingOutput.push_back(skstd::make_unique<SkPDFPendingOutput>());
+            fPendingOutput.back()->fDone = true;
+        }
+        output = fPendingOutput.back().get();
+    }
+    output->fObjectOffsets.emplace_back(ref.fValue, output->fBytes.bytesWritten());
+    begin_indirect_object(ref, &output->fBytes);
+    return &output->fBytes;
 };
 
-void SkPDFDocument::endObject() {
-    end_indirect_object(this->getStream());
-    fMutex.release();
+void SkPDFDocument::endObject(SkWStream* stream) {
+    end_indirect_object(stream);
+    if (!gJobOutput) {
+        if (stream != this->getStream()) {
+            const SkPDFPendingOutput& output = *fPendingOutput.back();
+            this->retainBytes(output.fBytes.bytesWritten() - output.fObjectOffsets.back().second);
+        }
+        fMutex.release();
+    }
 };
 
 static SkSize operator*(SkISize u, SkScalar s) { return SkSize{u.width() * s, u.height() * s}; }
@@ -227,7 +295,7 @@ static SkSize operator*(SkSize u, SkScalar s) { return SkSize{u.width() * s, u.h
 
 SkCanvas* SkPDFDocument::onBeginPage(SkScalar width, SkScalar height) {
     SkASSERT(fCanvas.imageInfo().dimensions().isZero());
-    if (fPages.empty()) {
+    if (fPageRefs.empty()) {
         // if this is the first page if the document.
         {
             SkAutoMutexAcquire autoMutexAcquire(fMutex);
@@ -259,6 +327,9 @@ SkCanvas* SkPDFDocument::onBeginPage(SkScalar width, SkScalar height) {
     fPageDevice = sk_make_sp<SkPDFDevice>(pageSize, this, initialTransform);
     reset_object(&fCanvas, fPageDevice);
     fCanvas.scale(fRasterScale, fRasterScale);
+    if (fMetadata.fStreaming && fPageRefs.size() % kMaxNodeSize == 0) {
+        fPageTreeNodeRefs.push_back(this->reserveRef());
+    }
     fPageRefs.push_back(this->reserveRef());
     return &fCanvas;
 }
@@ -288,6 +359,17 @@ void SkPDFDocument::onEndPage() {
     // The StructParents unique identifier for each page is just its
     // 0-based page index.
     page->insertInt("StructParents", SkToInt(this->currentPageIndex()));
+    if (fMetadata.fStreaming) {
+        page->insertRef("Parent", fPageTreeNodeRefs.back());
+        this->emit(*page, fPageRefs.back());
+        return;
+    }
+    if (fMetadata.fPeakRetainedBytes) {
+        SkNullWStream pageBytes;
+        page->emitObject(&pageBytes);
+        fRetainedPageBytes += pageBytes.bytesWritten();
+        this->retainBytes(pageBytes.bytesWritten());
+    }
     fPages.emplace_back(std::move(page));
 }
 
@@ -452,8 +534,11 @@ static std::vector<const SkPDFFont*> get_fonts(const SkPDFDocument& canon) {
 
 void SkPDFDocument::onClose(SkWStream* stream) {
     SkASSERT(fCanvas.imageInfo().dimensions().isZero());
-    if (fPages.empty()) {
+    if (fPageRefs.empty()) {
         this->waitForJobs();
+        if (fMetadata.fPeakRetainedBytes) {
+            *fMetadata.fPeakRetainedBytes = fPeakRetainedBytes;
+        }
         return;
     }
     auto docCatalog = SkPDFMakeDict("Catalog");
@@ -465,7 +550,14 @@ void SkPDFDocument::onClose(SkWStream* stream) {
         docCatalog->insertObject("OutputIntents", make_srgb_output_intents(this));
     }
 
-    docCatalog->insertRef("Pages", generate_page_tree(this, std::move(fPages), fPageRefs));
+    if (fMetadata.fStreaming) {
+        docCatalog->insertRef("Pages",
+                              generate_streamed_page_tree(this, fPageTreeNodeRefs, fPageRefs));
+    } else {
+        docCatalog->insertRef("Pages", generate_page_tree(this, std::move(fPages), fPageRefs));
+        this->releaseBytes(fRetainedPageBytes);
+        fRetainedPageBytes = 0;
+    }
 
     if (fDests.size() > 0) {
         docCatalog->insertRef("Dests", this->emit(fDests));
@@ -483,6 +575,7 @@ void SkPDFDocument::onClose(SkWStream* stream) {
 
     auto docCatalogRef = this->emit(*docCatalog);
 
+    // No fonts are added once we start closing, so jobs may hold on to them until we're done.
     for (const SkPDFFont* f : get_fonts(*this)) {
         f->emitSubset(this);
     }
@@ -490,17 +583,75 @@ void SkPDFDocument::onClose(SkWStream* stream) {
     this->waitForJobs();
     {
         SkAutoMutexAcquire autoMutexAcquire(fMutex);
+        SkASSERT(fPendingOutput.empty());
         serialize_footer(fOffsetMap, this->getStream(), fInfoDict, docCatalogRef, fUUID);
     }
+    if (fMetadata.fPeakRetainedBytes) {
+        *fMetadata.fPeakRetainedBytes = fPeakRetainedBytes;
+    }
+}
+
+// When streaming, we don't let more than this many jobs pile up, so that memory held by jobs
+// waiting to run stays bounded too.
+static constexpr int kMaxStreamingJobs = 32;
+
+void SkPDFDocument::runJob(std::function<void()> job) {
+    if (!fExecutor || gJobOutput) {
+        job();
+        return;
+    }
+    if (fMetadata.fStreaming) {
+        this->waitForJobs(kMaxStreamingJobs - 1);
+    }
+    SkPDFPendingOutput* output;
+    {
+        SkAutoMutexAcquire autoMutexAcquire(fMutex);
+        fPendingOutput.push_back(skstd::make_unique<SkPDFPendingOutput>());
+        output = fPendingOutput.back().get();
+    }
+    fJobCount++;
+    fExecutor->add([this, output, job]() {
+        gJobOutput = output;
+        job();
+        gJobOutput = nullptr;
+        {
+            SkAutoMutexAcquire autoMutexAcquire(fMutex);
+            output->fDone = true;
+            this->retainBytes(output->fBytes.bytesWritten());
+            this->flushPendingOutput();
+        }
+        fSemaphore.signal();
+    });
 }
 
-void SkPDFDocument::incrementJobCount() { fJobCount++; }
+void SkPDFDocument::flushPendingOutput() {
+    SkWStream* stream = this->getStream();
+    while (!fPendingOutput.empty() && fPendingOutput.front()->fDone) {
+        SkPDFPendingOutput* output = fPendingOutput.front().get();
+        size_t base = stream->bytesWritten();
+        for (const auto& object : output->fObjectOffsets) {
+            fOffsetMap.markStartOfObject(object.first, base + object.second);
+        }
+        this->releaseBytes(output->fBytes.bytesWritten());
+        output->fBytes.writeToAndReset(stream);
+        fPendingOutput.pop_front();
+    }
+}
 
-void SkPDFDocument::signalJobComplete() { fSemaphore.signal(); }
+void SkPDFDocument::retainBytes(size_t bytes) {
+    size_t retained = fRetainedBytes += bytes;
+    size_t peak = fPeakRetainedBytes.load();
+    while (retained > peak && !fPeakRetainedBytes.compare_exchange_weak(peak, retained)) {}
+}
+
+void SkPDFDocument::releaseBytes(size_t bytes) {
+    SkASSERT(fRetainedBytes >= bytes);
+    fRetainedBytes -= bytes;
+}
 
-void SkPDFDocument::waitForJobs() {
+void SkPDFDocument::waitForJobs(int maxJobs) {
      // fJobCount can increase while we wait.
-     while (fJobCount > 0) {
+     while (fJobCount > maxJobs) {
          fSemaphore.wait();
          --fJobCount;
      }
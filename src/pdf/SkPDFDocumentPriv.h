@@ -16,6 +16,8 @@
 #include "SkTHash.h"
 
 #include <atomic>
+#include <deque>
+#include <functional>
 #include <vector>
 #include <memory>
 
@@ -24,6 +26,7 @@ class SkPDFDevice;
 class SkPDFFont;
 struct SkAdvancedTypefaceMetrics;
 struct SkBitmapKey;
+struct SkPDFPendingOutput;
 struct SkPDFFillGraphicState;
 struct SkPDFImageShaderKey;
 struct SkPDFStrokeGraphicState;
@@ -40,6 +43,7 @@ class SkPDFOffsetMap {
 public:
     void markStartOfDocument(const SkWStream*);
     void markStartOfObject(int referenceNumber, const SkWStream*);
+    void markStartOfObject(int referenceNumber, size_t bytesWritten);
     int objectCount() const;
     int emitCrossReferenceTable(SkWStream* s) const;
 private:
@@ -78,7 +82,7 @@ public:
         stream->writeText(" stream\n");
         writeStream(stream);
         stream->writeText("\nendstream");
-        this->endObject();
+        this->endObject(stream);
     }
 
     const SkPDF::Metadata& metadata() const { return fMetadata; }
@@ -90,9 +94,21 @@ public:
     SkPDFIndirectReference reserveRef() { return SkPDFIndirectReference{fNextObjectNumber++}; }
 
     SkExecutor* executor() const { return fExecutor; }
-    void incrementJobCount();
-    void signalJobComplete();
-    size_t currentPageIndex() { return fPages.size(); }
+
+    /** Runs job on the executor, or right away if there is no executor or we are already
+        inside a job.  Objects emitted by a job are written to the document in the order the
+        jobs were started, not the order they finish, so as long as every reference is
+        reserved before its job starts, the output does not depend on the executor.
+     */
+    void runJob(std::function<void()> job);
+
+    /** Track memory held until the document is closed, or until earlier jobs finish, for
+        Metadata::fPeakRetainedBytes.  This covers serialized objects we could not write yet,
+        unwritten pages, and per-font tables, but not the page being drawn or the inputs of
+        queued jobs. */
+    void retainBytes(size_t);
+    void releaseBytes(size_t);
+    size_t currentPageIndex() { SkASSERT(!fPageRefs.empty()); return fPageRefs.size() - 1; }
     size_t pageCount() { return fPageRefs.size(); }
 
     // Canonicalized objects
@@ -116,10 +132,14 @@ private:
     SkCanvas fCanvas;
     std::vector<std::unique_ptr<SkPDFDict>> fPages;
     std::vector<SkPDFIndirectReference> fPageRefs;
+    std::vector<SkPDFIndirectReference> fPageTreeNodeRefs;  // When streaming.
+    size_t fRetainedPageBytes = 0;
     SkPDFDict fDests;
     sk_sp<SkPDFDevice> fPageDevice;
     std::atomic<int> fNextObjectNumber = {1};
     std::atomic<int> fJobCount = {0};
+    std::atomic<size_t> fRetainedBytes = {0};
+    std::atomic<size_t> fPeakRetainedBytes = {0};
     SkUUID fUUID;
     SkPDFIndirectReference fInfoDict;
     SkPDFIndirectReference fXMP;
@@ -134,9 +154,14 @@ private:
     SkMutex fMutex;
     SkSemaphore fSemaphore;
 
-    void waitForJobs();
+    // Output that can't be written yet because a job started before it is still running,
+    // in document order.  Guarded by fMutex.
+    std::deque<std::unique_ptr<SkPDFPendingOutput>> fPendingOutput;
+
+    void waitForJobs(int maxJobs = 0);
+    void flushPendingOutput();
     SkWStream* beginObject(SkPDFIndirectReference);
-    void endObject();
+    void endObject(SkWStream*);
 };
 
 #endif  // SkPDFDocumentPriv_DEFINED
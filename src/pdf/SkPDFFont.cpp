@@ -165,6 +165,7 @@ const std::vector<SkUnichar>& SkPDFFont::GetUnicodeMap(const SkTypeface* typefac
     }
     std::vector<SkUnichar> buffer(typeface->countGlyphs());
     typeface->getGlyphToUnicodeMap(buffer.data());
+    canon->retainBytes(buffer.size() * sizeof(SkUnichar));
     return *canon->fToUnicodeMap.set(id, std::move(buffer));
 }
 
@@ -225,6 +226,7 @@ SkPDFFont* SkPDFFont::GetFontResource(SkPDFDocument* doc,
         lastGlyph = SkToU16(SkTMin<int>((int)lastGlyph, 254 + (int)subsetCode));
     }
     auto ref = doc->reserveRef();
+    doc->retainBytes(sizeof(SkPDFFont) + (lastGlyph - firstNonZeroGlyph + 2) / 8);
     return doc->fFontMap.set(
             fontID, SkPDFFont(std::move(typeface), firstNonZeroGlyph, lastGlyph, type, ref));
 }
@@ -283,6 +285,50 @@ static sk_sp<SkData> stream_to_data(std::unique_ptr<SkStreamAsset> stream) {
     return SkData::MakeFromStream(stream.get(), size);
 }
 
+// Subsetting is slow, so we do it on the document's executor when there is one.
+static void serialize_true_type_font(const SkPDFFont& font,
+                                     std::unique_ptr<SkStreamAsset> fontAsset,
+                                     int ttcIndex,
+                                     bool subset,
+                                     const char* fontName,
+                                     SkPDFDocument* doc,
+                                     SkPDFIndirectReference ref) {
+    sk_sp<SkData> fontData = stream_to_data(std::move(fontAsset));
+    if (subset) {
+        SkASSERT(font.firstGlyphID() == 1);
+        sk_sp<SkData> subsetFontData = SkPDFSubsetFont(fontData, font.glyphUsage(),
+                                                       fontName, ttcIndex);
+        if (subsetFontData) {
+            fontData = std::move(subsetFontData);
+        }
+        // If subsetting fails, fall back to original font data.
+    }
+    std::unique_ptr<SkPDFDict> tmp = SkPDFMakeDict();
+    tmp->insertInt("Length1", SkToInt(fontData->size()));
+    SkPDFSerializeStream(std::move(tmp), SkMemoryStream::Make(std::move(fontData)),
+                         doc, ref, true);
+}
+
+// Building the CMap of a large font takes a while too.
+static SkPDFIndirectReference emit_to_unicode_cmap(const SkPDFFont& font, SkPDFDocument* doc) {
+    const std::vector<SkUnichar>& glyphToUnicode =
+        SkPDFFont::GetUnicodeMap(font.typeface(), doc);
+    SkASSERT(SkToSizeT(font.typeface()->countGlyphs()) == glyphToUnicode.size());
+    SkPDFIndirectReference ref = doc->reserveRef();
+    const SkPDFFont* fontPtr = &font;
+    // The document's map of these may grow before the job runs, so the job gets a copy.
+    doc->runJob([fontPtr, glyphToUnicode, doc, ref]() {
+        SkPDFSerializeStream(nullptr,
+                             SkPDFMakeToUnicodeCmap(glyphToUnicode.data(),
+                                                    &fontPtr->glyphUsage(),
+                                                    fontPtr->multiByteGlyphs(),
+                                                    fontPtr->firstGlyphID(),
+                                                    fontPtr->lastGlyphID()),
+                             doc, ref);
+    });
+    return ref;
+}
+
 static void emit_subset_type0(const SkPDFFont& font, SkPDFDocument* doc) {
     const SkAdvancedTypefaceMetrics* metricsPtr =
         SkPDFFont::GetMetrics(font.typeface(), doc);
@@ -308,33 +354,18 @@ static void emit_subset_type0(const SkPDFFont& font, SkPDFDocument* doc) {
     } else {
         switch (type) {
             case SkAdvancedTypefaceMetrics::kTrueType_Font: {
-                if (!SkToBool(metrics.fFlags &
-                              SkAdvancedTypefaceMetrics::kNotSubsettable_FontFlag)) {
-                    SkASSERT(font.firstGlyphID() == 1);
-                    sk_sp<SkData> subsetFontData = SkPDFSubsetFont(
-                            stream_to_data(std::move(fontAsset)), font.glyphUsage(),
-                            metrics.fFontName.c_str(), ttcIndex);
-                    if (subsetFontData) {
-                        std::unique_ptr<SkPDFDict> tmp = SkPDFMakeDict();
-                        tmp->insertInt("Length1", SkToInt(subsetFontData->size()));
-                        descriptor->insertRef(
-                                "FontFile2",
-                                SkPDFStreamOut(std::move(tmp),
-                                               SkMemoryStream::Make(std::move(subsetFontData)),
-                                               doc, true));
-                        break;
-                    }
-                    // If subsetting fails, fall back to original font data.
-                    fontAsset = face->openStream(&ttcIndex);
-                    SkASSERT(fontAsset);
-                    SkASSERT(fontAsset->getLength() == fontSize);
-                    if (!fontAsset || fontAsset->getLength() == 0) { break; }
-                }
-                std::unique_ptr<SkPDFDict> tmp = SkPDFMakeDict();
-                tmp->insertInt("Length1", fontSize);
-                descriptor->insertRef("FontFile2",
-                                      SkPDFStreamOut(std::move(tmp), std::move(fontAsset),
-                                                     doc, true));
+                SkPDFIndirectReference fontFile = doc->reserveRef();
+                descriptor->insertRef("FontFile2", fontFile);
+                bool subset = !SkToBool(metrics.fFlags &
+                                        SkAdvancedTypefaceMetrics::kNotSubsettable_FontFlag);
+                const SkPDFFont* fontPtr = &font;
+                SkStreamAsset* fontAssetPtr = fontAsset.release();
+                SkString fontName = metrics.fFontName;
+                doc->runJob([fontPtr, fontAssetPtr, ttcIndex, subset, fontName, doc, fontFile]() {
+                    serialize_true_type_font(*fontPtr,
+                                             std::unique_ptr<SkStreamAsset>(fontAssetPtr),
+                                             ttcIndex, subset, fontName.c_str(), doc, fontFile);
+                });
                 break;
             }
             case SkAdvancedTypefaceMetrics::kType1CID_Font: {
@@ -394,16 +425,7 @@ static void emit_subset_type0(const SkPDFFont& font, SkPDFDocument* doc) {
     descendantFonts->appendRef(doc->emit(*newCIDFont));
     fontDict.insertObject("DescendantFonts", std::move(descendantFonts));
 
-    const std::vector<SkUnichar>& glyphToUnicode =
-        SkPDFFont::GetUnicodeMap(font.typeface(), doc);
-    SkASSERT(SkToSizeT(font.typeface()->countGlyphs()) == glyphToUnicode.size());
-    std::unique_ptr<SkStreamAsset> toUnicode =
-            SkPDFMakeToUnicodeCmap(glyphToUnicode.data(),
-                                   &font.glyphUsage(),
-                                   font.multiByteGlyphs(),
-                                   font.firstGlyphID(),
-                                   font.lastGlyphID());
-    fontDict.insertRef("ToUnicode", SkPDFStreamOut(nullptr, std::move(toUnicode), doc));
+    fontDict.insertRef("ToUnicode", emit_to_unicode_cmap(font, doc));
 
     doc->emit(fontDict, font.indirectReference());
 }
@@ -449,6 +471,7 @@ static const std::vector<SkString>& type_1_glyphnames(SkPDFDocument* canon,
     if (!glyphNames) {
         std::vector<SkString> names(typeface->countGlyphs());
         SkPDFFont::GetType1GlyphNames(*typeface, names.data());
+        canon->retainBytes(names.size() * sizeof(SkString));
         glyphNames = canon->fType1GlyphNames.set(fontID, std::move(names));
     }
     SkASSERT(glyphNames);
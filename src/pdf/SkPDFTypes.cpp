@@ -9,7 +9,6 @@
 
 #include "SkData.h"
 #include "SkDeflate.h"
-#include "SkExecutor.h"
 #include "SkMakeUnique.h"
 #include "SkPDFDocumentPriv.h"
 #include "SkPDFUnion.h"
@@ -430,9 +429,10 @@ static void serialize_stream(SkPDFDict* origDict,
     SkPDFDict tmpDict;
     SkPDFDict& dict = origDict ? *origDict : tmpDict;
     static const size_t kMinimumSavings = strlen("/Filter_/FlateDecode_");
-    if (deflate && stream->getLength() > kMinimumSavings) {
+    const int level = (int)doc->metadata().fCompressionLevel;
+    if (deflate && 0 != level && stream->getLength() > kMinimumSavings) {
         SkDynamicMemoryWStream compressedData;
-        SkDeflateWStream deflateWStream(&compressedData);
+        SkDeflateWStream deflateWStream(&compressedData, level);
         SkStreamCopy(&deflateWStream, stream);
         deflateWStream.finalize();
         #ifdef SK_PDF_BASE85_BINARY
@@ -467,20 +467,22 @@ SkPDFIndirectReference SkPDFStreamOut(std::unique_ptr<SkPDFDict> dict,
                                       SkPDFDocument* doc,
                                       bool deflate) {
     SkPDFIndirectReference ref = doc->reserveRef();
-    if (SkExecutor* executor = doc->executor()) {
-        SkPDFDict* dictPtr = dict.release();
-        SkStreamAsset* contentPtr = content.release();
-        // Pass ownership of both pointers into a std::function, which should
-        // only be executed once.
-        doc->incrementJobCount();
-        executor->add([dictPtr, contentPtr, deflate, doc, ref]() {
-            serialize_stream(dictPtr, contentPtr, deflate, doc, ref);
-            delete dictPtr;
-            delete contentPtr;
-            doc->signalJobComplete();
-        });
-        return ref;
-    }
-    serialize_stream(dict.get(), content.get(), deflate, doc, ref);
+    SkPDFDict* dictPtr = dict.release();
+    SkStreamAsset* contentPtr = content.release();
+    // Pass ownership of both pointers into a std::function, which should
+    // only be executed once.
+    doc->runJob([dictPtr, contentPtr, deflate, doc, ref]() {
+        serialize_stream(dictPtr, contentPtr, deflate, doc, ref);
+        delete dictPtr;
+        delete contentPtr;
+    });
     return ref;
 }
+
+void SkPDFSerializeStream(std::unique_ptr<SkPDFDict> dict,
+                          std::unique_ptr<SkStreamAsset> content,
+                          SkPDFDocument* doc,
+                          SkPDFIndirectReference ref,
+                          bool deflate) {
+    serialize_stream(dict.get(), content.get(), deflate, doc, ref);
+}
@@ -201,4 +201,12 @@ SkPDFIndirectReference SkPDFStreamOut(std::unique_ptr<SkPDFDict> dict,
                                       std::unique_ptr<SkStreamAsset> stream,
                                       SkPDFDocument* doc,
                                       bool deflate = kSkPDFDefaultDoDeflate);
+
+/** Like SkPDFStreamOut(), but serializes the stream right away, as the already reserved ref.
+    Jobs use this so that object numbers don't depend on when they run. */
+void SkPDFSerializeStream(std::unique_ptr<SkPDFDict> dict,
+                          std::unique_ptr<SkStreamAsset> stream,
+                          SkPDFDocument* doc,
+                          SkPDFIndirectReference ref,
+                          bool deflate = kSkPDFDefaultDoDeflate);
 #endif
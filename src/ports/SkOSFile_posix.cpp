@@ -74,6 +74,19 @@ void sk_fmunmap(const void* addr, size_t length) {
     munmap(const_cast<void*>(addr), length);
 }
 
+void sk_fmmap_will_read(const void* addr, size_t length) {
+    if (!addr || 0 == length) {
+        return;
+    }
+    // madvise() needs a page aligned address.
+    static const uintptr_t kPageMask = sysconf(_SC_PAGESIZE) - 1;
+    uintptr_t start = reinterpret_cast<uintptr_t>(addr);
+    uintptr_t aligned = start & ~kPageMask;
+    void* page = reinterpret_cast<void*>(aligned);
+    // This is only a hint, so ignore failure.
+    (void)madvise(page, length + (start - aligned), MADV_WILLNEED);
+}
+
 void* sk_fdmmap(int fd, size_t* size) {
     struct stat status;
     if (0 != fstat(fd, &status)) {
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SKSL_BYTECODE
+#define SKSL_BYTECODE
+
+#include "SkSLString.h"
+
+#include <memory>
+#include <vector>
+
+namespace SkSL {
+
+/**
+ * The instructions understood by the Interpreter's virtual machine. Each instruction is a one-byte
+ * opcode followed by its operands: 16-bit register indices (dst, a, b, test), 16-bit absolute code
+ * offsets (target), or a 32-bit immediate (imm), all little-endian and unaligned.
+ *
+ * Registers are 32 bits wide and hold a float, an int, or a bool (0 or ~0). The VM may run several
+ * lanes at once, so every instruction works on all lanes of its registers. Only kStore respects
+ * the execution mask; everything else writes temporaries, which no inactive lane will ever read.
+ */
+#define SKSL_BYTECODE_INSTRUCTIONS(M)                                                             \
+    /* dst = a op b */                                                                          \
+    M(AddF) M(AddI) M(SubtractF) M(SubtractI) M(MultiplyF) M(MultiplyI)                         \
+    M(DivideF) M(DivideS) M(RemainderF) M(RemainderS)                                           \
+    M(AndB) M(OrB) M(XorB) M(ShiftLeft) M(ShiftRightS)                                          \
+    M(MinF) M(MaxF)                                                                             \
+    M(CompareFLT) M(CompareFLTEQ) M(CompareFEQ) M(CompareFNEQ)                                  \
+    M(CompareSLT) M(CompareSLTEQ) M(CompareIEQ) M(CompareINEQ)                                  \
+    /* dst = op a */                                                                            \
+    M(NegateF) M(NegateS) M(NotB) M(AbsF) M(SqrtF) M(SinF) M(CosF) M(TanF)                      \
+    M(ConvertFtoS) M(ConvertStoF)                                                               \
+    M(Copy)           /* dst = a */                                                             \
+    M(Store)          /* dst = a, in active lanes only */                                       \
+    M(LoadConstant)   /* dst = imm */                                                           \
+    M(Select)         /* dst = test ? a : b */                                                  \
+    M(MaskPush)       /* pushes (mask & test) */                                                \
+    M(MaskNegate)     /* replaces mask with (previous mask & ~mask) */                          \
+    M(MaskPop)        /* pops mask */                                                           \
+    M(LoopBegin)      /* pushes a copy of mask */                                               \
+    M(LoopMask)       /* mask &= test */                                                        \
+    M(Branch)         /* jumps to target */                                                     \
+    M(BranchIfAllOff) /* jumps to target if no lanes are active */                              \
+    M(Return)
+
+enum class ByteCodeInstruction : uint8_t {
+#define M(name) k##name,
+    SKSL_BYTECODE_INSTRUCTIONS(M)
+#undef M
+};
+
+/**
+ * A single function compiled by Compiler::toByteCode(). Its parameters occupy registers
+ * [0, fParameterCount), followed by its return value (if it has one), followed by its local
+ * variables and temporaries.
+ */
+struct ByteCodeFunction {
+    String fName;
+    // One entry per parameter: true if it is 'out' or 'inout', meaning the caller's copy of it
+    // receives its final value.
+    std::vector<bool> fParameterIsOut;
+    // One entry per parameter: true if it is a float, false if it is an int.
+    std::vector<bool> fParameterIsFloat;
+    int fParameterCount = 0;
+    int fReturnCount = 0;
+    int fRegisterCount = 0;
+    // How deep the execution mask stack can get while running this function.
+    int fMaskDepth = 0;
+    std::vector<uint8_t> fCode;
+};
+
+struct ByteCode {
+    const ByteCodeFunction* getFunction(const char* name) const {
+        for (const auto& f : fFunctions) {
+            if (f->fName == name) {
+                return f.get();
+            }
+        }
+        return nullptr;
+    }
+
+    std::vector<std::unique_ptr<ByteCodeFunction>> fFunctions;
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,656 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkSLByteCodeGenerator.h"
+
+#include "SkSLCompiler.h"
+#include "ir/SkSLBoolLiteral.h"
+#include "ir/SkSLExpressionStatement.h"
+#include "ir/SkSLFloatLiteral.h"
+#include "ir/SkSLIntLiteral.h"
+#include "ir/SkSLReturnStatement.h"
+
+#include <cstring>
+
+namespace SkSL {
+
+// Register indices and branch targets are encoded in 16 bits.
+static constexpr int kMaxOperand = 0xFFFF;
+
+bool ByteCodeGenerator::generateCode() {
+    for (const auto& e : fProgram) {
+        if (ProgramElement::kFunction_Kind == e.fKind) {
+            this->writeFunction((const FunctionDefinition&) e);
+        }
+    }
+    return 0 == fErrors.errorCount();
+}
+
+ByteCodeGenerator::TypeCategory ByteCodeGenerator::getTypeCategory(int offset, const Type& type) {
+    if (type == *fContext.fBool_Type) {
+        return TypeCategory::kBool;
+    }
+    if (Type::kScalar_Kind == type.kind()) {
+        if (type.isFloat()) {
+            return TypeCategory::kFloat;
+        }
+        if (type.isSigned()) {
+            return TypeCategory::kSigned;
+        }
+    }
+    fErrors.error(offset, "unsupported type '" + type.description() + "'");
+    return TypeCategory::kFloat;
+}
+
+void ByteCodeGenerator::writeFunction(const FunctionDefinition& f) {
+    std::unique_ptr<ByteCodeFunction> result(new ByteCodeFunction());
+    fFunction = result.get();
+    fFunction->fName = f.fDeclaration.fName;
+    fVariableRegisters.clear();
+    fNextRegister = 0;
+    fMaskDepth = 0;
+
+    for (const Variable* p : f.fDeclaration.fParameters) {
+        TypeCategory category = this->getTypeCategory(p->fOffset, p->fType);
+        if (TypeCategory::kBool == category) {
+            fErrors.error(p->fOffset, "bool parameters are not supported");
+        }
+        fVariableRegisters[p] = this->nextRegister();
+        fFunction->fParameterIsOut.push_back(p->fModifiers.fFlags & Modifiers::kOut_Flag);
+        fFunction->fParameterIsFloat.push_back(TypeCategory::kFloat == category);
+    }
+    fFunction->fParameterCount = fNextRegister;
+    int returnRegister = -1;
+    if (f.fDeclaration.fReturnType != *fContext.fVoid_Type) {
+        if (TypeCategory::kBool == this->getTypeCategory(f.fOffset, f.fDeclaration.fReturnType)) {
+            fErrors.error(f.fOffset, "bool return values are not supported");
+        }
+        returnRegister = this->nextRegister();
+        fFunction->fReturnCount = 1;
+    }
+
+    // Every lane reaches the end of the function, so that is the only place we can return from.
+    const ReturnStatement* returnStatement = nullptr;
+    if (Statement::kBlock_Kind == f.fBody->fKind) {
+        const Block& body = (const Block&) *f.fBody;
+        size_t count = body.fStatements.size();
+        if (count && Statement::kReturn_Kind == body.fStatements.back()->fKind) {
+            returnStatement = (const ReturnStatement*) body.fStatements.back().get();
+            --count;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            this->writeStatement(*body.fStatements[i]);
+        }
+    } else {
+        this->writeStatement(*f.fBody);
+    }
+    if (returnStatement && returnStatement->fExpression) {
+        int value = this->writeExpression(*returnStatement->fExpression);
+        this->write(ByteCodeInstruction::kCopy, returnRegister, value);
+    } else if (returnRegister >= 0) {
+        fErrors.error(f.fOffset, "function '" + fFunction->fName + "' must end with a return");
+    }
+    this->write(ByteCodeInstruction::kReturn);
+
+    if (fFunction->fRegisterCount > kMaxOperand + 1 || fFunction->fCode.size() > kMaxOperand) {
+        fErrors.error(f.fOffset, "function '" + fFunction->fName + "' is too large");
+    }
+    SkASSERT(0 == fMaskDepth);
+    fFunction = nullptr;
+    fOutput->fFunctions.push_back(std::move(result));
+}
+
+void ByteCodeGenerator::writeStatement(const Statement& s) {
+    switch (s.fKind) {
+        case Statement::kBlock_Kind:
+            this->writeBlock((const Block&) s);
+            break;
+        case Statement::kExpression_Kind: {
+            int saved = fNextRegister;
+            this->writeExpression(*((const ExpressionStatement&) s).fExpression);
+            fNextRegister = saved;
+            break;
+        }
+        case Statement::kIf_Kind:
+            this->writeIfStatement((const IfStatement&) s);
+            break;
+        case Statement::kFor_Kind:
+            this->writeForStatement((const ForStatement&) s);
+            break;
+        case Statement::kWhile_Kind:
+            this->writeWhileStatement((const WhileStatement&) s);
+            break;
+        case Statement::kDo_Kind:
+            this->writeDoStatement((const DoStatement&) s);
+            break;
+        case Statement::kVarDeclarations_Kind:
+            this->writeVarDeclarations(*((const VarDeclarationsStatement&) s).fDeclaration);
+            break;
+        case Statement::kNop_Kind:
+            break;
+        case Statement::kReturn_Kind:
+            fErrors.error(s.fOffset, "return is only supported as the last statement of a "
+                                     "function");
+            break;
+        default:
+            fErrors.error(s.fOffset, "unsupported statement: " + s.description());
+            break;
+    }
+}
+
+void ByteCodeGenerator::writeBlock(const Block& b) {
+    int saved = fNextRegister;
+    for (const auto& s : b.fStatements) {
+        this->writeStatement(*s);
+    }
+    fNextRegister = saved;
+}
+
+void ByteCodeGenerator::writeIfStatement(const IfStatement& i) {
+    int saved = fNextRegister;
+    this->writeMaskPush(this->writeExpression(*i.fTest));
+    fNextRegister = saved;
+    int skipTrue = this->writeBranch(ByteCodeInstruction::kBranchIfAllOff);
+    this->writeStatement(*i.fIfTrue);
+    this->setBranchTarget(skipTrue);
+    if (i.fIfFalse) {
+        this->write(ByteCodeInstruction::kMaskNegate);
+        int skipFalse = this->writeBranch(ByteCodeInstruction::kBranchIfAllOff);
+        this->writeStatement(*i.fIfFalse);
+        this->setBranchTarget(skipFalse);
+    }
+    this->writeMaskPop();
+}
+
+void ByteCodeGenerator::writeForStatement(const ForStatement& f) {
+    int saved = fNextRegister;
+    if (f.fInitializer) {
+        this->writeStatement(*f.fInitializer);
+    }
+    this->writeLoop(f.fTest.get(), *f.fStatement, f.fNext.get(), true);
+    fNextRegister = saved;
+}
+
+void ByteCodeGenerator::writeWhileStatement(const WhileStatement& w) {
+    this->writeLoop(w.fTest.get(), *w.fStatement, nullptr, true);
+}
+
+void ByteCodeGenerator::writeDoStatement(const DoStatement& d) {
+    this->writeLoop(d.fTest.get(), *d.fStatement, nullptr, false);
+}
+
+void ByteCodeGenerator::writeLoop(const Expression* test, const Statement& body,
+                                  const Expression* next, bool testFirst) {
+    // Lanes drop out of the loop mask as they fail the test, and we leave the loop once they all
+    // have. Without break or continue, nothing else can change the mask inside the loop.
+    this->write(ByteCodeInstruction::kLoopBegin);
+    this->enterMask();
+    int top = (int) fFunction->fCode.size();
+    int exit = -1;
+    auto writeTest = [&]() {
+        if (test) {
+            int saved = fNextRegister;
+            int value = this->writeExpression(*test);
+            fNextRegister = saved;
+            this->write(ByteCodeInstruction::kLoopMask);
+            this->write16(value);
+            exit = this->writeBranch(ByteCodeInstruction::kBranchIfAllOff);
+        }
+    };
+    if (testFirst) {
+        writeTest();
+    }
+    this->writeStatement(body);
+    if (next) {
+        int saved = fNextRegister;
+        this->writeExpression(*next);
+        fNextRegister = saved;
+    }
+    if (!testFirst) {
+        writeTest();
+    }
+    this->write(ByteCodeInstruction::kBranch);
+    this->write16(top);
+    if (exit >= 0) {
+        this->setBranchTarget(exit);
+    }
+    this->writeMaskPop();
+}
+
+void ByteCodeGenerator::writeVarDeclarations(const VarDeclarations& decls) {
+    for (const auto& declStatement : decls.fVars) {
+        const VarDeclaration& decl = (const VarDeclaration&) *declStatement;
+        if (decl.fSizes.size()) {
+            fErrors.error(decl.fOffset, "arrays are not supported");
+        }
+        this->getTypeCategory(decl.fOffset, decl.fVar->fType);
+        int reg = this->nextRegister();
+        if (decl.fValue) {
+            // The variable is new, so whatever inactive lanes hold in its register doesn't matter.
+            int value = this->writeExpression(*decl.fValue);
+            this->write(ByteCodeInstruction::kCopy, reg, value);
+        }
+        fNextRegister = reg + 1;
+        fVariableRegisters[decl.fVar] = reg;
+    }
+}
+
+int ByteCodeGenerator::writeExpression(const Expression& e) {
+    switch (e.fKind) {
+        case Expression::kBinary_Kind:
+            return this->writeBinaryExpression((const BinaryExpression&) e);
+        case Expression::kBoolLiteral_Kind:
+            return this->writeConstant(((const BoolLiteral&) e).fValue ? ~0u : 0u);
+        case Expression::kIntLiteral_Kind:
+            return this->writeConstant((uint32_t) ((const IntLiteral&) e).fValue);
+        case Expression::kFloatLiteral_Kind: {
+            float value = (float) ((const FloatLiteral&) e).fValue;
+            uint32_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            return this->writeConstant(bits);
+        }
+        case Expression::kConstructor_Kind:
+            return this->writeConstructor((const Constructor&) e);
+        case Expression::kFunctionCall_Kind:
+            return this->writeFunctionCall((const FunctionCall&) e);
+        case Expression::kPrefix_Kind:
+            return this->writePrefixExpression((const PrefixExpression&) e);
+        case Expression::kPostfix_Kind:
+            return this->writePostfixExpression((const PostfixExpression&) e);
+        case Expression::kTernary_Kind:
+            return this->writeTernaryExpression((const TernaryExpression&) e);
+        case Expression::kVariableReference_Kind:
+            return this->writeVariableReference((const VariableReference&) e);
+        default:
+            fErrors.error(e.fOffset, "unsupported expression: " + e.description());
+            return this->nextRegister();
+    }
+}
+
+int ByteCodeGenerator::writeBinaryExpression(const BinaryExpression& b) {
+    Token::Kind op = b.fOperator;
+    if (Token::LOGICALAND == op || Token::LOGICALOR == op) {
+        return this->writeLogicalExpression(b);
+    }
+    if (Token::EQ == op) {
+        int dst = this->getLValue(*b.fLeft);
+        int value = this->writeExpression(*b.fRight);
+        this->write(ByteCodeInstruction::kStore, dst, value);
+        return dst;
+    }
+    TypeCategory category = this->getTypeCategory(b.fLeft->fOffset, b.fLeft->fType);
+    if (Compiler::IsAssignment(op)) {
+        int dst = this->getLValue(*b.fLeft);
+        int value = this->writeExpression(*b.fRight);
+        int result = this->writeArithmetic(b.fOffset, op, category, dst, value);
+        this->write(ByteCodeInstruction::kStore, dst, result);
+        return dst;
+    }
+
+    int left = this->writeExpression(*b.fLeft);
+    if (b.fRight->hasSideEffects()) {
+        // The right side may change the variable holding the left side's value.
+        int copy = this->nextRegister();
+        this->write(ByteCodeInstruction::kCopy, copy, left);
+        left = copy;
+    }
+    int right = this->writeExpression(*b.fRight);
+    bool isFloat = TypeCategory::kFloat == category;
+    ByteCodeInstruction inst;
+    switch (op) {
+        case Token::EQEQ:
+            inst = isFloat ? ByteCodeInstruction::kCompareFEQ : ByteCodeInstruction::kCompareIEQ;
+            break;
+        case Token::NEQ:
+        case Token::LOGICALXOR:
+            inst = isFloat ? ByteCodeInstruction::kCompareFNEQ : ByteCodeInstruction::kCompareINEQ;
+            break;
+        case Token::LT:
+        case Token::GT:
+            inst = isFloat ? ByteCodeInstruction::kCompareFLT : ByteCodeInstruction::kCompareSLT;
+            break;
+        case Token::LTEQ:
+        case Token::GTEQ:
+            inst = isFloat ? ByteCodeInstruction::kCompareFLTEQ
+                           : ByteCodeInstruction::kCompareSLTEQ;
+            break;
+        default:
+            return this->writeArithmetic(b.fOffset, op, category, left, right);
+    }
+    if (Token::GT == op || Token::GTEQ == op) {
+        // a > b is b < a.
+        std::swap(left, right);
+    }
+    int result = this->nextRegister();
+    this->write(inst, result, left, right);
+    return result;
+}
+
+int ByteCodeGenerator::writeLogicalExpression(const BinaryExpression& b) {
+    int left = this->writeExpression(*b.fLeft);
+    if (!b.fRight->hasSideEffects()) {
+        int right = this->writeExpression(*b.fRight);
+        int result = this->nextRegister();
+        this->write(Token::LOGICALAND == b.fOperator ? ByteCodeInstruction::kAndB
+                                                     : ByteCodeInstruction::kOrB,
+                    result, left, right);
+        return result;
+    }
+
+    // Only evaluate the right side in the lanes whose result it can still change.
+    int result = this->nextRegister();
+    this->write(ByteCodeInstruction::kCopy, result, left);
+    int test = result;
+    if (Token::LOGICALOR == b.fOperator) {
+        test = this->nextRegister();
+        this->write(ByteCodeInstruction::kNotB, test, result);
+    }
+    this->writeMaskPush(test);
+    int skip = this->writeBranch(ByteCodeInstruction::kBranchIfAllOff);
+    int right = this->writeExpression(*b.fRight);
+    this->write(ByteCodeInstruction::kStore, result, right);
+    this->setBranchTarget(skip);
+    this->writeMaskPop();
+    return result;
+}
+
+int ByteCodeGenerator::writeArithmetic(int offset, Token::Kind op, TypeCategory category,
+                                       int a, int b) {
+    bool isFloat = TypeCategory::kFloat == category;
+    ByteCodeInstruction inst;
+    switch (op) {
+        case Token::PLUS:
+        case Token::PLUSEQ:
+            inst = isFloat ? ByteCodeInstruction::kAddF : ByteCodeInstruction::kAddI;
+            break;
+        case Token::MINUS:
+        case Token::MINUSEQ:
+            inst = isFloat ? ByteCodeInstruction::kSubtractF : ByteCodeInstruction::kSubtractI;
+            break;
+        case Token::STAR:
+        case Token::STAREQ:
+            inst = isFloat ? ByteCodeInstruction::kMultiplyF : ByteCodeInstruction::kMultiplyI;
+            break;
+        case Token::SLASH:
+        case Token::SLASHEQ:
+            inst = isFloat ? ByteCodeInstruction::kDivideF : ByteCodeInstruction::kDivideS;
+            break;
+        case Token::PERCENT:
+        case Token::PERCENTEQ:
+            inst = isFloat ? ByteCodeInstruction::kRemainderF : ByteCodeInstruction::kRemainderS;
+            break;
+        case Token::BITWISEAND:
+        case Token::BITWISEANDEQ:
+            inst = ByteCodeInstruction::kAndB;
+            break;
+        case Token::BITWISEOR:
+        case Token::BITWISEOREQ:
+            inst = ByteCodeInstruction::kOrB;
+            break;
+        case Token::BITWISEXOR:
+        case Token::BITWISEXOREQ:
+            inst = ByteCodeInstruction::kXorB;
+            break;
+        case Token::SHL:
+        case Token::SHLEQ:
+            inst = ByteCodeInstruction::kShiftLeft;
+            break;
+        case Token::SHR:
+        case Token::SHREQ:
+            inst = ByteCodeInstruction::kShiftRightS;
+            break;
+        default:
+            fErrors.error(offset, String("unsupported operator '") + Compiler::OperatorName(op) +
+                                  "'");
+            return this->nextRegister();
+    }
+    int result = this->nextRegister();
+    this->write(inst, result, a, b);
+    return result;
+}
+
+int ByteCodeGenerator::writeConstructor(const Constructor& c) {
+    if (c.fArguments.size() != 1) {
+        fErrors.error(c.fOffset, "unsupported constructor: " + c.description());
+        return this->nextRegister();
+    }
+    const Expression& arg = *c.fArguments[0];
+    TypeCategory to = this->getTypeCategory(c.fOffset, c.fType);
+    TypeCategory from = this->getTypeCategory(arg.fOffset, arg.fType);
+    int value = this->writeExpression(arg);
+    if (to == from) {
+        return value;
+    }
+    int result = this->nextRegister();
+    switch (to) {
+        case TypeCategory::kFloat:
+            if (TypeCategory::kSigned == from) {
+                this->write(ByteCodeInstruction::kConvertStoF, result, value);
+            } else {
+                // 1.0f
+                this->write(ByteCodeInstruction::kAndB, result, value,
+                            this->writeConstant(0x3F800000));
+            }
+            break;
+        case TypeCategory::kSigned:
+            if (TypeCategory::kFloat == from) {
+                this->write(ByteCodeInstruction::kConvertFtoS, result, value);
+            } else {
+                this->write(ByteCodeInstruction::kAndB, result, value, this->writeConstant(1));
+            }
+            break;
+        case TypeCategory::kBool:
+            this->write(TypeCategory::kFloat == from ? ByteCodeInstruction::kCompareFNEQ
+                                                     : ByteCodeInstruction::kCompareINEQ,
+                        result, value, this->writeConstant(0));
+            break;
+    }
+    return result;
+}
+
+int ByteCodeGenerator::writeFunctionCall(const FunctionCall& c) {
+    const FunctionDeclaration& f = c.fFunction;
+    std::vector<int> args;
+    for (const auto& arg : c.fArguments) {
+        if (TypeCategory::kFloat != this->getTypeCategory(arg->fOffset, arg->fType)) {
+            fErrors.error(arg->fOffset, "unsupported argument type");
+        }
+        args.push_back(this->writeExpression(*arg));
+    }
+    static const struct {
+        const char*         fName;
+        ByteCodeInstruction fInstruction;
+    } kUnaryIntrinsics[] = {
+        { "abs",  ByteCodeInstruction::kAbsF  },
+        { "sqrt", ByteCodeInstruction::kSqrtF },
+        { "sin",  ByteCodeInstruction::kSinF  },
+        { "cos",  ByteCodeInstruction::kCosF  },
+        { "tan",  ByteCodeInstruction::kTanF  },
+    };
+    if (f.fBuiltin) {
+        int result = this->nextRegister();
+        if (1 == args.size()) {
+            for (const auto& intrinsic : kUnaryIntrinsics) {
+                if (intrinsic.fName == f.fName) {
+                    this->write(intrinsic.fInstruction, result, args[0]);
+                    return result;
+                }
+            }
+        }
+        if (3 == args.size() && "clamp" == f.fName) {
+            int min = this->nextRegister();
+            this->write(ByteCodeInstruction::kMaxF, min, args[0], args[1]);
+            this->write(ByteCodeInstruction::kMinF, result, min, args[2]);
+            return result;
+        }
+    }
+    fErrors.error(c.fOffset, "unsupported function call: " + c.description());
+    return this->nextRegister();
+}
+
+int ByteCodeGenerator::writePrefixExpression(const PrefixExpression& p) {
+    TypeCategory category = this->getTypeCategory(p.fOffset, p.fType);
+    switch (p.fOperator) {
+        case Token::PLUS:
+            return this->writeExpression(*p.fOperand);
+        case Token::MINUS: {
+            int value = this->writeExpression(*p.fOperand);
+            int result = this->nextRegister();
+            this->write(TypeCategory::kFloat == category ? ByteCodeInstruction::kNegateF
+                                                         : ByteCodeInstruction::kNegateS,
+                        result, value);
+            return result;
+        }
+        case Token::LOGICALNOT:
+        case Token::BITWISENOT: {
+            int value = this->writeExpression(*p.fOperand);
+            int result = this->nextRegister();
+            this->write(ByteCodeInstruction::kNotB, result, value);
+            return result;
+        }
+        case Token::PLUSPLUS:
+        case Token::MINUSMINUS: {
+            int dst = this->getLValue(*p.fOperand);
+            int one = this->writeConstant(TypeCategory::kFloat == category ? 0x3F800000 : 1);
+            int value = this->writeArithmetic(p.fOffset, Token::PLUSPLUS == p.fOperator
+                                                                 ? Token::PLUS : Token::MINUS,
+                                              category, dst, one);
+            this->write(ByteCodeInstruction::kStore, dst, value);
+            return dst;
+        }
+        default:
+            fErrors.error(p.fOffset, "unsupported expression: " + p.description());
+            return this->nextRegister();
+    }
+}
+
+int ByteCodeGenerator::writePostfixExpression(const PostfixExpression& p) {
+    TypeCategory category = this->getTypeCategory(p.fOffset, p.fType);
+    int dst = this->getLValue(*p.fOperand);
+    int old = this->nextRegister();
+    this->write(ByteCodeInstruction::kCopy, old, dst);
+    int one = this->writeConstant(TypeCategory::kFloat == category ? 0x3F800000 : 1);
+    int value = this->writeArithmetic(p.fOffset, Token::PLUSPLUS == p.fOperator ? Token::PLUS
+                                                                                : Token::MINUS,
+                                      category, dst, one);
+    this->write(ByteCodeInstruction::kStore, dst, value);
+    return old;
+}
+
+int ByteCodeGenerator::writeTernaryExpression(const TernaryExpression& t) {
+    int test = this->writeExpression(*t.fTest);
+    if (!t.fIfTrue->hasSideEffects() && !t.fIfFalse->hasSideEffects()) {
+        // Cheaper to evaluate both sides in every lane than to branch.
+        int ifTrue = this->writeExpression(*t.fIfTrue);
+        int ifFalse = this->writeExpression(*t.fIfFalse);
+        int result = this->nextRegister();
+        this->write(ByteCodeInstruction::kSelect, result, test, ifTrue);
+        this->write16(ifFalse);
+        return result;
+    }
+    int result = this->nextRegister();
+    this->writeMaskPush(test);
+    int skipTrue = this->writeBranch(ByteCodeInstruction::kBranchIfAllOff);
+    int ifTrue = this->writeExpression(*t.fIfTrue);
+    this->write(ByteCodeInstruction::kStore, result, ifTrue);
+    this->setBranchTarget(skipTrue);
+    this->write(ByteCodeInstruction::kMaskNegate);
+    int skipFalse = this->writeBranch(ByteCodeInstruction::kBranchIfAllOff);
+    int ifFalse = this->writeExpression(*t.fIfFalse);
+    this->write(ByteCodeInstruction::kStore, result, ifFalse);
+    this->setBranchTarget(skipFalse);
+    this->writeMaskPop();
+    return result;
+}
+
+int ByteCodeGenerator::writeVariableReference(const VariableReference& r) {
+    auto found = fVariableRegisters.find(&r.fVariable);
+    if (found == fVariableRegisters.end()) {
+        fErrors.error(r.fOffset, "unsupported variable '" + r.fVariable.fName + "'");
+        return this->nextRegister();
+    }
+    return found->second;
+}
+
+int ByteCodeGenerator::getLValue(const Expression& e) {
+    if (Expression::kVariableReference_Kind != e.fKind) {
+        fErrors.error(e.fOffset, "unsupported lvalue: " + e.description());
+        return this->nextRegister();
+    }
+    return this->writeVariableReference((const VariableReference&) e);
+}
+
+int ByteCodeGenerator::writeConstant(uint32_t value) {
+    int result = this->nextRegister();
+    this->write(ByteCodeInstruction::kLoadConstant);
+    this->write16(result);
+    this->write32(value);
+    return result;
+}
+
+int ByteCodeGenerator::nextRegister() {
+    int result = fNextRegister++;
+    fFunction->fRegisterCount = std::max(fFunction->fRegisterCount, fNextRegister);
+    return result;
+}
+
+void ByteCodeGenerator::write(ByteCodeInstruction inst) {
+    fFunction->fCode.push_back((uint8_t) inst);
+}
+
+void ByteCodeGenerator::write16(int value) {
+    SkASSERT(value >= 0);
+    fFunction->fCode.push_back(value & 0xFF);
+    fFunction->fCode.push_back((value >> 8) & 0xFF);
+}
+
+void ByteCodeGenerator::write32(uint32_t value) {
+    this->write16(value & 0xFFFF);
+    this->write16(value >> 16);
+}
+
+void ByteCodeGenerator::write(ByteCodeInstruction inst, int dst, int a) {
+    this->write(inst);
+    this->write16(dst);
+    this->write16(a);
+}
+
+void ByteCodeGenerator::write(ByteCodeInstruction inst, int dst, int a, int b) {
+    this->write(inst, dst, a);
+    this->write16(b);
+}
+
+int ByteCodeGenerator::writeBranch(ByteCodeInstruction inst) {
+    this->write(inst);
+    int location = (int) fFunction->fCode.size();
+    this->write16(0);
+    return location;
+}
+
+void ByteCodeGenerator::setBranchTarget(int location) {
+    int target = (int) fFunction->fCode.size();
+    fFunction->fCode[location]     = target & 0xFF;
+    fFunction->fCode[location + 1] = (target >> 8) & 0xFF;
+}
+
+void ByteCodeGenerator::enterMask() {
+    ++fMaskDepth;
+    fFunction->fMaskDepth = std::max(fFunction->fMaskDepth, fMaskDepth);
+}
+
+void ByteCodeGenerator::writeMaskPush(int test) {
+    this->write(ByteCodeInstruction::kMaskPush);
+    this->write16(test);
+    this->enterMask();
+}
+
+void ByteCodeGenerator::writeMaskPop() {
+    this->write(ByteCodeInstruction::kMaskPop);
+    --fMaskDepth;
+}
+
+} // namespace
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SKSL_BYTECODEGENERATOR
+#define SKSL_BYTECODEGENERATOR
+
+#include <unordered_map>
+
+#include "SkSLByteCode.h"
+#include "SkSLCodeGenerator.h"
+#include "ir/SkSLBinaryExpression.h"
+#include "ir/SkSLBlock.h"
+#include "ir/SkSLConstructor.h"
+#include "ir/SkSLDoStatement.h"
+#include "ir/SkSLForStatement.h"
+#include "ir/SkSLFunctionCall.h"
+#include "ir/SkSLFunctionDefinition.h"
+#include "ir/SkSLIfStatement.h"
+#include "ir/SkSLPostfixExpression.h"
+#include "ir/SkSLPrefixExpression.h"
+#include "ir/SkSLTernaryExpression.h"
+#include "ir/SkSLVarDeclarationsStatement.h"
+#include "ir/SkSLVariableReference.h"
+#include "ir/SkSLWhileStatement.h"
+
+namespace SkSL {
+
+/**
+ * Converts a Program into ByteCode for the Interpreter.
+ *
+ * Every value is a scalar float, int, or bool, held in a register. Parameters and return values
+ * may be float or int. Control flow is compiled into execution masks rather than jumps (except to
+ * skip code no lane needs), so the same code can run many lanes at once; for that reason 'break',
+ * 'continue', 'discard', and 'switch' are not supported, and 'return' may only appear as the last
+ * statement of a function. Functions may call the sqrt, sin, cos, tan, abs, and clamp intrinsics,
+ * but not each other.
+ */
+class ByteCodeGenerator : public CodeGenerator {
+public:
+    ByteCodeGenerator(const Context* context, const Program* program, ErrorReporter* errors,
+                      ByteCode* output)
+    : INHERITED(program, errors, nullptr)
+    , fContext(*context)
+    , fOutput(output) {}
+
+    bool generateCode() override;
+
+private:
+    enum class TypeCategory {
+        kFloat,
+        kSigned,
+        kBool,
+    };
+
+    // Reports an error if the type is not supported.
+    TypeCategory getTypeCategory(int offset, const Type& type);
+
+    void writeFunction(const FunctionDefinition& f);
+
+    void writeStatement(const Statement& s);
+
+    void writeBlock(const Block& b);
+
+    void writeIfStatement(const IfStatement& i);
+
+    void writeForStatement(const ForStatement& f);
+
+    void writeWhileStatement(const WhileStatement& w);
+
+    void writeDoStatement(const DoStatement& d);
+
+    void writeVarDeclarations(const VarDeclarations& decls);
+
+    // Writes the loop that tests 'test' (if not null), then runs 'body' and 'next' (if not null),
+    // for as long as any lane passes the test.
+    void writeLoop(const Expression* test, const Statement& body, const Expression* next,
+                   bool testFirst);
+
+    // Returns the register holding the expression's value. That may be the register of a
+    // variable, which must not be written to.
+    int writeExpression(const Expression& e);
+
+    int writeBinaryExpression(const BinaryExpression& b);
+
+    int writeLogicalExpression(const BinaryExpression& b);
+
+    int writeConstructor(const Constructor& c);
+
+    int writeFunctionCall(const FunctionCall& c);
+
+    int writePrefixExpression(const PrefixExpression& p);
+
+    int writePostfixExpression(const PostfixExpression& p);
+
+    int writeTernaryExpression(const TernaryExpression& t);
+
+    int writeVariableReference(const VariableReference& r);
+
+    // Writes 'a op b' into a new temporary, where op is one of the arithmetic or bitwise operators
+    // (or their compound assignment forms).
+    int writeArithmetic(int offset, Token::Kind op, TypeCategory category, int a, int b);
+
+    // Returns the register of the variable an assignment writes to.
+    int getLValue(const Expression& e);
+
+    int writeConstant(uint32_t value);
+
+    int nextRegister();
+
+    void write(ByteCodeInstruction inst);
+
+    void write16(int value);
+
+    void write32(uint32_t value);
+
+    void write(ByteCodeInstruction inst, int dst, int a);
+
+    void write(ByteCodeInstruction inst, int dst, int a, int b);
+
+    // Writes a branch instruction and returns the location of its target, to be filled in later
+    // by setBranchTarget().
+    int writeBranch(ByteCodeInstruction inst);
+
+    // Points the branch at 'location' at the current end of the code.
+    void setBranchTarget(int location);
+
+    void enterMask();
+
+    // Restricts the execution mask to the lanes where 'test' is true, until writeMaskPop().
+    void writeMaskPush(int test);
+
+    void writeMaskPop();
+
+    const Context& fContext;
+
+    ByteCode* fOutput;
+
+    ByteCodeFunction* fFunction = nullptr;
+
+    std::unordered_map<const Variable*, int> fVariableRegisters;
+
+    // Registers below this one hold live variables; those above it are free.
+    int fNextRegister = 0;
+
+    int fMaskDepth = 0;
+
+    typedef CodeGenerator INHERITED;
+};
+
+} // namespace
+
+#endif
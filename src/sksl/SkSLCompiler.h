@@ -40,6 +40,7 @@
 
 namespace SkSL {
 
+struct ByteCode;
 class IRGenerator;
 
 /**
@@ -114,6 +115,8 @@ public:
     bool toPipelineStage(const Program& program, String* out,
                          std::vector<FormatArg>* outFormatArgs);
 
+    std::unique_ptr<ByteCode> toByteCode(Program& program);
+
     void error(int offset, String msg) override;
 
     String errorText();
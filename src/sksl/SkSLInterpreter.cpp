@@ -23,7 +23,12 @@
 #include "ir/SkSLVarDeclarations.h"
 #include "ir/SkSLVarDeclarationsStatement.h"
 #include "ir/SkSLVariableReference.h"
+#include "SkArenaAlloc.h"
+#include "SkFloatingPoint.h"
 #include "SkRasterPipeline.h"
+#include "SkTemplates.h"
+
+#include <cmath>
 
 namespace SkSL {
 
@@ -467,6 +472,279 @@ Interpreter::Value Interpreter::evaluate(const Expression& expr) {
     ABORT("unsupported expression: %s\n", expr.description().c_str());
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+static inline int read16(const uint8_t*& ip) {
+    int result = ip[0] | (ip[1] << 8);
+    ip += 2;
+    return result;
+}
+
+static inline int32_t read32(const uint8_t*& ip) {
+    uint32_t result = read16(ip);
+    result |= (uint32_t) read16(ip) << 16;
+    return (int32_t) result;
+}
+
+// Threaded dispatch below takes the addresses of labels, a GNU extension clang warns about.
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wgnu-label-as-value"
+#endif
+
+// Runs f on W lanes at once. Each of f's registers holds W consecutive Values in regs. mask
+// holds W lanes of the initial execution mask, with room after it for fMaskDepth more.
+template <int W>
+static void run_lanes(const ByteCodeFunction& f, Interpreter::Value* regs, int32_t* mask) {
+    using Value = Interpreter::Value;
+    const uint8_t* code = f.fCode.data();
+    const uint8_t* ip = code;
+
+    #define REG(index) (regs + (index) * W)
+    #define LANES for (int i = 0; i < W; ++i)
+
+#if defined(__GNUC__)
+    // Threaded dispatch: each instruction jumps straight to the next one's implementation,
+    // which gives the branch predictor far more to work with than a single switch.
+    static const void* kLabels[] = {
+    #define M(name) &&name,
+        SKSL_BYTECODE_INSTRUCTIONS(M)
+    #undef M
+    };
+    #define CASE(name) name:
+    #define NEXT() goto *kLabels[*ip++]
+    NEXT();
+    {
+#else
+    #define CASE(name) case ByteCodeInstruction::k##name:
+    #define NEXT() break
+    for (;;) switch ((ByteCodeInstruction) *ip++) {
+#endif
+
+    #define BINARY(name, expr)                     \
+        CASE(name) {                               \
+            Value* dst = REG(read16(ip));          \
+            const Value* a = REG(read16(ip));      \
+            const Value* b = REG(read16(ip));      \
+            LANES { expr; }                        \
+            NEXT();                                \
+        }
+    #define UNARY(name, expr)                      \
+        CASE(name) {                               \
+            Value* dst = REG(read16(ip));          \
+            const Value* a = REG(read16(ip));      \
+            LANES { expr; }                        \
+            NEXT();                                \
+        }
+    // Integer math wraps, and division by zero is zero, so garbage in inactive lanes is harmless.
+    #define WRAP(op) (int32_t) ((uint32_t) a[i].fInt op (uint32_t) b[i].fInt)
+    #define COMPARE(field, op) dst[i].fInt = a[i].field op b[i].field ? ~0 : 0
+
+        BINARY(AddF,      dst[i].fFloat = a[i].fFloat + b[i].fFloat)
+        BINARY(AddI,      dst[i].fInt = WRAP(+))
+        BINARY(SubtractF, dst[i].fFloat = a[i].fFloat - b[i].fFloat)
+        BINARY(SubtractI, dst[i].fInt = WRAP(-))
+        BINARY(MultiplyF, dst[i].fFloat = a[i].fFloat * b[i].fFloat)
+        BINARY(MultiplyI, dst[i].fInt = WRAP(*))
+        BINARY(DivideF,   dst[i].fFloat = a[i].fFloat / b[i].fFloat)
+        BINARY(DivideS,   dst[i].fInt = b[i].fInt ==  0 ? 0
+                                      : b[i].fInt == -1 ? (int32_t) (0u - (uint32_t) a[i].fInt)
+                                                        : a[i].fInt / b[i].fInt)
+        BINARY(RemainderF, dst[i].fFloat = fmodf(a[i].fFloat, b[i].fFloat))
+        BINARY(RemainderS, dst[i].fInt = b[i].fInt == 0 || b[i].fInt == -1 ? 0
+                                                                           : a[i].fInt % b[i].fInt)
+        BINARY(AndB,        dst[i].fInt = a[i].fInt & b[i].fInt)
+        BINARY(OrB,         dst[i].fInt = a[i].fInt | b[i].fInt)
+        BINARY(XorB,        dst[i].fInt = a[i].fInt ^ b[i].fInt)
+        BINARY(ShiftLeft,   dst[i].fInt = (int32_t) ((uint32_t) a[i].fInt << (b[i].fInt & 31)))
+        BINARY(ShiftRightS, dst[i].fInt = a[i].fInt >> (b[i].fInt & 31))
+        BINARY(MinF,        dst[i].fFloat = SkTMin(a[i].fFloat, b[i].fFloat))
+        BINARY(MaxF,        dst[i].fFloat = SkTMax(a[i].fFloat, b[i].fFloat))
+
+        BINARY(CompareFLT,   COMPARE(fFloat, < ))
+        BINARY(CompareFLTEQ, COMPARE(fFloat, <=))
+        BINARY(CompareFEQ,   COMPARE(fFloat, ==))
+        BINARY(CompareFNEQ,  COMPARE(fFloat, !=))
+        BINARY(CompareSLT,   COMPARE(fInt,   < ))
+        BINARY(CompareSLTEQ, COMPARE(fInt,   <=))
+        BINARY(CompareIEQ,   COMPARE(fInt,   ==))
+        BINARY(CompareINEQ,  COMPARE(fInt,   !=))
+
+        UNARY(NegateF,     dst[i].fFloat = -a[i].fFloat)
+        UNARY(NegateS,     dst[i].fInt = (int32_t) (0u - (uint32_t) a[i].fInt))
+        UNARY(NotB,        dst[i].fInt = ~a[i].fInt)
+        UNARY(AbsF,        dst[i].fFloat = fabsf(a[i].fFloat))
+        UNARY(SqrtF,       dst[i].fFloat = sqrtf(a[i].fFloat))
+        UNARY(SinF,        dst[i].fFloat = sinf(a[i].fFloat))
+        UNARY(CosF,        dst[i].fFloat = cosf(a[i].fFloat))
+        UNARY(TanF,        dst[i].fFloat = tanf(a[i].fFloat))
+        UNARY(ConvertFtoS, dst[i].fInt = sk_float_saturate2int(a[i].fFloat))
+        UNARY(ConvertStoF, dst[i].fFloat = (float) a[i].fInt)
+        UNARY(Copy,        dst[i].fInt = a[i].fInt)
+        UNARY(Store,       dst[i].fInt = (a[i].fInt & mask[i]) | (dst[i].fInt & ~mask[i]))
+
+    #undef COMPARE
+    #undef WRAP
+    #undef UNARY
+    #undef BINARY
+
+        CASE(LoadConstant) {
+            Value* dst = REG(read16(ip));
+            int32_t value = read32(ip);
+            LANES { dst[i].fInt = value; }
+            NEXT();
+        }
+        CASE(Select) {
+            Value* dst = REG(read16(ip));
+            const Value* test = REG(read16(ip));
+            const Value* a = REG(read16(ip));
+            const Value* b = REG(read16(ip));
+            LANES { dst[i].fInt = (a[i].fInt & test[i].fInt) | (b[i].fInt & ~test[i].fInt); }
+            NEXT();
+        }
+        CASE(MaskPush) {
+            const Value* test = REG(read16(ip));
+            LANES { mask[W + i] = mask[i] & test[i].fInt; }
+            mask += W;
+            NEXT();
+        }
+        CASE(MaskNegate) {
+            LANES { mask[i] = mask[i - W] & ~mask[i]; }
+            NEXT();
+        }
+        CASE(MaskPop) {
+            mask -= W;
+            NEXT();
+        }
+        CASE(LoopBegin) {
+            LANES { mask[W + i] = mask[i]; }
+            mask += W;
+            NEXT();
+        }
+        CASE(LoopMask) {
+            const Value* test = REG(read16(ip));
+            LANES { mask[i] &= test[i].fInt; }
+            NEXT();
+        }
+        CASE(Branch) {
+            int target = read16(ip);
+            ip = code + target;
+            NEXT();
+        }
+        CASE(BranchIfAllOff) {
+            int target = read16(ip);
+            int32_t active = 0;
+            LANES { active |= mask[i]; }
+            if (!active) {
+                ip = code + target;
+            }
+            NEXT();
+        }
+        CASE(Return) {
+            return;
+        }
+    }
+
+    #undef NEXT
+    #undef CASE
+    #undef LANES
+    #undef REG
+}
+
+#if defined(__clang__)
+#pragma clang diagnostic pop
+#endif
+
+// Enough registers and mask stack for most functions to run without touching the heap.
+static constexpr int kStackRegisters = 64;
+static constexpr int kStackMasks = 8;
+
+// How many lanes RunStriped() runs at once.
+static constexpr int kStripedLanes = 8;
+
+void Interpreter::Run(const ByteCodeFunction* f, Value args[], Value* outReturn) {
+    SkAutoSTArray<kStackRegisters, Value> regs(f->fRegisterCount);
+    SkAutoSTArray<kStackMasks, int32_t> masks(f->fMaskDepth + 1);
+    std::copy(args, args + f->fParameterCount, regs.get());
+    masks[0] = ~0;
+    run_lanes<1>(*f, regs.get(), masks.get());
+    for (int p = 0; p < f->fParameterCount; ++p) {
+        if (f->fParameterIsOut[p]) {
+            args[p] = regs[p];
+        }
+    }
+    if (outReturn && f->fReturnCount) {
+        *outReturn = regs[f->fParameterCount];
+    }
+}
+
+void Interpreter::RunStriped(const ByteCodeFunction* f, int N, Value* args[], Value* outReturn) {
+    constexpr int W = kStripedLanes;
+    SkAutoSTArray<kStackRegisters * W, Value> regs(f->fRegisterCount * W);
+    SkAutoSTArray<kStackMasks * W, int32_t> masks((f->fMaskDepth + 1) * W);
+    for (int base = 0; base < N; base += W) {
+        // Lanes past the end of our inputs start out inactive, with zeroed parameters.
+        int lanes = SkTMin(W, N - base);
+        for (int p = 0; p < f->fParameterCount; ++p) {
+            for (int i = 0; i < W; ++i) {
+                regs[p * W + i] = i < lanes ? args[p][base + i] : Value(0);
+            }
+        }
+        for (int i = 0; i < W; ++i) {
+            masks[i] = i < lanes ? ~0 : 0;
+        }
+        run_lanes<W>(*f, regs.get(), masks.get());
+        for (int p = 0; p < f->fParameterCount; ++p) {
+            if (f->fParameterIsOut[p]) {
+                std::copy(&regs[p * W], &regs[p * W] + lanes, args[p] + base);
+            }
+        }
+        if (outReturn && f->fReturnCount) {
+            const Value* result = &regs[f->fParameterCount * W];
+            std::copy(result, result + lanes, outReturn + base);
+        }
+    }
+}
+
+struct ByteCodeCallbackCtx : public SkRasterPipeline_CallbackCtx {
+    const ByteCodeFunction* fFunction;
+};
+
+static void do_bytecode_callback(SkRasterPipeline_CallbackCtx* raw, int activePixels) {
+    ByteCodeCallbackCtx& ctx = (ByteCodeCallbackCtx&) *raw;
+    const int channels = ctx.fFunction->fParameterCount;
+    Interpreter::Value values[4][SkRasterPipeline_kMaxStride];
+    Interpreter::Value* args[4] = { values[0], values[1], values[2], values[3] };
+    for (int c = 0; c < channels; ++c) {
+        for (int i = 0; i < activePixels; ++i) {
+            values[c][i] = Interpreter::Value(ctx.rgba[i * 4 + c]);
+        }
+    }
+    Interpreter::RunStriped(ctx.fFunction, activePixels, args, nullptr);
+    for (int c = 0; c < channels; ++c) {
+        for (int i = 0; i < activePixels; ++i) {
+            ctx.rgba[i * 4 + c] = values[c][i].fFloat;
+        }
+    }
+}
+
+bool Interpreter::AppendByteCodeStage(SkRasterPipeline* pipeline, SkArenaAlloc* alloc,
+                                      const ByteCodeFunction* f) {
+    if (!f || f->fParameterCount < 1 || f->fParameterCount > 4) {
+        return false;
+    }
+    for (int p = 0; p < f->fParameterCount; ++p) {
+        if (!f->fParameterIsOut[p] || !f->fParameterIsFloat[p]) {
+            return false;
+        }
+    }
+    ByteCodeCallbackCtx* ctx = alloc->make<ByteCodeCallbackCtx>();
+    ctx->fn = do_bytecode_callback;
+    ctx->fFunction = f;
+    pipeline->append(SkRasterPipeline::callback, ctx);
+    return true;
+}
+
 } // namespace
 
 #endif
@@ -8,6 +8,7 @@
 #ifndef SKSL_INTERPRETER
 #define SKSL_INTERPRETER
 
+#include "SkSLByteCode.h"
 #include "ir/SkSLAppendStage.h"
 #include "ir/SkSLExpression.h"
 #include "ir/SkSLFunctionCall.h"
@@ -17,6 +18,7 @@
 
 #include <stack>
 
+class SkArenaAlloc;
 class SkRasterPipeline;
 
 namespace SkSL {
@@ -31,6 +33,8 @@ class Interpreter {
 
 public:
     union Value {
+        Value() {}
+
         Value(float f)
         : fFloat(f) {}
 
@@ -76,6 +80,27 @@ public:
 
     Value evaluate(const Expression& expr);
 
+    /**
+     * Runs a function compiled by Compiler::toByteCode(). args holds its parameters, and receives
+     * the final values of any 'out' or 'inout' ones. If outReturn is not null, it receives the
+     * return value.
+     */
+    static void Run(const ByteCodeFunction* f, Value args[], Value* outReturn);
+
+    /**
+     * Like Run(), but runs f on N independent sets of inputs, several at a time. args[i] points
+     * to the N values of the i'th parameter, and outReturn (if not null) to N return values.
+     */
+    static void RunStriped(const ByteCodeFunction* f, int N, Value* args[], Value* outReturn);
+
+    /**
+     * Appends a stage that runs f on each pixel. f must take one to four 'inout float'
+     * parameters, which hold the pixel's r, g, b, and a (in that order). Returns false, without
+     * appending anything, if it doesn't.
+     */
+    static bool AppendByteCodeStage(SkRasterPipeline* pipeline, SkArenaAlloc* alloc,
+                                    const ByteCodeFunction* f);
+
 private:
     std::unique_ptr<Program> fProgram;
     SkRasterPipeline& fPipeline;
@@ -10,12 +10,14 @@
 #include "SkCodecImageGenerator.h"
 #include "SkData.h"
 #include "SkImage.h"
+#include "SkTaskGroup.h"
 #include <algorithm>
 
 SkAnimCodecPlayer::SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec) : fCodec(std::move(codec)) {
     fImageInfo = fCodec->getInfo();
     fFrameInfos = fCodec->getFrameInfo();
     fImages.resize(fFrameInfos.size());
+    fLastUsed.resize(fFrameInfos.size());
 
     // change the interpretation of fDuration to a end-time for that frame
     size_t dur = 0;
@@ -34,44 +36,104 @@ SkAnimCodecPlayer::SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec) : fCodec(st
     }
 }
 
-SkAnimCodecPlayer::~SkAnimCodecPlayer() {}
+SkAnimCodecPlayer::~SkAnimCodecPlayer() {
+    this->stopLookAhead();
+}
 
 SkISize SkAnimCodecPlayer::dimensions() {
     return { fImageInfo.width(), fImageInfo.height() };
 }
 
+size_t SkAnimCodecPlayer::frameBytes() const {
+    return fImageInfo.computeMinByteSize();
+}
+
+// Called with fMutex held. It is released while the frame decodes, so that getFrame() never
+// waits on another frame's decode.
 sk_sp<SkImage> SkAnimCodecPlayer::getFrameAt(int index) {
     SkASSERT((unsigned)index < fFrameInfos.size());
 
+    fLastUsed[index] = ++fUseCount;
     if (fImages[index]) {
         return fImages[index];
     }
 
-    size_t rb = fImageInfo.minRowBytes();
-    size_t size = fImageInfo.computeByteSize(rb);
-    auto data = SkData::MakeUninitialized(size);
-
     SkCodec::Options opts;
     opts.fFrameIndex = index;
 
+    // Draw on top of the latest cached frame that this one can be drawn on. If there is none,
+    // decode (and cache) the frame it requires, rather than leaving the codec to decode that
+    // again for every frame that depends on it.
     const int requiredFrame = fFrameInfos[index].fRequiredFrame;
+    int priorFrame = SkCodec::kNoFrame;
+    sk_sp<SkImage> priorImage;
     if (requiredFrame != SkCodec::kNoFrame) {
-        auto requiredImage = fImages[requiredFrame];
-        SkPixmap requiredPM;
-        if (requiredImage && requiredImage->peekPixels(&requiredPM)) {
-            sk_careful_memcpy(data->writable_data(), requiredPM.addr(), size);
-            opts.fPriorFrame = requiredFrame;
+        priorFrame = index - 1;
+        while (priorFrame > requiredFrame && (!fImages[priorFrame] ||
+                fFrameInfos[priorFrame].fDisposalMethod ==
+                        SkCodecAnimation::DisposalMethod::kRestorePrevious)) {
+            priorFrame--;
         }
+        priorImage = this->getFrameAt(priorFrame);
     }
-    if (SkCodec::kSuccess == fCodec->getPixels(fImageInfo, data->writable_data(), rb, &opts)) {
-        return fImages[index] = SkImage::MakeRasterData(fImageInfo, std::move(data), rb);
+
+    fMutex.release();
+    sk_sp<SkImage> image;
+    {
+        SkAutoMutexAcquire codecLock(fCodecMutex);
+        // Another thread may have decoded this frame while we waited for the codec.
+        fMutex.acquire();
+        image = fImages[index];
+        fMutex.release();
+
+        if (!image) {
+            size_t rb = fImageInfo.minRowBytes();
+            size_t size = fImageInfo.computeByteSize(rb);
+            auto data = SkData::MakeUninitialized(size);
+
+            SkPixmap priorPM;
+            if (priorImage && priorImage->peekPixels(&priorPM)) {
+                sk_careful_memcpy(data->writable_data(), priorPM.addr(), size);
+                opts.fPriorFrame = priorFrame;
+            }
+            if (SkCodec::kSuccess ==
+                    fCodec->getPixels(fImageInfo, data->writable_data(), rb, &opts)) {
+                image = SkImage::MakeRasterData(fImageInfo, std::move(data), rb);
+            }
+        }
+
+        // Publish the frame before letting go of the codec, so nobody decodes it again.
+        fMutex.acquire();
+        if (image && !fImages[index]) {
+            fImages[index] = image;
+            fCachedBytes += this->frameBytes();
+            this->purge(index);
+        }
+    }
+    return image;
+}
+
+void SkAnimCodecPlayer::purge(int keepIndex) {
+    while (fCachedBytes > fCacheBudget) {
+        int oldest = -1;
+        for (int i = 0; i < (int) fImages.size(); i++) {
+            if (fImages[i] && i != keepIndex && i != fCurrIndex &&
+                    (oldest < 0 || fLastUsed[i] < fLastUsed[oldest])) {
+                oldest = i;
+            }
+        }
+        if (oldest < 0) {
+            break;
+        }
+        fImages[oldest].reset();
+        fCachedBytes -= this->frameBytes();
     }
-    return nullptr;
 }
 
 sk_sp<SkImage> SkAnimCodecPlayer::getFrame() {
     SkASSERT(fTotalDuration > 0 || fImages.size() == 1);
 
+    SkAutoMutexAcquire lock(fMutex);
     return fTotalDuration > 0
         ? this->getFrameAt(fCurrIndex)
         : fImages.front();
@@ -88,9 +150,88 @@ bool SkAnimCodecPlayer::seek(uint32_t msec) {
                                   [](const SkCodec::FrameInfo& info, uint32_t msec) {
                                       return (uint32_t)info.fDuration < msec;
                                   });
-    int prevIndex = fCurrIndex;
-    fCurrIndex = lower - fFrameInfos.begin();
-    return fCurrIndex != prevIndex;
+    {
+        SkAutoMutexAcquire lock(fMutex);
+        int prevIndex = fCurrIndex;
+        fCurrIndex = lower - fFrameInfos.begin();
+        if (fCurrIndex == prevIndex) {
+            return false;
+        }
+    }
+    this->startLookAhead();
+    return true;
+}
+
+void SkAnimCodecPlayer::setCacheBudget(size_t bytes) {
+    SkAutoMutexAcquire lock(fMutex);
+    fCacheBudget = bytes;
+    this->purge(fCurrIndex);
 }
 
+void SkAnimCodecPlayer::setLookAhead(SkExecutor* executor, int frameCount) {
+    this->stopLookAhead();
+    if (!executor || frameCount <= 0 || !fTotalDuration) {
+        return;
+    }
+
+    {
+        SkAutoMutexAcquire lock(fMutex);
+        fLookAheadCount = frameCount;
+    }
+    fLookAheadTasks.reset(new SkTaskGroup(*executor));
+    this->startLookAhead();
+}
+
+void SkAnimCodecPlayer::startLookAhead() {
+    if (!fLookAheadTasks) {
+        return;
+    }
+    {
+        SkAutoMutexAcquire lock(fMutex);
+        if (fLookAheadRunning) {
+            return;
+        }
+        fLookAheadRunning = true;
+    }
+    // The executor may run the task right away, so add it without holding fMutex.
+    fLookAheadTasks->add([this] { this->lookAhead(); });
+}
 
+void SkAnimCodecPlayer::lookAhead() {
+    const int frameCount = (int) fFrameInfos.size();
+    SkAutoMutexAcquire lock(fMutex);
+    for (;;) {
+        // Decode the first missing frame after the current one, without dropping any of the
+        // ones before it to make room. getFrameAt() lets go of fMutex while it decodes.
+        const size_t framesInBudget = fCacheBudget / this->frameBytes();
+        const int count = (int) std::min<size_t>({ (size_t) fLookAheadCount,
+                                                   (size_t) frameCount - 1,
+                                                   framesInBudget ? framesInBudget - 1 : 0 });
+        int next = -1;
+        for (int i = 1; i <= count && !fStopLookAhead; i++) {
+            const int index = (fCurrIndex + i) % frameCount;
+            if (!fImages[index]) {
+                next = index;
+                break;
+            }
+        }
+        if (next < 0 || !this->getFrameAt(next)) {
+            fLookAheadRunning = false;
+            return;
+        }
+    }
+}
+
+void SkAnimCodecPlayer::stopLookAhead() {
+    {
+        SkAutoMutexAcquire lock(fMutex);
+        fStopLookAhead = true;
+    }
+    // Waits for the current task to finish.
+    fLookAheadTasks.reset();
+
+    SkAutoMutexAcquire lock(fMutex);
+    fStopLookAhead = false;
+    fLookAheadRunning = false;
+    fLookAheadCount = 0;
+}
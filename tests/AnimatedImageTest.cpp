@@ -14,6 +14,7 @@
 #include "SkCodec.h"
 #include "SkColor.h"
 #include "SkData.h"
+#include "SkExecutor.h"
 #include "SkImageInfo.h"
 #include "SkPicture.h"
 #include "SkRefCnt.h"
@@ -354,3 +355,64 @@ DEF_TEST(AnimatedImage, r) {
         }
     }
 }
+
+DEF_TEST(AnimatedImage_lookAhead, r) {
+    if (GetResourcePath().isEmpty()) {
+        return;
+    }
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(1);
+    for (const char* file : { "images/alphabetAnim.gif",
+                              "images/colorTables.gif",
+                              "images/randPixelsAnim.gif",
+                              "images/randPixelsAnim2.gif",
+                              "images/required.gif",
+                              "images/webp-animated.webp",
+                              "images/required.webp",
+                              }) {
+        auto data = GetResourceAsData(file);
+        if (!data) {
+            ERRORF(r, "Could not get %s", file);
+            continue;
+        }
+
+        // Decoding ahead must not change any frame.
+        sk_sp<SkAnimatedImage> images[2];
+        for (auto& image : images) {
+            image = SkAnimatedImage::Make(SkAndroidCodec::MakeFromCodec(
+                        SkCodec::MakeFromData(data)));
+        }
+        if (!images[0] || !images[1]) {
+            ERRORF(r, "Could not create animated image for %s", file);
+            continue;
+        }
+        for (auto& image : images) {
+            image->setRepetitionCount(SkCodec::kRepetitionCountInfinite);
+        }
+        images[1]->setLookAheadExecutor(executor.get());
+
+        const SkIRect bounds = images[0]->getBounds().roundOut();
+        const auto info = SkImageInfo::MakeN32Premul(bounds.width(), bounds.height());
+        for (int i = 0; i < 40; i++) {
+            if (17 == i) {
+                for (auto& image : images) {
+                    image->reset();
+                }
+            }
+
+            SkBitmap bms[2];
+            for (int j = 0; j < 2; j++) {
+                bms[j].allocPixels(info);
+                bms[j].eraseColor(SK_ColorTRANSPARENT);
+                SkCanvas canvas(bms[j]);
+                images[j]->draw(&canvas);
+            }
+            if (!compare_bitmaps(r, file, i, bms[0], bms[1])) {
+                break;
+            }
+
+            const int duration = images[0]->decodeNextFrame();
+            REPORTER_ASSERT(r, duration == images[1]->decodeNextFrame());
+        }
+        images[1]->setLookAheadExecutor(nullptr);
+    }
+}
@@ -13,16 +13,23 @@
 #include "SkCodec.h"
 #include "SkCodecAnimation.h"
 #include "SkData.h"
+#include "SkExecutor.h"
+#include "SkImage.h"
 #include "SkImageInfo.h"
 #include "SkMakeUnique.h"
 #include "SkRefCnt.h"
+#include "SkSemaphore.h"
 #include "SkSize.h"
+#include "SkStream.h"
 #include "SkString.h"
 #include "SkTypes.h"
 #include "Test.h"
 #include "sk_tool_utils.h"
 
+#include <atomic>
+#include <chrono>
 #include <cstring>
+#include <future>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -484,3 +491,119 @@ DEF_TEST(AnimCodecPlayer, r) {
         REPORTER_ASSERT(r, f1->bounds().size() == test.fSize);
     }
 }
+
+DEF_TEST(AnimCodecPlayer_cache, r) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(1);
+    for (const char* file : { "images/alphabetAnim.gif",
+                              "images/randPixelsAnim2.gif",
+                              "images/required.gif",
+                              "images/webp-animated.webp",
+                              }) {
+        auto data = GetResourceAsData(file);
+        if (!data) {
+            ERRORF(r, "Missing resource %s", file);
+            continue;
+        }
+
+        auto codec = SkCodec::MakeFromData(data);
+        if (!codec) {
+            ERRORF(r, "Could not create codec for %s", file);
+            continue;
+        }
+        auto expectedPlayer = skstd::make_unique<SkAnimCodecPlayer>(std::move(codec));
+        const uint32_t duration = expectedPlayer->duration();
+        if (0 == duration) {
+            ERRORF(r, "%s is not animated", file);
+            continue;
+        }
+
+        // Keep room for the current frame and two more, so that frames are dropped and
+        // decoded again, and look ahead as far as that allows.
+        const SkISize dims = expectedPlayer->dimensions();
+        const size_t frameBytes = SkImageInfo::MakeN32Premul(dims).computeMinByteSize();
+        for (size_t budget : { frameBytes * 3, frameBytes * 3 / 2, (size_t) SIZE_MAX }) {
+            for (bool lookAhead : { false, true }) {
+                auto player = skstd::make_unique<SkAnimCodecPlayer>(SkCodec::MakeFromData(data));
+                player->setCacheBudget(budget);
+                if (lookAhead) {
+                    player->setLookAhead(executor.get(), 4);
+                }
+
+                // Play through twice, skipping some frames the second time.
+                for (uint32_t msec = 0; msec < 2 * duration; msec += msec < duration ? 10 : 70) {
+                    expectedPlayer->seek(msec);
+                    player->seek(msec);
+                    sk_sp<SkImage> expected = expectedPlayer->getFrame(),
+                                   actual = player->getFrame();
+                    REPORTER_ASSERT(r, !expected == !actual);
+                    if (!expected || !actual) {
+                        continue;
+                    }
+
+                    SkBitmap expectedBm, actualBm;
+                    REPORTER_ASSERT(r, expected->asLegacyBitmap(&expectedBm));
+                    REPORTER_ASSERT(r, actual->asLegacyBitmap(&actualBm));
+                    if (expectedBm.computeByteSize() != actualBm.computeByteSize() ||
+                            memcmp(expectedBm.getPixels(), actualBm.getPixels(),
+                                   expectedBm.computeByteSize())) {
+                        ERRORF(r, "%s differs at %u ms with budget %zu, lookAhead %d", file,
+                               msec, budget, lookAhead);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+namespace {
+// A stream whose next read, once stall() is called, waits for resume(). It has no memory base,
+// so that codecs read frames from it as they decode them.
+class StallingStream : public SkMemoryStream {
+public:
+    explicit StallingStream(sk_sp<SkData> data) : SkMemoryStream(std::move(data)) {}
+
+    void stall() { fStall = true; }
+    void waitUntilStalled() { fStalled.wait(); }
+    void resume() { fResume.signal(); }
+
+    size_t read(void* buffer, size_t size) override {
+        if (fStall.exchange(false)) {
+            fStalled.signal();
+            fResume.wait();
+        }
+        return SkMemoryStream::read(buffer, size);
+    }
+    const void* getMemoryBase() override { return nullptr; }
+
+private:
+    std::atomic<bool> fStall{false};
+    SkSemaphore       fStalled, fResume;
+};
+}  // namespace
+
+// Getting a frame that is already decoded must not wait on a frame being decoded ahead.
+DEF_TEST(AnimCodecPlayer_lookAheadDoesNotBlock, r) {
+    auto data = GetResourceAsData("images/alphabetAnim.gif");
+    if (!data) {
+        ERRORF(r, "Missing resource");
+        return;
+    }
+    auto stream = skstd::make_unique<StallingStream>(data);
+    StallingStream* streamPtr = stream.get();
+    auto player = skstd::make_unique<SkAnimCodecPlayer>(SkCodec::MakeFromStream(std::move(stream)));
+    sk_sp<SkImage> frame = player->getFrame();
+    REPORTER_ASSERT(r, frame);
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(1);
+    streamPtr->stall();
+    player->setLookAhead(executor.get(), 1);
+    streamPtr->waitUntilStalled();
+
+    auto cached = std::async(std::launch::async, [&player] { return player->getFrame(); });
+    bool blocked = cached.wait_for(std::chrono::seconds(10)) != std::future_status::ready;
+    REPORTER_ASSERT(r, !blocked);
+    streamPtr->resume();
+    REPORTER_ASSERT(r, cached.get() == frame);
+    player->setLookAhead(nullptr, 0);
+}
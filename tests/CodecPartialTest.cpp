@@ -10,6 +10,7 @@
 #include "Resources.h"
 #include "SkBitmap.h"
 #include "SkCodec.h"
+#include "SkColorPriv.h"
 #include "SkData.h"
 #include "SkImageInfo.h"
 #include "SkMakeUnique.h"
@@ -122,6 +123,28 @@ static void test_partial(skiatest::Reporter* r, const char* name, const sk_sp<Sk
     compare_bitmaps(r, truth, incremental);
 }
 
+// SkPngCodec reads every chunk up to and including the first IDAT chunk's header before it
+// creates a codec.  Returns how many bytes that is, or 0 if data is not such a PNG.
+static size_t png_bytes_to_create(const SkData& data) {
+    const uint8_t* bytes = data.bytes();
+    const size_t size = data.size();
+    constexpr size_t kSignatureSize = 8,
+                     kChunkHeaderSize = 8,  // length, then type
+                     kCRCSize = 4;
+    if (size < kSignatureSize || memcmp(bytes, "\x89PNG\r\n\x1a\n", kSignatureSize)) {
+        return 0;
+    }
+    for (size_t offset = kSignatureSize; offset + kChunkHeaderSize <= size; ) {
+        const size_t length = (size_t)bytes[offset + 0] << 24 | (size_t)bytes[offset + 1] << 16 |
+                              (size_t)bytes[offset + 2] <<  8 | (size_t)bytes[offset + 3];
+        if (!memcmp(bytes + offset + 4, "IDAT", 4)) {
+            return offset + kChunkHeaderSize;
+        }
+        offset += kChunkHeaderSize + length + kCRCSize;
+    }
+    return 0;
+}
+
 static void test_partial(skiatest::Reporter* r, const char* name, size_t minBytes = 0) {
     sk_sp<SkData> file = GetResourceAsData(name);
     if (!file) {
@@ -131,13 +154,11 @@ static void test_partial(skiatest::Reporter* r, const char* name, size_t minByte
 
     // This size is arbitrary, but deliberately different from the buffer size used by SkPngCodec.
     constexpr size_t kIncrement = 1000;
+    minBytes = SkTMax(minBytes, png_bytes_to_create(*file));
     test_partial(r, name, file, SkTMax(file->size() / 2, minBytes), kIncrement);
 }
 
 DEF_TEST(Codec_partial, r) {
-#if 0
-    // FIXME (scroggo): SkPngCodec needs to use SkStreamBuffer in order to
-    // support incremental decoding.
     test_partial(r, "images/plane.png");
     test_partial(r, "images/plane_interlaced.png");
     test_partial(r, "images/yellow_rose.png");
@@ -148,12 +169,147 @@ DEF_TEST(Codec_partial, r) {
     test_partial(r, "images/arrow.png");
     test_partial(r, "images/randPixels.png");
     test_partial(r, "images/baby_tux.png");
-#endif
     test_partial(r, "images/box.gif");
     test_partial(r, "images/randPixels.gif", 215);
     test_partial(r, "images/color_wheel.gif");
 }
 
+namespace {
+struct PreviewChecker {
+    skiatest::Reporter* fReporter;
+    const SkBitmap*     fTruth;
+    const SkBitmap*     fDst;
+    bool                fIsPng;
+    std::vector<int>    fPasses;
+};
+}  // namespace
+
+static void check_preview(void* context, int passes) {
+    PreviewChecker* checker = static_cast<PreviewChecker*>(context);
+    skiatest::Reporter* r = checker->fReporter;
+    REPORTER_ASSERT(r, passes > 0);
+    REPORTER_ASSERT(r, checker->fPasses.empty() || passes > checker->fPasses.back());
+    checker->fPasses.push_back(passes);
+
+    const SkBitmap& dst = *checker->fDst;
+    const SkBitmap& truth = *checker->fTruth;
+    if (checker->fIsPng) {
+        // Every pixel shows the final color of the last pixel above and to the left of it that
+        // the passes so far decoded.
+        static constexpr int kBlockWidths[]  = { 8, 4, 4, 2, 2, 1, 1 };
+        static constexpr int kBlockHeights[] = { 8, 8, 4, 4, 2, 2, 1 };
+        REPORTER_ASSERT(r, passes < 7);
+        const int blockWidth = kBlockWidths[passes - 1],
+                  blockHeight = kBlockHeights[passes - 1];
+        for (int y = 0; y < dst.height(); y++) {
+            for (int x = 0; x < dst.width(); x++) {
+                const SkPMColor expected = *truth.getAddr32(x - x % blockWidth,
+                                                            y - y % blockHeight);
+                if (*dst.getAddr32(x, y) != expected) {
+                    ERRORF(r, "pass %d preview at (%d, %d) is %08x, not %08x", passes, x, y,
+                           *dst.getAddr32(x, y), expected);
+                    return;
+                }
+            }
+        }
+    } else {
+        // The jpeg is opaque, so every pixel should have been written over the transparent
+        // dst.
+        for (int y = 0; y < dst.height(); y++) {
+            for (int x = 0; x < dst.width(); x++) {
+                if (SkGetPackedA32(*dst.getAddr32(x, y)) != 0xFF) {
+                    ERRORF(r, "scan %d preview did not write (%d, %d)", passes, x, y);
+                    return;
+                }
+            }
+        }
+    }
+}
+
+static void test_preview(skiatest::Reporter* r, const char* name, size_t increment) {
+    sk_sp<SkData> file = GetResourceAsData(name);
+    if (!file) {
+        SkDebugf("missing resource %s\n", name);
+        return;
+    }
+    SkBitmap truth;
+    if (!create_truth(file, &truth)) {
+        ERRORF(r, "Failed to decode %s\n", name);
+        return;
+    }
+
+    HaltingStream* stream = new HaltingStream(file, file->size() / 10);
+    auto codec = SkCodec::MakeFromStream(std::unique_ptr<SkStream>(stream));
+    if (!codec) {
+        ERRORF(r, "Failed to create codec for %s", name);
+        return;
+    }
+
+    const SkImageInfo info = standardize_info(codec.get());
+    SkBitmap bm;
+    bm.allocPixels(info);
+    bm.eraseColor(SK_ColorTRANSPARENT);
+
+    PreviewChecker checker = { r, &truth, &bm, SkStrEndsWith(name, ".png"), {} };
+    SkCodec::Options options;
+    options.fPreviewProc = check_preview;
+    options.fPreviewContext = &checker;
+    if (SkCodec::kSuccess != codec->startIncrementalDecode(info, bm.getPixels(), bm.rowBytes(),
+                                                           &options)) {
+        ERRORF(r, "Failed to start incremental decode of %s", name);
+        return;
+    }
+
+    while (true) {
+        const size_t previews = checker.fPasses.size();
+        int rowsDecoded = 0;
+        const SkCodec::Result result = codec->incrementalDecode(&rowsDecoded);
+        if (SkCodec::kSuccess == result) {
+            break;
+        }
+        REPORTER_ASSERT(r, SkCodec::kIncompleteInput == result);
+        if (checker.fPasses.size() > previews) {
+            REPORTER_ASSERT(r, rowsDecoded == info.height());
+        }
+        if (stream->isAllDataReceived()) {
+            ERRORF(r, "Failed to completely decode %s", name);
+            return;
+        }
+        stream->addNewData(increment);
+    }
+
+    REPORTER_ASSERT(r, checker.fPasses.size() > 1, "%s: only %zu previews", name,
+                    checker.fPasses.size());
+    compare_bitmaps(r, truth, bm);
+}
+
+DEF_TEST(Codec_partialPreview, r) {
+    test_preview(r, "images/plane_interlaced.png", 500);
+    test_preview(r, "images/flutter_logo.jpg", 500);
+    test_preview(r, "images/brickwork-texture.jpg", 4000);
+
+    // Without fPreviewProc, or for a baseline jpeg, SkJpegCodec does not decode incrementally.
+    auto codec = SkCodec::MakeFromData(GetResourceAsData("images/flutter_logo.jpg"));
+    if (codec) {
+        const SkImageInfo info = standardize_info(codec.get());
+        SkBitmap bm;
+        bm.allocPixels(info);
+        REPORTER_ASSERT(r, SkCodec::kUnimplemented ==
+                           codec->startIncrementalDecode(info, bm.getPixels(), bm.rowBytes()));
+    }
+    codec = SkCodec::MakeFromData(GetResourceAsData("images/mandrill_512_q075.jpg"));
+    if (codec) {
+        const SkImageInfo info = standardize_info(codec.get());
+        SkBitmap bm;
+        bm.allocPixels(info);
+        SkCodec::Options options;
+        options.fPreviewProc = [](void*, int) {};
+        REPORTER_ASSERT(r, SkCodec::kUnimplemented ==
+                           codec->startIncrementalDecode(info, bm.getPixels(), bm.rowBytes(),
+                                                         &options));
+    }
+}
+
 DEF_TEST(Codec_partialWuffs, r) {
     const char* path = "images/alphabetAnim.gif";
     auto file = GetResourceAsData(path);
@@ -18,6 +18,7 @@
 #include "SkColorSpacePriv.h"
 #include "SkData.h"
 #include "SkEncodedImageFormat.h"
+#include "SkExecutor.h"
 #include "SkFrontBufferedStream.h"
 #include "SkImage.h"
 #include "SkImageGenerator.h"
@@ -1809,3 +1810,200 @@ DEF_TEST(Codec_crbug807324, r) {
         }
     }
 }
+
+// Runs each task as soon as it is added, and counts them.
+class CountingExecutor final : public SkExecutor {
+public:
+    void add(std::function<void(void)> work) override {
+        fCount++;
+        work();
+    }
+
+    int fCount = 0;
+};
+
+// Decodes data with and without an executor, and checks that the results match exactly.
+static void check_jpeg_bands(skiatest::Reporter* r, const sk_sp<SkData>& data,
+                             const SkImageInfo& dstInfo, bool expectBands) {
+    std::unique_ptr<SkCodec> codec(SkCodec::MakeFromData(data));
+    if (!codec) {
+        ERRORF(r, "Unable to create codec");
+        return;
+    }
+
+    SkBitmap serial, banded;
+    serial.allocPixels(dstInfo);
+    banded.allocPixels(dstInfo);
+    banded.eraseColor(SK_ColorTRANSPARENT);
+    REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getPixels(serial.pixmap()));
+
+    CountingExecutor executor;
+    SkCodec::Options options;
+    options.fExecutor = &executor;
+    REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getPixels(dstInfo, banded.getPixels(),
+                                                             banded.rowBytes(), &options));
+    REPORTER_ASSERT(r, expectBands == (executor.fCount > 1), "%dx%d color type %d: %d bands",
+                    dstInfo.width(), dstInfo.height(), dstInfo.colorType(), executor.fCount);
+
+    for (int y = 0; y < dstInfo.height(); y++) {
+        if (0 != memcmp(serial.getAddr(0, y), banded.getAddr(0, y), dstInfo.minRowBytes())) {
+            ERRORF(r, "%dx%d color type %d: row %d differs", dstInfo.width(), dstInfo.height(),
+                   dstInfo.colorType(), y);
+            return;
+        }
+    }
+}
+
+DEF_TEST(Codec_jpegRestartBands, r) {
+    SkBitmap mandrill;
+    if (!GetResourceAsBitmap("images/mandrill_512.png", &mandrill)) {
+        return;
+    }
+
+    // Large enough to split into several bands at every scale.
+    SkBitmap src;
+    src.allocPixels(SkImageInfo::MakeN32Premul(1000, 1600));
+    SkCanvas canvas(src);
+    canvas.scale(2, 3.125f);
+    canvas.drawBitmap(mandrill, 0, 0);
+
+    SkBitmap gray;
+    gray.allocPixels(src.info().makeColorType(kGray_8_SkColorType)
+                               .makeAlphaType(kOpaque_SkAlphaType));
+    src.readPixels(gray.pixmap());
+
+    auto p3 = SkColorSpace::MakeRGB(SkNamedTransferFn::kSRGB, SkNamedGamut::kDCIP3);
+    auto encode = [](const SkPixmap& pixmap, SkJpegEncoder::Downsample downsample,
+                     int restartRows) {
+        SkJpegEncoder::Options options;
+        options.fQuality = 90;
+        options.fDownsample = downsample;
+        options.fRestartRows = restartRows;
+        SkDynamicMemoryWStream stream;
+        SkAssertResult(SkJpegEncoder::Encode(&stream, pixmap, options));
+        return stream.detachAsData();
+    };
+
+    for (auto downsample : { SkJpegEncoder::Downsample::k420, SkJpegEncoder::Downsample::k422,
+                             SkJpegEncoder::Downsample::k444 }) {
+        // With more than one row per interval, bands must reach further for their context rows.
+        for (int restartRows : { 1, 3 }) {
+            sk_sp<SkData> data = encode(src.pixmap(), downsample, restartRows);
+            std::unique_ptr<SkCodec> codec(SkCodec::MakeFromData(data));
+            for (float scale : { 1.0f, 0.5f, 0.25f, 0.125f }) {
+                SkISize size = codec->getScaledDimensions(scale);
+                check_jpeg_bands(r, data, codec->getInfo().makeWH(size.width(), size.height()),
+                                 true);
+            }
+            for (SkColorType colorType : { kRGB_565_SkColorType, kRGBA_F16_SkColorType }) {
+                check_jpeg_bands(r, data, codec->getInfo().makeColorType(colorType), true);
+            }
+            // Needs a color xform.
+            check_jpeg_bands(r, data, codec->getInfo().makeColorSpace(p3), true);
+        }
+    }
+
+    // Without restart markers, the image is decoded serially.
+    check_jpeg_bands(r, encode(src.pixmap(), SkJpegEncoder::Downsample::k420, 0),
+                     src.info().makeAlphaType(kOpaque_SkAlphaType), false);
+
+    sk_sp<SkData> data = encode(gray.pixmap(), SkJpegEncoder::Downsample::k420, 1);
+    check_jpeg_bands(r, data, gray.info(), true);
+    check_jpeg_bands(r, data, gray.info().makeColorType(kN32_SkColorType), true);
+
+    // Truncated data is left to the serial decode, which reports it.
+    sk_sp<SkData> truncated = SkData::MakeSubset(data.get(), 0, data->size() - 100);
+    std::unique_ptr<SkCodec> codec(SkCodec::MakeFromData(truncated));
+    SkBitmap bm;
+    bm.allocPixels(gray.info());
+    CountingExecutor executor;
+    SkCodec::Options options;
+    options.fExecutor = &executor;
+    REPORTER_ASSERT(r, SkCodec::kIncompleteInput == codec->getPixels(gray.info(), bm.getPixels(),
+                                                                     bm.rowBytes(), &options));
+    REPORTER_ASSERT(r, 0 == executor.fCount);
+}
+
+// Decodes each subset with a codec that seeks to restart markers, and checks it against a codec
+// that cannot, because its stream is not in memory.
+static void check_jpeg_seek(skiatest::Reporter* r, const sk_sp<SkData>& data) {
+    std::unique_ptr<SkAndroidCodec> codec(SkAndroidCodec::MakeFromData(data));
+    std::unique_ptr<SkAndroidCodec> expectedCodec(SkAndroidCodec::MakeFromStream(
+            skstd::make_unique<NotAssetMemStream>(data)));
+    if (!codec || !expectedCodec) {
+        ERRORF(r, "Failed to create codecs");
+        return;
+    }
+
+    const SkISize dims = codec->getInfo().dimensions();
+    for (int sampleSize : { 1, 2, 3, 8 }) {
+        // Reuse the codecs for every tile, as a region decoder does.
+        for (int y = 0; y < dims.height(); y += 300) {
+            for (int x : { 0, 250 }) {
+                SkIRect subset = SkIRect::MakeXYWH(x, y, 300, 300);
+                if (!subset.intersect(SkIRect::MakeSize(dims)) ||
+                        !codec->getSupportedSubset(&subset)) {
+                    continue;
+                }
+                SkISize size = codec->getSampledSubsetDimensions(sampleSize, subset);
+                SkImageInfo info = codec->getInfo().makeWH(size.width(), size.height());
+                SkAndroidCodec::AndroidOptions options;
+                options.fSubset = &subset;
+                options.fSampleSize = sampleSize;
+
+                SkBitmap bm, expected;
+                bm.allocPixels(info);
+                expected.allocPixels(info);
+                REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getAndroidPixels(info,
+                        bm.getPixels(), bm.rowBytes(), &options));
+                REPORTER_ASSERT(r, SkCodec::kSuccess == expectedCodec->getAndroidPixels(info,
+                        expected.getPixels(), expected.rowBytes(), &options));
+                for (int row = 0; row < info.height(); row++) {
+                    if (memcmp(bm.getAddr(0, row), expected.getAddr(0, row),
+                               info.minRowBytes())) {
+                        ERRORF(r, "Mismatch in row %d of [%d %d %d %d] with sampleSize %d", row,
+                               subset.fLeft, subset.fTop, subset.fRight, subset.fBottom,
+                               sampleSize);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+DEF_TEST(Codec_jpegRestartSeek, r) {
+    SkBitmap mandrill;
+    if (!GetResourceAsBitmap("images/mandrill_512.png", &mandrill)) {
+        return;
+    }
+
+    SkBitmap src;
+    src.allocPixels(SkImageInfo::MakeN32Premul(600, 1200));
+    SkCanvas canvas(src);
+    canvas.scale(1.25f, 2.5f);
+    canvas.drawBitmap(mandrill, 0, 0);
+
+    SkBitmap gray;
+    gray.allocPixels(src.info().makeColorType(kGray_8_SkColorType)
+                               .makeAlphaType(kOpaque_SkAlphaType));
+    src.readPixels(gray.pixmap());
+
+    auto encode = [](const SkPixmap& pixmap, SkJpegEncoder::Downsample downsample,
+                     int restartRows) {
+        SkJpegEncoder::Options options;
+        options.fQuality = 90;
+        options.fDownsample = downsample;
+        options.fRestartRows = restartRows;
+        SkDynamicMemoryWStream stream;
+        SkAssertResult(SkJpegEncoder::Encode(&stream, pixmap, options));
+        return stream.detachAsData();
+    };
+
+    for (auto downsample : { SkJpegEncoder::Downsample::k420, SkJpegEncoder::Downsample::k444 }) {
+        for (int restartRows : { 1, 3 }) {
+            check_jpeg_seek(r, encode(src.pixmap(), downsample, restartRows));
+        }
+    }
+    check_jpeg_seek(r, encode(gray.pixmap(), SkJpegEncoder::Downsample::k420, 2));
+}
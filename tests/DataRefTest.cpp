@@ -6,6 +6,7 @@
  */
 
 #include "SkData.h"
+#include "SkDataPriv.h"
 #include "SkDataTable.h"
 #include "SkOSFile.h"
 #include "SkOSPath.h"
@@ -181,6 +182,13 @@ static void test_files(skiatest::Reporter* reporter) {
     REPORTER_ASSERT(reporter, r2.get() != nullptr);
     REPORTER_ASSERT(reporter, r2->size() == 26);
     REPORTER_ASSERT(reporter, strncmp(static_cast<const char*>(r2->data()), s, 26) == 0);
+
+    // Only data we mapped ourselves is hinted to the OS before decoding.
+    REPORTER_ASSERT(reporter, SkDataPriv::IsFileMapping(*r1));
+    REPORTER_ASSERT(reporter, SkDataPriv::IsFileMapping(*r2));
+    REPORTER_ASSERT(reporter, !SkDataPriv::IsFileMapping(*SkData::MakeWithCopy(s, 26)));
+    REPORTER_ASSERT(reporter,
+                    !SkDataPriv::IsFileMapping(*SkData::MakeSubset(r1.get(), 0, 26)));
 }
 
 DEF_TEST(Data, reporter) {
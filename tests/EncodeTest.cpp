@@ -8,12 +8,19 @@
 #include "Resources.h"
 #include "Test.h"
 
+#include "SkAutoPixmapStorage.h"
 #include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkCodec.h"
 #include "SkColorPriv.h"
 #include "SkEncodedImageFormat.h"
+#include "SkExecutor.h"
+#include "SkGradientShader.h"
 #include "SkImage.h"
 #include "SkJpegEncoder.h"
+#include "SkPictureRecorder.h"
 #include "SkPngEncoder.h"
+#include "SkRandom.h"
 #include "SkStream.h"
 #include "SkWebpEncoder.h"
 
@@ -291,6 +298,212 @@ DEF_TEST(Encode_PngOptions, r) {
     REPORTER_ASSERT(r, almost_equals(bm0, bm2, 0));
 }
 
+static SkBitmap decode_png(skiatest::Reporter* r, sk_sp<SkData> data, const SkImageInfo& info) {
+    SkBitmap bm;
+    std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(std::move(data));
+    REPORTER_ASSERT(r, codec);
+    if (codec) {
+        bm.allocPixels(info);
+        REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getPixels(bm.pixmap()));
+    }
+    return bm;
+}
+
+DEF_TEST(Encode_PngBands, r) {
+    // Tall enough to be split into several bands, with some noise so that the filters differ from
+    // row to row, and some repetition for the compressor to find across bands.
+    SkBitmap bitmap;
+    bitmap.allocPixels(SkImageInfo::Make(400, 2000, kRGBA_8888_SkColorType,
+                                         kUnpremul_SkAlphaType));
+    SkRandom random;
+    for (int y = 0; y < bitmap.height(); y++) {
+        for (int x = 0; x < bitmap.width(); x++) {
+            uint32_t noise = random.nextU() & 0x0F0F0F0F;
+            uint32_t gradient = 0xFF000000 | (x & 0xFF) << 16 | (y & 0xFF) << 8 | ((x ^ y) & 0xFF);
+            *bitmap.getAddr32(x, y) = (y % 300 < 150) ? gradient : 0xF0000000 | noise;
+        }
+    }
+
+    SkPixmap src;
+    SkAssertResult(bitmap.peekPixels(&src));
+    SkImageInfo gray = src.info().makeColorType(kGray_8_SkColorType)
+                                 .makeAlphaType(kOpaque_SkAlphaType);
+    SkAutoPixmapStorage graySrc;
+    graySrc.alloc(gray);
+    SkAssertResult(src.readPixels(graySrc));
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(2);
+    for (const SkPixmap* pm : { &src, (SkPixmap*)&graySrc }) {
+        for (SkPngEncoder::FilterFlag filters : { SkPngEncoder::FilterFlag::kAll,
+                                                  SkPngEncoder::FilterFlag::kNone,
+                                                  SkPngEncoder::FilterFlag::kSub,
+                                                  SkPngEncoder::FilterFlag::kUp,
+                                                  SkPngEncoder::FilterFlag::kAvg,
+                                                  SkPngEncoder::FilterFlag::kPaeth }) {
+            for (int zlibLevel : { 0, 1, 6, 9 }) {
+                SkPngEncoder::Options options;
+                options.fFilterFlags = filters;
+                options.fZLibLevel = zlibLevel;
+
+                SkDynamicMemoryWStream serial, banded;
+                REPORTER_ASSERT(r, SkPngEncoder::Encode(&serial, *pm, options));
+                options.fExecutor = executor.get();
+                REPORTER_ASSERT(r, SkPngEncoder::Encode(&banded, *pm, options));
+
+                sk_sp<SkData> serialData = serial.detachAsData(),
+                              bandedData = banded.detachAsData();
+                // Splitting into bands should cost very little.
+                REPORTER_ASSERT(r, bandedData->size() < serialData->size() * 1.01 + 64,
+                                "filters %x, level %d: %d bytes in bands, %d in one piece",
+                                (int)filters, zlibLevel, (int)bandedData->size(),
+                                (int)serialData->size());
+
+                SkBitmap expected = decode_png(r, serialData, pm->info()),
+                         actual   = decode_png(r, bandedData, pm->info());
+                for (int y = 0; y < pm->height(); y++) {
+                    REPORTER_ASSERT(r, !memcmp(expected.getAddr(0, y), actual.getAddr(0, y),
+                                               pm->info().minRowBytes()));
+                }
+            }
+        }
+    }
+}
+
+static uint32_t pattern_pixel(int x, int y) {
+    return 0xFF000000 | (x & 0xFF) << 16 | (y & 0xFF) << 8 | ((x * y) & 0xFF);
+}
+
+// Generates its rows on demand, checking that it is only asked for one strip at a time.
+class PatternRowSource : public SkEncoder::RowSource {
+public:
+    PatternRowSource(skiatest::Reporter* r, int stripHeight, int failAt = -1)
+        : fReporter(r), fStripHeight(stripHeight), fFailAt(failAt) {}
+
+    bool getRows(int y, const SkPixmap& rows) override {
+        REPORTER_ASSERT(fReporter, y == fNextRow);
+        REPORTER_ASSERT(fReporter, rows.height() <= fStripHeight);
+        REPORTER_ASSERT(fReporter, !fStrip || fStrip == rows.addr());
+        fStrip = rows.addr();
+        if (fFailAt >= 0 && fFailAt < y + rows.height()) {
+            return false;
+        }
+        for (int j = 0; j < rows.height(); j++) {
+            for (int x = 0; x < rows.width(); x++) {
+                *rows.writable_addr32(x, j) = pattern_pixel(x, y + j);
+            }
+        }
+        fNextRow = y + rows.height();
+        return true;
+    }
+
+    int nextRow() const { return fNextRow; }
+
+private:
+    skiatest::Reporter* fReporter;
+    const int           fStripHeight;
+    const int           fFailAt;
+    int                 fNextRow = 0;
+    const void*         fStrip = nullptr;
+};
+
+static std::unique_ptr<SkEncoder> make_encoder(SkEncodedImageFormat format, SkWStream* dst,
+                                               const SkImageInfo& info,
+                                               SkEncoder::RowSource* source, int stripHeight) {
+    switch (format) {
+        case SkEncodedImageFormat::kJPEG:
+            return SkJpegEncoder::Make(dst, info, source, stripHeight, SkJpegEncoder::Options());
+        case SkEncodedImageFormat::kPNG:
+            return SkPngEncoder::Make(dst, info, source, stripHeight, SkPngEncoder::Options());
+        default:
+            SkASSERT(false);
+            return nullptr;
+    }
+}
+
+DEF_TEST(Encode_RowSource, r) {
+    // Encoding in strips must produce exactly what encoding the whole image at once would.
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(500, 1500);
+    SkBitmap bitmap;
+    bitmap.allocPixels(info);
+    for (int y = 0; y < info.height(); y++) {
+        for (int x = 0; x < info.width(); x++) {
+            *bitmap.getAddr32(x, y) = pattern_pixel(x, y);
+        }
+    }
+
+    for (SkEncodedImageFormat format : { SkEncodedImageFormat::kPNG,
+                                         SkEncodedImageFormat::kJPEG }) {
+        SkDynamicMemoryWStream whole;
+        REPORTER_ASSERT(r, encode(format, &whole, bitmap.pixmap()));
+        sk_sp<SkData> expected = whole.detachAsData();
+
+        for (int stripHeight : { 1, 16, 37, 5000 }) {
+            // Ask for rows in uneven batches, some larger than a strip.
+            for (int batch : { 1, 100, info.height() }) {
+                PatternRowSource source(r, stripHeight);
+                SkDynamicMemoryWStream strips;
+                std::unique_ptr<SkEncoder> encoder = make_encoder(format, &strips, info, &source,
+                                                                  stripHeight);
+                REPORTER_ASSERT(r, encoder);
+                if (!encoder) {
+                    continue;
+                }
+                for (int y = 0; y < info.height(); y += batch) {
+                    REPORTER_ASSERT(r, encoder->encodeRows(batch));
+                }
+                REPORTER_ASSERT(r, source.nextRow() == info.height());
+                REPORTER_ASSERT(r, strips.detachAsData()->equals(expected.get()),
+                                "format %d, strips of %d, batches of %d", (int)format, stripHeight,
+                                batch);
+            }
+        }
+
+        // A failing source fails the encode, and stops it.
+        PatternRowSource failing(r, 16, 100);
+        SkDynamicMemoryWStream ignored;
+        std::unique_ptr<SkEncoder> encoder = make_encoder(format, &ignored, info, &failing, 16);
+        REPORTER_ASSERT(r, encoder && !encoder->encodeRows(info.height()));
+        REPORTER_ASSERT(r, failing.nextRow() == 96);
+
+        REPORTER_ASSERT(r, !make_encoder(format, &ignored, info, nullptr, 16));
+        REPORTER_ASSERT(r, !make_encoder(format, &ignored, info, &failing, 0));
+    }
+}
+
+DEF_TEST(Encode_RowSourcePicture, r) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(300, 1000);
+    SkRTreeFactory factory;
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(info.width(), info.height(), &factory);
+    // Anti-aliased edges may be rasterized a little differently when clipped to a strip, so
+    // stick to content that must come out the same either way.
+    SkPaint paint;
+    for (int i = 0; i < 40; i++) {
+        paint.setColor(0xFF000000 | (i * 0x0A1B2C));
+        canvas->drawRect(SkRect::MakeXYWH(37 * i % info.width(), 25 * i, 60, 45), paint);
+    }
+    const SkPoint pts[] = { { 0, 0 }, { 0, SkIntToScalar(info.height()) } };
+    const SkColor colors[] = { 0x80FF0000, 0x800000FF };
+    paint.setShader(SkGradientShader::MakeLinear(pts, colors, nullptr, 2,
+                                                 SkShader::kClamp_TileMode));
+    canvas->drawRect(SkRect::MakeXYWH(100, 0, 100, info.height()), paint);
+    sk_sp<SkPicture> picture = recorder.finishRecordingAsPicture();
+
+    SkBitmap bitmap;
+    bitmap.allocPixels(info);
+    bitmap.eraseColor(SK_ColorTRANSPARENT);
+    SkCanvas(bitmap).drawPicture(picture);
+    SkDynamicMemoryWStream whole;
+    REPORTER_ASSERT(r, SkPngEncoder::Encode(&whole, bitmap.pixmap(), SkPngEncoder::Options()));
+
+    std::unique_ptr<SkEncoder::RowSource> source = SkEncoder::RowSource::MakeFromPicture(picture);
+    SkDynamicMemoryWStream strips;
+    std::unique_ptr<SkEncoder> encoder = SkPngEncoder::Make(&strips, info, source.get(), 64,
+                                                            SkPngEncoder::Options());
+    REPORTER_ASSERT(r, encoder && encoder->encodeRows(info.height()));
+    REPORTER_ASSERT(r, strips.detachAsData()->equals(whole.detachAsData().get()));
+}
+
 #ifndef SK_BUILD_FOR_GOOGLE3
 DEF_TEST(Encode_WebpQuality, r) {
     SkBitmap bm;
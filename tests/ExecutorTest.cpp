@@ -0,0 +1,54 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkExecutor.h"
+#include "SkTaskGroup.h"
+#include "Test.h"
+
+#include <atomic>
+
+static void test_executor(skiatest::Reporter* r, SkExecutor& executor) {
+    // Every task in a batch runs exactly once.
+    {
+        std::atomic<int> counts[1000];
+        for (auto& count : counts) {
+            count.store(0);
+        }
+        SkTaskGroup tg(executor);
+        tg.batch(SK_ARRAY_COUNT(counts), [&](int i) { counts[i]++; });
+        tg.wait();
+        for (auto& count : counts) {
+            REPORTER_ASSERT(r, count.load() == 1);
+        }
+    }
+
+    // Task groups nest: tasks add more tasks to the same executor and wait on them.
+    {
+        std::atomic<int> sum{0};
+        SkTaskGroup outer(executor);
+        outer.batch(32, [&](int) {
+            SkTaskGroup inner(executor);
+            inner.batch(32, [&](int j) { sum += j; });
+            inner.wait();
+        });
+        outer.wait();
+        REPORTER_ASSERT(r, sum.load() == 32 * (32 * 31 / 2));
+    }
+}
+
+DEF_TEST(Executor_FIFO, r) {
+    test_executor(r, *SkExecutor::MakeFIFOThreadPool(4));
+}
+
+DEF_TEST(Executor_LIFO, r) {
+    test_executor(r, *SkExecutor::MakeLIFOThreadPool(4));
+}
+
+DEF_TEST(Executor_WorkStealing, r) {
+    test_executor(r, *SkExecutor::MakeWorkStealingThreadPool(4));
+    test_executor(r, *SkExecutor::MakeWorkStealingThreadPool(1));
+}
@@ -7,6 +7,7 @@
 
 #include "SkDiscardableMemory.h"
 #include "SkResourceCache.h"
+#include "SkTaskGroup.h"
 #include "Test.h"
 
 namespace {
@@ -42,7 +43,8 @@ struct TestingRec : public SkResourceCache::Rec {
 static const int COUNT = 10;
 static const int DIM = 256;
 
-static void test_cache(skiatest::Reporter* reporter, SkResourceCache& cache, bool testPurge) {
+template <typename Cache>
+static void test_cache(skiatest::Reporter* reporter, Cache& cache, bool testPurge) {
     for (int i = 0; i < COUNT; ++i) {
         TestingKey key(i);
         intptr_t value = -1;
@@ -73,7 +75,8 @@ static void test_cache(skiatest::Reporter* reporter, SkResourceCache& cache, boo
     cache.setTotalByteLimit(0);
 }
 
-static void test_cache_purge_shared_id(skiatest::Reporter* reporter, SkResourceCache& cache) {
+template <typename Cache>
+static void test_cache_purge_shared_id(skiatest::Reporter* reporter, Cache& cache) {
     for (int i = 0; i < COUNT; ++i) {
         TestingKey key(i, i & 1);   // every other key will have a 1 for its sharedID
         cache.add(new TestingRec(key, i));
@@ -150,3 +153,66 @@ DEF_TEST(ImageCache_doubleAdd, r) {
     REPORTER_ASSERT(r, cache.find(key, TestingRec::Visitor, &value));
     REPORTER_ASSERT(r, 2 == value || 3 == value);
 }
+
+DEF_TEST(ImageCache_sharded, reporter) {
+    static const size_t defLimit = DIM * DIM * 4 * COUNT + 1024;    // 1K slop
+
+    for (int shards : {1, 3, 8}) {
+        {
+            SkShardedResourceCache cache(shards, defLimit);
+            REPORTER_ASSERT(reporter, defLimit == cache.getTotalByteLimit());
+            test_cache(reporter, cache, true);
+            REPORTER_ASSERT(reporter, 0 == cache.getTotalBytesUsed());
+        }
+        {
+            SkShardedResourceCache cache(shards, SkDiscardableMemory::Create);
+            test_cache(reporter, cache, false);
+        }
+        {
+            SkShardedResourceCache cache(shards, defLimit);
+            test_cache_purge_shared_id(reporter, cache);
+        }
+    }
+}
+
+static void count_visitor(const SkResourceCache::Rec&, void* context) {
+    *(int*)context += 1;
+}
+
+DEF_TEST(ImageCache_shardedBudget, reporter) {
+    // Room for about 100 recs in total, spread over 4 shards.
+    const size_t recSize = TestingRec(TestingKey(0), 0).bytesUsed();
+    const size_t limit = 100 * recSize;
+    SkShardedResourceCache cache(4, limit);
+
+    SkTaskGroup().batch(1000, [&](int i) {
+        cache.add(new TestingRec(TestingKey(i), i));
+        intptr_t value = -1;
+        if (cache.find(TestingKey(i / 2), TestingRec::Visitor, &value)) {
+            REPORTER_ASSERT(reporter, i / 2 == value);
+        }
+    });
+
+    // No shard may go over its slice, so neither may the cache as a whole.
+    REPORTER_ASSERT(reporter, cache.getTotalBytesUsed() <= limit);
+
+    int count = 0;
+    cache.visitAll(count_visitor, &count);
+    REPORTER_ASSERT(reporter, count * recSize == cache.getTotalBytesUsed());
+
+    // Lowering the limit purges every shard down to its new slice.
+    REPORTER_ASSERT(reporter, limit == cache.setTotalByteLimit(limit / 2));
+    REPORTER_ASSERT(reporter, cache.getTotalBytesUsed() <= limit / 2);
+
+    cache.purgeAll();
+    REPORTER_ASSERT(reporter, 0 == cache.getTotalBytesUsed());
+}
+
+DEF_TEST(ImageCache_shardedSingleAllocationLimit, reporter) {
+    // 4 shards get 26, 25, 25 and 25 bytes; an allocation must fit in the smallest of them.
+    SkShardedResourceCache cache(4, 101);
+    REPORTER_ASSERT(reporter, 25 == cache.getEffectiveSingleAllocationByteLimit());
+
+    cache.setSingleAllocationByteLimit(10);
+    REPORTER_ASSERT(reporter, 10 == cache.getEffectiveSingleAllocationByteLimit());
+}
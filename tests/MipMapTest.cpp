@@ -6,6 +6,7 @@
  */
 
 #include "SkBitmap.h"
+#include "SkExecutor.h"
 #include "SkMipMap.h"
 #include "SkRandom.h"
 #include "Test.h"
@@ -209,3 +210,71 @@ DEF_TEST(MipMap_F16, reporter) {
     bmp.eraseColor(0);
     sk_sp<SkMipMap> mipmap(SkMipMap::Build(bmp, nullptr));
 }
+
+// Checks the first level of the mipmap against a plain 2x2 box filter, and every level against
+// the same mipmap built with a thread pool.
+static void test_box_filter(skiatest::Reporter* reporter, SkColorType ct, int width, int height,
+                            SkExecutor* executor) {
+    SkASSERT(width % 2 == 0 && height % 2 == 0);
+
+    SkBitmap bmp;
+    bmp.allocPixels(SkImageInfo::Make(width, height, ct, kPremul_SkAlphaType));
+    SkRandom rand;
+    uint8_t* bytes = (uint8_t*)bmp.getPixels();
+    for (size_t i = 0; i < bmp.computeByteSize(); i++) {
+        bytes[i] = (uint8_t)rand.nextU();
+    }
+
+    sk_sp<SkMipMap> mm(SkMipMap::Build(bmp, nullptr));
+    sk_sp<SkMipMap> threaded(SkMipMap::Build(bmp, nullptr, executor));
+    REPORTER_ASSERT(reporter, mm && threaded);
+    if (!mm || !threaded) {
+        return;
+    }
+
+    SkMipMap::Level level;
+    REPORTER_ASSERT(reporter, mm->getLevel(0, &level));
+    const SkPixmap& pm = level.fPixmap;
+    const size_t bpp = pm.info().bytesPerPixel();
+    for (int y = 0; y < pm.height(); y++) {
+        for (int x = 0; x < pm.width(); x++) {
+            for (size_t c = 0; c < bpp; c++) {
+                unsigned sum = 0;
+                for (int dy = 0; dy < 2; dy++) {
+                    for (int dx = 0; dx < 2; dx++) {
+                        sum += ((const uint8_t*)bmp.getAddr(2*x + dx, 2*y + dy))[c];
+                    }
+                }
+                const uint8_t actual = ((const uint8_t*)pm.addr(x, y))[c];
+                if (actual != sum / 4) {
+                    ERRORF(reporter, "%dx%d: (%d, %d) channel %d is %d, not %d",
+                           width, height, x, y, (int)c, actual, sum / 4);
+                    return;
+                }
+            }
+        }
+    }
+
+    REPORTER_ASSERT(reporter, mm->countLevels() == threaded->countLevels());
+    for (int i = 0; i < mm->countLevels(); i++) {
+        SkMipMap::Level a, b;
+        REPORTER_ASSERT(reporter, mm->getLevel(i, &a) && threaded->getLevel(i, &b));
+        for (int y = 0; y < a.fPixmap.height(); y++) {
+            REPORTER_ASSERT(reporter, !memcmp(a.fPixmap.addr(0, y), b.fPixmap.addr(0, y),
+                                              a.fPixmap.info().minRowBytes()));
+        }
+    }
+}
+
+DEF_TEST(MipMap_BoxFilter, reporter) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    for (SkColorType ct : { kRGBA_8888_SkColorType, kAlpha_8_SkColorType }) {
+        // Widths that do and don't fill the vectorized loops exactly, and sizes large enough to
+        // be split into bands.
+        for (int width : { 2, 16, 22, 34, 1024, 1030 }) {
+            for (int height : { 2, 512, 1026 }) {
+                test_box_filter(reporter, ct, width, height, executor.get());
+            }
+        }
+    }
+}
@@ -163,6 +163,38 @@ DEF_TEST(SkPDF_DeflateWStream, r) {
             }
         }
     }
+
+    // Writes larger than SkDeflateWStream's own buffer go straight to zlib, at any level.
+    for (int level : { -1, 0, 1, 6, 9 }) {
+        uint32_t size = 100000;
+        SkAutoTMalloc<uint8_t> buffer(size);
+        for (uint32_t j = 0; j < size; ++j) {
+            // Compressible, but not trivially so.
+            buffer[j] = (j % 251 < 128) ? (j & 0x3f) : random.nextU() & 0xff;
+        }
+
+        SkDynamicMemoryWStream dynamicMemoryWStream;
+        {
+            SkDeflateWStream deflateWStream(&dynamicMemoryWStream, level);
+            uint32_t j = 0;
+            while (j < size) {
+                uint32_t writeSize = SkTMin(size - j, random.nextRangeU(1, 20000));
+                REPORTER_ASSERT(r, deflateWStream.write(&buffer[j], writeSize));
+                j += writeSize;
+            }
+            REPORTER_ASSERT(r, deflateWStream.bytesWritten() == size);
+        }
+        std::unique_ptr<SkStreamAsset> compressed(dynamicMemoryWStream.detachAsStream());
+        REPORTER_ASSERT(r, level == 0 || compressed->getLength() < size);
+        std::unique_ptr<SkStreamAsset> decompressed(stream_inflate(r, compressed.get()));
+        REPORTER_ASSERT(r, decompressed && decompressed->getLength() == size);
+        if (decompressed && decompressed->getLength() == size) {
+            SkAutoTMalloc<uint8_t> result(size);
+            decompressed->read(result.get(), size);
+            REPORTER_ASSERT(r, !memcmp(result.get(), buffer.get(), size), "level %d", level);
+        }
+    }
+
     SkDeflateWStream emptyDeflateWStream(nullptr);
     REPORTER_ASSERT(r, !emptyDeflateWStream.writeText("FOO"));
 }
@@ -16,6 +16,8 @@
 
 #include "sk_tool_utils.h"
 
+#include <string>
+
 static void test_empty(skiatest::Reporter* reporter) {
     SkDynamicMemoryWStream stream;
 
@@ -256,3 +258,140 @@ DEF_TEST(SkPDF_abort_jobs, rep) {
     doc->abort();
 }
 
+static void draw_threaded_pages(SkDocument* doc) {
+    SkBitmap opaque, translucent;
+    opaque.allocN32Pixels(64, 64);
+    opaque.eraseColor(0xFF336699);
+    translucent.allocN32Pixels(64, 64);
+    translucent.eraseColor(0x80996633);
+    SkFont font(sk_tool_utils::create_portable_typeface(), 24);
+    for (int i = 0; i < 8; ++i) {
+        SkCanvas* canvas = doc->beginPage(612, 792);
+        canvas->drawColor(SkColorSetARGB(0xFF, 0x00, (uint8_t)(32 * i), 0x00));
+        canvas->drawBitmap(opaque, 10.0f * i, 20);
+        canvas->drawBitmap(translucent, 100, 10.0f * i);
+        canvas->drawString(SkStringPrintf("Page %d", i), 72, 144, font, SkPaint());
+        doc->endPage();
+    }
+}
+
+// Jobs run on the executor must not change the bytes we write.
+DEF_TEST(SkPDF_executor_reproducible, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_executor_reproducible, r);
+    SkDynamicMemoryWStream serial;
+    {
+        auto doc = SkPDF::MakeDocument(&serial);
+        draw_threaded_pages(doc.get());
+    }
+    sk_sp<SkData> expected = serial.detachAsData();
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    SkPDF::Metadata metadata;
+    metadata.fExecutor = executor.get();
+    for (int i = 0; i < 3; ++i) {
+        SkDynamicMemoryWStream threaded;
+        {
+            auto doc = SkPDF::MakeDocument(&threaded, metadata);
+            draw_threaded_pages(doc.get());
+        }
+        sk_sp<SkData> actual = threaded.detachAsData();
+        REPORTER_ASSERT(r, actual->equals(expected.get()));
+    }
+}
+
+static std::string draw_image_page(SkColor color) {
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(16, 16);  // Premul, so not known to be opaque.
+    bitmap.eraseColor(color);
+    SkPDF::Metadata metadata;
+    metadata.fCompressionLevel = SkPDF::Metadata::CompressionLevel::None;
+    SkDynamicMemoryWStream stream;
+    auto doc = SkPDF::MakeDocument(&stream, metadata);
+    doc->beginPage(612, 792)->drawBitmap(bitmap, 36, 36);
+    doc->endPage();
+    doc->close();
+    sk_sp<SkData> data = stream.detachAsData();
+    return std::string((const char*)data->data(), data->size());
+}
+
+// Images that may not be opaque get a soft mask. If their pixels turn out to be opaque, it's a
+// single opaque pixel rather than an empty object.
+DEF_TEST(SkPDF_image_smask, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_image_smask, r);
+    std::string opaque = draw_image_page(0xFF336699),
+                translucent = draw_image_page(0x80336699);
+    REPORTER_ASSERT(r, opaque.find("/SMask") != std::string::npos);
+    REPORTER_ASSERT(r, opaque.find("/Width 1\n/Height 1\n") != std::string::npos);
+    REPORTER_ASSERT(r, opaque.find("obj\n<<>>") == std::string::npos);
+    REPORTER_ASSERT(r, translucent.find("/SMask") != std::string::npos);
+    REPORTER_ASSERT(r, translucent.find("/Width 1\n/Height 1\n") == std::string::npos);
+}
+
+static size_t peak_retained_bytes(SkWStream* dst, int pageCount, bool streaming) {
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(16, 16);
+    bitmap.eraseColor(0xFF336699);
+    SkFont font(sk_tool_utils::create_portable_typeface(), 12);
+    size_t peakRetainedBytes = 0;
+    SkPDF::Metadata metadata;
+    metadata.fStreaming = streaming;
+    metadata.fPeakRetainedBytes = &peakRetainedBytes;
+    auto doc = SkPDF::MakeDocument(dst, metadata);
+    for (int i = 0; i < pageCount; ++i) {
+        SkCanvas* canvas = doc->beginPage(612, 792);
+        canvas->drawBitmap(bitmap, 36, 36);
+        canvas->drawString(SkStringPrintf("Page %d", i), 72, 144, font, SkPaint());
+        doc->endPage();
+    }
+    doc->close();
+    return peakRetainedBytes;
+}
+
+DEF_TEST(SkPDF_streaming, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_streaming, r);
+    SkNullWStream nullStream;
+    // Without streaming, every page waits for the document to close.
+    size_t retained = peak_retained_bytes(&nullStream, 100, false);
+    REPORTER_ASSERT(r, peak_retained_bytes(&nullStream, 10, false) < retained);
+
+    // With streaming, memory use doesn't depend on the page count, and is less.
+    size_t streamingRetained = peak_retained_bytes(&nullStream, 100, true);
+    REPORTER_ASSERT(r, peak_retained_bytes(&nullStream, 10, true) == streamingRetained);
+    REPORTER_ASSERT(r, streamingRetained < retained);
+
+    SkDynamicMemoryWStream stream;
+    peak_retained_bytes(&stream, 100, true);
+    sk_sp<SkData> data = stream.detachAsData();
+    std::string pdf((const char*)data->data(), data->size());
+    REPORTER_ASSERT(r, pdf.find("/Type /Pages\n/Count 100\n") != std::string::npos);
+    REPORTER_ASSERT(r, pdf.compare(pdf.size() - 5, 5, "%%EOF") == 0);
+}
+
+static std::string draw_busy_page(SkPDF::Metadata::CompressionLevel level) {
+    SkPDF::Metadata metadata;
+    metadata.fCompressionLevel = level;
+    SkDynamicMemoryWStream stream;
+    auto doc = SkPDF::MakeDocument(&stream, metadata);
+    SkCanvas* canvas = doc->beginPage(612, 792);
+    SkPaint paint;
+    for (int i = 0; i < 1000; ++i) {
+        paint.setColor(0xFF000000 | (i * 0x010203));
+        canvas->drawRect(SkRect::MakeXYWH(i % 600, i % 780, 12, 12), paint);
+    }
+    doc->endPage();
+    doc->close();
+    sk_sp<SkData> data = stream.detachAsData();
+    return std::string((const char*)data->data(), data->size());
+}
+
+DEF_TEST(SkPDF_compression_level, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_compression_level, r);
+    using Level = SkPDF::Metadata::CompressionLevel;
+    std::string none = draw_busy_page(Level::None),
+                fast = draw_busy_page(Level::LowButFast),
+                best = draw_busy_page(Level::HighButSlow);
+    REPORTER_ASSERT(r, none.find("/FlateDecode") == std::string::npos);
+    REPORTER_ASSERT(r, fast.find("/FlateDecode") != std::string::npos);
+    REPORTER_ASSERT(r, fast.size() < none.size());
+    REPORTER_ASSERT(r, best.size() <= fast.size());
+}
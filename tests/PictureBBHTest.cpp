@@ -36,6 +36,10 @@ public:
         // With an R-Tree
         SkRTreeFactory RTreeFactory;
         this->run(&RTreeFactory, reporter);
+
+        // With a packed R-Tree
+        SkPackedRTreeFactory packedRTreeFactory;
+        this->run(&packedRTreeFactory, reporter);
     }
 
 private:
@@ -879,3 +879,183 @@ DEF_TEST(Picture_empty_serial, reporter) {
     REPORTER_ASSERT(reporter, pic2);
 }
 
+
+static sk_sp<SkPicture> make_in_place_test_picture() {
+    SkPictureRecorder recorder;
+
+    SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(64, 64));
+    canvas->drawRect(SkRect::MakeXYWH(4, 4, 20, 20), SkPaint());
+    SkPaint paint;
+    paint.setColor(SK_ColorBLUE);
+    paint.setAntiAlias(true);
+    canvas->drawCircle(40, 40, 16, paint);
+    sk_sp<SkPicture> child = recorder.finishRecordingAsPicture();
+
+    canvas = recorder.beginRecording(SkRect::MakeWH(64, 64));
+    canvas->clear(SK_ColorWHITE);
+    SkPath path;
+    path.moveTo(2, 60);
+    path.lineTo(32, 2);
+    path.quadTo(60, 30, 62, 62);
+    paint.setColor(SK_ColorRED);
+    canvas->save();
+        canvas->clipPath(path, true);
+        canvas->drawPicture(child);
+    canvas->restore();
+    paint.setStyle(SkPaint::kStroke_Style);
+    paint.setStrokeWidth(3);
+    canvas->drawPath(path, paint);
+    canvas->translate(10, 10);
+    canvas->drawPicture(child);
+    return recorder.finishRecordingAsPicture();
+}
+
+static SkBitmap draw_in_place_test_picture(const SkPicture* picture) {
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(64, 64);
+    bitmap.eraseColor(SK_ColorWHITE);
+    SkCanvas canvas(bitmap);
+    canvas.drawPicture(picture);
+    return bitmap;
+}
+
+static bool same_pixels(const SkBitmap& a, const SkBitmap& b) {
+    return a.computeByteSize() == b.computeByteSize() &&
+           0 == memcmp(a.getPixels(), b.getPixels(), a.computeByteSize());
+}
+
+DEF_TEST(Picture_InPlace, r) {
+    sk_sp<SkPicture> picture = make_in_place_test_picture();
+    sk_sp<SkData> data = picture->serialize();
+    SkBitmap expected = draw_in_place_test_picture(picture.get());
+
+    sk_sp<SkPicture> inPlace = SkPicture::MakeFromDataInPlace(data);
+    REPORTER_ASSERT(r, inPlace);
+    REPORTER_ASSERT(r, inPlace->cullRect() == picture->cullRect());
+    // SkPictureRecord wraps the ops it serializes in a save and a restore.
+    REPORTER_ASSERT(r, inPlace->approximateOpCount() == picture->approximateOpCount() + 2);
+    REPORTER_ASSERT(r, same_pixels(expected, draw_in_place_test_picture(inPlace.get())));
+    // The second draw doesn't parse anything.
+    REPORTER_ASSERT(r, same_pixels(expected, draw_in_place_test_picture(inPlace.get())));
+
+    // The picture holds on to its data.
+    sk_sp<SkPicture> fromOwnCopy = SkPicture::MakeFromDataInPlace(
+            SkData::MakeWithCopy(data->data(), data->size()));
+    REPORTER_ASSERT(r, same_pixels(expected, draw_in_place_test_picture(fromOwnCopy.get())));
+
+    // Misaligned data is copied where it needs to be.
+    SkAutoTMalloc<uint8_t> storage(data->size() + 1);
+    memcpy(storage.get() + 1, data->data(), data->size());
+    sk_sp<SkPicture> misaligned = SkPicture::MakeFromDataInPlace(
+            SkData::MakeWithoutCopy(storage.get() + 1, data->size()));
+    REPORTER_ASSERT(r, misaligned);
+    REPORTER_ASSERT(r, same_pixels(expected, draw_in_place_test_picture(misaligned.get())));
+
+    // It serializes as any other picture does.
+    sk_sp<SkPicture> roundTrip = SkPicture::MakeFromData(inPlace->serialize().get());
+    REPORTER_ASSERT(r, roundTrip);
+    REPORTER_ASSERT(r, same_pixels(expected, draw_in_place_test_picture(roundTrip.get())));
+
+    REPORTER_ASSERT(r, !SkPicture::MakeFromDataInPlace(nullptr));
+    REPORTER_ASSERT(r, !SkPicture::MakeFromDataInPlace(SkData::MakeSubset(data.get(), 0, 40)));
+}
+
+DEF_TEST(Picture_InPlaceOpIndex, r) {
+    SkRTreeFactory factory;
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(256, 256), &factory);
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(8, 8);
+    bitmap.eraseColor(SK_ColorBLUE);
+    bitmap.erase(SK_ColorRED, SkIRect::MakeWH(4, 4));
+    sk_sp<SkImage> image = SkImage::MakeFromBitmap(bitmap);
+    SkRandom rand;
+    for (int i = 0; i < 200; i++) {
+        SkPaint paint;
+        paint.setColor(rand.nextU() | 0xFF000000);
+        const SkRect rect = SkRect::MakeXYWH(rand.nextRangeScalar(0, 240),
+                                             rand.nextRangeScalar(0, 240),
+                                             rand.nextRangeScalar(1, 16),
+                                             rand.nextRangeScalar(1, 16));
+        if (i % 10 == 0) {
+            canvas->save();
+            canvas->clipRect(rect.makeOutset(4, 4));
+            canvas->translate(2, 2);
+            canvas->drawOval(rect, paint);
+            canvas->restore();
+        } else if (i % 10 == 5) {
+            SkPath path;
+            path.moveTo(rect.fLeft, rect.fBottom);
+            path.lineTo(rect.centerX(), rect.fTop);
+            path.lineTo(rect.fRight, rect.fBottom);
+            canvas->drawPath(path, paint);
+        } else if (i % 10 == 7) {
+            canvas->drawImage(image, rect.fLeft, rect.fTop);
+        } else {
+            canvas->drawRect(rect, paint);
+        }
+    }
+    // A clipped block that starts exactly on the first tile's right edge. The tile's query is
+    // outset, so the block's ops are indexed, but its clip is empty and skips past them.
+    {
+        SkPaint paint;
+        canvas->save();
+        canvas->clipRect(SkRect::MakeXYWH(64, 0, 32, 32));
+        canvas->drawOval(SkRect::MakeXYWH(60, 4, 20, 20), paint);
+        canvas->drawRect(SkRect::MakeXYWH(62, 8, 10, 10), paint);
+        canvas->restore();
+        paint.setColor(SK_ColorGREEN);
+        canvas->drawRect(SkRect::MakeXYWH(40, 20, 8, 8), paint);
+        canvas->drawRect(SkRect::MakeXYWH(56, 2, 8, 8), paint);
+    }
+    sk_sp<SkPicture> picture = recorder.finishRecordingAsPicture();
+    sk_sp<SkData> data = picture->serialize();
+
+    sk_sp<SkPicture> inPlace = SkPicture::MakeFromDataInPlace(data);
+    REPORTER_ASSERT(r, inPlace);
+
+    // Tiles draw the same as they do from the original picture, with fewer ops.
+    const SkRect tiles[] = {
+        SkRect::MakeXYWH(  0,   0,  64,  64),
+        SkRect::MakeXYWH(100,  30,  50,  90),
+        SkRect::MakeXYWH(192, 192,  64,  64),
+        SkRect::MakeXYWH(-10, -10, 300, 300),
+    };
+    for (const SkRect& tile : tiles) {
+        SkBitmap expected, actual;
+        expected.allocN32Pixels(256, 256);
+        actual.allocN32Pixels(256, 256);
+        expected.eraseColor(SK_ColorWHITE);
+        actual.eraseColor(SK_ColorWHITE);
+        {
+            SkCanvas expectedCanvas(expected), actualCanvas(actual);
+            expectedCanvas.clipRect(tile);
+            actualCanvas.clipRect(tile);
+            picture->playback(&expectedCanvas);
+            inPlace->playback(&actualCanvas);
+        }
+        REPORTER_ASSERT(r, same_pixels(expected, actual));
+        if (tile.contains(SkRect::MakeXYWH(40, 20, 8, 8))) {
+            // The draws after the clipped-out block still happen.
+            REPORTER_ASSERT(r, SK_ColorGREEN == actual.getColor(44, 24));
+            REPORTER_ASSERT(r, SK_ColorGREEN == actual.getColor(60, 6));
+        }
+
+        SkPictureRecorder tileRecorder;
+        SkCanvas* tileCanvas = tileRecorder.beginRecording(SkRect::MakeWH(256, 256));
+        tileCanvas->clipRect(tile);
+        inPlace->playback(tileCanvas);
+        const int tileOps = tileRecorder.finishRecordingAsPicture()->approximateOpCount();
+        if (tile.contains(inPlace->cullRect())) {
+            REPORTER_ASSERT(r, tileOps > inPlace->approximateOpCount());
+        } else {
+            REPORTER_ASSERT(r, tileOps < inPlace->approximateOpCount() / 2);
+        }
+    }
+
+    // Pictures loaded the usual way ignore the index.
+    sk_sp<SkPicture> copy = SkPicture::MakeFromData(data.get());
+    REPORTER_ASSERT(r, copy);
+    REPORTER_ASSERT(r, same_pixels(draw_in_place_test_picture(picture.get()),
+                                   draw_in_place_test_picture(copy.get())));
+}
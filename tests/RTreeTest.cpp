@@ -5,6 +5,8 @@
  * found in the LICENSE file.
  */
 
+#include "SkExecutor.h"
+#include "SkPackedRTree.h"
 #include "SkRTree.h"
 #include "SkRandom.h"
 #include "Test.h"
@@ -44,7 +46,7 @@ static bool verify_query(SkRect query, SkRect rects[], SkTDArray<int>& found) {
 }
 
 static void run_queries(skiatest::Reporter* reporter, SkRandom& rand, SkRect rects[],
-                        const SkRTree& tree) {
+                        const SkBBoxHierarchy& tree) {
     for (size_t i = 0; i < NUM_QUERIES; ++i) {
         SkTDArray<int> hits;
         SkRect query = random_rect(rand);
@@ -89,3 +91,80 @@ DEF_TEST(RTree, reporter) {
                                   expectedDepthMax >= rtree.getDepth());
     }
 }
+
+// Building the levels of a large tree in parallel must give the same tree as building it serially.
+DEF_TEST(RTree_Parallel, reporter) {
+    static const int kNumRects = 50000;
+    SkRandom rand;
+    SkAutoTMalloc<SkRect> rects(kNumRects);
+    for (int i = 0; i < kNumRects; i++) {
+        rects[i] = random_rect(rand);
+    }
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    SkRTree serial, parallel(1, executor.get());
+    serial.insert(rects.get(), kNumRects);
+    parallel.insert(rects.get(), kNumRects);
+
+    REPORTER_ASSERT(reporter, serial.getCount() == parallel.getCount());
+    REPORTER_ASSERT(reporter, serial.getDepth() == parallel.getDepth());
+    REPORTER_ASSERT(reporter, serial.getRootBound() == parallel.getRootBound());
+    REPORTER_ASSERT(reporter, serial.bytesUsed() == parallel.bytesUsed());
+    for (size_t i = 0; i < NUM_QUERIES; ++i) {
+        SkRect query = random_rect(rand);
+        SkTDArray<int> expected, found;
+        serial.search(query, &expected);
+        parallel.search(query, &found);
+        REPORTER_ASSERT(reporter, expected == found);
+    }
+}
+
+DEF_TEST(PackedRTree, reporter) {
+    SkRandom rand;
+    SkAutoTMalloc<SkRect> rects(NUM_RECTS);
+    for (size_t i = 0; i < NUM_ITERATIONS; ++i) {
+        SkPackedRTree tree;
+        REPORTER_ASSERT(reporter, 0 == tree.getCount());
+
+        for (int j = 0; j < NUM_RECTS; j++) {
+            rects[j] = random_rect(rand);
+        }
+
+        SkRTree rtree;
+        tree.insert(rects.get(), NUM_RECTS);
+        rtree.insert(rects.get(), NUM_RECTS);
+
+        run_queries(reporter, rand, rects, tree);
+        REPORTER_ASSERT(reporter, NUM_RECTS == tree.getCount());
+        REPORTER_ASSERT(reporter, rtree.getRootBound() == tree.getRootBound());
+
+        // 200 rects make 25 leaves, 4 nodes above them, then the root.
+        REPORTER_ASSERT(reporter, 3 == tree.getDepth());
+
+        // Both trees must find the same ops, in the same order.
+        for (size_t q = 0; q < NUM_QUERIES; ++q) {
+            SkRect query = random_rect(rand);
+            SkTDArray<int> expected, found;
+            rtree.search(query, &expected);
+            tree.search(query, &found);
+            REPORTER_ASSERT(reporter, expected == found);
+        }
+    }
+
+    // Empty rects are never found, and a tree of only empty rects has nothing in it.
+    SkRect mixed[] = { {0,0,10,10}, {5,5,5,5}, {5,5,15,15} };
+    SkPackedRTree tree;
+    tree.insert(mixed, SK_ARRAY_COUNT(mixed));
+    SkTDArray<int> hits;
+    tree.search({0,0,20,20}, &hits);
+    REPORTER_ASSERT(reporter, 2 == hits.count() && 0 == hits[0] && 2 == hits[1]);
+    REPORTER_ASSERT(reporter, tree.getRootBound() == SkRect::MakeWH(15, 15));
+
+    SkRect empty[] = { {5,5,5,5} };
+    SkPackedRTree emptyTree;
+    emptyTree.insert(empty, SK_ARRAY_COUNT(empty));
+    hits.reset();
+    emptyTree.search({0,0,20,20}, &hits);
+    REPORTER_ASSERT(reporter, 0 == hits.count() && 0 == emptyTree.getCount());
+    REPORTER_ASSERT(reporter, emptyTree.getRootBound().isEmpty());
+}
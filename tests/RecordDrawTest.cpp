@@ -10,7 +10,9 @@
 
 #include "SkDebugCanvas.h"
 #include "SkDropShadowImageFilter.h"
+#include "SkExecutor.h"
 #include "SkImagePriv.h"
+#include "SkRandom.h"
 #include "SkRecord.h"
 #include "SkRecordDraw.h"
 #include "SkRecordOpts.h"
@@ -210,6 +212,54 @@ DEF_TEST(RecordDraw_SaveLayerAffectsClipBounds, r) {
     REPORTER_ASSERT(r, sloppy_rect_eq(bounds[3], SkRect::MakeLTRB(0, 0, 50, 50)));
 }
 
+// Bounding a large record in parallel chunks must give exactly the same bounds as one pass,
+// even for Save blocks, matrices, and SaveLayer paints that span the chunks.
+DEF_TEST(RecordDraw_ParallelBounds, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, 1000, 1000);
+
+    SkPaint shadow;
+    shadow.setImageFilter(SkDropShadowImageFilter::Make(
+                                 20, 0, 0, 0, SK_ColorBLACK,
+                                 SkDropShadowImageFilter::kDrawShadowAndForeground_ShadowMode,
+                                 nullptr));
+    SkPaint stroke;
+    stroke.setStyle(SkPaint::kStroke_Style);
+    stroke.setStrokeWidth(3);
+
+    SkRandom rand;
+    for (int i = 0; i < 20000; i++) {
+        switch (rand.nextULessThan(8)) {
+            case 0: recorder.save(); break;
+            case 1: recorder.saveLayer(nullptr, rand.nextBool() ? &shadow : nullptr); break;
+            case 2: recorder.restore(); break;
+            case 3: recorder.translate(rand.nextRangeF(-5, 5), rand.nextRangeF(-5, 5)); break;
+            case 4: recorder.clipRect(SkRect::MakeXYWH(rand.nextRangeF(0, 900),
+                                                       rand.nextRangeF(0, 900), 200, 200));
+                    break;
+            default:
+                recorder.drawRect(SkRect::MakeXYWH(rand.nextRangeF(0, 900),
+                                                   rand.nextRangeF(0, 900), 50, 50),
+                                  rand.nextBool() ? stroke : SkPaint());
+                break;
+        }
+    }
+    // Leave some Saves unbalanced.
+    recorder.save();
+    recorder.drawRect(SkRect::MakeWH(10, 10), SkPaint());
+
+    const SkRect cull = SkRect::MakeWH(1000, 1000);
+    SkAutoTMalloc<SkRect> expected(record.count()),
+                          actual(record.count());
+    SkRecordFillBounds(cull, record, expected);
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    SkRecordFillBounds(cull, record, actual, executor.get());
+    for (int i = 0; i < record.count(); i++) {
+        REPORTER_ASSERT(r, expected[i] == actual[i]);
+    }
+}
+
 // TODO This would be nice, but we can't get it right today.
 #if 0
 // When a saveLayer provides an explicit bound and has a complex paint (e.g., one that
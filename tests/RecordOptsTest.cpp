@@ -11,6 +11,7 @@
 #include "SkBlurImageFilter.h"
 #include "SkColorFilter.h"
 #include "SkRecord.h"
+#include "SkRecordDraw.h"
 #include "SkRecordOpts.h"
 #include "SkRecorder.h"
 #include "SkRecords.h"
@@ -427,3 +428,243 @@ DEF_TEST(savelayer_srcmode_alpha, r) {
     do_savelayer_srcmode(r, 0x80FF0000);
 }
 
+
+DEF_TEST(RecordOpts_NoopCulledDraws, r) {
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    recorder.drawRect(SkRect::MakeXYWH(10, 10, 100, 100), SkPaint());      // inside
+    recorder.drawRect(SkRect::MakeXYWH(W + 10, 10, 100, 100), SkPaint());  // to the right
+    recorder.save();
+        recorder.translate(-500, 0);
+        recorder.drawRect(SkRect::MakeXYWH(10, 10, 100, 100), SkPaint());  // moved off the left
+        recorder.drawRect(SkRect::MakeXYWH(450, 10, 100, 100), SkPaint()); // straddles the edge
+    recorder.restore();
+
+    SkRecordNoopCulledDraws(&record, SkRect::MakeWH(W, H));
+    assert_type<SkRecords::DrawRect>(r, record, 0);
+    assert_type<SkRecords::NoOp>    (r, record, 1);
+    assert_type<SkRecords::Save>    (r, record, 2);
+    assert_type<SkRecords::NoOp>    (r, record, 4);
+    assert_type<SkRecords::DrawRect>(r, record, 5);
+    assert_type<SkRecords::Restore> (r, record, 6);
+}
+
+DEF_TEST(RecordOpts_NoopOccludedDraws, r) {
+    SkPaint translucent;
+    translucent.setColor(0x80FF0000);
+    const SkRect rect = SkRect::MakeWH(200, 200);
+
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    recorder.drawRect(rect, SkPaint());                 // 0, outside the clip of 4
+    recorder.save();
+        recorder.clipRect(rect);
+        recorder.drawOval(rect, SkPaint());             // 3, covered by 4
+        recorder.drawPaint(SkPaint());                  // 4
+    recorder.restore();
+    recorder.drawPaint(translucent);                    // 6, doesn't cover 0
+    recorder.saveLayer(nullptr, nullptr);
+        recorder.drawRect(rect, SkPaint());             // 8, in a different layer from 10
+    recorder.restore();
+    recorder.drawPaint(SkPaint());                      // 10, can't see past the layer
+
+    SkRecordNoopOccludedDraws(&record);
+    assert_type<SkRecords::DrawRect> (r, record, 0);
+    assert_type<SkRecords::NoOp>     (r, record, 3);
+    assert_type<SkRecords::DrawPaint>(r, record, 4);
+    assert_type<SkRecords::DrawPaint>(r, record, 6);
+    assert_type<SkRecords::DrawRect> (r, record, 8);
+    assert_type<SkRecords::DrawPaint>(r, record, 10);
+
+    // A clear covers everything before it, but a DrawPaint in an anti-aliased clip covers nothing.
+    SkRecord cleared;
+    SkRecorder clearedRecorder(&cleared, W, H);
+    clearedRecorder.drawRect(rect, translucent);
+    clearedRecorder.save();
+        clearedRecorder.clipRect(rect, true);
+        clearedRecorder.drawOval(rect, SkPaint());
+        clearedRecorder.drawPaint(SkPaint());
+    clearedRecorder.restore();
+    SkRecordNoopOccludedDraws(&cleared);
+    assert_type<SkRecords::DrawOval>(r, cleared, 3);
+
+    clearedRecorder.clear(SK_ColorTRANSPARENT);
+    SkRecordNoopOccludedDraws(&cleared);
+    for (int i : {0, 3, 4}) {
+        assert_type<SkRecords::NoOp>(r, cleared, i);
+    }
+    assert_type<SkRecords::DrawPaint>(r, cleared, 6);
+
+    // An opaque, aliased DrawRect covers the draws whose bounds it contains, under a translate.
+    SkPaint aa, stroke;
+    aa.setAntiAlias(true);
+    stroke.setStyle(SkPaint::kStroke_Style);
+    SkRecord rects;
+    SkRecorder rectsRecorder(&rects, W, H);
+    rectsRecorder.drawOval(SkRect::MakeXYWH(20, 20, 50, 50), SkPaint());     // 0, covered by 3
+    rectsRecorder.drawOval(SkRect::MakeXYWH(20, 20, 100, 50), SkPaint());    // 1, spills out of 3
+    rectsRecorder.translate(10.5f, 10);
+    rectsRecorder.drawRect(SkRect::MakeWH(100, 100), SkPaint());             // 3
+    rectsRecorder.drawOval(SkRect::MakeXYWH(10, 10, 50, 50), SkPaint());     // 4, under 5-9
+    rectsRecorder.drawRect(SkRect::MakeWH(100, 100), aa);                    // 5, anti-aliased
+    rectsRecorder.drawRect(SkRect::MakeWH(100, 100), stroke);                // 6, a stroke
+    rectsRecorder.save();
+        rectsRecorder.scale(2, 2);
+        rectsRecorder.drawRect(SkRect::MakeWH(100, 100), SkPaint());         // 9, scaled
+    rectsRecorder.restore();
+    SkRecordNoopOccludedDraws(&rects);
+    assert_type<SkRecords::NoOp>    (r, rects, 0);
+    assert_type<SkRecords::DrawOval>(r, rects, 1);
+    for (int i : {3, 5, 6, 9}) {
+        assert_type<SkRecords::DrawRect>(r, rects, i);
+    }
+    assert_type<SkRecords::DrawOval>(r, rects, 4);
+
+    rectsRecorder.drawRect(SkRect::MakeWH(100, 100), SkPaint());             // 11
+    SkRecordNoopOccludedDraws(&rects);
+    assert_type<SkRecords::DrawOval>(r, rects, 1);
+    assert_type<SkRecords::NoOp>    (r, rects, 4);
+    for (int i : {3, 5, 6, 9, 11}) {
+        assert_type<SkRecords::DrawRect>(r, rects, i);
+    }
+}
+
+DEF_TEST(RecordOpts_NoopRedundantClips, r) {
+    const SkRect rect = SkRect::MakeWH(200, 200);
+
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    recorder.save();
+        recorder.clipRect(rect);
+        recorder.drawRect(rect, SkPaint());
+    recorder.restore();
+    recorder.save();
+        recorder.clipRect(rect);                        // 5, joined with the block above
+        recorder.drawOval(rect, SkPaint());
+        recorder.clipRect(rect);                        // 7, repeats 5
+        recorder.clipRect(rect, true);                  // 8, anti-aliased
+        recorder.clipRect(rect, true);                  // 9, anti-aliased
+        recorder.translate(10, 10);
+        recorder.clipRect(rect);                        // 11, under a different matrix
+        recorder.drawOval(rect, SkPaint());
+    recorder.restore();
+
+    SkRecordNoopRedundantClips(&record);
+    assert_type<SkRecords::Save>    (r, record, 0);
+    assert_type<SkRecords::ClipRect>(r, record, 1);
+    assert_type<SkRecords::DrawRect>(r, record, 2);
+    for (int i : {3, 4, 5, 7}) {
+        assert_type<SkRecords::NoOp>(r, record, i);
+    }
+    assert_type<SkRecords::DrawOval>(r, record, 6);
+    assert_type<SkRecords::ClipRect>(r, record, 8);
+    assert_type<SkRecords::ClipRect>(r, record, 9);
+    assert_type<SkRecords::ClipRect>(r, record, 11);
+    assert_type<SkRecords::Restore> (r, record, 13);
+}
+
+static sk_sp<SkImage> make_merge_test_image(SkColor color) {
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(10, 10);
+    bitmap.eraseColor(color);
+    return SkImage::MakeFromBitmap(bitmap);
+}
+
+DEF_TEST(RecordOpts_MergeDraws, r) {
+    SkPaint red, blue, aa;
+    red.setColor(SK_ColorRED);
+    blue.setColor(SK_ColorBLUE);
+    aa.setAntiAlias(true);
+    SkPaint translucent;
+    translucent.setAlpha(0x80);
+    sk_sp<SkImage> image1 = make_merge_test_image(SK_ColorGREEN),
+                   image2 = make_merge_test_image(SK_ColorYELLOW);
+
+    SkRecord record;
+    SkRecorder recorder(&record, W, H);
+
+    recorder.drawRect(SkRect::MakeXYWH( 0, 0, 10, 10), red);   // 0, merges with 1 and 2
+    recorder.drawRect(SkRect::MakeXYWH(20, 0, 10, 10), red);
+    recorder.drawRect(SkRect::MakeXYWH(40, 0, 10, 10), red);
+    recorder.drawRect(SkRect::MakeXYWH(45, 0, 10, 10), red);   // 3, overlaps 2
+    recorder.drawRect(SkRect::MakeXYWH(60, 0, 10, 10), blue);  // 4, another paint
+    recorder.drawRect(SkRect::MakeXYWH(80, 0, 10.5f, 10), blue); // 5, not whole pixels
+    recorder.drawRect(SkRect::MakeXYWH(0, 20, 10, 10), aa);    // 6, anti-aliased
+    recorder.drawImage(image1, 0, 40);                          // 7, merges with 8 and 9
+    recorder.drawImage(image2, 20, 40, &translucent);
+    recorder.drawImageRect(image1, SkRect::MakeXYWH(40, 40, 20, 20), nullptr);
+    recorder.drawImageRect(image2, SkRect::MakeWH(5, 5), SkRect::MakeXYWH(0, 60, 10, 10),
+                           nullptr, SkCanvas::kStrict_SrcRectConstraint);  // 10, strict
+
+    SkRecordMergeDraws(&record);
+    const SkRecords::DrawRegion* region = assert_type<SkRecords::DrawRegion>(r, record, 0);
+    if (region) {
+        REPORTER_ASSERT(r, region->paint == red);
+        REPORTER_ASSERT(r, region->region.computeRegionComplexity() == 3);
+    }
+    assert_type<SkRecords::NoOp>    (r, record, 1);
+    assert_type<SkRecords::NoOp>    (r, record, 2);
+    assert_type<SkRecords::DrawRect>(r, record, 3);
+    assert_type<SkRecords::DrawRect>(r, record, 4);
+    assert_type<SkRecords::DrawRect>(r, record, 5);
+    assert_type<SkRecords::DrawRect>(r, record, 6);
+    const SkRecords::DrawImageSet* set = assert_type<SkRecords::DrawImageSet>(r, record, 7);
+    if (set) {
+        REPORTER_ASSERT(r, set->count == 3);
+        REPORTER_ASSERT(r, set->set[1].fAlpha == 0x80 / 255.0f);
+        REPORTER_ASSERT(r, set->set[2].fDstRect == SkRect::MakeXYWH(40, 40, 20, 20));
+    }
+    assert_type<SkRecords::NoOp>         (r, record, 8);
+    assert_type<SkRecords::NoOp>         (r, record, 9);
+    assert_type<SkRecords::DrawImageRect>(r, record, 10);
+}
+
+// Draws a bit of everything SkRecordOptimize2() looks for.
+static void draw_optimize2_test(SkCanvas* canvas) {
+    SkPaint red, translucent;
+    red.setColor(SK_ColorRED);
+    translucent.setColor(0x800000FF);
+
+    canvas->drawRect(SkRect::MakeWH(50, 50), translucent);      // occluded
+    canvas->clear(SK_ColorWHITE);
+    canvas->drawRect(SkRect::MakeXYWH(200, 0, 50, 50), red);    // culled
+    for (int i = 0; i < 4; i++) {
+        canvas->save();
+        canvas->clipRect(SkRect::MakeWH(60, 60));               // joined
+        canvas->drawRect(SkRect::MakeXYWH(i * 15, 5, 10, 10), translucent);  // merged
+        canvas->restore();
+    }
+    canvas->drawImage(make_merge_test_image(SK_ColorGREEN), 10, 30);
+    canvas->drawImage(make_merge_test_image(SK_ColorBLUE), 30, 40, &translucent);
+}
+
+DEF_TEST(RecordOpts_Optimize2Stats, r) {
+    const SkRect cull = SkRect::MakeWH(100, 100);
+    SkRecord record, original;
+    SkRecorder recorder(&record, cull), originalRecorder(&original, cull);
+    draw_optimize2_test(&recorder);
+    draw_optimize2_test(&originalRecorder);
+
+    SkRecordOptimizeStats stats;
+    SkRecordOptimize2(&record, cull, &stats);
+    REPORTER_ASSERT(r, stats.fCulledDraws == 1);
+    REPORTER_ASSERT(r, stats.fOccludedDraws == 1);
+    REPORTER_ASSERT(r, stats.fRedundantClips == 9);
+    REPORTER_ASSERT(r, stats.fMergedDraws == 4);
+    REPORTER_ASSERT(r, stats.total() == original.count() - record.count());
+
+    // The optimized record draws just what the original does.
+    SkBitmap expected, actual;
+    expected.allocN32Pixels(100, 100);
+    actual.allocN32Pixels(100, 100);
+    {
+        SkCanvas expectedCanvas(expected), actualCanvas(actual);
+        SkRecordDraw(original, &expectedCanvas, nullptr, nullptr, 0, nullptr, nullptr);
+        SkRecordDraw(record, &actualCanvas, nullptr, nullptr, 0, nullptr, nullptr);
+    }
+    REPORTER_ASSERT(r, 0 == memcmp(expected.getPixels(), actual.getPixels(),
+                                   expected.computeByteSize()));
+}
@@ -202,3 +202,88 @@ DEF_TEST(SkRasterPipeline_lowp_clamp01, r) {
     p.append(SkRasterPipeline::store_8888, &ptr);
     p.run(0,0,1,1);
 }
+
+DEF_TEST(SkRasterPipeline_fused, r) {
+    // Fused stages should be drawing exactly what their runs of stages would,
+    // in both lowp and highp, at full stride and in the tail.
+    const int W = 37, H = 3;
+    uint32_t src[W*H], mask_and_pad[W*H];
+    for (int i = 0; i < W*H; i++) {
+        src[i] = 0x80000000 | (i * 0x00010203 & 0x00ffffff);
+        mask_and_pad[i] = (i * 37) & 0xff;
+        mask_and_pad[i] |= mask_and_pad[i] << 8 | mask_and_pad[i] << 16 | mask_and_pad[i] << 24;
+    }
+    const float matrix[] = { 0.75f, 0.25f, 0.25f, 0.75f, 0.5f, 0.5f };
+
+    SkRasterPipeline_MemoryCtx src_ctx  = { src,          W },
+                               mask_ctx = { mask_and_pad, W };
+    SkRasterPipeline_GatherCtx gather_ctx = { src, W, W, H };
+
+    // A callback that changes nothing, just to knock the pipeline out of lowp.
+    SkRasterPipeline_CallbackCtx highp_only;
+    highp_only.fn = [](SkRasterPipeline_CallbackCtx*, int) {};
+
+    enum Shader { kLoad, kGather, kBilerp };
+    enum Coverage { kNone, kScaleU8, kScaleFloat };
+    const float half = 0.5f;
+
+    for (bool highp : {false, true})
+    for (Shader shader : {kLoad, kGather, kBilerp})
+    for (Coverage coverage : {kNone, kScaleU8, kScaleFloat}) {
+        uint32_t dst[2][W*H];
+        for (int fuse = 0; fuse < 2; fuse++) {
+            for (int i = 0; i < W*H; i++) {
+                dst[fuse][i] = 0xff204060;
+            }
+            SkRasterPipeline_MemoryCtx dst_ctx = { dst[fuse], W };
+
+            SkRasterPipeline_<256> p;
+            p.set_fusion_enabled(fuse);
+            switch (shader) {
+                case kLoad:   p.append(SkRasterPipeline::load_8888, &src_ctx); break;
+                case kGather: p.append(SkRasterPipeline::seed_shader);
+                              p.append(SkRasterPipeline::matrix_2x3, matrix);
+                              p.append(SkRasterPipeline::gather_8888, &gather_ctx); break;
+                case kBilerp: p.append(SkRasterPipeline::seed_shader);
+                              p.append(SkRasterPipeline::matrix_2x3, matrix);
+                              p.append(SkRasterPipeline::bilerp_clamp_8888, &gather_ctx); break;
+            }
+            if (highp) {
+                p.append(SkRasterPipeline::callback, &highp_only);
+            }
+            switch (coverage) {
+                case kNone:                                                              break;
+                case kScaleU8:    p.append(SkRasterPipeline::scale_u8,      &mask_ctx); break;
+                case kScaleFloat: p.append(SkRasterPipeline::scale_1_float, &half);     break;
+            }
+            p.append(SkRasterPipeline::load_8888_dst, &dst_ctx);
+            p.append(SkRasterPipeline::srcover);
+            p.append(SkRasterPipeline::store_8888, &dst_ctx);
+
+            const SkRasterPipeline::FusedStage blend = coverage == kScaleU8
+                                                     ? SkRasterPipeline::scale_u8_srcover_8888
+                                                     : coverage == kScaleFloat
+                                                     ? SkRasterPipeline::scale_1_float_srcover_8888
+                                                     : SkRasterPipeline::srcover_8888;
+            const SkRasterPipeline::FusedStage sample = shader == kBilerp
+                                                      ? SkRasterPipeline::bilerp_clamp_8888_2x3
+                                                      : SkRasterPipeline::gather_8888_2x3;
+            uint64_t blendHits  = SkRasterPipeline::FusedStageHits(blend),
+                     sampleHits = SkRasterPipeline::FusedStageHits(sample);
+            p.run(0,0,W,H);
+            if (fuse) {
+                REPORTER_ASSERT(r, SkRasterPipeline::FusedStageHits(blend) > blendHits);
+                if (shader != kLoad) {
+                    REPORTER_ASSERT(r, SkRasterPipeline::FusedStageHits(sample) > sampleHits);
+                }
+            }
+        }
+        for (int i = 0; i < W*H; i++) {
+            if (dst[0][i] != dst[1][i]) {
+                ERRORF(r, "highp %d, shader %d, coverage %d, pixel %d: fused %08x, unfused %08x",
+                       highp, shader, coverage, i, dst[1][i], dst[0][i]);
+                break;
+            }
+        }
+    }
+}
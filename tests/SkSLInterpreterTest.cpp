@@ -0,0 +1,229 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkArenaAlloc.h"
+#include "SkRasterPipeline.h"
+#include "SkSLByteCode.h"
+#include "SkSLCompiler.h"
+#include "SkSLInterpreter.h"
+
+#include "Test.h"
+
+using Value = SkSL::Interpreter::Value;
+
+struct Case {
+    Value fX, fY, fExpected;
+};
+
+static std::unique_ptr<SkSL::ByteCode> compile(skiatest::Reporter* r, SkSL::Compiler* compiler,
+                                               const char* src) {
+    SkSL::Program::Settings settings;
+    std::unique_ptr<SkSL::Program> program = compiler->convertProgram(
+                                                                 SkSL::Program::kPipelineStage_Kind,
+                                                                 SkSL::String(src), settings);
+    REPORTER_ASSERT(r, program);
+    if (!program) {
+        ERRORF(r, "%s", compiler->errorText().c_str());
+        return nullptr;
+    }
+    std::unique_ptr<SkSL::ByteCode> byteCode = compiler->toByteCode(*program);
+    if (!byteCode) {
+        ERRORF(r, "%s", compiler->errorText().c_str());
+    }
+    return byteCode;
+}
+
+// Runs 'int test(int x, int y)' or 'float test(float x, float y)' on each case one at a time,
+// then on all of them at once, comparing results bit for bit.
+static void test(skiatest::Reporter* r, const char* src, std::initializer_list<Case> cases) {
+    SkSL::Compiler compiler;
+    std::unique_ptr<SkSL::ByteCode> byteCode = compile(r, &compiler, src);
+    if (!byteCode) {
+        return;
+    }
+    const SkSL::ByteCodeFunction* f = byteCode->getFunction("test");
+    REPORTER_ASSERT(r, f);
+    if (!f) {
+        return;
+    }
+
+    std::vector<Value> xs, ys, results(cases.size(), Value(0));
+    for (const Case& c : cases) {
+        Value args[] = { c.fX, c.fY };
+        Value result;
+        SkSL::Interpreter::Run(f, args, &result);
+        REPORTER_ASSERT(r, result.fInt == c.fExpected.fInt, "%s\n(%d, %d) returned %d, not %d",
+                        src, c.fX.fInt, c.fY.fInt, result.fInt, c.fExpected.fInt);
+        xs.push_back(c.fX);
+        ys.push_back(c.fY);
+    }
+
+    Value* args[] = { xs.data(), ys.data() };
+    SkSL::Interpreter::RunStriped(f, (int) cases.size(), args, results.data());
+    int i = 0;
+    for (const Case& c : cases) {
+        REPORTER_ASSERT(r, results[i].fInt == c.fExpected.fInt,
+                        "%s\nlane %d returned %d, not %d", src, i, results[i].fInt,
+                        c.fExpected.fInt);
+        ++i;
+    }
+}
+
+DEF_TEST(SkSLInterpreterArithmetic, r) {
+    test(r, "int test(int x, int y) { return x + y * 3 - 1; }",
+         { { 1, 2, 6 }, { -5, 7, 15 }, { 0, 0, -1 } });
+    test(r, "float test(float x, float y) { return x * y + x / y; }",
+         { { 4.0f, 2.0f, 10.0f }, { -1.0f, 0.5f, -2.5f }, { 0.0f, 8.0f, 0.0f } });
+    test(r, "int test(int x, int y) { x += y; x *= 2; x -= 1; return x; }",
+         { { 12, 5, 33 }, { 0, 0, -1 } });
+    test(r, "int test(int x, int y) { return x / y + x % y; }",
+         { { 17, 5, 5 }, { -17, 5, -5 }, { 9, 0, 0 }, { 9, -1, -9 } });
+    test(r, "int test(int x, int y) { return (x & y) | (x ^ y) << 4; }",
+         { { 45, 15, 13 | (34 << 4) }, { 0, -1, -16 } });
+    test(r, "int test(int x, int y) { return -x + int(float(y) * 1.5); }",
+         { { 3, 4, 3 }, { -3, -4, -3 } });
+    test(r, "float test(float x, float y) { return clamp(sqrt(abs(x)), 0, y); }",
+         { { -16.0f, 10.0f, 4.0f }, { 9.0f, 2.0f, 2.0f }, { 0.0f, 1.0f, 0.0f } });
+}
+
+DEF_TEST(SkSLInterpreterControlFlow, r) {
+    const std::initializer_list<Case> minMax = {
+        { 1, 2, 1 }, { 7, -3, -3 }, { 4, 4, 4 }, { -8, 0, -8 }, { 100, 99, 99 },
+        { 0, 1, 0 }, { 5, 6, 5 }, { 6, 5, 5 }, { 3, 30, 3 }, { 31, 2, 2 },
+    };
+    test(r, "int test(int x, int y) {"
+            "    int r = 0;"
+            "    if (x < y) { r = x; } else { r = y; }"
+            "    return r;"
+            "}",
+         minMax);
+    test(r, "int test(int x, int y) { return x > y ? y : x; }", minMax);
+
+    // The lanes of these loops run for different numbers of iterations.
+    test(r, "int test(int x, int y) {"
+            "    int sum = 0;"
+            "    for (int i = 0; i < x; i++) { sum += y; }"
+            "    return sum;"
+            "}",
+         { { 0, 5, 0 }, { 1, 5, 5 }, { 3, -2, -6 }, { 10, 10, 100 }, { 2, 7, 14 },
+           { 9, 1, 9 }, { 4, 4, 16 }, { 5, 0, 0 }, { 1, 1, 1 }, { 12, 3, 36 } });
+    test(r, "int test(int x, int y) {"
+            "    int n = 0;"
+            "    while (x >= y) { x -= y; ++n; }"
+            "    return n * 100 + x;"
+            "}",
+         { { 17, 5, 302 }, { 4, 5, 4 }, { 100, 7, 1402 }, { 5, 5, 100 }, { 0, 1, 0 } });
+    test(r, "int test(int x, int y) {"
+            "    int n = 0;"
+            "    do { x /= y; n++; } while (x > 0);"
+            "    return n;"
+            "}",
+         { { 1000, 10, 4 }, { 0, 10, 1 }, { 255, 2, 8 }, { 1, 3, 1 } });
+    test(r, "int test(int x, int y) {"
+            "    int n = 0;"
+            "    for (int i = 0; i < 10; i++) {"
+            "        if (i < x) { if (i >= y) { n += 1; } } else { n += 100; }"
+            "    }"
+            "    return n;"
+            "}",
+         { { 5, 2, 503 }, { 0, 0, 1000 }, { 10, 0, 10 }, { 3, 7, 700 } });
+}
+
+DEF_TEST(SkSLInterpreterSideEffects, r) {
+    // The right side of && and ||, and the unused side of ?:, must not run.
+    test(r, "int test(int x, int y) {"
+            "    int n = 0;"
+            "    bool a = x > 0 && (n += 1) > 0;"
+            "    bool b = y > 0 || (n += 10) > 0;"
+            "    return n;"
+            "}",
+         { { 1, 1, 1 }, { 0, 1, 0 }, { 1, 0, 11 }, { 0, 0, 10 } });
+    test(r, "int test(int x, int y) {"
+            "    int n = 0;"
+            "    int z = x > y ? n++ : (n += 5);"
+            "    return n * 10 + z;"
+            "}",
+         { { 2, 1, 10 }, { 1, 2, 55 } });
+    test(r, "int test(int x, int y) { int z = x++ + x; return z * 10 + x; }",
+         { { 3, 0, 74 } });
+}
+
+DEF_TEST(SkSLInterpreterUnsupported, r) {
+    SkSL::Compiler compiler;
+    SkSL::Program::Settings settings;
+    for (const char* src : {
+            "int test(int x) { while (true) { if (x > 3) { break; } x++; } return x; }",
+            "int f(int x) { return x; } int test(int x) { return f(x); }",
+            "int test(int x) { if (x > 0) { return 1; } return 0; }",
+            "float2 test(float2 x) { return x; }",
+    }) {
+        std::unique_ptr<SkSL::Program> program = compiler.convertProgram(
+                                                                 SkSL::Program::kPipelineStage_Kind,
+                                                                 SkSL::String(src), settings);
+        REPORTER_ASSERT(r, program);
+        if (program) {
+            REPORTER_ASSERT(r, !compiler.toByteCode(*program), "%s", src);
+        }
+    }
+}
+
+DEF_TEST(SkSLInterpreterPipelineStage, r) {
+    SkSL::Compiler compiler;
+    std::unique_ptr<SkSL::ByteCode> byteCode = compile(r, &compiler,
+        "void swizzle(inout float r, inout float g, inout float b, inout float a) {"
+        "    float t = r;"
+        "    r = b;"
+        "    b = t;"
+        "    a = a > 0.5 ? 1.0 : 0.0;"
+        "}");
+    if (!byteCode) {
+        return;
+    }
+
+    const int N = 37;
+    float src[4 * N], dst[4 * N];
+    for (int i = 0; i < 4 * N; i++) {
+        src[i] = i / (4.0f * N);
+    }
+    SkRasterPipeline_MemoryCtx srcCtx = { src, 0 },
+                               dstCtx = { dst, 0 };
+    SkSTArenaAlloc<256> alloc;
+    SkRasterPipeline p(&alloc);
+    p.append(SkRasterPipeline::load_f32, &srcCtx);
+    REPORTER_ASSERT(r, SkSL::Interpreter::AppendByteCodeStage(&p, &alloc,
+                                                              byteCode->getFunction("swizzle")));
+    p.append(SkRasterPipeline::store_f32, &dstCtx);
+    p.run(0, 0, N, 1);
+
+    for (int i = 0; i < N; i++) {
+        REPORTER_ASSERT(r, dst[4 * i + 0] == src[4 * i + 2]);
+        REPORTER_ASSERT(r, dst[4 * i + 1] == src[4 * i + 1]);
+        REPORTER_ASSERT(r, dst[4 * i + 2] == src[4 * i + 0]);
+        REPORTER_ASSERT(r, dst[4 * i + 3] == (src[4 * i + 3] > 0.5f ? 1.0f : 0.0f));
+    }
+}
+
+// Only functions taking one to four 'inout float' parameters can be pipeline stages.
+DEF_TEST(SkSLInterpreterPipelineStageUnsupported, r) {
+    SkSL::Compiler compiler;
+    std::unique_ptr<SkSL::ByteCode> byteCode = compile(r, &compiler,
+        "void none() {}"
+        "void five(inout float r, inout float g, inout float b, inout float a, inout float x) {}"
+        "void integer(inout float r, inout int g) {}"
+        "void readOnly(inout float r, float g) {}");
+    if (!byteCode) {
+        return;
+    }
+    SkSTArenaAlloc<256> alloc;
+    SkRasterPipeline p(&alloc);
+    for (const char* name : { "none", "five", "integer", "readOnly" }) {
+        const SkSL::ByteCodeFunction* f = byteCode->getFunction(name);
+        REPORTER_ASSERT(r, f);
+        REPORTER_ASSERT(r, !SkSL::Interpreter::AppendByteCodeStage(&p, &alloc, f), "%s", name);
+    }
+    REPORTER_ASSERT(r, p.empty());
+}
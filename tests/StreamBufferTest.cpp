@@ -111,6 +111,18 @@ DEF_TEST(StreamBuffer, r) {
         test_flushing(r, f.createStream(), size, true);
     }
 
+    // A stream in memory is read in place.
+    {
+        SkStreamBuffer buffer(skstd::make_unique<SkMemoryStream>(data));
+        REPORTER_ASSERT(r, buffer.buffer(5));
+        REPORTER_ASSERT(r, buffer.get() == gText);
+        buffer.flush();
+        REPORTER_ASSERT(r, buffer.buffer(5));
+        REPORTER_ASSERT(r, buffer.get() == gText + 5);
+        sk_sp<SkData> atPosition = buffer.getDataAtPosition(2, 7);
+        REPORTER_ASSERT(r, atPosition && atPosition->data() == gText + 2);
+    }
+
     // Stream that will receive more data. Will be owned by the SkStreamBuffer.
     auto halting = skstd::make_unique<HaltingStream>(data, 6);
     HaltingStream* peekHalting = halting.get();
@@ -0,0 +1,163 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkFont.h"
+#include "SkStrike.h"
+#include "SkStrikeCache.h"
+#include "SkTaskGroup.h"
+#include "SkTypeface.h"
+#include "Test.h"
+#include "sk_tool_utils.h"
+
+DEF_TEST(StrikeCache_Shared, r) {
+    SkFont font(sk_tool_utils::create_portable_typeface("serif", SkFontStyle()), 24);
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    font.setSubpixel(true);
+
+    SkAutoDescriptor ad;
+    SkScalerContextEffects effects;
+    const SkDescriptor* desc = SkScalerContext::CreateDescriptorAndEffectsUsingPaint(
+            font, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+            SkScalerContextFlags::kNone, SkMatrix::I(), &ad, &effects);
+    const SkTypeface& typeface = *font.getTypefaceOrDefault();
+
+    const int kGlyphs = 200;
+    const int kMoreGlyphs = 20;
+    const SkFixed kSubpixels[] = { 0, SK_Fixed1/4, SK_Fixed1/2 };
+
+    SkStrikeCache cache;
+    {
+        // Hold one reference ourselves, so we can check on the strike while the threads work.
+        SkSharedStrikePtr strike = cache.findOrCreateStrikeShared(*desc, effects, typeface);
+        REPORTER_ASSERT(r, strike);
+        // Shared strikes count against the cache's budgets, as any other strike does.
+        REPORTER_ASSERT(r, cache.getCacheCountUsed() == 1);
+        const size_t emptySize = cache.getTotalMemoryUsed();
+        REPORTER_ASSERT(r, emptySize > 0);
+
+        const int kThreads = 8;
+        const SkGlyph* seen[kThreads][kGlyphs][SK_ARRAY_COUNT(kSubpixels)];
+        SkTaskGroup().batch(kThreads, [&](int t) {
+            SkSharedStrikePtr mine = cache.findOrCreateStrikeShared(*desc, effects, typeface);
+            // Walk the glyphs in a different order on each thread to mix up who generates what.
+            for (int i = 0; i < kGlyphs; i++) {
+                int id = (i * 7 + t * 31) % kGlyphs;
+                for (size_t s = 0; s < SK_ARRAY_COUNT(kSubpixels); s++) {
+                    seen[t][id][s] = &mine.getGlyphIDMetrics(id, kSubpixels[s], 0);
+                }
+            }
+        });
+
+        // Every thread should have found the same glyphs, in the strike we're holding.
+        for (int t = 0; t < kThreads; t++)
+        for (int id = 0; id < kGlyphs; id++)
+        for (size_t s = 0; s < SK_ARRAY_COUNT(kSubpixels); s++) {
+            REPORTER_ASSERT(r, seen[t][id][s] == &strike.getGlyphIDMetrics(id, kSubpixels[s], 0));
+        }
+
+        // The glyphs the threads made are accounted for.
+        const size_t sharedSize = cache.getTotalMemoryUsed();
+        REPORTER_ASSERT(r, sharedSize > emptySize + kGlyphs * sizeof(SkGlyph));
+
+        // Shared strikes can't be purged.
+        cache.purgeAll();
+        REPORTER_ASSERT(r, cache.getCacheCountUsed() == 1);
+        REPORTER_ASSERT(r, cache.getTotalMemoryUsed() == sharedSize);
+
+        // Exclusive finds return the shared strike rather than make another, and what they add to
+        // it is accounted for once they let go.
+        {
+            SkExclusiveStrikePtr exclusive = cache.findStrikeExclusive(*desc);
+            REPORTER_ASSERT(r, exclusive);
+            REPORTER_ASSERT(r, &exclusive->getGlyphIDMetrics(0, 0, 0) ==
+                               &strike.getGlyphIDMetrics(0));
+            exclusive->getGlyphIDMetrics(kGlyphs);
+        }
+        {
+            SkExclusiveStrikePtr exclusive =
+                    cache.findOrCreateStrikeExclusive(*desc, effects, typeface);
+            REPORTER_ASSERT(r, cache.getCacheCountUsed() == 1);
+        }
+        REPORTER_ASSERT(r, cache.getTotalMemoryUsed() > sharedSize);
+
+        // Walking the strikes doesn't get in the way of threads adding glyphs to a shared one.
+        SkTaskGroup().batch(kThreads, [&](int t) {
+            if (t == 0) {
+                for (int i = 0; i < kMoreGlyphs; i++) {
+                    cache.validateGlyphCacheDataSize();
+                }
+                return;
+            }
+            SkSharedStrikePtr mine = cache.findOrCreateStrikeShared(*desc, effects, typeface);
+            for (int id = kGlyphs + 1; id <= kGlyphs + kMoreGlyphs; id++) {
+                mine.getGlyphIDMetrics(id);
+            }
+        });
+        REPORTER_ASSERT(r, cache.getCacheCountUsed() == 1);
+
+        // The glyphs should match what an exclusive strike makes.
+        SkStrikeCache other;
+        SkExclusiveStrikePtr exclusive = other.findOrCreateStrikeExclusive(*desc, effects, typeface);
+        for (int id = 0; id < kGlyphs; id++) {
+            const SkGlyph& expected = exclusive->getGlyphIDMetrics(id);
+            const void* expectedImage = exclusive->findImage(expected);
+            const SkGlyph& actual = strike.getGlyphIDMetrics(id);
+            REPORTER_ASSERT(r, actual.fWidth    == expected.fWidth  &&
+                               actual.fHeight   == expected.fHeight &&
+                               actual.fLeft     == expected.fLeft   &&
+                               actual.fTop      == expected.fTop    &&
+                               actual.fAdvanceX == expected.fAdvanceX);
+            REPORTER_ASSERT(r, (actual.fImage == nullptr) == (expectedImage == nullptr));
+            if (expectedImage) {
+                REPORTER_ASSERT(r, !memcmp(actual.fImage, expectedImage, expected.computeImageSize()));
+            }
+        }
+    }
+
+    // Once nobody is sharing the strike, it's back in the cache for anyone to find.
+    REPORTER_ASSERT(r, cache.getCacheCountUsed() == 1);
+    const size_t unsharedSize = cache.getTotalMemoryUsed();
+    {
+        SkExclusiveStrikePtr strike = cache.findStrikeExclusive(*desc);
+        REPORTER_ASSERT(r, strike);
+        REPORTER_ASSERT(r, strike->countCachedGlyphs() ==
+                           kGlyphs * (int)SK_ARRAY_COUNT(kSubpixels) + 1 + kMoreGlyphs);
+        REPORTER_ASSERT(r, strike->getMemoryUsed() == unsharedSize);
+    }
+    cache.purgeAll();
+    REPORTER_ASSERT(r, cache.getCacheCountUsed() == 0);
+}
+
+DEF_TEST(StrikeCache_SharedRasterText, r) {
+    // Raster text looks its glyphs up in shared strikes, so threads drawing the same text at the
+    // same time all draw from the same strike.
+    SkFont font(sk_tool_utils::create_portable_typeface("serif", SkFontStyle()), 17);
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    font.setSubpixel(true);
+
+    const int kThreads = 8;
+    SkBitmap bitmaps[kThreads];
+    SkTaskGroup().batch(kThreads, [&](int t) {
+        bitmaps[t].allocN32Pixels(128, 64);
+        bitmaps[t].eraseColor(SK_ColorWHITE);
+        SkCanvas canvas(bitmaps[t]);
+        canvas.drawString("Shared strikes", 3.25f, 20, font, SkPaint());
+        canvas.drawString("Shared strikes", 3.75f, 50, font, SkPaint());
+    });
+
+    SkBitmap blank;
+    blank.allocN32Pixels(128, 64);
+    blank.eraseColor(SK_ColorWHITE);
+    REPORTER_ASSERT(r, memcmp(bitmaps[0].getPixels(), blank.getPixels(),
+                              blank.computeByteSize()));
+    for (int t = 1; t < kThreads; t++) {
+        REPORTER_ASSERT(r, !memcmp(bitmaps[0].getPixels(), bitmaps[t].getPixels(),
+                                   bitmaps[0].computeByteSize()));
+    }
+}
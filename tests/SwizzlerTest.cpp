@@ -5,7 +5,9 @@
  * found in the LICENSE file.
  */
 
+#include "SkCodecPriv.h"
 #include "SkImageInfoPriv.h"
+#include "SkRandom.h"
 #include "SkSwizzle.h"
 #include "SkSwizzler.h"
 #include "Test.h"
@@ -152,3 +154,97 @@ DEF_TEST(PublicSwizzleOpts, r) {
     SkSwapRB(&dst, &src, 1);
     REPORTER_ASSERT(r, dst == 0xFA04B0CE);
 }
+
+// Sampled rows are converted by the same SkOpts procs as full rows, after gathering the sampled
+// pixels.  Check them against converting each sampled pixel on its own.
+DEF_TEST(SwizzlerSampled, r) {
+    constexpr int kWidth = 37;
+    SkRandom rand;
+    uint8_t src[kWidth * 8];
+    for (uint8_t& byte : src) {
+        byte = rand.nextU() & 0xFF;
+    }
+    SkPMColor ctable[256];
+    for (SkPMColor& color : ctable) {
+        color = rand.nextU();
+    }
+
+    const struct {
+        SkEncodedInfo::Color fColor;
+        SkEncodedInfo::Alpha fAlpha;
+        int                  fBitsPerComponent;
+    } kSrcs[] = {
+        { SkEncodedInfo::kGray_Color,         SkEncodedInfo::kOpaque_Alpha,    8 },
+        { SkEncodedInfo::kGrayAlpha_Color,    SkEncodedInfo::kUnpremul_Alpha,  8 },
+        { SkEncodedInfo::kPalette_Color,      SkEncodedInfo::kOpaque_Alpha,    8 },
+        { SkEncodedInfo::kRGB_Color,          SkEncodedInfo::kOpaque_Alpha,    8 },
+        { SkEncodedInfo::kRGBA_Color,         SkEncodedInfo::kUnpremul_Alpha,  8 },
+        { SkEncodedInfo::kBGRA_Color,         SkEncodedInfo::kUnpremul_Alpha,  8 },
+        { SkEncodedInfo::kInvertedCMYK_Color, SkEncodedInfo::kOpaque_Alpha,    8 },
+        { SkEncodedInfo::kRGB_Color,          SkEncodedInfo::kOpaque_Alpha,   16 },
+        { SkEncodedInfo::kRGBA_Color,         SkEncodedInfo::kUnpremul_Alpha, 16 },
+    };
+
+    // Returns the color of the pixel at p, before premultiplying.
+    auto unpremulColor = [](SkEncodedInfo::Color color, int bitsPerComponent, const uint8_t* p) {
+        const int step = bitsPerComponent / 8;
+        switch (color) {
+            case SkEncodedInfo::kGray_Color:
+                return SkColorSetARGB(0xFF, p[0], p[0], p[0]);
+            case SkEncodedInfo::kGrayAlpha_Color:
+                return SkColorSetARGB(p[1], p[0], p[0], p[0]);
+            case SkEncodedInfo::kRGB_Color:
+                return SkColorSetARGB(0xFF, p[0], p[step], p[2 * step]);
+            case SkEncodedInfo::kRGBA_Color:
+                return SkColorSetARGB(p[3 * step], p[0], p[step], p[2 * step]);
+            case SkEncodedInfo::kBGRA_Color:
+                return SkColorSetARGB(p[3], p[2], p[1], p[0]);
+            case SkEncodedInfo::kInvertedCMYK_Color:
+                return SkColorSetARGB(0xFF, SkMulDiv255Round(p[0], p[3]),
+                                      SkMulDiv255Round(p[1], p[3]), SkMulDiv255Round(p[2], p[3]));
+            default:
+                SkASSERT(false);
+                return SK_ColorTRANSPARENT;
+        }
+    };
+
+    for (const auto& s : kSrcs) {
+        const SkEncodedInfo info = SkEncodedInfo::Make(kWidth, 1, s.fColor, s.fAlpha,
+                                                       s.fBitsPerComponent);
+        const int srcBPP = info.bitsPerPixel() / 8;
+        for (SkColorType colorType : { kRGBA_8888_SkColorType, kBGRA_8888_SkColorType }) {
+            for (SkAlphaType alphaType : { kPremul_SkAlphaType, kUnpremul_SkAlphaType }) {
+                const SkImageInfo dstInfo = SkImageInfo::Make(kWidth, 1, colorType, alphaType);
+                for (int sampleX : { 1, 2, 3, 5, 8 }) {
+                    auto swizzler = SkSwizzler::Make(info, ctable, dstInfo, SkCodec::Options());
+                    REPORTER_ASSERT(r, swizzler);
+                    if (!swizzler) {
+                        continue;
+                    }
+                    const int width = swizzler->setSampleX(sampleX);
+                    REPORTER_ASSERT(r, width == get_scaled_dimension(kWidth, sampleX));
+
+                    uint32_t dst[kWidth];
+                    swizzler->swizzle(dst, src);
+                    for (int x = 0; x < width; x++) {
+                        const uint8_t* p = src + (get_start_coord(sampleX) + x * sampleX) * srcBPP;
+                        uint32_t expected;
+                        if (SkEncodedInfo::kPalette_Color == s.fColor) {
+                            expected = ctable[p[0]];
+                        } else {
+                            SkColor c = unpremulColor(s.fColor, s.fBitsPerComponent, p);
+                            auto pack = choose_pack_color_proc(kPremul_SkAlphaType == alphaType &&
+                                    SkEncodedInfo::kOpaque_Alpha != s.fAlpha, colorType);
+                            expected = pack(SkColorGetA(c), SkColorGetR(c), SkColorGetG(c),
+                                            SkColorGetB(c));
+                        }
+                        REPORTER_ASSERT(r, dst[x] == expected,
+                                        "color %d, %d bits, sampleX %d, x %d: %08x != %08x",
+                                        s.fColor, s.fBitsPerComponent, sampleX, x, dst[x],
+                                        expected);
+                    }
+                }
+            }
+        }
+    }
+}
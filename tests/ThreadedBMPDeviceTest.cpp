@@ -0,0 +1,218 @@
+/*
+ * Copyright 2019 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkGradientShader.h"
+#include "SkPath.h"
+#include "SkRRect.h"
+#include "SkScan.h"
+#include "SkThreadedBMPDevice.h"
+#include "Test.h"
+
+static void draw_scene(SkCanvas* canvas) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+
+    const SkPoint pts[] = {{0, 0}, {256, 256}};
+    const SkColor colors[] = {SK_ColorRED, SK_ColorBLUE};
+    paint.setShader(SkGradientShader::MakeLinear(pts, colors, nullptr, 2,
+                                                 SkShader::kClamp_TileMode));
+    canvas->drawPaint(paint);
+    paint.setShader(nullptr);
+
+    // A star big enough to have its coverage recorded once and shared by every tile.
+    SkPath star;
+    star.moveTo(128, 10);
+    for (int i = 1; i < 5; i++) {
+        SkScalar angle = i * 4 * SK_ScalarPI / 5;
+        star.lineTo(128 + 118 * SkScalarSin(angle), 128 - 118 * SkScalarCos(angle));
+    }
+    star.close();
+    paint.setColor(0x8000FF00);
+    canvas->drawPath(star, paint);
+
+    star.setFillType(SkPath::kEvenOdd_FillType);
+    canvas->save();
+        canvas->translate(13.5f, 7.25f);
+        canvas->rotate(20);
+        canvas->clipRect(SkRect::MakeLTRB(20, 30, 200, 150), true);
+        paint.setColor(SK_ColorYELLOW);
+        canvas->drawPath(star, paint);
+    canvas->restore();
+
+    paint.setStyle(SkPaint::kStroke_Style);
+    paint.setStrokeWidth(5);
+    paint.setColor(SK_ColorBLACK);
+    canvas->drawRRect(SkRRect::MakeRectXY(SkRect::MakeLTRB(30, 40, 220, 230), 20, 30), paint);
+    canvas->drawCircle(128, 128, 60, paint);
+
+    paint.setStyle(SkPaint::kFill_Style);
+    paint.setAntiAlias(false);
+    paint.setColor(SK_ColorCYAN);
+    canvas->drawRect(SkRect::MakeLTRB(100.5f, 3, 140, 250), paint);
+
+    const SkPoint points[] = {{10, 10}, {50, 200}, {245, 100}, {150, 20}};
+    paint.setStrokeWidth(3);
+    canvas->drawPoints(SkCanvas::kPoints_PointMode, SK_ARRAY_COUNT(points), points, paint);
+}
+
+// Inverse fills have no bounds, so every tile draws them.
+static void draw_inverse_fills(SkCanvas* canvas) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+
+    SkPath star;
+    star.moveTo(128, 10);
+    for (int i = 1; i < 5; i++) {
+        SkScalar angle = i * 4 * SK_ScalarPI / 5;
+        star.lineTo(128 + 118 * SkScalarSin(angle), 128 - 118 * SkScalarCos(angle));
+    }
+    star.close();
+    star.setFillType(SkPath::kInverseWinding_FillType);
+    canvas->save();
+        canvas->clipRect(SkRect::MakeLTRB(20.5f, 30, 230, 240), true);
+        paint.setColor(0x80FF0000);
+        canvas->drawPath(star, paint);
+    canvas->restore();
+
+    SkPath circle;
+    circle.addCircle(100, 150, 40);
+    circle.setFillType(SkPath::kInverseEvenOdd_FillType);
+    paint.setColor(0x400000FF);
+    canvas->drawPath(circle, paint);
+    paint.setAntiAlias(false);
+    paint.setColor(0x2000FF00);
+    canvas->drawPath(circle, paint);
+}
+
+// Aliased lines and strokes are clipped to each tile before they're scan converted, which can
+// move their edges by a pixel where they cross, or run near, a tile boundary.
+static void draw_aliased_lines(SkCanvas* canvas) {
+    SkPaint paint;
+    paint.setColor(SK_ColorBLACK);
+    const SkPoint points[] = {{10, 10}, {50, 200}, {245, 100}, {150, 20}, {12, 250}};
+    canvas->drawPoints(SkCanvas::kPolygon_PointMode, SK_ARRAY_COUNT(points), points, paint);
+    paint.setStrokeWidth(3);
+    canvas->translate(3.5f, 1.25f);
+    canvas->drawPoints(SkCanvas::kPolygon_PointMode, SK_ARRAY_COUNT(points), points, paint);
+}
+
+// Returns true if every pixel of actual matches expected at that pixel or one of its neighbors.
+static bool within_one_pixel(const SkBitmap& expected, const SkBitmap& actual) {
+    for (int y = 0; y < actual.height(); y++) {
+        for (int x = 0; x < actual.width(); x++) {
+            const SkColor c = actual.getColor(x, y);
+            bool found = false;
+            for (int dy = -1; dy <= 1 && !found; dy++) {
+                for (int dx = -1; dx <= 1 && !found; dx++) {
+                    const int ex = x + dx, ey = y + dy;
+                    found = ex >= 0 && ey >= 0 && ex < expected.width() && ey < expected.height()
+                         && expected.getColor(ex, ey) == c;
+                }
+            }
+            if (!found) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Returns true if each 4x4 block of actual is, on average, within 8 of expected in every channel.
+// Shared coverage is computed with delta AA, which an SkBitmapDevice doesn't pick for these paths,
+// and which differs from what it does pick by up to a few dozen along edges. Drawing a tile twice,
+// or leaving out part of one, moves whole blocks much further than that.
+static bool close_to(const SkBitmap& expected, const SkBitmap& actual) {
+    constexpr int kBlock = 4, kTolerance = 8 * kBlock * kBlock;
+    for (int by = 0; by < actual.height(); by += kBlock) {
+        for (int bx = 0; bx < actual.width(); bx += kBlock) {
+            for (int shift = 0; shift < 32; shift += 8) {
+                int diff = 0;
+                for (int y = by; y < SkTMin(by + kBlock, actual.height()); y++) {
+                    for (int x = bx; x < SkTMin(bx + kBlock, actual.width()); x++) {
+                        diff += (int) ((*actual.getAddr32(x, y) >> shift) & 0xFF) -
+                                (int) ((*expected.getAddr32(x, y) >> shift) & 0xFF);
+                    }
+                }
+                if (SkTAbs(diff) > kTolerance) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+static SkBitmap draw_plain(void (*draw)(SkCanvas*)) {
+    SkBitmap bitmap;
+    bitmap.allocPixels(SkImageInfo::MakeN32Premul(256, 256));
+    bitmap.eraseColor(SK_ColorTRANSPARENT);
+    SkCanvas canvas(bitmap);
+    draw(&canvas);
+    return bitmap;
+}
+
+static SkBitmap draw_threaded(void (*draw)(SkCanvas*), int tiles, SkExecutor* executor) {
+    SkBitmap bitmap;
+    bitmap.allocPixels(SkImageInfo::MakeN32Premul(256, 256));
+    bitmap.eraseColor(SK_ColorTRANSPARENT);
+    SkCanvas canvas(sk_make_sp<SkThreadedBMPDevice>(bitmap, tiles, 0, executor));
+    draw(&canvas);
+    canvas.flush();
+    return bitmap;
+}
+
+DEF_TEST(ThreadedBMPDevice, r) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(256, 256);
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    // The device picks delta AA for the paths whose coverage it shares between tiles, which an
+    // SkBitmapDevice would only do if told to, so we expect the device with many tiles to match
+    // the device with a single tile exactly, and a plain canvas closely.
+    const SkBitmap expected = draw_threaded(draw_scene, 1, executor.get());
+    const SkBitmap expectedInverse = draw_threaded(draw_inverse_fills, 1, executor.get());
+    const SkBitmap plain = draw_plain(draw_scene);
+    const SkBitmap plainInverse = draw_plain(draw_inverse_fills);
+
+    // With one tile, that's just an SkBitmapDevice, apart from the paths it records.
+    const SkBitmap expectedLines = draw_plain(draw_aliased_lines);
+    {
+        SkBitmap actual = draw_threaded(draw_aliased_lines, 1, executor.get());
+        REPORTER_ASSERT(r, !memcmp(actual.getPixels(), expectedLines.getPixels(),
+                                   expectedLines.computeByteSize()));
+    }
+
+    for (int tiles : {3, 8, 256}) {
+        SkBitmap actual;
+        actual.allocPixels(info);
+        actual.eraseColor(SK_ColorTRANSPARENT);
+        {
+            SkCanvas canvas(sk_make_sp<SkThreadedBMPDevice>(actual, tiles, 0, executor.get()));
+            draw_scene(&canvas);
+
+            // Reading back through the canvas must see every queued draw.
+            SkBitmap readBack;
+            readBack.allocPixels(info);
+            REPORTER_ASSERT(r, canvas.readPixels(readBack, 0, 0));
+            REPORTER_ASSERT(r, !memcmp(readBack.getPixels(), expected.getPixels(),
+                                       expected.computeByteSize()));
+        }
+        REPORTER_ASSERT(r, !memcmp(actual.getPixels(), expected.getPixels(),
+                                   expected.computeByteSize()), "tiles=%d", tiles);
+        REPORTER_ASSERT(r, close_to(plain, actual), "tiles=%d", tiles);
+
+        SkBitmap inverse = draw_threaded(draw_inverse_fills, tiles, executor.get());
+        REPORTER_ASSERT(r, !memcmp(inverse.getPixels(), expectedInverse.getPixels(),
+                                   expectedInverse.computeByteSize()), "tiles=%d", tiles);
+        REPORTER_ASSERT(r, close_to(plainInverse, inverse), "tiles=%d", tiles);
+
+        REPORTER_ASSERT(r, within_one_pixel(expectedLines,
+                                            draw_threaded(draw_aliased_lines, tiles,
+                                                          executor.get())), "tiles=%d", tiles);
+    }
+}
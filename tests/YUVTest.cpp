@@ -7,7 +7,10 @@
 
 #include "Resources.h"
 #include "SkAutoMalloc.h"
+#include "SkBitmap.h"
 #include "SkCodec.h"
+#include "SkConvertPixels.h"
+#include "SkRandom.h"
 #include "SkStream.h"
 #include "SkTemplates.h"
 #include "SkYUVASizeInfo.h"
@@ -15,7 +18,8 @@
 
 static void codec_yuv(skiatest::Reporter* reporter,
                       const char path[],
-                      SkISize expectedSizes[4]) {
+                      SkISize expectedSizes[4],
+                      SkYUVColorSpace expectedColorSpace = kJPEG_SkYUVColorSpace) {
     std::unique_ptr<SkStream> stream(GetResourceAsStream(path));
     if (!stream) {
         return;
@@ -58,7 +62,7 @@ static void codec_yuv(skiatest::Reporter* reporter,
             REPORTER_ASSERT(reporter,
                             info.fWidthBytes[i] == (uint32_t) SkAlign8(info.fSizes[i].width()));
         }
-        REPORTER_ASSERT(reporter, kJPEG_SkYUVColorSpace == colorSpace);
+        REPORTER_ASSERT(reporter, expectedColorSpace == colorSpace);
     }
 
     // Allocate the memory for the YUV decode
@@ -124,3 +128,96 @@ DEF_TEST(Jpeg_YUV_Codec, r) {
     // A PNG should fail.
     codec_yuv(r, "images/arrow.png", nullptr);
 }
+
+DEF_TEST(Webp_YUV_Codec, r) {
+    // Lossy, opaque, and still.
+    SkISize sizes[4];
+    sizes[0].set(800, 800);
+    sizes[1].set(400, 400);
+    sizes[2].set(400, 400);
+    sizes[3].set(0, 0);
+    codec_yuv(r, "images/webp-color-profile-lossy.webp", sizes, kRec601_SkYUVColorSpace);
+
+    // Lossless, lossy with alpha, and animated images should fail.
+    codec_yuv(r, "images/color_wheel.webp", nullptr);
+    codec_yuv(r, "images/yellow_rose.webp", nullptr);
+    codec_yuv(r, "images/webp-animated.webp", nullptr);
+}
+
+DEF_TEST(YUV_ConvertPixels, r) {
+    // With the identity color space, each pixel is just its Y, U, and V samples, so this checks
+    // which chroma sample each pixel gets, including in the tail of each row.
+    SkRandom random;
+    for (SkISize uvScale : { SkISize{1, 1}, SkISize{2, 1}, SkISize{2, 2}, SkISize{4, 2} }) {
+        const int width = 37, height = 5;
+        SkYUVASizeInfo info;
+        info.fSizes[0].set(width, height);
+        info.fSizes[1].set((width + uvScale.width() - 1) / uvScale.width(),
+                           (height + uvScale.height() - 1) / uvScale.height());
+        info.fSizes[2] = info.fSizes[1];
+        info.fSizes[3].set(0, 0);
+        for (int i = 0; i < 3; i++) {
+            info.fWidthBytes[i] = SkAlign8(info.fSizes[i].width());
+        }
+        info.fWidthBytes[3] = 0;
+
+        SkAutoMalloc storage(info.computeTotalBytes());
+        void* planes[SkYUVASizeInfo::kMaxCount];
+        info.computePlanes(storage.get(), planes);
+        for (size_t i = 0; i < info.computeTotalBytes(); i++) {
+            ((uint8_t*)storage.get())[i] = random.nextU() & 0xFF;
+        }
+
+        SkBitmap bm;
+        bm.allocPixels(SkImageInfo::Make(width, height, kRGBA_8888_SkColorType,
+                                         kOpaque_SkAlphaType));
+        REPORTER_ASSERT(r, SkConvertYUVPixels(bm.pixmap(), info, planes,
+                                              kIdentity_SkYUVColorSpace));
+        for (int y = 0; y < height; y++) {
+            const uint8_t* yRow = SkTAddOffset<uint8_t>(planes[0], y * info.fWidthBytes[0]);
+            const int uvY = y / uvScale.height();
+            const uint8_t* uRow = SkTAddOffset<uint8_t>(planes[1], uvY * info.fWidthBytes[1]);
+            const uint8_t* vRow = SkTAddOffset<uint8_t>(planes[2], uvY * info.fWidthBytes[2]);
+            for (int x = 0; x < width; x++) {
+                const int uvX = x / uvScale.width();
+                const uint32_t expected = 0xFF000000 | vRow[uvX] << 16 | uRow[uvX] << 8 | yRow[x];
+                REPORTER_ASSERT(r, *bm.getAddr32(x, y) == expected,
+                                "(%d, %d): %08x != %08x", x, y, *bm.getAddr32(x, y), expected);
+            }
+        }
+    }
+
+    // Without subsampling, converting a jpeg's planes should match decoding it to RGB.
+    std::unique_ptr<SkCodec> codec = SkCodec::MakeFromStream(
+            GetResourceAsStream("images/mandrill_h1v1.jpg"));
+    if (!codec) {
+        return;
+    }
+    SkYUVASizeInfo info;
+    SkYUVColorSpace colorSpace;
+    REPORTER_ASSERT(r, codec->queryYUV8(&info, &colorSpace));
+    SkAutoMalloc storage(info.computeTotalBytes());
+    void* planes[SkYUVASizeInfo::kMaxCount];
+    info.computePlanes(storage.get(), planes);
+    REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getYUV8Planes(info, planes));
+
+    const SkImageInfo rgbInfo = codec->getInfo().makeColorType(kRGBA_8888_SkColorType)
+                                                .makeColorSpace(nullptr);
+    SkBitmap expected, actual;
+    expected.allocPixels(rgbInfo);
+    actual.allocPixels(rgbInfo);
+    REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getPixels(expected.pixmap()));
+    REPORTER_ASSERT(r, SkConvertYUVPixels(actual.pixmap(), info, planes, colorSpace));
+    int maxDiff = 0;
+    for (int y = 0; y < rgbInfo.height(); y++) {
+        for (int x = 0; x < rgbInfo.width(); x++) {
+            const uint32_t e = *expected.getAddr32(x, y),
+                           a = *actual.getAddr32(x, y);
+            for (int shift = 0; shift < 32; shift += 8) {
+                maxDiff = SkTMax(maxDiff, SkTAbs((int)((e >> shift) & 0xFF) -
+                                                 (int)((a >> shift) & 0xFF)));
+            }
+        }
+    }
+    REPORTER_ASSERT(r, maxDiff <= 2, "max difference %d", maxDiff);
+}